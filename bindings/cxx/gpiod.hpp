@@ -34,6 +34,7 @@
 #include "gpiodcxx/line-config.hpp"
 #include "gpiodcxx/line-info.hpp"
 #include "gpiodcxx/line-request.hpp"
+#include "gpiodcxx/line-resolver.hpp"
 #include "gpiodcxx/line-settings.hpp"
 #include "gpiodcxx/request-builder.hpp"
 #include "gpiodcxx/request-config.hpp"
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/* SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file line-resolver.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_LINE_RESOLVER_HPP__
+#define __LIBGPIOD_CXX_LINE_RESOLVER_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "line.hpp"
+
+namespace gpiod {
+
+/**
+ * @brief Index of line names across all GPIO chips in the system.
+ *
+ * Looking up a line by name otherwise requires opening every chip and
+ * querying each of its lines. The resolver does this once, optionally backed
+ * by a cache file, and then answers lookups from memory.
+ *
+ * The resolver is a snapshot. It doesn't track line names changing or chips
+ * appearing after it was created. Chips the caller doesn't have permission to
+ * open are skipped.
+ */
+class line_resolver final
+{
+public:
+
+	/**
+	 * @brief Default location of the line name cache file.
+	 */
+	static const ::std::filesystem::path default_cache;
+
+	/**
+	 * @brief Index the line names of all GPIO chips in the system
+	 *        without using a cache file.
+	 */
+	line_resolver();
+
+	/**
+	 * @brief Index the line names of all GPIO chips in the system.
+	 * @param cache_path Path to the cache file storing the line names
+	 *                   between runs. Failing to write the cache is not an
+	 *                   error.
+	 */
+	explicit line_resolver(const ::std::filesystem::path& cache_path);
+
+	line_resolver(const line_resolver& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	line_resolver(line_resolver&& other) noexcept;
+
+	~line_resolver();
+
+	line_resolver& operator=(const line_resolver& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	line_resolver& operator=(line_resolver&& other) noexcept;
+
+	/**
+	 * @brief Get the paths of all indexed chips.
+	 * @return Paths to the chips' character devices, sorted.
+	 */
+	::std::vector<::std::filesystem::path> chip_paths() const;
+
+	/**
+	 * @brief Find a line by name.
+	 * @param name Name of the line.
+	 * @return Path of the chip and offset of the first line with this name
+	 *         or an empty optional if there is no such line. Lines are
+	 *         matched in chip and offset order.
+	 */
+	::std::optional<::std::pair<::std::filesystem::path, line::offset>>
+	find(const ::std::string& name) const;
+
+	/**
+	 * @brief Get the number of lines with the given name.
+	 * @param name Name of the line.
+	 * @return Number of lines with this name across all chips.
+	 */
+	::std::size_t count(const ::std::string& name) const;
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_LINE_RESOLVER_HPP__ */
@@ -50,6 +50,7 @@ using line_request_deleter = deleter<::gpiod_line_request, ::gpiod_line_request_
 using edge_event_deleter = deleter<::gpiod_edge_event, ::gpiod_edge_event_free>;
 using edge_event_buffer_deleter = deleter<::gpiod_edge_event_buffer,
 					  ::gpiod_edge_event_buffer_free>;
+using line_resolver_deleter = deleter<::gpiod_line_resolver, ::gpiod_line_resolver_free>;
 
 using chip_ptr = ::std::unique_ptr<::gpiod_chip, chip_deleter>;
 using chip_info_ptr = ::std::unique_ptr<::gpiod_chip_info, chip_info_deleter>;
@@ -62,6 +63,7 @@ using line_request_ptr = ::std::unique_ptr<::gpiod_line_request, line_request_de
 using edge_event_ptr = ::std::unique_ptr<::gpiod_edge_event, edge_event_deleter>;
 using edge_event_buffer_ptr = ::std::unique_ptr<::gpiod_edge_event_buffer,
 						edge_event_buffer_deleter>;
+using line_resolver_ptr = ::std::unique_ptr<::gpiod_line_resolver, line_resolver_deleter>;
 
 struct chip::impl
 {
@@ -229,6 +231,20 @@ struct edge_event_buffer::impl
 	::std::vector<edge_event> events;
 };
 
+struct line_resolver::impl
+{
+	impl(const char* cache_path);
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	int find(const ::std::string& name, ::std::size_t* chip_index,
+		 unsigned int* offset) const;
+
+	line_resolver_ptr resolver;
+};
+
 } /* namespace gpiod */
 
 #endif /* __LIBGPIOD_CXX_INTERNAL_HPP__ */
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+line_resolver_ptr make_line_resolver(const char* cache_path)
+{
+	line_resolver_ptr resolver(::gpiod_line_resolver_new(cache_path));
+	if (!resolver)
+		throw_from_errno("unable to index the GPIO lines");
+
+	return resolver;
+}
+
+} /* namespace */
+
+GPIOD_CXX_API const ::std::filesystem::path line_resolver::default_cache =
+					GPIOD_LINE_RESOLVER_DEFAULT_CACHE;
+
+line_resolver::impl::impl(const char* cache_path)
+	: resolver(make_line_resolver(cache_path))
+{
+
+}
+
+int line_resolver::impl::find(const ::std::string& name, ::std::size_t* chip_index,
+			      unsigned int* offset) const
+{
+	int ret;
+
+	ret = ::gpiod_line_resolver_find(this->resolver.get(), name.c_str(),
+					 chip_index, offset);
+	if (ret < 0)
+		throw_from_errno("unable to look up the line " + name);
+
+	return ret;
+}
+
+GPIOD_CXX_API line_resolver::line_resolver()
+	: _m_priv(new impl(nullptr))
+{
+
+}
+
+GPIOD_CXX_API line_resolver::line_resolver(const ::std::filesystem::path& cache_path)
+	: _m_priv(new impl(cache_path.c_str()))
+{
+
+}
+
+GPIOD_CXX_API line_resolver::line_resolver(line_resolver&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API line_resolver::~line_resolver()
+{
+
+}
+
+GPIOD_CXX_API line_resolver& line_resolver::operator=(line_resolver&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::vector<::std::filesystem::path> line_resolver::chip_paths() const
+{
+	auto num_chips = ::gpiod_line_resolver_get_num_chips(this->_m_priv->resolver.get());
+	::std::vector<::std::filesystem::path> paths;
+
+	paths.reserve(num_chips);
+
+	for (::std::size_t i = 0; i < num_chips; i++)
+		paths.push_back(::gpiod_line_resolver_get_chip_path(
+					this->_m_priv->resolver.get(), i));
+
+	return paths;
+}
+
+GPIOD_CXX_API ::std::optional<::std::pair<::std::filesystem::path, line::offset>>
+line_resolver::find(const ::std::string& name) const
+{
+	::std::size_t chip_index;
+	unsigned int offset;
+
+	if (!this->_m_priv->find(name, &chip_index, &offset))
+		return ::std::nullopt;
+
+	return ::std::make_pair(::std::filesystem::path(
+			::gpiod_line_resolver_get_chip_path(this->_m_priv->resolver.get(),
+							    chip_index)),
+			line::offset(offset));
+}
+
+GPIOD_CXX_API ::std::size_t line_resolver::count(const ::std::string& name) const
+{
+	return this->_m_priv->find(name, nullptr, nullptr);
+}
+
+} /* namespace gpiod */
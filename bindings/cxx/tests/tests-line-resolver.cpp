@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <gpiod.hpp>
+#include <string>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+
+namespace {
+
+bool contains(const ::std::vector<::std::filesystem::path>& paths,
+	      const ::std::filesystem::path& path)
+{
+	return ::std::find(paths.begin(), paths.end(), path) != paths.end();
+}
+
+TEST_CASE("line_resolver finds lines by name", "[line-resolver]")
+{
+	auto first = make_sim()
+		.set_num_lines(8)
+		.set_line_name(1, "resolver-foo")
+		.set_line_name(3, "resolver-dup")
+		.build();
+
+	auto second = make_sim()
+		.set_num_lines(8)
+		.set_line_name(0, "resolver-dup")
+		.set_line_name(6, "resolver-bar")
+		.build();
+
+	::gpiod::line_resolver resolver;
+
+	SECTION("lines on multiple chips are found")
+	{
+		auto foo = resolver.find("resolver-foo");
+		auto bar = resolver.find("resolver-bar");
+
+		REQUIRE(foo);
+		REQUIRE(foo->first == first.dev_path());
+		REQUIRE(foo->second == 1);
+		REQUIRE(bar);
+		REQUIRE(bar->first == second.dev_path());
+		REQUIRE(bar->second == 6);
+	}
+
+	SECTION("first of duplicate names is returned")
+	{
+		auto dup = resolver.find("resolver-dup");
+
+		REQUIRE(dup);
+		REQUIRE(dup->first == first.dev_path());
+		REQUIRE(dup->second == 3);
+		REQUIRE(resolver.count("resolver-dup") == 2);
+	}
+
+	SECTION("nonexistent line is not found")
+	{
+		REQUIRE_FALSE(resolver.find("resolver-none"));
+		REQUIRE(resolver.count("resolver-none") == 0);
+	}
+
+	SECTION("chip paths are listed")
+	{
+		auto paths = resolver.chip_paths();
+
+		REQUIRE(contains(paths, first.dev_path()));
+		REQUIRE(contains(paths, second.dev_path()));
+	}
+}
+
+TEST_CASE("line_resolver can use a cache file", "[line-resolver]")
+{
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.set_line_name(5, "resolver-cached")
+		.build();
+
+	char tmpl[] = "/tmp/gpiod-cxx-resolver-XXXXXX";
+	REQUIRE(::mkdtemp(tmpl));
+	::std::filesystem::path dir(tmpl);
+	auto cache = dir / "line-names.cache";
+
+	{
+		::gpiod::line_resolver resolver(cache);
+
+		REQUIRE(::std::filesystem::exists(cache));
+	}
+
+	::gpiod::line_resolver resolver(cache);
+	auto found = resolver.find("resolver-cached");
+
+	REQUIRE(found);
+	REQUIRE(found->first == sim.dev_path());
+	REQUIRE(found->second == 5);
+
+	::std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("line_resolver can be moved", "[line-resolver]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.set_line_name(2, "resolver-moved")
+		.build();
+
+	::gpiod::line_resolver resolver;
+
+	SECTION("move constructor works")
+	{
+		auto moved(::std::move(resolver));
+
+		REQUIRE(moved.count("resolver-moved") == 1);
+	}
+
+	SECTION("move assignment operator works")
+	{
+		::gpiod::line_resolver moved(::std::filesystem::path("/nonexistent/cache"));
+
+		moved = ::std::move(resolver);
+
+		REQUIRE(moved.count("resolver-moved") == 1);
+	}
+}
+
+} /* namespace */
@@ -5,29 +5,19 @@
 """Minimal example of finding a line with the given name."""
 
 import gpiod
-import os
-
-
-def generate_gpio_chips():
-    for entry in os.scandir("/dev/"):
-        if gpiod.is_gpiochip_device(entry.path):
-            yield entry.path
 
 
 def find_line_by_name(line_name):
     # Names are not guaranteed unique, so this finds the first line with
     # the given name.
-    for path in generate_gpio_chips():
-        with gpiod.Chip(path) as chip:
-            try:
-                offset = chip.line_offset_from_id(line_name)
-                print("{}: {} {}".format(line_name, chip.get_info().name, offset))
-                return
-            except OSError:
-                # An OSError is raised if the name is not found.
-                continue
-
-    print("line '{}' not found".format(line_name))
+    found = gpiod.LineResolver().find(line_name)
+    if not found:
+        print("line '{}' not found".format(line_name))
+        return
+
+    path, offset = found
+    with gpiod.Chip(path) as chip:
+        print("{}: {} {}".format(line_name, chip.get_info().name, offset))
 
 
 if __name__ == "__main__":
@@ -20,6 +20,7 @@ from . import (
     line,
     line_info,
     line_request,
+    line_resolver,
     line_settings,
     version,
 )
@@ -30,6 +31,7 @@ from .exception import *
 from .info_event import *
 from .line_info import *
 from .line_request import *
+from .line_resolver import *
 from .line_settings import *
 from .version import __version__
 
@@ -45,6 +47,7 @@ __all__ = [
     "line",
     "line_info",
     "line_request",
+    "line_resolver",
     "line_settings",
     "version",
 ]
@@ -59,6 +62,7 @@ __all__ += (
     + info_event.__all__
     + line_info.__all__
     + line_request.__all__
+    + line_resolver.__all__
     + line_settings.__all__
 )
 
@@ -61,9 +61,17 @@ class Chip:
     @property
     def fd(self) -> int: ...
 
+class LineResolver:
+    def __init__(self, cache_path: Optional[str]) -> None: ...
+    # (chip path, offset of the first match, number of matches) or None
+    def find(self, name: str) -> Optional[tuple[str, int, int]]: ...
+    @property
+    def chip_paths(self) -> list[str]: ...
+
 def is_gpiochip_device(path: str) -> bool: ...
 
 api_version: str
+LINE_RESOLVER_DEFAULT_CACHE: str
 
 # enum constants
 BIAS_AS_IS: int
@@ -134,6 +134,10 @@ class Chip:
           the chip. If it fails, it tries to convert the string to an integer
           and check if it represents a valid offset within the chip and if
           so - returns it.
+
+        Note:
+          Only this chip is searched. Use gpiod.LineResolver to look lines up
+          by name across all chips in the system.
         """
         self._check_closed()
 
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include "internal.h"
+
+typedef struct {
+	PyObject_HEAD;
+	struct gpiod_line_resolver *resolver;
+} line_resolver_object;
+
+static int
+line_resolver_init(line_resolver_object *self, PyObject *args,
+		   PyObject *Py_UNUSED(ignored))
+{
+	struct gpiod_line_resolver *resolver;
+	const char *cache_path;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "z", &cache_path);
+	if (!ret)
+		return -1;
+
+	Py_BEGIN_ALLOW_THREADS;
+	resolver = gpiod_line_resolver_new(cache_path);
+	Py_END_ALLOW_THREADS;
+	if (!resolver) {
+		Py_gpiod_SetErrFromErrno();
+		return -1;
+	}
+
+	self->resolver = resolver;
+
+	return 0;
+}
+
+static void line_resolver_finalize(line_resolver_object *self)
+{
+	gpiod_line_resolver_free(self->resolver);
+	self->resolver = NULL;
+}
+
+static PyObject *
+line_resolver_chip_paths(line_resolver_object *self,
+			 void *Py_UNUSED(ignored))
+{
+	PyObject *paths, *path;
+	size_t num_chips, i;
+	int ret;
+
+	num_chips = gpiod_line_resolver_get_num_chips(self->resolver);
+
+	paths = PyList_New(num_chips);
+	if (!paths)
+		return NULL;
+
+	for (i = 0; i < num_chips; i++) {
+		path = PyUnicode_FromString(
+			gpiod_line_resolver_get_chip_path(self->resolver, i));
+		if (!path) {
+			Py_DECREF(paths);
+			return NULL;
+		}
+
+		ret = PyList_SetItem(paths, i, path);
+		if (ret) {
+			Py_DECREF(paths);
+			return NULL;
+		}
+	}
+
+	return paths;
+}
+
+static PyGetSetDef line_resolver_getset[] = {
+	{
+		.name = "chip_paths",
+		.get = (getter)line_resolver_chip_paths,
+	},
+	{ }
+};
+
+static PyObject *line_resolver_find(line_resolver_object *self,
+				    PyObject *args)
+{
+	unsigned int offset;
+	size_t chip_index;
+	const char *name;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "s", &name);
+	if (!ret)
+		return NULL;
+
+	ret = gpiod_line_resolver_find(self->resolver, name,
+				       &chip_index, &offset);
+	if (ret < 0)
+		return Py_gpiod_SetErrFromErrno();
+
+	if (ret == 0)
+		Py_RETURN_NONE;
+
+	/* Chip path, offset of the first match and number of matches. */
+	return Py_BuildValue("(sIi)",
+			gpiod_line_resolver_get_chip_path(self->resolver,
+							  chip_index),
+			offset, ret);
+}
+
+static PyMethodDef line_resolver_methods[] = {
+	{
+		.ml_name = "find",
+		.ml_meth = (PyCFunction)line_resolver_find,
+		.ml_flags = METH_VARARGS,
+	},
+	{ }
+};
+
+PyTypeObject line_resolver_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.LineResolver",
+	.tp_basicsize = sizeof(line_resolver_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_init = (initproc)line_resolver_init,
+	.tp_finalize = (destructor)line_resolver_finalize,
+	.tp_dealloc = (destructor)Py_gpiod_dealloc,
+	.tp_getset = line_resolver_getset,
+	.tp_methods = line_resolver_methods,
+};
@@ -143,12 +143,14 @@ static PyModuleDef module_def = {
 
 extern PyTypeObject chip_type;
 extern PyTypeObject line_config_type;
+extern PyTypeObject line_resolver_type;
 extern PyTypeObject line_settings_type;
 extern PyTypeObject request_type;
 
 static PyTypeObject *types[] = {
 	&chip_type,
 	&line_config_type,
+	&line_resolver_type,
 	&line_settings_type,
 	&request_type,
 	NULL,
@@ -172,6 +174,13 @@ PyMODINIT_FUNC PyInit__ext(void)
 		return NULL;
 	}
 
+	ret = PyModule_AddStringConstant(module, "LINE_RESOLVER_DEFAULT_CACHE",
+					 GPIOD_LINE_RESOLVER_DEFAULT_CACHE);
+	if (ret) {
+		Py_DECREF(module);
+		return NULL;
+	}
+
 	all = PyList_New(0);
 	if (!all) {
 		Py_DECREF(module);
@@ -0,0 +1,87 @@
+# SPDX-License-Identifier: LGPL-2.1-or-later
+# SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+from __future__ import annotations
+
+from typing import Optional
+
+from . import _ext
+
+__all__ = ["LineResolver"]
+
+
+class LineResolver:
+    """
+    Index of line names across all GPIO chips in the system.
+
+    Looking up a line by name otherwise requires opening every chip and
+    querying each of its lines. The resolver does this once, optionally
+    backed by a cache file, and then answers lookups from memory.
+
+    The resolver is a snapshot. It doesn't track line names changing or chips
+    appearing after it was created. Chips the caller doesn't have permission
+    to open are skipped.
+
+    Example::
+
+        resolver = gpiod.LineResolver()
+        found = resolver.find("GPIO19")
+        if found:
+            path, offset = found
+    """
+
+    DEFAULT_CACHE = _ext.LINE_RESOLVER_DEFAULT_CACHE
+    """Default location of the line name cache file."""
+
+    def __init__(self, cache_path: Optional[str] = None):
+        """
+        Index the line names of all GPIO chips in the system.
+
+        Args:
+          cache_path:
+            Path to the cache file storing the line names between runs or
+            None to always scan all chips. Failing to write the cache is not
+            an error.
+        """
+        self._resolver = _ext.LineResolver(cache_path)
+
+    @property
+    def chip_paths(self) -> list[str]:
+        """
+        Paths of all indexed chips, sorted.
+        """
+        return self._resolver.chip_paths
+
+    def find(self, name: str) -> Optional[tuple[str, int]]:
+        """
+        Find a line by name.
+
+        Args:
+          name:
+            Name of the line.
+
+        Returns:
+          Tuple of the path of the chip and the offset of the first line with
+          this name or None if there is no such line. Lines are matched in chip
+          and offset order.
+        """
+        found = self._resolver.find(name)
+        if not found:
+            return None
+
+        return found[0], found[1]
+
+    def count(self, name: str) -> int:
+        """
+        Get the number of lines with the given name.
+
+        Args:
+          name:
+            Name of the line.
+
+        Returns:
+          Number of lines with this name across all chips.
+        """
+        found = self._resolver.find(name)
+
+        return found[2] if found else 0
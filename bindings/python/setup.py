@@ -175,6 +175,7 @@ class build_ext(orig_build_ext):
                 "lib/line-config.c",
                 "lib/line-info.c",
                 "lib/line-request.c",
+                "lib/line-resolver.c",
                 "lib/line-settings.c",
                 "lib/misc.c",
                 "lib/request-config.c",
@@ -210,6 +211,7 @@ gpiod_ext = Extension(
         "gpiod/ext/chip.c",
         "gpiod/ext/common.c",
         "gpiod/ext/line-config.c",
+        "gpiod/ext/line-resolver.c",
         "gpiod/ext/line-settings.c",
         "gpiod/ext/module.c",
         "gpiod/ext/request.c",
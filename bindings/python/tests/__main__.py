@@ -12,6 +12,7 @@ from .tests_info_event import *
 from .tests_line import *
 from .tests_line_info import *
 from .tests_line_request import *
+from .tests_line_resolver import *
 from .tests_line_settings import *
 from .tests_module import *
 
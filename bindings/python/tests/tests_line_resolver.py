@@ -0,0 +1,65 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+# SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+import os
+import tempfile
+from unittest import TestCase
+
+import gpiod
+
+from . import gpiosim
+
+
+class LineResolverFind(TestCase):
+    def setUp(self) -> None:
+        self.first = gpiosim.Chip(
+            num_lines=8, line_names={1: "resolver-foo", 3: "resolver-dup"}
+        )
+        self.second = gpiosim.Chip(
+            num_lines=8, line_names={0: "resolver-dup", 6: "resolver-bar"}
+        )
+
+    def tearDown(self) -> None:
+        self.first = None  # type: ignore[assignment]
+        self.second = None  # type: ignore[assignment]
+
+    def test_find_lines_on_multiple_chips(self) -> None:
+        resolver = gpiod.LineResolver()
+
+        self.assertEqual(resolver.find("resolver-foo"), (self.first.dev_path, 1))
+        self.assertEqual(resolver.find("resolver-bar"), (self.second.dev_path, 6))
+        self.assertIn(self.first.dev_path, resolver.chip_paths)
+        self.assertIn(self.second.dev_path, resolver.chip_paths)
+
+    def test_find_returns_first_match(self) -> None:
+        resolver = gpiod.LineResolver()
+
+        self.assertEqual(resolver.find("resolver-dup"), (self.first.dev_path, 3))
+        self.assertEqual(resolver.count("resolver-dup"), 2)
+
+    def test_find_nonexistent_line(self) -> None:
+        resolver = gpiod.LineResolver()
+
+        self.assertIsNone(resolver.find("resolver-none"))
+        self.assertEqual(resolver.count("resolver-none"), 0)
+
+    def test_find_with_cache(self) -> None:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            cache = os.path.join(tmpdir, "line-names.cache")
+
+            resolver = gpiod.LineResolver(cache_path=cache)
+            self.assertTrue(os.path.exists(cache))
+            self.assertEqual(
+                resolver.find("resolver-foo"), (self.first.dev_path, 1)
+            )
+
+            resolver = gpiod.LineResolver(cache_path=cache)
+            self.assertEqual(
+                resolver.find("resolver-bar"), (self.second.dev_path, 6)
+            )
+
+    def test_find_invalid_argument(self) -> None:
+        resolver = gpiod.LineResolver()
+
+        with self.assertRaises(TypeError):
+            resolver.find(4)  # type: ignore[arg-type]
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/* SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file gpiod-mock.h
+ */
+
+#ifndef __LIBGPIOD_GPIOD_MOCK_H__
+#define __LIBGPIOD_GPIOD_MOCK_H__
+
+#include <gpiod.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct gpiod_mock_chip
+ * @{
+ *
+ * Refer to @ref mock for functions that operate on gpiod_mock_chip.
+ *
+ * @}
+*/
+struct gpiod_mock_chip;
+
+/**
+ * @defgroup mock In-process mock backend
+ * @{
+ *
+ * Functions for creating and driving simulated GPIO chips living entirely in
+ * the memory of the calling process.
+ *
+ * A mock chip is exposed under a path of the form /dev/gpiomockX. This path
+ * does not exist in the filesystem but is recognized by ::gpiod_chip_open and
+ * ::gpiod_is_gpiochip_device as long as the mock chip is alive. Chips opened
+ * this way are handled by the library exactly like the ones backed by the
+ * kernel character device: the same calls are used for reading line info,
+ * requesting lines, setting and reading values and reading edge and info
+ * events. The file descriptors returned by ::gpiod_chip_get_fd and
+ * ::gpiod_line_request_get_fd can be polled for events.
+ *
+ * Mock chips can also be created without modifying the program by setting the
+ * GPIOD_MOCK_CHIPS environment variable to a comma-separated list of line
+ * counts (e.g. "8,64"). If GPIOD_MOCK_EDGE_RATE is set as well, all lines of
+ * these chips generate synthetic edge events at the given rate (in Hz, 0 means
+ * "as fast as the reader can consume them") whenever they are requested with
+ * edge detection enabled. This allows to load-test any program linked against
+ * libgpiod - including the language bindings - without the gpio-sim kernel
+ * module.
+ *
+ * The mock backend is only available if libgpiod was configured with
+ * --enable-mock-backend. It is meant for testing and profiling and should not
+ * be enabled in production builds.
+ */
+
+/**
+ * @brief Create a new mock chip.
+ * @param num_lines Number of lines exposed by the chip.
+ * @param label Label of the chip. Can be NULL in which case the default
+ *              "gpio-mock" label will be used.
+ * @return New mock chip object or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_mock_chip_free.
+ */
+struct gpiod_mock_chip *gpiod_mock_chip_new(size_t num_lines,
+					    const char *label);
+
+/**
+ * @brief Remove a mock chip.
+ * @param chip Mock chip to free.
+ * @note The path of the chip stops being recognized immediately. Chips and
+ *       requests that are already open keep working until they're closed.
+ */
+void gpiod_mock_chip_free(struct gpiod_mock_chip *chip);
+
+/**
+ * @brief Get the path under which the mock chip can be opened.
+ * @param chip Mock chip object.
+ * @return Path to pass to ::gpiod_chip_open. The string lifetime is tied to
+ *         the mock chip object.
+ */
+const char *gpiod_mock_chip_get_path(struct gpiod_mock_chip *chip);
+
+/**
+ * @brief Get the name of the mock chip as reported in the chip info.
+ * @param chip Mock chip object.
+ * @return Name of the chip. The string lifetime is tied to the mock chip
+ *         object.
+ */
+const char *gpiod_mock_chip_get_name(struct gpiod_mock_chip *chip);
+
+/**
+ * @brief Set the name of a line of the mock chip.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @param name New name of the line.
+ * @return 0 on success, -1 on error.
+ */
+int gpiod_mock_chip_set_line_name(struct gpiod_mock_chip *chip,
+				  unsigned int offset, const char *name);
+
+/**
+ * @brief Set the level the mock chip sees on an input line.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @param value New physical level of the line.
+ * @return 0 on success, -1 on error.
+ *
+ * If the line is requested as input with edge detection enabled and the
+ * level changes, an edge event is queued for the request.
+ */
+int gpiod_mock_chip_set_pull(struct gpiod_mock_chip *chip, unsigned int offset,
+			     enum gpiod_line_value value);
+
+/**
+ * @brief Get the physical level currently driven on a line of the mock chip.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @return Value driven by the request if the line is an output, the last
+ *         value set with ::gpiod_mock_chip_set_pull otherwise.
+ *         ::GPIOD_LINE_VALUE_ERROR on error.
+ */
+enum gpiod_line_value gpiod_mock_chip_get_value(struct gpiod_mock_chip *chip,
+						unsigned int offset);
+
+/**
+ * @brief Make a line generate a synthetic stream of edge events.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @param rate_hz Number of edges per second. If 0, events are generated as
+ *                fast as they are read: every read returns as many events as
+ *                were requested.
+ * @param count Number of edges to generate. 0 means no limit.
+ * @return 0 on success, -1 on error.
+ *
+ * Events are only generated while the line is requested with edge detection
+ * enabled. Their timestamps are spaced exactly 1/rate_hz apart starting from
+ * the moment the generator was armed or the line requested, whichever comes
+ * later. Calling this function again replaces the previous settings and
+ * restarts the stream.
+ */
+int gpiod_mock_chip_generate_edges(struct gpiod_mock_chip *chip,
+				   unsigned int offset, uint64_t rate_hz,
+				   uint64_t count);
+
+/**
+ * @brief Stop generating synthetic edge events on a line.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @return 0 on success, -1 on error.
+ */
+int gpiod_mock_chip_stop_edges(struct gpiod_mock_chip *chip,
+			       unsigned int offset);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __LIBGPIOD_GPIOD_MOCK_H__ */
@@ -120,6 +120,123 @@ struct gpiod_edge_event;
 */
 struct gpiod_edge_event_buffer;
 
+/**
+ * @struct gpiod_event_reader
+ * @{
+ *
+ * Refer to @ref event_reader for functions that operate on
+ * gpiod_event_reader.
+ *
+ * @}
+*/
+struct gpiod_event_reader;
+
+/**
+ * @struct gpiod_event_merger
+ * @{
+ *
+ * Refer to @ref event_merger for functions that operate on
+ * gpiod_event_merger.
+ *
+ * @}
+*/
+struct gpiod_event_merger;
+
+/**
+ * @struct gpiod_event_recorder
+ * @{
+ *
+ * Refer to @ref event_recording for functions that operate on
+ * gpiod_event_recorder.
+ *
+ * @}
+*/
+struct gpiod_event_recorder;
+
+/**
+ * @struct gpiod_event_recording
+ * @{
+ *
+ * Refer to @ref event_recording for functions that operate on
+ * gpiod_event_recording.
+ *
+ * @}
+*/
+struct gpiod_event_recording;
+
+/**
+ * @struct gpiod_line_resolver
+ * @{
+ *
+ * Refer to @ref line_resolver for functions that operate on
+ * gpiod_line_resolver.
+ *
+ * @}
+*/
+struct gpiod_line_resolver;
+
+/**
+ * @struct gpiod_chip_mirror
+ * @{
+ *
+ * Refer to @ref chip_mirror for functions that operate on
+ * gpiod_chip_mirror.
+ *
+ * @}
+*/
+struct gpiod_chip_mirror;
+
+/**
+ * @struct gpiod_pwm
+ * @{
+ *
+ * Refer to @ref pwm for functions that operate on gpiod_pwm.
+ *
+ * @}
+*/
+struct gpiod_pwm;
+
+/**
+ * @struct gpiod_sampler
+ * @{
+ *
+ * Refer to @ref sampler for functions that operate on gpiod_sampler.
+ *
+ * @}
+*/
+struct gpiod_sampler;
+
+/**
+ * @struct gpiod_output_group
+ * @{
+ *
+ * Refer to @ref output_group for functions that operate on
+ * gpiod_output_group.
+ *
+ * @}
+*/
+struct gpiod_output_group;
+
+/**
+ * @struct gpiod_reflex
+ * @{
+ *
+ * Refer to @ref reflex for functions that operate on gpiod_reflex.
+ *
+ * @}
+*/
+struct gpiod_reflex;
+
+/**
+ * @struct gpiod_quadrature
+ * @{
+ *
+ * Refer to @ref quadrature for functions that operate on gpiod_quadrature.
+ *
+ * @}
+*/
+struct gpiod_quadrature;
+
 /**
  * @defgroup chips GPIO chips
  * @{
@@ -186,6 +303,25 @@ struct gpiod_line_info *gpiod_chip_get_line_info(struct gpiod_chip *chip,
 struct gpiod_line_info *gpiod_chip_watch_line_info(struct gpiod_chip *chip,
 						   unsigned int offset);
 
+/**
+ * @brief Get a snapshot of the status of multiple lines and start watching
+ *        them for future changes.
+ * @param chip GPIO chip object.
+ * @param offsets Array of offsets of the lines to watch.
+ * @param num_offsets Number of offsets in the array.
+ * @param infos Array of at least num_offsets elements in which to store the
+ *              line info objects or NULL if the caller doesn't need them, in
+ *              which case no line info objects are allocated. Each returned
+ *              object must be freed by the caller using
+ *              ::gpiod_line_info_free.
+ * @return 0 on success, -1 on failure.
+ * @note Either all lines are watched or none: on failure the watches set up
+ *       by this call are removed and no line info objects are returned.
+ */
+int gpiod_chip_watch_lines(struct gpiod_chip *chip,
+			   const unsigned int *offsets, size_t num_offsets,
+			   struct gpiod_line_info **infos);
+
 /**
  * @brief Stop watching a line for status changes.
  * @param chip GPIO chip object.
@@ -251,6 +387,243 @@ gpiod_chip_request_lines(struct gpiod_chip *chip,
 			 struct gpiod_request_config *req_cfg,
 			 struct gpiod_line_config *line_cfg);
 
+/**
+ * @}
+ *
+ * @defgroup chip_registry Chip registry
+ * @{
+ *
+ * Process-wide cache of GPIO chip device validation and metadata.
+ *
+ * Opening a chip normally involves verifying that the path points to a GPIO
+ * character device, which takes several system calls and sysfs lookups, and
+ * making a line request involves querying the chip for its name. Programs
+ * opening chips and requesting lines frequently can enable the chip registry
+ * to remember which paths were already validated together with the chip
+ * name, label and number of lines, keyed by the device number.
+ *
+ * A cached path is revalidated with a single stat() on every open unless the
+ * registry watches /dev for changes using inotify, in which case paths of
+ * device nodes located directly in /dev are trusted until a file is created,
+ * removed or renamed in that directory. The cache can also be dropped
+ * explicitly at any time.
+ *
+ * The registry is disabled by default. All functions in this group are
+ * thread-safe.
+ */
+
+/**
+ * @brief Enable the chip registry.
+ * @param watch If true, watch /dev for changes and drop the cache whenever
+ *              a device node is added or removed.
+ * @return 0 on success, -1 on failure.
+ * @note Calling this function while the registry is already enabled updates
+ *       the watch setting and keeps the cached entries.
+ */
+int gpiod_chip_registry_enable(bool watch);
+
+/**
+ * @brief Disable the chip registry and drop all cached entries.
+ * @note Chips opened while the registry was enabled keep their cached chip
+ *       info.
+ */
+void gpiod_chip_registry_disable(void);
+
+/**
+ * @brief Drop all entries cached by the chip registry.
+ *
+ * Should be called after chips were added to or removed from the system if
+ * the registry doesn't watch /dev.
+ */
+void gpiod_chip_registry_refresh(void);
+
+/**
+ * @}
+ *
+ * @defgroup line_resolver Line name resolver
+ * @{
+ *
+ * Index of line names across all GPIO chips in the system.
+ *
+ * Looking up a line by name otherwise requires opening every chip and
+ * querying the info of each of its lines. The resolver does this once - for
+ * all chips in parallel - and then answers lookups from a hash table.
+ *
+ * The line names can additionally be stored in a cache file. On subsequent
+ * runs the names of a chip are taken from the cache as long as the chip at
+ * the same path still has the same label and number of lines and its device
+ * node wasn't recreated, which only takes a single query per chip. Chips that
+ * changed are scanned again and the cache file is rewritten. Failing to write
+ * the cache is not an error.
+ *
+ * The resolver is a snapshot - it doesn't track line names changing or chips
+ * appearing after it was created.
+ */
+
+/**
+ * @brief Default location of the line name cache file.
+ */
+#define GPIOD_LINE_RESOLVER_DEFAULT_CACHE "/run/gpiod/line-names.cache"
+
+/**
+ * @brief Index the line names of all GPIO chips in the system.
+ * @param cache_path Path to the cache file or NULL to always scan all chips.
+ * @return New line resolver or NULL on failure.
+ * @note Chips the caller doesn't have permission to open are skipped.
+ */
+struct gpiod_line_resolver *gpiod_line_resolver_new(const char *cache_path);
+
+/**
+ * @brief Free the line resolver and release all associated resources.
+ * @param resolver Line resolver to free.
+ */
+void gpiod_line_resolver_free(struct gpiod_line_resolver *resolver);
+
+/**
+ * @brief Get the number of chips indexed by the resolver.
+ * @param resolver Line resolver object.
+ * @return Number of chips.
+ */
+size_t gpiod_line_resolver_get_num_chips(struct gpiod_line_resolver *resolver);
+
+/**
+ * @brief Get the path of an indexed chip.
+ * @param resolver Line resolver object.
+ * @param index Index of the chip. Chips are sorted by their path.
+ * @return Path to the chip's character device or NULL if the index is out
+ *         of range. The string lifetime is tied to the resolver object so the
+ *         pointer must not be freed by the caller.
+ */
+const char *
+gpiod_line_resolver_get_chip_path(struct gpiod_line_resolver *resolver,
+				  size_t index);
+
+/**
+ * @brief Find a line by name.
+ * @param resolver Line resolver object.
+ * @param name Name of the line.
+ * @param chip_index Buffer in which to store the index of the chip of the
+ *                   first matching line. May be NULL.
+ * @param offset Buffer in which to store the offset of the first matching
+ *               line. May be NULL.
+ * @return Number of lines with this name, 0 if there are none, -1 on failure.
+ * @note Lines are matched in chip and offset order so the first match is the
+ *       same one a sequential scan of all chips would find.
+ */
+int gpiod_line_resolver_find(struct gpiod_line_resolver *resolver,
+			     const char *name, size_t *chip_index,
+			     unsigned int *offset);
+
+/**
+ * @}
+ *
+ * @defgroup chip_mirror Chip state mirror
+ * @{
+ *
+ * In-memory copy of the info of all lines of a chip.
+ *
+ * The mirror reads the info of every line once, watching each one for
+ * changes at the same time, and then keeps its table up to date by applying
+ * the line info events emitted by the kernel. Querying the line info is then
+ * a memory lookup instead of an ioctl() and an allocation.
+ *
+ * Every change bumps the mirror's generation counter and the line's
+ * generation is set to the new value. Users can remember the generation they
+ * last saw and only look at lines with a higher one.
+ *
+ * The mirror opens its own file descriptor for the chip so it doesn't
+ * consume the info events of any other chip object. Its state only advances
+ * when ::gpiod_chip_mirror_update is called, typically once the file
+ * descriptor becomes readable.
+ *
+ * The kernel queues a limited number of info events per file descriptor and
+ * silently drops events on overflow. Users that may fail to update the mirror
+ * in time should call ::gpiod_chip_mirror_resync periodically.
+ *
+ * Mirror objects are not thread-safe.
+ */
+
+/**
+ * @brief Create a mirror of the state of all lines of a chip.
+ * @param path Path to the GPIO chip device file.
+ * @return New chip mirror or NULL on failure.
+ */
+struct gpiod_chip_mirror *gpiod_chip_mirror_new(const char *path);
+
+/**
+ * @brief Free the chip mirror and release all associated resources.
+ * @param mirror Chip mirror to free.
+ */
+void gpiod_chip_mirror_free(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Get the file descriptor on which the mirror receives line info
+ *        events.
+ * @param mirror Chip mirror object.
+ * @return File descriptor. It becomes readable when ::gpiod_chip_mirror_update
+ *         has events to apply.
+ */
+int gpiod_chip_mirror_get_fd(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Get the number of lines mirrored.
+ * @param mirror Chip mirror object.
+ * @return Number of lines of the chip.
+ */
+size_t gpiod_chip_mirror_get_num_lines(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Apply all pending line info events to the mirror.
+ * @param mirror Chip mirror object.
+ * @return Number of distinct lines whose info changed, -1 on failure. A line
+ *         changing several times is counted once, while the generation
+ *         counter is bumped for every change.
+ * @note This function never blocks.
+ */
+int gpiod_chip_mirror_update(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Re-read the info of all lines from the chip.
+ * @param mirror Chip mirror object.
+ * @return Number of distinct lines whose info changed, either through pending
+ *         line info events or through the re-read, -1 on failure.
+ *
+ * Recovers from line info events lost due to the kernel queue overflowing.
+ */
+int gpiod_chip_mirror_resync(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Get the mirrored info of a line.
+ * @param mirror Chip mirror object.
+ * @param offset Offset of the line.
+ * @return Line info object or NULL if the offset is out of range. The object
+ *         is owned by the mirror and must not be freed by the caller. Its
+ *         contents change when the mirror is updated so callers wishing to
+ *         keep a snapshot must use ::gpiod_line_info_copy.
+ */
+struct gpiod_line_info *
+gpiod_chip_mirror_get_line_info(struct gpiod_chip_mirror *mirror,
+				unsigned int offset);
+
+/**
+ * @brief Get the current generation of the mirror.
+ * @param mirror Chip mirror object.
+ * @return Generation counter, incremented on every line info change. The
+ *         initial state has generation 0.
+ */
+uint64_t gpiod_chip_mirror_get_generation(struct gpiod_chip_mirror *mirror);
+
+/**
+ * @brief Get the generation in which the info of a line last changed.
+ * @param mirror Chip mirror object.
+ * @param offset Offset of the line.
+ * @return Generation of the line's last change, 0 if it didn't change since
+ *         the mirror was created or if the offset is out of range.
+ */
+uint64_t
+gpiod_chip_mirror_get_line_generation(struct gpiod_chip_mirror *mirror,
+				      unsigned int offset);
+
 /**
  * @}
  *
@@ -1155,6 +1528,85 @@ int gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
 					struct gpiod_edge_event_buffer *buffer,
 					size_t max_events);
 
+/**
+ * @brief Set the blocking mode of the file descriptor associated with a line
+ *        request.
+ * @param request GPIO line request.
+ * @param nonblocking If true, reading edge events never blocks. Reading from
+ *                    a request with no events queued fails with errno set
+ *                    to EAGAIN.
+ * @return 0 on success, -1 on failure.
+ * @note By default the file descriptor is blocking.
+ */
+int gpiod_line_request_set_nonblocking(struct gpiod_line_request *request,
+				       bool nonblocking);
+
+/**
+ * @brief Check if the line request is in non-blocking mode.
+ * @param request GPIO line request.
+ * @return True if the file descriptor associated with the request was set to
+ *         non-blocking with ::gpiod_line_request_set_nonblocking, false
+ *         otherwise.
+ */
+bool gpiod_line_request_is_nonblocking(struct gpiod_line_request *request);
+
+/**
+ * @brief Read all edge events queued for a line request.
+ * @param request GPIO line request in non-blocking mode.
+ * @param buffer Edge event buffer. Its capacity is increased as needed to
+ *               hold up to \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read, which is 0 if no
+ *         event was queued. On failure returns -1.
+ *
+ * Unlike ::gpiod_line_request_read_edge_events, this function keeps reading
+ * until the kernel event queue is empty, which makes it suitable for use
+ * with edge-triggered event loops (e.g. epoll with EPOLLET) that get a single
+ * notification for any number of queued events. If the function returns
+ * \p max_events, there may still be events left and it should be called
+ * again before waiting for the next notification.
+ *
+ * Fails with errno set to EINVAL if the request is not in non-blocking mode.
+ * @note Any exising events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int gpiod_line_request_drain_edge_events(struct gpiod_line_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events);
+
+/**
+ * @brief Read edge events, busy-polling for a while before blocking.
+ * @param request GPIO line request in non-blocking mode.
+ * @param buffer Edge event buffer, sized to hold at least \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @param spin_ns Time in nanoseconds during which the function repeatedly
+ *                tries to read events without sleeping. If set to 0, the
+ *                function tries once and then blocks.
+ * @param timeout_ns Total wait time limit in nanoseconds, including the time
+ *                   spent spinning. If set to 0, the function returns
+ *                   immediately. If set to a negative number, the function
+ *                   blocks indefinitely after spinning until an event
+ *                   becomes available.
+ * @param spun Optional pointer set to true if the events were read while
+ *             spinning and to false if the function had to go to sleep or
+ *             didn't spin at all because \p spin_ns or \p timeout_ns was 0.
+ * @return On success returns the number of events read, which is 0 if the
+ *         wait timed out. On failure returns -1.
+ *
+ * Meant for latency-critical users: an event arriving during the spin phase
+ * is read without the scheduler wakeup latency of a blocking wait, at the
+ * cost of keeping a CPU busy for up to \p spin_ns.
+ *
+ * Fails with errno set to EINVAL if the request is not in non-blocking mode.
+ * @note Any exising events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int
+gpiod_line_request_read_edge_events_busy(struct gpiod_line_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events, int64_t spin_ns,
+					 int64_t timeout_ns, bool *spun);
+
 /**
  * @}
  *
@@ -1294,6 +1746,1116 @@ gpiod_edge_event_buffer_get_event(struct gpiod_edge_event_buffer *buffer,
 size_t
 gpiod_edge_event_buffer_get_num_events(struct gpiod_edge_event_buffer *buffer);
 
+/**
+ * @}
+ *
+ * @defgroup event_reader Batched event reader
+ * @{
+ *
+ * Functions for waiting for and reading events from many line requests and
+ * chips at once.
+ *
+ * Programs monitoring a large number of requests would normally poll all
+ * their file descriptors and then issue a separate read for every one that
+ * became ready. The event reader keeps a read outstanding on every source
+ * registered with it and collects whatever data arrives. If libgpiod was
+ * configured with --enable-io-uring and the running kernel supports it, the
+ * reads are submitted in a single batch using io_uring with registered files
+ * and buffers, so that waiting for and reading events from any number of
+ * sources costs a single system call. Otherwise the reader falls back to
+ * polling all sources and reading the ones that became ready.
+ *
+ * Sources are identified by the index returned when adding them. All sources
+ * must be added before the first call to ::gpiod_event_reader_wait and must
+ * stay open for as long as the reader exists. The reader doesn't take
+ * ownership of them.
+ */
+
+/**
+ * @brief Create a new event reader.
+ * @return New event reader object or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_event_reader_free.
+ */
+struct gpiod_event_reader *gpiod_event_reader_new(void);
+
+/**
+ * @brief Free the event reader and release all associated resources.
+ * @param reader Event reader to free.
+ * @note Reads still in flight are cancelled and any data not yet consumed is
+ *       lost.
+ */
+void gpiod_event_reader_free(struct gpiod_event_reader *reader);
+
+/**
+ * @brief Register a line request as a source of edge events.
+ * @param reader Event reader.
+ * @param request Line request to read edge events from.
+ * @return Index identifying the source within the reader or -1 on error.
+ */
+int gpiod_event_reader_add_request(struct gpiod_event_reader *reader,
+				   struct gpiod_line_request *request);
+
+/**
+ * @brief Register a chip as a source of line info events.
+ * @param reader Event reader.
+ * @param chip GPIO chip to read info events from.
+ * @return Index identifying the source within the reader or -1 on error.
+ * @note Only lines watched with ::gpiod_chip_watch_line_info generate events.
+ */
+int gpiod_event_reader_add_chip(struct gpiod_event_reader *reader,
+				struct gpiod_chip *chip);
+
+/**
+ * @brief Wait for events on any of the registered sources.
+ * @param reader Event reader.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until an event becomes
+ *                   available.
+ * @return Number of sources with events pending, 0 if wait timed out, -1 if
+ *         an error occurred.
+ *
+ * Sources which still have unconsumed events from a previous call count as
+ * pending and cause the function to return immediately.
+ */
+int gpiod_event_reader_wait(struct gpiod_event_reader *reader,
+			    int64_t timeout_ns);
+
+/**
+ * @brief Get the index of the next source with events pending.
+ * @param reader Event reader.
+ * @return Index of the source or -1 if no source has pending events, in which
+ *         case errno is set to EAGAIN.
+ *
+ * Sources are returned in round-robin order. A source stays pending until
+ * all its events have been consumed.
+ */
+int gpiod_event_reader_next_ready(struct gpiod_event_reader *reader);
+
+/**
+ * @brief Read edge events collected for a line request source.
+ * @param reader Event reader.
+ * @param source Index of a source added with ::gpiod_event_reader_add_request.
+ * @param buffer Edge event buffer, sized to hold at least \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events stored in the buffer, on
+ *         failure returns -1. If the source has no pending events, errno is
+ *         set to EAGAIN.
+ * @note This function never blocks.
+ * @note Any exising events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int gpiod_event_reader_read_edge_events(struct gpiod_event_reader *reader,
+					unsigned int source,
+					struct gpiod_edge_event_buffer *buffer,
+					size_t max_events);
+
+/**
+ * @brief Read a single line info event collected for a chip source.
+ * @param reader Event reader.
+ * @param source Index of a source added with ::gpiod_event_reader_add_chip.
+ * @return Newly read watch event object or NULL on error. If the source has
+ *         no pending events, errno is set to EAGAIN. The returned object must
+ *         be freed by the caller using ::gpiod_info_event_free.
+ * @note This function never blocks.
+ */
+struct gpiod_info_event *
+gpiod_event_reader_read_info_event(struct gpiod_event_reader *reader,
+				   unsigned int source);
+
+/**
+ * @brief Check whether the reader submits its reads using io_uring.
+ * @param reader Event reader.
+ * @return True if io_uring is in use, false if the reader falls back to
+ *         polling. The result is only meaningful after the first call to
+ *         ::gpiod_event_reader_wait.
+ */
+bool gpiod_event_reader_uses_io_uring(struct gpiod_event_reader *reader);
+
+/**
+ * @}
+ *
+ * @defgroup event_merger Timestamp-ordered event merging
+ * @{
+ *
+ * Functions for merging edge events from many sources into a single stream
+ * ordered by timestamp.
+ *
+ * Every line request delivers its events in order, but events from
+ * different requests - for instance for lines on different chips - are
+ * read in whatever order the requests become ready. The merger keeps a
+ * queue of events for each source and releases them oldest first.
+ *
+ * The oldest queued event is released as soon as every source has at least
+ * one event queued, since none of them can deliver anything older. If some
+ * sources are quiet, the event is held back until it's older than the
+ * reorder window, which bounds the latency added by the merger. Events
+ * arriving later than the window with an older timestamp are still
+ * delivered, but out of order.
+ *
+ * Sources are either line requests, read by the merger itself using an
+ * @ref event_reader, or queues fed by the user with edge event buffers.
+ * Each source must deliver its events in timestamp order. All sources must
+ * be added before the first call to ::gpiod_event_merger_wait.
+ */
+
+/**
+ * @brief Create a new event merger.
+ * @param clock Clock used for the timestamps of the merged events. For
+ *              ::GPIOD_LINE_CLOCK_HTE, the reorder window is measured
+ *              against the newest timestamp seen rather than the current
+ *              time.
+ * @param reorder_window_ns Maximum time in nanoseconds for which an event is
+ *                          held back waiting for older events from other
+ *                          sources.
+ * @return New event merger object or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_event_merger_free.
+ */
+struct gpiod_event_merger *
+gpiod_event_merger_new(enum gpiod_line_clock clock,
+		       uint64_t reorder_window_ns);
+
+/**
+ * @brief Free the event merger and release all associated resources.
+ * @param merger Event merger to free.
+ * @note Events still queued are lost.
+ */
+void gpiod_event_merger_free(struct gpiod_event_merger *merger);
+
+/**
+ * @brief Add a line request as a source of edge events.
+ * @param merger Event merger.
+ * @param request Line request to read edge events from. The merger doesn't
+ *                take ownership of it and it must stay valid for as long as
+ *                the merger exists.
+ * @return Index identifying the source within the merger or -1 on error.
+ */
+int gpiod_event_merger_add_request(struct gpiod_event_merger *merger,
+				   struct gpiod_line_request *request);
+
+/**
+ * @brief Add a source fed with ::gpiod_event_merger_push.
+ * @param merger Event merger.
+ * @return Index identifying the source within the merger or -1 on error.
+ */
+int gpiod_event_merger_add_source(struct gpiod_event_merger *merger);
+
+/**
+ * @brief Queue edge events for a source.
+ * @param merger Event merger.
+ * @param source Index of the source.
+ * @param buffer Edge event buffer holding the events, which are copied.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_event_merger_push(struct gpiod_event_merger *merger,
+			    unsigned int source,
+			    struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Wait until there are merged events ready to be read.
+ * @param merger Event merger.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until an event is ready.
+ * @return 1 if there are events ready, 0 if wait timed out, -1 if an error
+ *         occurred.
+ *
+ * Events from line request sources are read while waiting. If there are no
+ * line request sources, the function only waits for the reorder window of
+ * queued events to elapse and returns 0 right away if there are none.
+ */
+int gpiod_event_merger_wait(struct gpiod_event_merger *merger,
+			    int64_t timeout_ns);
+
+/**
+ * @brief Read merged events in timestamp order.
+ * @param merger Event merger.
+ * @param buffer Edge event buffer.
+ * @param sources Optional array filled with the index of the source of each
+ *                event. Must hold at least \p max_events entries.
+ * @param max_events Maximum number of events to read. Limited to the
+ *                   capacity of the buffer.
+ * @return On success returns the number of events stored in the buffer,
+ *         which is 0 if none is ready yet. On failure returns -1.
+ * @note This function never blocks.
+ * @note Any exising events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int gpiod_event_merger_read(struct gpiod_event_merger *merger,
+			    struct gpiod_edge_event_buffer *buffer,
+			    unsigned int *sources, size_t max_events);
+
+/**
+ * @brief Read queued events in timestamp order without waiting for the
+ *        reorder window.
+ * @param merger Event merger.
+ * @param buffer Edge event buffer.
+ * @param sources Optional array filled with the index of the source of each
+ *                event. Must hold at least \p max_events entries.
+ * @param max_events Maximum number of events to read. Limited to the
+ *                   capacity of the buffer.
+ * @return On success returns the number of events stored in the buffer. On
+ *         failure returns -1.
+ * @note Meant for draining the merger once the sources are done.
+ */
+int gpiod_event_merger_flush(struct gpiod_event_merger *merger,
+			     struct gpiod_edge_event_buffer *buffer,
+			     unsigned int *sources, size_t max_events);
+
+/**
+ * @brief Get the number of events queued in the merger.
+ * @param merger Event merger.
+ * @return Number of events queued across all sources.
+ */
+size_t gpiod_event_merger_get_num_pending(struct gpiod_event_merger *merger);
+
+/**
+ * @}
+ *
+ * @defgroup event_recording Edge event recording
+ * @{
+ *
+ * Compact binary format for storing streams of edge events.
+ *
+ * A recording starts with a header containing the chip name and the offsets
+ * of the recorded lines followed by blocks of up to 1024 events. Within a
+ * block, events are stored as variable-length deltas against the previous
+ * event, which takes 4-6 bytes per event for a steady stream. A finished
+ * recording ends with an index of the blocks.
+ *
+ * The recorder writes to a file descriptor and doesn't need it to be
+ * seekable, so recordings can be streamed through a pipe. Events are
+ * buffered until a block is full or the recorder is flushed.
+ *
+ * Recordings are read by mapping the file into memory. Any event can be
+ * accessed by its index in the recording or looked up by timestamp without
+ * decoding the whole file. Reading consecutive events only decodes each
+ * event once. Recordings that were not finished - for instance because the
+ * recording process was killed - can still be read up to the last complete
+ * block.
+ *
+ * Neither recorders nor recordings are thread-safe.
+ */
+
+/**
+ * @brief Start a new recording.
+ * @param fd File descriptor to write the recording to. The recording starts
+ *           at the current position of the file descriptor, which must be
+ *           the start of the file for the recording to be readable with
+ *           ::gpiod_event_recording_open. The file descriptor is not closed
+ *           by the recorder.
+ * @param chip_name Name of the chip the events come from.
+ * @param offsets Offsets of the lines events will be recorded for.
+ * @param num_offsets Number of offsets, at most 64.
+ * @return New recorder object or NULL on failure. The header is written
+ *         before this function returns.
+ */
+struct gpiod_event_recorder *
+gpiod_event_recorder_new(int fd, const char *chip_name,
+			 const unsigned int *offsets, size_t num_offsets);
+
+/**
+ * @brief Free the recorder object.
+ * @param recorder Recorder to free.
+ * @note Buffered events are discarded. Use ::gpiod_event_recorder_finish
+ *       before freeing the recorder to write them out together with the
+ *       index.
+ */
+void gpiod_event_recorder_free(struct gpiod_event_recorder *recorder);
+
+/**
+ * @brief Append the events stored in an edge event buffer to the recording.
+ * @param recorder Recorder object.
+ * @param buffer Edge event buffer filled by
+ *               ::gpiod_line_request_read_edge_events or a similar function.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if any event comes
+ *         from a line not passed to ::gpiod_event_recorder_new.
+ */
+int gpiod_event_recorder_write(struct gpiod_event_recorder *recorder,
+			       struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Write out the events buffered by the recorder as a block.
+ * @param recorder Recorder object.
+ * @return 0 on success, -1 on failure.
+ * @note Flushing often results in small blocks, which makes the recording
+ *       larger and its index longer.
+ */
+int gpiod_event_recorder_flush(struct gpiod_event_recorder *recorder);
+
+/**
+ * @brief Flush the recorder and write the block index.
+ * @param recorder Recorder object.
+ * @return 0 on success, -1 on failure. No more events can be written after
+ *         the recording was successfully finished.
+ */
+int gpiod_event_recorder_finish(struct gpiod_event_recorder *recorder);
+
+/**
+ * @brief Open a recording for reading.
+ * @param path Path to the file containing the recording.
+ * @return New recording object or NULL on failure. Fails with EIO if the
+ *         file doesn't contain a valid recording.
+ */
+struct gpiod_event_recording *gpiod_event_recording_open(const char *path);
+
+/**
+ * @brief Close the recording and release all associated resources.
+ * @param recording Recording to close.
+ */
+void gpiod_event_recording_close(struct gpiod_event_recording *recording);
+
+/**
+ * @brief Get the name of the chip the recorded events come from.
+ * @param recording Recording object.
+ * @return Chip name. The string lifetime is tied to the recording object so
+ *         the pointer must not be freed by the caller.
+ */
+const char *
+gpiod_event_recording_get_chip_name(struct gpiod_event_recording *recording);
+
+/**
+ * @brief Get the number of lines in the recording.
+ * @param recording Recording object.
+ * @return Number of lines.
+ */
+size_t
+gpiod_event_recording_get_num_lines(struct gpiod_event_recording *recording);
+
+/**
+ * @brief Get the offsets of the lines in the recording.
+ * @param recording Recording object.
+ * @param offsets Array to store the offsets in.
+ * @param max_offsets Number of elements in the array.
+ * @return Number of offsets stored in the array.
+ */
+size_t
+gpiod_event_recording_get_line_offsets(struct gpiod_event_recording *recording,
+				       unsigned int *offsets,
+				       size_t max_offsets);
+
+/**
+ * @brief Get the number of events in the recording.
+ * @param recording Recording object.
+ * @return Number of events.
+ */
+uint64_t
+gpiod_event_recording_get_num_events(struct gpiod_event_recording *recording);
+
+/**
+ * @brief Read events from the recording.
+ * @param recording Recording object.
+ * @param index Index of the first event to read.
+ * @param buffer Edge event buffer to store the events in.
+ * @param max_events Maximum number of events to read. Limited by the
+ *                   capacity of the buffer.
+ * @return Number of events read, 0 if the index is past the last event, -1
+ *         on failure. Fails with EIO if the recording is corrupted.
+ */
+int
+gpiod_event_recording_read_events(struct gpiod_event_recording *recording,
+				  uint64_t index,
+				  struct gpiod_edge_event_buffer *buffer,
+				  size_t max_events);
+
+/**
+ * @brief Find the first event recorded at or after given time.
+ * @param recording Recording object.
+ * @param timestamp_ns Timestamp to look for.
+ * @return Index of the first event with a timestamp not earlier than
+ *         timestamp_ns or the number of events in the recording if there is
+ *         none.
+ * @note Timestamps are assumed to be monotonic which is not guaranteed for
+ *       events using the realtime clock.
+ */
+uint64_t
+gpiod_event_recording_find_timestamp(struct gpiod_event_recording *recording,
+				     uint64_t timestamp_ns);
+
+/**
+ * @}
+ *
+ * @defgroup pwm Software PWM
+ * @{
+ *
+ * Functions for driving output lines of a request with pulse-width
+ * modulated signals generated in software.
+ *
+ * Each requested line is a channel with its own period and duty cycle.
+ * The signals are generated by a thread started with ::gpiod_pwm_start,
+ * which keeps the upcoming edges of all channels sorted by time and sleeps
+ * until the earliest one is due. Edges falling due at the same time are
+ * applied with a single call to ::gpiod_line_request_set_values_subset.
+ *
+ * Edges are scheduled at absolute times, so the latency of waking up and
+ * setting the values doesn't accumulate into the period. It does show up as
+ * jitter of the individual edges, which is tracked together with the
+ * achieved period of each channel. The jitter is measured up to the moment
+ * the call setting the values returned, so it covers the time taken by the
+ * write itself in addition to the delay in starting it.
+ *
+ * The request must stay valid for as long as the PWM object exists and its
+ * values must not be changed by other means while the PWM thread is
+ * running.
+ */
+
+/**
+ * @brief Create a new software PWM for all lines of a request.
+ * @param request Line request with the lines configured as outputs. The PWM
+ *                object doesn't take ownership of it.
+ * @return New PWM object or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_pwm_free.
+ * @note All channels are initially disabled.
+ */
+struct gpiod_pwm *gpiod_pwm_new(struct gpiod_line_request *request);
+
+/**
+ * @brief Stop the PWM thread if running and free all associated resources.
+ * @param pwm PWM object to free.
+ * @note The lines are left at the values they had when the thread stopped.
+ */
+void gpiod_pwm_free(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Set the period and duty cycle of a channel.
+ * @param pwm PWM object.
+ * @param offset Offset of the requested line driven by the channel.
+ * @param period_ns Period of the signal in nanoseconds. If set to 0, the
+ *                  channel is disabled and its line is set inactive.
+ * @param duty_ns Time in nanoseconds during which the line is active in each
+ *                period. A duty equal to the period keeps the line active
+ *                and 0 keeps it inactive.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the line is not
+ *         part of the request or if the duty is longer than the period.
+ * @note If the channel is running, the new settings take effect at the
+ *       start of its next period so no truncated pulses are generated.
+ */
+int gpiod_pwm_set_channel(struct gpiod_pwm *pwm, unsigned int offset,
+			  uint64_t period_ns, uint64_t duty_ns);
+
+/**
+ * @brief Start the thread generating the signals.
+ * @param pwm PWM object.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the thread is
+ *         already running.
+ */
+int gpiod_pwm_start(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Stop the thread generating the signals.
+ * @param pwm PWM object.
+ * @return 0 if the thread ran without errors, -1 if it stopped due to a
+ *         failure to set the line values, in which case errno is set to the
+ *         error that occurred.
+ * @note Channels keep their settings and continue with a new period when
+ *       the thread is started again.
+ */
+int gpiod_pwm_stop(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Get the number of edges generated since the last statistics reset.
+ * @param pwm PWM object.
+ * @return Number of line value changes across all channels.
+ */
+uint64_t gpiod_pwm_get_num_edges(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Get the number of value writes since the last statistics reset.
+ * @param pwm PWM object.
+ * @return Number of calls made to set the line values. Lower than the number
+ *         of edges if simultaneous edges were coalesced.
+ */
+uint64_t gpiod_pwm_get_num_writes(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Get the mean jitter of the generated edges.
+ * @param pwm PWM object.
+ * @return Mean time in nanoseconds between the scheduled time of an edge and
+ *         the completion of the write setting the line value.
+ */
+uint64_t gpiod_pwm_get_mean_jitter_ns(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Get the maximum jitter of the generated edges.
+ * @param pwm PWM object.
+ * @return Maximum time in nanoseconds between the scheduled time of an edge
+ *         and the completion of the write setting the line value.
+ */
+uint64_t gpiod_pwm_get_max_jitter_ns(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Get the achieved period of a channel.
+ * @param pwm PWM object.
+ * @param offset Offset of the requested line driven by the channel.
+ * @return Mean time in nanoseconds between the rising edges of the channel
+ *         or 0 if there were less than two of them since the last statistics
+ *         reset or if the line is not part of the request.
+ */
+uint64_t gpiod_pwm_get_achieved_period_ns(struct gpiod_pwm *pwm,
+					  unsigned int offset);
+
+/**
+ * @brief Reset the edge and jitter statistics.
+ * @param pwm PWM object.
+ */
+void gpiod_pwm_reset_stats(struct gpiod_pwm *pwm);
+
+/**
+ * @}
+ *
+ * @defgroup sampler Periodic sampling
+ * @{
+ *
+ * Functions for periodically sampling the values of requested lines.
+ *
+ * Lines without edge detection can only be observed by reading their values
+ * repeatedly. The sampler does that from a dedicated thread, reading all
+ * lines of a request with a single call per sample on absolute deadlines
+ * spaced by the sampling period. Deadlines which passed while the previous
+ * sample was being taken are skipped and counted as missed.
+ *
+ * Samples are stored together with their CLOCK_MONOTONIC timestamps in a
+ * lock-free ring buffer from which a single consumer reads them in batches.
+ * Values are returned as bitmaps in which bit N corresponds to the Nth
+ * offset returned by ::gpiod_line_request_get_requested_offsets, so the
+ * request may contain at most 64 lines. If the ring buffer is full, new
+ * samples are dropped and counted as overruns.
+ *
+ * The sampler can also store only the samples in which any value changed,
+ * and call a user-supplied function for each of them. The first sample is
+ * always treated as a change of all lines.
+ */
+
+/**
+ * @brief Callback invoked from the sampling thread on value changes.
+ * @param timestamp_ns Time at which the sample was taken.
+ * @param values Bitmap of the line values.
+ * @param changed Bitmap of the lines whose values changed since the
+ *                previous sample.
+ * @param data User data passed to ::gpiod_sampler_set_change_callback.
+ */
+typedef void (*gpiod_sampler_change_cb)(uint64_t timestamp_ns,
+					uint64_t values, uint64_t changed,
+					void *data);
+
+/**
+ * @brief Create a new sampler.
+ * @param request Line request to sample. The sampler doesn't take ownership
+ *                of it and it must stay valid for as long as the sampler
+ *                exists.
+ * @param period_ns Sampling period in nanoseconds.
+ * @param capacity Number of samples the ring buffer can hold. Rounded up to
+ *                 the next power of two.
+ * @return New sampler object or NULL on error. Fails with EINVAL if the
+ *         period or capacity is 0, if the capacity can't be rounded up to a
+ *         power of two or if the request holds more than 64 lines. The
+ *         returned object must be freed by the caller using
+ *         ::gpiod_sampler_free.
+ */
+struct gpiod_sampler *gpiod_sampler_new(struct gpiod_line_request *request,
+					uint64_t period_ns, size_t capacity);
+
+/**
+ * @brief Stop the sampling thread if running and free all associated
+ *        resources.
+ * @param sampler Sampler to free.
+ */
+void gpiod_sampler_free(struct gpiod_sampler *sampler);
+
+/**
+ * @brief Store only the samples in which any line value changed.
+ * @param sampler Sampler object.
+ * @param changes_only True to store only changes, false to store every
+ *                     sample.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the sampler is
+ *         running.
+ */
+int gpiod_sampler_set_changes_only(struct gpiod_sampler *sampler,
+				   bool changes_only);
+
+/**
+ * @brief Set the function called for samples in which any value changed.
+ * @param sampler Sampler object.
+ * @param callback Function to call or NULL to remove the callback.
+ * @param data User data passed to the callback.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the sampler is
+ *         running.
+ * @note The callback runs in the sampling thread and delays the following
+ *       samples for as long as it takes. It may call ::gpiod_sampler_stop,
+ *       which then returns without waiting for the thread. The thread exits
+ *       once the callback returns and is joined by the next call to
+ *       ::gpiod_sampler_stop or ::gpiod_sampler_free made from another
+ *       thread. The callback must not free the sampler.
+ */
+int gpiod_sampler_set_change_callback(struct gpiod_sampler *sampler,
+				      gpiod_sampler_change_cb callback,
+				      void *data);
+
+/**
+ * @brief Start the sampling thread.
+ * @param sampler Sampler object.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the thread is
+ *         already running.
+ */
+int gpiod_sampler_start(struct gpiod_sampler *sampler);
+
+/**
+ * @brief Stop the sampling thread.
+ * @param sampler Sampler object.
+ * @return 0 if the thread ran without errors, -1 if it stopped due to a
+ *         failure to read the line values, in which case errno is set to
+ *         the error that occurred.
+ * @note Samples already stored can still be read.
+ */
+int gpiod_sampler_stop(struct gpiod_sampler *sampler);
+
+/**
+ * @brief Read stored samples.
+ * @param sampler Sampler object.
+ * @param timestamps Optional array filled with the timestamps of the samples
+ *                   in nanoseconds.
+ * @param values Optional array filled with the bitmaps of the line values.
+ * @param max_samples Maximum number of samples to read. Both arrays must
+ *                    hold at least this many entries.
+ * @return Number of samples read, 0 if there are none.
+ * @note This function never blocks. It must not be called concurrently from
+ *       multiple threads.
+ */
+size_t gpiod_sampler_read(struct gpiod_sampler *sampler, uint64_t *timestamps,
+			  uint64_t *values, size_t max_samples);
+
+/**
+ * @brief Get the number of samples stored and not read yet.
+ * @param sampler Sampler object.
+ * @return Number of pending samples.
+ */
+size_t gpiod_sampler_get_num_pending(struct gpiod_sampler *sampler);
+
+/**
+ * @brief Get the number of samples dropped because the buffer was full.
+ * @param sampler Sampler object.
+ * @return Number of dropped samples.
+ */
+uint64_t gpiod_sampler_get_num_overruns(struct gpiod_sampler *sampler);
+
+/**
+ * @brief Get the number of sampling deadlines missed.
+ * @param sampler Sampler object.
+ * @return Number of deadlines skipped because the thread was late.
+ */
+uint64_t gpiod_sampler_get_num_missed(struct gpiod_sampler *sampler);
+
+/**
+ * @}
+ *
+ * @defgroup output_group Synchronized output
+ * @{
+ *
+ * Functions for setting the output values of multiple requests at once.
+ *
+ * A request only covers lines of a single chip, so updating outputs on
+ * several chips takes a set_values call per chip. Made one after another,
+ * the calls change the outputs of the later chips only after the earlier
+ * calls completed, which can take milliseconds for chips behind slow buses.
+ *
+ * The output group keeps a thread per request, parked on a barrier. Values
+ * are first staged for each request and then written by all threads as soon
+ * as the barrier releases them, so the writes to the different chips run
+ * concurrently. The spread of the times at which the writes completed is
+ * tracked as the skew of the update. The start of the writes isn't observed,
+ * so the skew also includes any difference in how long the chips take to
+ * complete a write, not only the delay between the threads starting them.
+ *
+ * The requests must stay valid for as long as the group exists. Functions
+ * operating on the group must not be called concurrently.
+ */
+
+/**
+ * @brief Create a new output group.
+ * @param requests Array of line requests to update together. The group
+ *                 doesn't take ownership of them.
+ * @param num_requests Number of requests in the array.
+ * @return New output group or NULL on error. Fails with EINVAL if
+ *         num_requests is 0 or if any of the requests is NULL. The returned
+ *         object must be freed by the caller using
+ *         ::gpiod_output_group_free.
+ */
+struct gpiod_output_group *
+gpiod_output_group_new(struct gpiod_line_request **requests,
+		       size_t num_requests);
+
+/**
+ * @brief Stop the threads and free all resources associated with the group.
+ * @param group Output group to free.
+ */
+void gpiod_output_group_free(struct gpiod_output_group *group);
+
+/**
+ * @brief Stage the values to be written to one of the requests.
+ * @param group Output group object.
+ * @param index Index of the request in the array passed to
+ *              ::gpiod_output_group_new.
+ * @param values Array of values in the order of the offsets returned by
+ *               ::gpiod_line_request_get_requested_offsets. It is copied, so
+ *               it can be reused right away.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the index is out
+ *         of range.
+ * @note Staging the values of the same request again replaces them.
+ */
+int gpiod_output_group_stage_values(struct gpiod_output_group *group,
+				    size_t index,
+				    const enum gpiod_line_value *values);
+
+/**
+ * @brief Write the staged values of all requests at once.
+ * @param group Output group object.
+ * @return 0 on success, -1 if any of the writes failed, in which case errno
+ *         is set to the error of the first request that failed. Requests
+ *         without staged values are left alone and the staged values are
+ *         dropped once written, regardless of the result.
+ * @note This function blocks until all writes completed.
+ */
+int gpiod_output_group_apply(struct gpiod_output_group *group);
+
+/**
+ * @brief Get the skew of the most recent update of multiple requests.
+ * @param group Output group object.
+ * @return Time in nanoseconds between the completion of the first and the
+ *         last write of the update, or 0 if no update wrote more than one
+ *         request.
+ */
+uint64_t gpiod_output_group_get_last_skew_ns(struct gpiod_output_group *group);
+
+/**
+ * @brief Get the mean skew of the updates of multiple requests.
+ * @param group Output group object.
+ * @return Mean skew in nanoseconds over all updates which wrote more than
+ *         one request, or 0 if there were none.
+ */
+uint64_t gpiod_output_group_get_mean_skew_ns(struct gpiod_output_group *group);
+
+/**
+ * @brief Get the maximum skew of the updates of multiple requests.
+ * @param group Output group object.
+ * @return Maximum skew in nanoseconds.
+ */
+uint64_t gpiod_output_group_get_max_skew_ns(struct gpiod_output_group *group);
+
+/**
+ * @}
+ *
+ * @defgroup reflex Edge-to-output reflexes
+ * @{
+ *
+ * Functions for reacting to edge events with output changes without going
+ * through the application.
+ *
+ * A reflex engine holds a table of rules, each of which ties an edge of an
+ * input line to an action on an output line. Once started, a dedicated
+ * thread waits for edge events of the input request, reads them in batches,
+ * runs the rules of each event's line and writes all outputs which changed
+ * in the batch with a single call to
+ * ::gpiod_line_request_set_values_subset. Pulses end on their own once
+ * their length passed since they were written.
+ *
+ * Events read in the same batch are coalesced, so an output toggled twice
+ * within a batch doesn't change. The thread can be run with the SCHED_FIFO
+ * policy to keep the latency of the reactions low.
+ *
+ * The reaction latency is the time from the timestamp of an event to the
+ * moment the write of the outputs it changed completed. It's only meaningful
+ * if the input lines use the default CLOCK_MONOTONIC event clock.
+ *
+ * The input and output requests may be the same request with lines in both
+ * directions. They must stay valid for as long as the reflex engine exists
+ * and must not be read from or written to by other means while it's
+ * running.
+ */
+
+/**
+ * @brief Actions a reflex rule can take on its output line.
+ */
+enum gpiod_reflex_action {
+	GPIOD_REFLEX_ACTION_SET = 1,
+	/**< Drive the output active. */
+	GPIOD_REFLEX_ACTION_CLEAR,
+	/**< Drive the output inactive. */
+	GPIOD_REFLEX_ACTION_TOGGLE,
+	/**< Invert the output. */
+	GPIOD_REFLEX_ACTION_PULSE,
+	/**< Drive the output active for the length of the pulse. */
+	GPIOD_REFLEX_ACTION_FOLLOW,
+	/**< Drive the output active on rising and inactive on falling edges. */
+};
+
+/**
+ * @brief Create a new reflex engine.
+ * @param input Line request with edge detection enabled on the input lines.
+ * @param output Line request with the lines configured as outputs. May be
+ *               the same as the input request. The reflex engine doesn't
+ *               take ownership of either of them.
+ * @return New reflex engine or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_reflex_free.
+ * @note The engine starts without rules.
+ */
+struct gpiod_reflex *gpiod_reflex_new(struct gpiod_line_request *input,
+				      struct gpiod_line_request *output);
+
+/**
+ * @brief Stop the thread and free all resources associated with the engine.
+ * @param reflex Reflex engine to free.
+ */
+void gpiod_reflex_free(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Add a rule to the reflex engine.
+ * @param reflex Reflex engine object.
+ * @param input_offset Offset of the line in the input request.
+ * @param edge Edge which triggers the rule: ::GPIOD_LINE_EDGE_RISING,
+ *             ::GPIOD_LINE_EDGE_FALLING or ::GPIOD_LINE_EDGE_BOTH.
+ * @param output_offset Offset of the line in the output request.
+ * @param action Action to take on the output line.
+ * @param pulse_ns Length of the pulse in nanoseconds. Only used by
+ *                 ::GPIOD_REFLEX_ACTION_PULSE.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if either offset
+ *         isn't part of its request, the edge or action is invalid or the
+ *         length of a pulse is 0, and with EBUSY if the engine is running.
+ * @note Rules of the same input line run in the order in which they were
+ *       added, so a later rule for the same output wins.
+ */
+int gpiod_reflex_add_rule(struct gpiod_reflex *reflex,
+			  unsigned int input_offset, enum gpiod_line_edge edge,
+			  unsigned int output_offset,
+			  enum gpiod_reflex_action action, uint64_t pulse_ns);
+
+/**
+ * @brief Set the real-time priority of the reflex thread.
+ * @param reflex Reflex engine object.
+ * @param priority SCHED_FIFO priority or 0 for the scheduling policy of the
+ *                 thread calling ::gpiod_reflex_start.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the priority is
+ *         out of range for SCHED_FIFO and with EBUSY if the engine is
+ *         running.
+ * @note Without sufficient privileges, ::gpiod_reflex_start fails with
+ *       EPERM.
+ */
+int gpiod_reflex_set_priority(struct gpiod_reflex *reflex, int priority);
+
+/**
+ * @brief Start reacting to edge events.
+ * @param reflex Reflex engine object.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the engine is
+ *         already running.
+ * @note The current values of the outputs are read before the thread
+ *       starts and the actions apply on top of them.
+ */
+int gpiod_reflex_start(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Stop reacting to edge events.
+ * @param reflex Reflex engine object.
+ * @return 0 on success, -1 if the thread stopped early because of an error,
+ *         in which case errno is set to that error.
+ * @note The outputs keep their last values, pulses in progress aren't ended.
+ */
+int gpiod_reflex_stop(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Get the number of edge events read by the reflex thread.
+ * @param reflex Reflex engine object.
+ * @return Number of edge events since the creation of the engine or the
+ *         last reset of the statistics.
+ */
+uint64_t gpiod_reflex_get_num_events(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Get the number of edge events which triggered at least one rule.
+ * @param reflex Reflex engine object.
+ * @return Number of reactions.
+ */
+uint64_t gpiod_reflex_get_num_reactions(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Get the number of writes of the output values.
+ * @param reflex Reflex engine object.
+ * @return Number of calls to ::gpiod_line_request_set_values_subset.
+ */
+uint64_t gpiod_reflex_get_num_writes(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Get the mean reaction latency.
+ * @param reflex Reflex engine object.
+ * @return Mean time in nanoseconds from an event to the completion of the
+ *         write it caused, or 0 if there were no reactions.
+ */
+uint64_t gpiod_reflex_get_mean_latency_ns(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Get the maximum reaction latency.
+ * @param reflex Reflex engine object.
+ * @return Maximum reaction latency in nanoseconds.
+ */
+uint64_t gpiod_reflex_get_max_latency_ns(struct gpiod_reflex *reflex);
+
+/**
+ * @brief Reset the event counters and latency statistics.
+ * @param reflex Reflex engine object.
+ */
+void gpiod_reflex_reset_stats(struct gpiod_reflex *reflex);
+
+/**
+ * @}
+ *
+ * @defgroup quadrature Quadrature decoding
+ * @{
+ *
+ * Functions for decoding the signals of quadrature encoders from edge
+ * events.
+ *
+ * An axis of an encoder is a pair of lines, A and B, whose square waves are
+ * a quarter of a period apart. The decoder keeps the state of each axis and
+ * runs every edge event through a state transition table, which yields the
+ * change of the position without branching on the transition. Edges which
+ * don't change the level of their line mean that edges were missed and are
+ * counted as illegal transitions.
+ *
+ * Events can be decoded from buffers filled by the application with
+ * ::gpiod_line_request_read_edge_events, or by a reader thread started with
+ * ::gpiod_quadrature_start, in which case the application only polls the
+ * results. The position, direction and illegal transition counter are
+ * updated once per batch of events and can be read from any thread.
+ *
+ * The velocity is estimated from the timestamps of the events over windows
+ * of at least the configured length and only makes sense if the lines use
+ * the default CLOCK_MONOTONIC event clock. All lines of an axis must have
+ * edge detection enabled on both edges.
+ */
+
+/**
+ * @brief Create a new quadrature decoder.
+ * @param request Line request with the encoder lines. The decoder doesn't
+ *                take ownership of it and it must stay valid for as long as
+ *                the decoder exists.
+ * @return New decoder or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_quadrature_free.
+ * @note The decoder starts without axes.
+ */
+struct gpiod_quadrature *
+gpiod_quadrature_new(struct gpiod_line_request *request);
+
+/**
+ * @brief Stop the reader thread and free all resources associated with the
+ *        decoder.
+ * @param quad Decoder to free.
+ */
+void gpiod_quadrature_free(struct gpiod_quadrature *quad);
+
+/**
+ * @brief Add an axis to the decoder.
+ * @param quad Decoder object.
+ * @param offset_a Offset of the A line of the axis.
+ * @param offset_b Offset of the B line of the axis.
+ * @return Index of the new axis on success, -1 on failure. Fails with EINVAL
+ *         if the offsets are equal, not part of the request or already used
+ *         by another axis, and with EBUSY if the reader thread is running.
+ * @note The current values of the lines are read to set up the initial state
+ *       of the axis. The position counts up while A leads B.
+ */
+int gpiod_quadrature_add_axis(struct gpiod_quadrature *quad,
+			      unsigned int offset_a, unsigned int offset_b);
+
+/**
+ * @brief Set the minimum time over which the velocity is estimated.
+ * @param quad Decoder object.
+ * @param window_ns Length of the window in nanoseconds. Defaults to 10ms.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the window is 0
+ *         and with EBUSY if the reader thread is running.
+ */
+int gpiod_quadrature_set_velocity_window(struct gpiod_quadrature *quad,
+					 uint64_t window_ns);
+
+/**
+ * @brief Decode a batch of edge events.
+ * @param quad Decoder object.
+ * @param buffer Edge event buffer filled from the decoder's request.
+ * @param num_events Number of events to decode from the start of the buffer.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the reader
+ *         thread is running.
+ * @note Events of lines which aren't part of any axis are ignored.
+ */
+int gpiod_quadrature_decode(struct gpiod_quadrature *quad,
+			    struct gpiod_edge_event_buffer *buffer,
+			    size_t num_events);
+
+/**
+ * @brief Start decoding edge events in a reader thread.
+ * @param quad Decoder object.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the thread is
+ *         already running.
+ */
+int gpiod_quadrature_start(struct gpiod_quadrature *quad);
+
+/**
+ * @brief Stop the reader thread.
+ * @param quad Decoder object.
+ * @return 0 on success, -1 if the thread stopped early because of an error,
+ *         in which case errno is set to that error.
+ */
+int gpiod_quadrature_stop(struct gpiod_quadrature *quad);
+
+/**
+ * @brief Get the position of an axis.
+ * @param quad Decoder object.
+ * @param axis Index of the axis.
+ * @return Position in counts, four per period of the signals, or 0 if the
+ *         axis doesn't exist.
+ */
+int64_t gpiod_quadrature_get_position(struct gpiod_quadrature *quad,
+				      size_t axis);
+
+/**
+ * @brief Set the position of an axis.
+ * @param quad Decoder object.
+ * @param axis Index of the axis.
+ * @param position New position in counts.
+ * @note Can be called while the reader thread is running, e.g. for homing.
+ */
+void gpiod_quadrature_set_position(struct gpiod_quadrature *quad, size_t axis,
+				   int64_t position);
+
+/**
+ * @brief Get the direction of the last movement of an axis.
+ * @param quad Decoder object.
+ * @param axis Index of the axis.
+ * @return 1 if the position last counted up, -1 if it counted down and 0 if
+ *         it hasn't changed yet or the axis doesn't exist.
+ */
+int gpiod_quadrature_get_direction(struct gpiod_quadrature *quad, size_t axis);
+
+/**
+ * @brief Get the estimated velocity of an axis.
+ * @param quad Decoder object.
+ * @param axis Index of the axis.
+ * @return Velocity in counts per second, or 0 if the axis doesn't exist or
+ *         no event was decoded within the last velocity window.
+ * @note The velocity is computed from the event timestamps, which works with
+ *       any event clock as long as all events come from the decoder's
+ *       request. Whether the axis came to rest is judged by the
+ *       CLOCK_MONOTONIC time at which events were decoded, so events passed
+ *       to ::gpiod_quadrature_decode should be decoded as they arrive.
+ */
+int64_t gpiod_quadrature_get_velocity(struct gpiod_quadrature *quad,
+				      size_t axis);
+
+/**
+ * @brief Get the number of illegal transitions of an axis.
+ * @param quad Decoder object.
+ * @param axis Index of the axis.
+ * @return Number of edges which didn't change the level of their line.
+ */
+uint64_t gpiod_quadrature_get_num_illegal(struct gpiod_quadrature *quad,
+					  size_t axis);
+
 /**
  * @}
  *
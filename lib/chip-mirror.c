@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+#define MIRROR_EVENT_BATCH	16
+
+struct gpiod_chip_mirror {
+	struct gpiod_chip *chip;
+	const struct gpiod_backend *backend;
+	int fd;
+	size_t num_lines;
+	struct gpiod_line_info **lines;
+	uint64_t *line_generations;
+	uint64_t generation;
+};
+
+/*
+ * Returns true if this is the line's first change since generation 'since',
+ * which lets callers count distinct lines rather than events.
+ */
+static bool mirror_mark_changed(struct gpiod_chip_mirror *mirror,
+				unsigned int offset, uint64_t since)
+{
+	bool first = mirror->line_generations[offset] <= since;
+
+	mirror->line_generations[offset] = ++mirror->generation;
+
+	return first;
+}
+
+GPIOD_API struct gpiod_chip_mirror *gpiod_chip_mirror_new(const char *path)
+{
+	struct gpiod_chip_mirror *mirror;
+	struct gpio_v2_line_info uapi_info;
+	struct gpiod_chip_info *info;
+	unsigned int offset;
+	int ret;
+
+	mirror = malloc(sizeof(*mirror));
+	if (!mirror)
+		return NULL;
+
+	memset(mirror, 0, sizeof(*mirror));
+
+	mirror->chip = gpiod_chip_open(path);
+	if (!mirror->chip)
+		goto err_free;
+
+	mirror->backend = gpiod_chip_get_backend(mirror->chip);
+	mirror->fd = gpiod_chip_get_fd(mirror->chip);
+
+	info = gpiod_chip_get_info(mirror->chip);
+	if (!info)
+		goto err_free;
+
+	mirror->num_lines = gpiod_chip_info_get_num_lines(info);
+	gpiod_chip_info_free(info);
+
+	mirror->lines = calloc(mirror->num_lines ?: 1, sizeof(*mirror->lines));
+	mirror->line_generations = calloc(mirror->num_lines ?: 1,
+					  sizeof(*mirror->line_generations));
+	if (!mirror->lines || !mirror->line_generations)
+		goto err_free;
+
+	/*
+	 * Setting up the watch returns the current line info so there's no
+	 * window in which a change could be missed between reading the
+	 * initial state and receiving events.
+	 */
+	for (offset = 0; offset < mirror->num_lines; offset++) {
+		memset(&uapi_info, 0, sizeof(uapi_info));
+		uapi_info.offset = offset;
+
+		ret = gpiod_ioctl(mirror->backend, mirror->fd,
+				  GPIO_V2_GET_LINEINFO_WATCH_IOCTL, &uapi_info);
+		if (ret)
+			goto err_free;
+
+		mirror->lines[offset] = gpiod_line_info_from_uapi(&uapi_info);
+		if (!mirror->lines[offset])
+			goto err_free;
+	}
+
+	ret = mirror->backend->set_nonblocking(mirror->fd, true);
+	if (ret)
+		goto err_free;
+
+	return mirror;
+
+err_free:
+	gpiod_chip_mirror_free(mirror);
+	return NULL;
+}
+
+GPIOD_API void gpiod_chip_mirror_free(struct gpiod_chip_mirror *mirror)
+{
+	size_t i;
+
+	if (!mirror)
+		return;
+
+	if (mirror->lines) {
+		for (i = 0; i < mirror->num_lines; i++)
+			gpiod_line_info_free(mirror->lines[i]);
+	}
+
+	free(mirror->lines);
+	free(mirror->line_generations);
+	gpiod_chip_close(mirror->chip);
+	free(mirror);
+}
+
+GPIOD_API int gpiod_chip_mirror_get_fd(struct gpiod_chip_mirror *mirror)
+{
+	assert(mirror);
+
+	return mirror->fd;
+}
+
+GPIOD_API size_t
+gpiod_chip_mirror_get_num_lines(struct gpiod_chip_mirror *mirror)
+{
+	assert(mirror);
+
+	return mirror->num_lines;
+}
+
+static int mirror_apply_events(struct gpiod_chip_mirror *mirror,
+			       uint64_t since)
+{
+	struct gpio_v2_line_info_changed events[MIRROR_EVENT_BATCH];
+	struct gpio_v2_line_info_changed *event;
+	int changed = 0;
+	size_t num, i;
+	ssize_t rd;
+
+	for (;;) {
+		rd = mirror->backend->read(mirror->fd, events, sizeof(events));
+		if (rd < 0) {
+			if (errno == EAGAIN)
+				break;
+
+			return -1;
+		}
+
+		num = rd / sizeof(*events);
+		if (!num) {
+			errno = EIO;
+			return -1;
+		}
+
+		for (i = 0; i < num; i++) {
+			event = &events[i];
+
+			if (event->info.offset >= mirror->num_lines)
+				continue;
+
+			if (gpiod_line_info_update_from_uapi(
+					mirror->lines[event->info.offset],
+					&event->info) &&
+			    mirror_mark_changed(mirror, event->info.offset,
+						since))
+				changed++;
+		}
+
+		if (num < MIRROR_EVENT_BATCH)
+			break;
+	}
+
+	return changed;
+}
+
+GPIOD_API int gpiod_chip_mirror_update(struct gpiod_chip_mirror *mirror)
+{
+	assert(mirror);
+
+	return mirror_apply_events(mirror, mirror->generation);
+}
+
+GPIOD_API int gpiod_chip_mirror_resync(struct gpiod_chip_mirror *mirror)
+{
+	struct gpio_v2_line_info uapi_info;
+	unsigned int offset;
+	int ret, changed;
+	uint64_t since;
+
+	assert(mirror);
+
+	since = mirror->generation;
+
+	/* Apply whatever is queued first so that it's not replayed later. */
+	changed = mirror_apply_events(mirror, since);
+	if (changed < 0)
+		return -1;
+
+	for (offset = 0; offset < mirror->num_lines; offset++) {
+		memset(&uapi_info, 0, sizeof(uapi_info));
+		uapi_info.offset = offset;
+
+		ret = gpiod_ioctl(mirror->backend, mirror->fd,
+				  GPIO_V2_GET_LINEINFO_IOCTL, &uapi_info);
+		if (ret)
+			return -1;
+
+		if (gpiod_line_info_update_from_uapi(mirror->lines[offset],
+						     &uapi_info) &&
+		    mirror_mark_changed(mirror, offset, since))
+			changed++;
+	}
+
+	return changed;
+}
+
+GPIOD_API struct gpiod_line_info *
+gpiod_chip_mirror_get_line_info(struct gpiod_chip_mirror *mirror,
+				unsigned int offset)
+{
+	assert(mirror);
+
+	if (offset >= mirror->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return mirror->lines[offset];
+}
+
+GPIOD_API uint64_t
+gpiod_chip_mirror_get_generation(struct gpiod_chip_mirror *mirror)
+{
+	assert(mirror);
+
+	return mirror->generation;
+}
+
+GPIOD_API uint64_t
+gpiod_chip_mirror_get_line_generation(struct gpiod_chip_mirror *mirror,
+				      unsigned int offset)
+{
+	assert(mirror);
+
+	if (offset >= mirror->num_lines)
+		return 0;
+
+	return mirror->line_generations[offset];
+}
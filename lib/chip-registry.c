@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+struct registry_path {
+	char *path;
+	dev_t devt;
+	struct registry_path *next;
+};
+
+struct registry_chip {
+	dev_t devt;
+	struct gpiochip_info info;
+	struct registry_chip *next;
+};
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool registry_enabled;
+static int registry_inotify_fd = -1;
+static struct registry_path *registry_paths;
+static struct registry_chip *registry_chips;
+
+static void registry_flush(void)
+{
+	struct registry_chip *chip, *next_chip;
+	struct registry_path *path, *next_path;
+
+	for (path = registry_paths; path; path = next_path) {
+		next_path = path->next;
+		free(path->path);
+		free(path);
+	}
+
+	for (chip = registry_chips; chip; chip = next_chip) {
+		next_chip = chip->next;
+		free(chip);
+	}
+
+	registry_paths = NULL;
+	registry_chips = NULL;
+}
+
+static void registry_process_inotify(void)
+{
+	char buf[4096]
+		__attribute__((aligned(__alignof__(struct inotify_event))));
+	bool changed = false;
+
+	if (registry_inotify_fd < 0)
+		return;
+
+	/*
+	 * We don't care which entry changed: device nodes come and go rarely
+	 * enough to just start over.
+	 */
+	while (read(registry_inotify_fd, buf, sizeof(buf)) > 0)
+		changed = true;
+
+	if (changed)
+		registry_flush();
+}
+
+/*
+ * Only paths naming an entry directly in /dev are covered by the inotify
+ * watch. Everything else must be verified on every lookup.
+ */
+static bool registry_path_is_watched(const char *path)
+{
+	if (registry_inotify_fd < 0)
+		return false;
+
+	if (strncmp(path, "/dev/", 5) != 0)
+		return false;
+
+	return strchr(path + 5, '/') == NULL;
+}
+
+static void registry_remove_path(struct registry_path *entry)
+{
+	struct registry_path **prev;
+
+	for (prev = &registry_paths; *prev; prev = &(*prev)->next) {
+		if (*prev == entry) {
+			*prev = entry->next;
+			free(entry->path);
+			free(entry);
+			return;
+		}
+	}
+}
+
+static struct registry_chip *registry_find_chip(dev_t devt)
+{
+	struct registry_chip *chip;
+
+	for (chip = registry_chips; chip; chip = chip->next) {
+		if (chip->devt == devt)
+			return chip;
+	}
+
+	return NULL;
+}
+
+bool gpiod_chip_registry_lookup(const char *path, dev_t *devt)
+{
+	struct registry_path *entry;
+	struct stat st;
+	bool found = false;
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry_enabled)
+		goto out;
+
+	registry_process_inotify();
+
+	for (entry = registry_paths; entry; entry = entry->next) {
+		if (strcmp(entry->path, path) == 0)
+			break;
+	}
+
+	if (!entry)
+		goto out;
+
+	if (!registry_path_is_watched(path)) {
+		if (stat(path, &st) || !S_ISCHR(st.st_mode) ||
+		    st.st_rdev != entry->devt) {
+			registry_remove_path(entry);
+			goto out;
+		}
+	}
+
+	*devt = entry->devt;
+	found = true;
+
+out:
+	pthread_mutex_unlock(&registry_lock);
+
+	return found;
+}
+
+void gpiod_chip_registry_add(const char *path, dev_t devt)
+{
+	struct registry_path *entry;
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry_enabled)
+		goto out;
+
+	/* The path may have been cached with a device that went away. */
+	for (entry = registry_paths; entry; entry = entry->next) {
+		if (strcmp(entry->path, path) == 0) {
+			entry->devt = devt;
+			goto out;
+		}
+	}
+
+	entry = malloc(sizeof(*entry));
+	if (!entry)
+		goto out;
+
+	entry->path = strdup(path);
+	if (!entry->path) {
+		free(entry);
+		goto out;
+	}
+
+	entry->devt = devt;
+	entry->next = registry_paths;
+	registry_paths = entry;
+
+out:
+	pthread_mutex_unlock(&registry_lock);
+}
+
+bool gpiod_chip_registry_get_info(dev_t devt, struct gpiochip_info *info)
+{
+	struct registry_chip *chip;
+	bool found = false;
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry_enabled)
+		goto out;
+
+	chip = registry_find_chip(devt);
+	if (chip) {
+		memcpy(info, &chip->info, sizeof(*info));
+		found = true;
+	}
+
+out:
+	pthread_mutex_unlock(&registry_lock);
+
+	return found;
+}
+
+void gpiod_chip_registry_set_info(dev_t devt, const struct gpiochip_info *info)
+{
+	struct registry_chip *chip;
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry_enabled || registry_find_chip(devt))
+		goto out;
+
+	chip = malloc(sizeof(*chip));
+	if (!chip)
+		goto out;
+
+	chip->devt = devt;
+	memcpy(&chip->info, info, sizeof(*info));
+	chip->next = registry_chips;
+	registry_chips = chip;
+
+out:
+	pthread_mutex_unlock(&registry_lock);
+}
+
+bool gpiod_chip_registry_is_active(void)
+{
+	bool enabled;
+
+	pthread_mutex_lock(&registry_lock);
+	enabled = registry_enabled;
+	pthread_mutex_unlock(&registry_lock);
+
+	return enabled;
+}
+
+GPIOD_API int gpiod_chip_registry_enable(bool watch)
+{
+	int fd = -1, ret;
+
+	if (watch) {
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0)
+			return -1;
+
+		ret = inotify_add_watch(fd, "/dev",
+					IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+					IN_MOVED_TO | IN_DELETE_SELF);
+		if (ret < 0) {
+			close(fd);
+			return -1;
+		}
+	}
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (registry_inotify_fd >= 0)
+		close(registry_inotify_fd);
+
+	registry_inotify_fd = fd;
+	registry_enabled = true;
+
+	pthread_mutex_unlock(&registry_lock);
+
+	return 0;
+}
+
+GPIOD_API void gpiod_chip_registry_disable(void)
+{
+	pthread_mutex_lock(&registry_lock);
+
+	registry_flush();
+
+	if (registry_inotify_fd >= 0) {
+		close(registry_inotify_fd);
+		registry_inotify_fd = -1;
+	}
+
+	registry_enabled = false;
+
+	pthread_mutex_unlock(&registry_lock);
+}
+
+GPIOD_API void gpiod_chip_registry_refresh(void)
+{
+	pthread_mutex_lock(&registry_lock);
+	registry_flush();
+	pthread_mutex_unlock(&registry_lock);
+}
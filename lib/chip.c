@@ -3,22 +3,60 @@
 
 #include <assert.h>
 #include <errno.h>
-#include <fcntl.h>
 #include <gpiod.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
+#include <sys/stat.h>
 
 #include "internal.h"
 
 struct gpiod_chip {
+	const struct gpiod_backend *backend;
 	int fd;
 	char *path;
+	bool registered;
+	dev_t devt;
+	bool has_info;
+	struct gpiochip_info info;
 };
 
+static void chip_register(struct gpiod_chip *chip, bool known, dev_t devt)
+{
+	struct stat st;
+
+	if (!known) {
+		if (fstat(chip->fd, &st))
+			return;
+
+		devt = st.st_rdev;
+		gpiod_chip_registry_add(chip->path, devt);
+	}
+
+	chip->registered = true;
+	chip->devt = devt;
+	chip->has_info = gpiod_chip_registry_get_info(devt, &chip->info);
+}
+
+/*
+ * The GPIO character devices have a range of device numbers of their own, so
+ * a device with the number of a validated chip is still a GPIO chip.
+ */
+static bool chip_fd_matches(int fd, dev_t devt)
+{
+	struct stat st;
+
+	if (fstat(fd, &st))
+		return false;
+
+	return S_ISCHR(st.st_mode) && st.st_rdev == devt;
+}
+
 GPIOD_API struct gpiod_chip *gpiod_chip_open(const char *path)
 {
+	const struct gpiod_backend *backend;
 	struct gpiod_chip *chip;
+	bool cached = false;
+	dev_t devt = 0;
 	int fd;
 
 	if (!path) {
@@ -26,13 +64,35 @@ GPIOD_API struct gpiod_chip *gpiod_chip_open(const char *path)
 		return NULL;
 	}
 
-	if (!gpiod_check_gpiochip_device(path, true))
+	backend = gpiod_backend_for_path(path);
+
+	if (backend == &gpiod_kernel_backend)
+		cached = gpiod_chip_registry_lookup(path, &devt);
+
+	if (!cached && !backend->is_chip_device(path, true))
 		return NULL;
 
-	fd = open(path, O_RDWR | O_CLOEXEC);
+	fd = backend->open(path);
 	if (fd < 0)
 		return NULL;
 
+	/*
+	 * A cached path skips the sysfs lookup but the device actually opened
+	 * must still be the GPIO chip validated when the path was cached,
+	 * otherwise validate it from scratch.
+	 */
+	if (cached && !chip_fd_matches(fd, devt)) {
+		backend->close(fd);
+		cached = false;
+
+		if (!backend->is_chip_device(path, true))
+			return NULL;
+
+		fd = backend->open(path);
+		if (fd < 0)
+			return NULL;
+	}
+
 	chip = malloc(sizeof(*chip));
 	if (!chip)
 		goto err_close_fd;
@@ -43,14 +103,18 @@ GPIOD_API struct gpiod_chip *gpiod_chip_open(const char *path)
 	if (!chip->path)
 		goto err_free_chip;
 
+	chip->backend = backend;
 	chip->fd = fd;
 
+	if (backend == &gpiod_kernel_backend && gpiod_chip_registry_is_active())
+		chip_register(chip, cached, devt);
+
 	return chip;
 
 err_free_chip:
 	free(chip);
 err_close_fd:
-	close(fd);
+	backend->close(fd);
 
 	return NULL;
 }
@@ -60,21 +124,33 @@ GPIOD_API void gpiod_chip_close(struct gpiod_chip *chip)
 	if (!chip)
 		return;
 
-	close(chip->fd);
+	chip->backend->close(chip->fd);
 	free(chip->path);
 	free(chip);
 }
 
-static int read_chip_info(int fd, struct gpiochip_info *info)
+static int read_chip_info(struct gpiod_chip *chip, struct gpiochip_info *info)
 {
 	int ret;
 
+	if (chip->has_info) {
+		memcpy(info, &chip->info, sizeof(*info));
+		return 0;
+	}
+
 	memset(info, 0, sizeof(*info));
 
-	ret = gpiod_ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, info);
+	ret = gpiod_ioctl(chip->backend, chip->fd, GPIO_GET_CHIPINFO_IOCTL,
+			  info);
 	if (ret)
 		return -1;
 
+	if (chip->registered) {
+		memcpy(&chip->info, info, sizeof(*info));
+		chip->has_info = true;
+		gpiod_chip_registry_set_info(chip->devt, info);
+	}
+
 	return 0;
 }
 
@@ -85,7 +161,7 @@ GPIOD_API struct gpiod_chip_info *gpiod_chip_get_info(struct gpiod_chip *chip)
 
 	assert(chip);
 
-	ret = read_chip_info(chip->fd, &info);
+	ret = read_chip_info(chip, &info);
 	if (ret)
 		return NULL;
 
@@ -99,7 +175,7 @@ GPIOD_API const char *gpiod_chip_get_path(struct gpiod_chip *chip)
 	return chip->path;
 }
 
-static int chip_read_line_info(int fd, unsigned int offset,
+static int chip_read_line_info(struct gpiod_chip *chip, unsigned int offset,
 			       struct gpio_v2_line_info *info, bool watch)
 {
 	int ret, cmd;
@@ -110,7 +186,7 @@ static int chip_read_line_info(int fd, unsigned int offset,
 	cmd = watch ? GPIO_V2_GET_LINEINFO_WATCH_IOCTL :
 		      GPIO_V2_GET_LINEINFO_IOCTL;
 
-	ret = gpiod_ioctl(fd, cmd, info);
+	ret = gpiod_ioctl(chip->backend, chip->fd, cmd, info);
 	if (ret)
 		return -1;
 
@@ -125,7 +201,7 @@ chip_get_line_info(struct gpiod_chip *chip, unsigned int offset, bool watch)
 
 	assert(chip);
 
-	ret = chip_read_line_info(chip->fd, offset, &info, watch);
+	ret = chip_read_line_info(chip, offset, &info, watch);
 	if (ret)
 		return NULL;
 
@@ -144,12 +220,67 @@ gpiod_chip_watch_line_info(struct gpiod_chip *chip, unsigned int offset)
 	return chip_get_line_info(chip, offset, true);
 }
 
+GPIOD_API int gpiod_chip_watch_lines(struct gpiod_chip *chip,
+				     const unsigned int *offsets,
+				     size_t num_offsets,
+				     struct gpiod_line_info **infos)
+{
+	struct gpio_v2_line_info info;
+	int ret, saved_errno;
+	size_t i;
+
+	assert(chip);
+
+	if (!offsets && num_offsets) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (infos)
+		memset(infos, 0, num_offsets * sizeof(*infos));
+
+	for (i = 0; i < num_offsets; i++) {
+		ret = chip_read_line_info(chip, offsets[i], &info, true);
+		if (ret)
+			goto err_unwatch;
+
+		if (infos) {
+			infos[i] = gpiod_line_info_from_uapi(&info);
+			if (!infos[i]) {
+				i++;
+				goto err_unwatch;
+			}
+		}
+	}
+
+	return 0;
+
+err_unwatch:
+	/* Leave the chip in the state we found it in. */
+	saved_errno = errno;
+
+	while (i--) {
+		gpiod_ioctl(chip->backend, chip->fd,
+			    GPIO_GET_LINEINFO_UNWATCH_IOCTL,
+			    (unsigned int *)&offsets[i]);
+
+		if (infos) {
+			gpiod_line_info_free(infos[i]);
+			infos[i] = NULL;
+		}
+	}
+
+	errno = saved_errno;
+	return -1;
+}
+
 GPIOD_API int gpiod_chip_unwatch_line_info(struct gpiod_chip *chip,
 					   unsigned int offset)
 {
 	assert(chip);
 
-	return gpiod_ioctl(chip->fd, GPIO_GET_LINEINFO_UNWATCH_IOCTL, &offset);
+	return gpiod_ioctl(chip->backend, chip->fd,
+			   GPIO_GET_LINEINFO_UNWATCH_IOCTL, &offset);
 }
 
 GPIOD_API int gpiod_chip_get_fd(struct gpiod_chip *chip)
@@ -159,12 +290,18 @@ GPIOD_API int gpiod_chip_get_fd(struct gpiod_chip *chip)
 	return chip->fd;
 }
 
+const struct gpiod_backend *
+gpiod_chip_get_backend(struct gpiod_chip *chip)
+{
+	return chip->backend;
+}
+
 GPIOD_API int gpiod_chip_wait_info_event(struct gpiod_chip *chip,
 					 int64_t timeout_ns)
 {
 	assert(chip);
 
-	return gpiod_poll_fd(chip->fd, timeout_ns);
+	return gpiod_poll_fd(chip->backend, chip->fd, timeout_ns);
 }
 
 GPIOD_API struct gpiod_info_event *
@@ -172,7 +309,7 @@ gpiod_chip_read_info_event(struct gpiod_chip *chip)
 {
 	assert(chip);
 
-	return gpiod_info_event_read_fd(chip->fd);
+	return gpiod_info_event_read_fd(chip->backend, chip->fd);
 }
 
 GPIOD_API int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
@@ -190,12 +327,12 @@ GPIOD_API int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
 		return -1;
 	}
 
-	ret = read_chip_info(chip->fd, &chinfo);
+	ret = read_chip_info(chip, &chinfo);
 	if (ret)
 		return -1;
 
 	for (offset = 0; offset < chinfo.lines; offset++) {
-		ret = chip_read_line_info(chip->fd, offset, &linfo, false);
+		ret = chip_read_line_info(chip, offset, &linfo, false);
 		if (ret)
 			return -1;
 
@@ -233,17 +370,19 @@ gpiod_chip_request_lines(struct gpiod_chip *chip,
 	if (ret)
 		return NULL;
 
-	ret = read_chip_info(chip->fd, &info);
+	ret = read_chip_info(chip, &info);
 	if (ret)
 		return NULL;
 
-	ret = gpiod_ioctl(chip->fd, GPIO_V2_GET_LINE_IOCTL, &uapi_req);
+	ret = gpiod_ioctl(chip->backend, chip->fd, GPIO_V2_GET_LINE_IOCTL,
+			  &uapi_req);
 	if (ret)
 		return NULL;
 
-	request = gpiod_line_request_from_uapi(&uapi_req, info.name);
+	request = gpiod_line_request_from_uapi(&uapi_req, info.name,
+					       chip->backend);
 	if (!request) {
-		close(uapi_req.fd);
+		chip->backend->close(uapi_req.fd);
 		return NULL;
 	}
 
@@ -6,6 +6,8 @@
 #include <gpiod.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/param.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "internal.h"
@@ -163,13 +165,42 @@ gpiod_edge_event_buffer_get_num_events(struct gpiod_edge_event_buffer *buffer)
 	return buffer->num_events;
 }
 
-int gpiod_edge_event_buffer_read_fd(int fd,
-				    struct gpiod_edge_event_buffer *buffer,
-				    size_t max_events)
+size_t gpiod_edge_event_buffer_from_uapi(struct gpiod_edge_event_buffer *buffer,
+					 const struct gpio_v2_line_event *data,
+					 size_t num_events)
 {
-	struct gpio_v2_line_event *curr;
+	const struct gpio_v2_line_event *curr;
 	struct gpiod_edge_event *event;
 	size_t i;
+
+	if (num_events > buffer->capacity)
+		num_events = buffer->capacity;
+
+	memset(buffer->events, 0, sizeof(*buffer->events) * buffer->capacity);
+
+	for (i = 0; i < num_events; i++) {
+		curr = &data[i];
+		event = &buffer->events[i];
+
+		event->line_offset = curr->offset;
+		event->event_type = curr->id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
+					    GPIOD_EDGE_EVENT_RISING_EDGE :
+					    GPIOD_EDGE_EVENT_FALLING_EDGE;
+		event->timestamp = curr->timestamp_ns;
+		event->global_seqno = curr->seqno;
+		event->line_seqno = curr->line_seqno;
+	}
+
+	buffer->num_events = num_events;
+
+	return num_events;
+}
+
+int gpiod_edge_event_buffer_read_fd(const struct gpiod_backend *backend,
+				    int fd,
+				    struct gpiod_edge_event_buffer *buffer,
+				    size_t max_events)
+{
 	ssize_t rd;
 
 	if (!buffer) {
@@ -179,13 +210,12 @@ int gpiod_edge_event_buffer_read_fd(int fd,
 
 	memset(buffer->event_data, 0,
 	       sizeof(*buffer->event_data) * buffer->capacity);
-	memset(buffer->events, 0, sizeof(*buffer->events) * buffer->capacity);
 
 	if (max_events > buffer->capacity)
 		max_events = buffer->capacity;
 
-	rd = read(fd, buffer->event_data,
-		  max_events * sizeof(*buffer->event_data));
+	rd = backend->read(fd, buffer->event_data,
+			   max_events * sizeof(*buffer->event_data));
 	if (rd < 0) {
 		return -1;
 	} else if ((unsigned int)rd < sizeof(*buffer->event_data)) {
@@ -193,20 +223,163 @@ int gpiod_edge_event_buffer_read_fd(int fd,
 		return -1;
 	}
 
-	buffer->num_events = rd / sizeof(*buffer->event_data);
+	return gpiod_edge_event_buffer_from_uapi(buffer, buffer->event_data,
+					rd / sizeof(*buffer->event_data));
+}
 
-	for (i = 0; i < buffer->num_events; i++) {
-		curr = &buffer->event_data[i];
-		event = &buffer->events[i];
+int gpiod_edge_event_buffer_reserve(struct gpiod_edge_event_buffer *buffer,
+				    size_t capacity)
+{
+	struct gpio_v2_line_event *event_data;
+	struct gpiod_edge_event *events;
 
-		event->line_offset = curr->offset;
-		event->event_type = curr->id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
-					    GPIOD_EDGE_EVENT_RISING_EDGE :
-					    GPIOD_EDGE_EVENT_FALLING_EDGE;
-		event->timestamp = curr->timestamp_ns;
-		event->global_seqno = curr->seqno;
-		event->line_seqno = curr->line_seqno;
+	if (capacity <= buffer->capacity)
+		return 0;
+
+	events = realloc(buffer->events, capacity * sizeof(*events));
+	if (!events)
+		return -1;
+
+	buffer->events = events;
+
+	event_data = realloc(buffer->event_data,
+			     capacity * sizeof(*event_data));
+	if (!event_data)
+		return -1;
+
+	buffer->event_data = event_data;
+	buffer->capacity = capacity;
+
+	return 0;
+}
+
+int gpiod_edge_event_buffer_drain_fd(const struct gpiod_backend *backend,
+				     int fd,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events)
+{
+	size_t num = 0, limit;
+	int err = 0, ret;
+	ssize_t rd;
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	while (num < max_events) {
+		if (num == buffer->capacity) {
+			ret = gpiod_edge_event_buffer_reserve(buffer,
+						MIN(num * 2, max_events));
+			if (ret) {
+				err = errno;
+				break;
+			}
+		}
+
+		limit = MIN(buffer->capacity, max_events);
+
+		rd = backend->read(fd, &buffer->event_data[num],
+				   (limit - num) * sizeof(*buffer->event_data));
+		if (rd < 0) {
+			if (errno != EAGAIN)
+				err = errno;
+			break;
+		} else if ((unsigned int)rd < sizeof(*buffer->event_data)) {
+			err = EIO;
+			break;
+		}
+
+		num += rd / sizeof(*buffer->event_data);
 	}
 
-	return i;
+	/*
+	 * Events already read can't be put back - report the error only if
+	 * there's nothing to return.
+	 */
+	if (!num && err) {
+		buffer->num_events = 0;
+		errno = err;
+		return -1;
+	}
+
+	return gpiod_edge_event_buffer_from_uapi(buffer, buffer->event_data,
+						 num);
+}
+
+int gpiod_edge_event_buffer_read_fd_busy(const struct gpiod_backend *backend,
+					 int fd,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events, int64_t spin_ns,
+					 int64_t timeout_ns, bool *spun)
+{
+	int64_t elapsed, remaining = -1;
+	uint64_t start;
+	ssize_t rd;
+	int ret;
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (max_events > buffer->capacity)
+		max_events = buffer->capacity;
+
+	if (timeout_ns >= 0 && spin_ns > timeout_ns)
+		spin_ns = timeout_ns;
+
+	memset(buffer->event_data, 0,
+	       sizeof(*buffer->event_data) * buffer->capacity);
+
+	start = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	/*
+	 * On a non-blocking file descriptor a read both checks for and fetches
+	 * the events so an event arriving while spinning costs a single
+	 * syscall and no scheduler wakeup.
+	 */
+	do {
+		rd = backend->read(fd, buffer->event_data,
+				   max_events * sizeof(*buffer->event_data));
+		if (rd >= 0 || errno != EAGAIN)
+			break;
+		elapsed = gpiod_clock_get_ns(CLOCK_MONOTONIC) - start;
+	} while (elapsed < spin_ns);
+
+	/* Without a spin phase the single read above doesn't count as one. */
+	if (spun)
+		*spun = rd >= 0 && spin_ns > 0;
+
+	while (rd < 0 && errno == EAGAIN) {
+		if (timeout_ns >= 0) {
+			elapsed = gpiod_clock_get_ns(CLOCK_MONOTONIC) - start;
+			remaining = timeout_ns - elapsed;
+			if (remaining <= 0)
+				goto timeout;
+		}
+
+		ret = backend->poll(fd, remaining);
+		if (ret < 0)
+			return -1;
+		if (ret == 0)
+			goto timeout;
+
+		rd = backend->read(fd, buffer->event_data,
+				   max_events * sizeof(*buffer->event_data));
+	}
+
+	if (rd < 0) {
+		return -1;
+	} else if ((unsigned int)rd < sizeof(*buffer->event_data)) {
+		errno = EIO;
+		return -1;
+	}
+
+	return gpiod_edge_event_buffer_from_uapi(buffer, buffer->event_data,
+					rd / sizeof(*buffer->event_data));
+
+timeout:
+	buffer->num_events = 0;
+	return 0;
 }
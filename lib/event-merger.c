@@ -0,0 +1,523 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define MERGER_MIN_QUEUE	64
+#define MERGER_READ_EVENTS	64
+
+struct merger_source {
+	/* ring buffer of events waiting to be merged */
+	struct gpio_v2_line_event *events;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	/* index within the event reader or -1 for sources fed by the user */
+	int reader_index;
+};
+
+struct gpiod_event_merger {
+	struct merger_source *sources;
+	size_t num_sources;
+	/* min-heap of indices of sources with queued events */
+	unsigned int *heap;
+	size_t heap_size;
+	struct gpiod_event_reader *reader;
+	struct gpiod_edge_event_buffer *scratch;
+	struct gpio_v2_line_event *out;
+	size_t out_size;
+	uint64_t window;
+	bool have_clock;
+	clockid_t clock;
+	/* newest timestamp seen, the reference time if there's no clock */
+	uint64_t latest;
+};
+
+static uint64_t merger_head_timestamp(struct gpiod_event_merger *merger,
+				      unsigned int idx)
+{
+	struct merger_source *source = &merger->sources[idx];
+
+	return source->events[source->head].timestamp_ns;
+}
+
+static bool merger_heap_less(struct gpiod_event_merger *merger,
+			     unsigned int a, unsigned int b)
+{
+	uint64_t ts_a = merger_head_timestamp(merger, a),
+		 ts_b = merger_head_timestamp(merger, b);
+
+	/* Keep the order stable by preferring lower source indices. */
+	return ts_a < ts_b || (ts_a == ts_b && a < b);
+}
+
+static void merger_heap_swap(struct gpiod_event_merger *merger, size_t i,
+			     size_t j)
+{
+	unsigned int tmp = merger->heap[i];
+
+	merger->heap[i] = merger->heap[j];
+	merger->heap[j] = tmp;
+}
+
+static void merger_heap_push(struct gpiod_event_merger *merger,
+			     unsigned int idx)
+{
+	size_t pos = merger->heap_size++, parent;
+
+	merger->heap[pos] = idx;
+
+	while (pos) {
+		parent = (pos - 1) / 2;
+		if (!merger_heap_less(merger, merger->heap[pos],
+				      merger->heap[parent]))
+			break;
+
+		merger_heap_swap(merger, pos, parent);
+		pos = parent;
+	}
+}
+
+/* Restore the heap after the head of the top source changed. */
+static void merger_heap_sift_down(struct gpiod_event_merger *merger)
+{
+	size_t pos = 0, child;
+
+	for (;;) {
+		child = pos * 2 + 1;
+		if (child >= merger->heap_size)
+			break;
+
+		if (child + 1 < merger->heap_size &&
+		    merger_heap_less(merger, merger->heap[child + 1],
+				     merger->heap[child]))
+			child++;
+
+		if (!merger_heap_less(merger, merger->heap[child],
+				      merger->heap[pos]))
+			break;
+
+		merger_heap_swap(merger, pos, child);
+		pos = child;
+	}
+}
+
+static void merger_heap_pop(struct gpiod_event_merger *merger)
+{
+	merger->heap[0] = merger->heap[--merger->heap_size];
+	merger_heap_sift_down(merger);
+}
+
+static int merger_source_reserve(struct merger_source *source, size_t count)
+{
+	struct gpio_v2_line_event *events;
+	size_t capacity, first;
+
+	if (source->count + count <= source->capacity)
+		return 0;
+
+	capacity = source->capacity ?: MERGER_MIN_QUEUE;
+	while (capacity < source->count + count)
+		capacity *= 2;
+
+	events = malloc(capacity * sizeof(*events));
+	if (!events)
+		return -1;
+
+	/* Unwrap the ring while copying. */
+	first = source->capacity - source->head;
+	if (first > source->count)
+		first = source->count;
+
+	memcpy(events, &source->events[source->head],
+	       first * sizeof(*events));
+	memcpy(&events[first], source->events,
+	       (source->count - first) * sizeof(*events));
+
+	free(source->events);
+	source->events = events;
+	source->capacity = capacity;
+	source->head = 0;
+
+	return 0;
+}
+
+static int merger_add(struct gpiod_event_merger *merger, int reader_index)
+{
+	struct merger_source *sources;
+	unsigned int *heap;
+	size_t num = merger->num_sources + 1;
+
+	sources = realloc(merger->sources, num * sizeof(*sources));
+	if (!sources)
+		return -1;
+
+	merger->sources = sources;
+
+	heap = realloc(merger->heap, num * sizeof(*heap));
+	if (!heap)
+		return -1;
+
+	merger->heap = heap;
+
+	memset(&sources[merger->num_sources], 0, sizeof(*sources));
+	sources[merger->num_sources].reader_index = reader_index;
+
+	return merger->num_sources++;
+}
+
+static uint64_t merger_now(struct gpiod_event_merger *merger)
+{
+	if (!merger->have_clock)
+		return merger->latest;
+
+	return gpiod_clock_get_ns(merger->clock);
+}
+
+/*
+ * The oldest queued event can go out once every source has an event queued,
+ * as sources deliver their events in order, or once it's older than the
+ * reorder window.
+ */
+static bool merger_head_ready(struct gpiod_event_merger *merger, uint64_t now)
+{
+	if (!merger->heap_size)
+		return false;
+
+	if (merger->heap_size == merger->num_sources)
+		return true;
+
+	return merger_head_timestamp(merger, merger->heap[0]) +
+	       merger->window <= now;
+}
+
+/*
+ * Nanoseconds until the oldest event can go out, 0 if it already can or -1
+ * if it depends on events yet to arrive.
+ */
+static int64_t merger_time_to_ready(struct gpiod_event_merger *merger)
+{
+	uint64_t now, ready;
+
+	if (!merger->heap_size)
+		return -1;
+
+	now = merger_now(merger);
+	if (merger_head_ready(merger, now))
+		return 0;
+
+	if (!merger->have_clock)
+		return -1;
+
+	ready = merger_head_timestamp(merger, merger->heap[0]) +
+		merger->window;
+
+	return ready - now;
+}
+
+GPIOD_API struct gpiod_event_merger *
+gpiod_event_merger_new(enum gpiod_line_clock clock, uint64_t reorder_window_ns)
+{
+	struct gpiod_event_merger *merger;
+
+	merger = malloc(sizeof(*merger));
+	if (!merger)
+		return NULL;
+
+	memset(merger, 0, sizeof(*merger));
+
+	merger->window = reorder_window_ns;
+
+	switch (clock) {
+	case GPIOD_LINE_CLOCK_MONOTONIC:
+		merger->have_clock = true;
+		merger->clock = CLOCK_MONOTONIC;
+		break;
+	case GPIOD_LINE_CLOCK_REALTIME:
+		merger->have_clock = true;
+		merger->clock = CLOCK_REALTIME;
+		break;
+	case GPIOD_LINE_CLOCK_HTE:
+		break;
+	default:
+		free(merger);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return merger;
+}
+
+GPIOD_API void gpiod_event_merger_free(struct gpiod_event_merger *merger)
+{
+	size_t i;
+
+	if (!merger)
+		return;
+
+	for (i = 0; i < merger->num_sources; i++)
+		free(merger->sources[i].events);
+
+	gpiod_event_reader_free(merger->reader);
+	gpiod_edge_event_buffer_free(merger->scratch);
+	free(merger->sources);
+	free(merger->heap);
+	free(merger->out);
+	free(merger);
+}
+
+GPIOD_API int gpiod_event_merger_add_request(struct gpiod_event_merger *merger,
+					     struct gpiod_line_request *request)
+{
+	int index;
+
+	assert(merger);
+
+	if (!request) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!merger->reader) {
+		merger->reader = gpiod_event_reader_new();
+		if (!merger->reader)
+			return -1;
+	}
+
+	if (!merger->scratch) {
+		merger->scratch = gpiod_edge_event_buffer_new(
+							MERGER_READ_EVENTS);
+		if (!merger->scratch)
+			return -1;
+	}
+
+	index = gpiod_event_reader_add_request(merger->reader, request);
+	if (index < 0)
+		return -1;
+
+	return merger_add(merger, index);
+}
+
+GPIOD_API int gpiod_event_merger_add_source(struct gpiod_event_merger *merger)
+{
+	assert(merger);
+
+	return merger_add(merger, -1);
+}
+
+GPIOD_API int gpiod_event_merger_push(struct gpiod_event_merger *merger,
+				      unsigned int source,
+				      struct gpiod_edge_event_buffer *buffer)
+{
+	struct gpio_v2_line_event *data;
+	struct gpiod_edge_event *event;
+	struct merger_source *src;
+	size_t num, i, pos;
+	bool was_empty;
+
+	assert(merger);
+
+	if (source >= merger->num_sources || !buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	src = &merger->sources[source];
+	num = gpiod_edge_event_buffer_get_num_events(buffer);
+
+	if (merger_source_reserve(src, num))
+		return -1;
+
+	was_empty = !src->count;
+
+	for (i = 0; i < num; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		pos = (src->head + src->count++) % src->capacity;
+		data = &src->events[pos];
+
+		memset(data, 0, sizeof(*data));
+		data->timestamp_ns = gpiod_edge_event_get_timestamp_ns(event);
+		data->id = gpiod_edge_event_get_event_type(event) ==
+					GPIOD_EDGE_EVENT_RISING_EDGE ?
+				GPIO_V2_LINE_EVENT_RISING_EDGE :
+				GPIO_V2_LINE_EVENT_FALLING_EDGE;
+		data->offset = gpiod_edge_event_get_line_offset(event);
+		data->seqno = gpiod_edge_event_get_global_seqno(event);
+		data->line_seqno = gpiod_edge_event_get_line_seqno(event);
+
+		if (data->timestamp_ns > merger->latest)
+			merger->latest = data->timestamp_ns;
+	}
+
+	if (was_empty && src->count)
+		merger_heap_push(merger, source);
+
+	return 0;
+}
+
+/* Move everything the event reader collected into the source queues. */
+static int merger_collect(struct gpiod_event_merger *merger)
+{
+	struct merger_source *source;
+	int index, ret;
+	size_t i;
+
+	while ((index = gpiod_event_reader_next_ready(merger->reader)) >= 0) {
+		for (i = 0; i < merger->num_sources; i++) {
+			source = &merger->sources[i];
+			if (source->reader_index == index)
+				break;
+		}
+
+		ret = gpiod_event_reader_read_edge_events(merger->reader, index,
+							  merger->scratch,
+							  MERGER_READ_EVENTS);
+		if (ret < 0)
+			return -1;
+
+		if (gpiod_event_merger_push(merger, i, merger->scratch))
+			return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API int gpiod_event_merger_wait(struct gpiod_event_merger *merger,
+				      int64_t timeout_ns)
+{
+	int64_t ready, wait_ns;
+	uint64_t deadline = 0;
+	struct timespec ts;
+	int ret;
+
+	assert(merger);
+
+	if (timeout_ns > 0)
+		deadline = gpiod_clock_get_ns(CLOCK_MONOTONIC) + timeout_ns;
+
+	for (;;) {
+		ready = merger_time_to_ready(merger);
+		if (ready == 0)
+			return 1;
+
+		if (timeout_ns < 0) {
+			wait_ns = -1;
+		} else if (timeout_ns == 0) {
+			wait_ns = 0;
+		} else {
+			wait_ns = deadline -
+				  gpiod_clock_get_ns(CLOCK_MONOTONIC);
+			if (wait_ns < 0)
+				wait_ns = 0;
+		}
+
+		if (ready > 0 && (wait_ns < 0 || ready < wait_ns))
+			wait_ns = ready;
+
+		if (merger->reader) {
+			ret = gpiod_event_reader_wait(merger->reader, wait_ns);
+			if (ret < 0)
+				return -1;
+
+			if (ret > 0 && merger_collect(merger))
+				return -1;
+		} else if (wait_ns < 0) {
+			/* Nothing will ever show up without more pushes. */
+			return 0;
+		} else if (wait_ns > 0) {
+			ts.tv_sec = wait_ns / 1000000000;
+			ts.tv_nsec = wait_ns % 1000000000;
+			nanosleep(&ts, NULL);
+		}
+
+		if (timeout_ns == 0 ||
+		    (timeout_ns > 0 &&
+		     gpiod_clock_get_ns(CLOCK_MONOTONIC) >= deadline))
+			return merger_time_to_ready(merger) == 0;
+	}
+}
+
+static int merger_pop(struct gpiod_event_merger *merger,
+		      struct gpiod_edge_event_buffer *buffer,
+		      unsigned int *sources, size_t max_events, bool flush)
+{
+	struct gpio_v2_line_event *out;
+	struct merger_source *source;
+	unsigned int idx;
+	size_t num = 0;
+	uint64_t now;
+
+	assert(merger);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (max_events > gpiod_edge_event_buffer_get_capacity(buffer))
+		max_events = gpiod_edge_event_buffer_get_capacity(buffer);
+
+	if (max_events > merger->out_size) {
+		out = realloc(merger->out, max_events * sizeof(*out));
+		if (!out)
+			return -1;
+
+		merger->out = out;
+		merger->out_size = max_events;
+	}
+
+	now = merger_now(merger);
+
+	while (num < max_events &&
+	       (flush ? merger->heap_size > 0 : merger_head_ready(merger, now))) {
+		idx = merger->heap[0];
+		source = &merger->sources[idx];
+
+		merger->out[num] = source->events[source->head];
+		if (sources)
+			sources[num] = idx;
+		num++;
+
+		source->head = (source->head + 1) % source->capacity;
+		if (--source->count)
+			merger_heap_sift_down(merger);
+		else
+			merger_heap_pop(merger);
+	}
+
+	return gpiod_edge_event_buffer_from_uapi(buffer, merger->out, num);
+}
+
+GPIOD_API int gpiod_event_merger_read(struct gpiod_event_merger *merger,
+				      struct gpiod_edge_event_buffer *buffer,
+				      unsigned int *sources, size_t max_events)
+{
+	return merger_pop(merger, buffer, sources, max_events, false);
+}
+
+GPIOD_API int gpiod_event_merger_flush(struct gpiod_event_merger *merger,
+				       struct gpiod_edge_event_buffer *buffer,
+				       unsigned int *sources, size_t max_events)
+{
+	return merger_pop(merger, buffer, sources, max_events, true);
+}
+
+GPIOD_API size_t
+gpiod_event_merger_get_num_pending(struct gpiod_event_merger *merger)
+{
+	size_t i, num = 0;
+
+	assert(merger);
+
+	for (i = 0; i < merger->num_sources; i++)
+		num += merger->sources[i].count;
+
+	return num;
+}
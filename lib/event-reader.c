@@ -0,0 +1,749 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef GPIOD_IO_URING
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include "internal.h"
+
+/* Number of events each source can collect in a single read. */
+#define READER_EDGE_EVENTS	64
+#define READER_INFO_EVENTS	16
+
+enum {
+	READER_SOURCE_REQUEST = 1,
+	READER_SOURCE_CHIP,
+};
+
+struct reader_source {
+	int type;
+	int fd;
+	const struct gpiod_backend *backend;
+	void *data;
+	size_t size;
+	size_t len;
+	size_t pos;
+	int error;
+	bool in_flight;
+};
+
+#ifdef GPIOD_IO_URING
+/* Marks the completions of cancel requests, as opposed to those of reads. */
+#define RING_CANCEL_TAG		((uint64_t)1 << 63)
+/* Reads are given up to a second to acknowledge the cancellation. */
+#define RING_CANCEL_TIMEOUT_NS	100000000
+#define RING_CANCEL_TRIES	10
+
+struct reader_ring {
+	int fd;
+	void *sq_ptr;
+	size_t sq_size;
+	void *cq_ptr;
+	size_t cq_size;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+};
+#endif
+
+struct gpiod_event_reader {
+	struct reader_source *sources;
+	size_t num_sources;
+	size_t cursor;
+	bool started;
+	bool uring;
+	struct pollfd *pfds;
+#ifdef GPIOD_IO_URING
+	struct reader_ring ring;
+#endif
+};
+
+static bool source_pending(struct reader_source *source)
+{
+	return source->error || source->pos < source->len;
+}
+
+/* res is either the number of bytes read or a negative errno. */
+static void source_complete(struct reader_source *source, ssize_t res)
+{
+	source->in_flight = false;
+	source->pos = 0;
+	source->len = 0;
+
+	if (res < 0)
+		source->error = -res;
+	else if (res == 0)
+		source->error = EIO;
+	else
+		source->len = res;
+}
+
+#ifdef GPIOD_IO_URING
+
+static int ring_setup(struct gpiod_event_reader *reader)
+{
+	struct reader_ring *ring = &reader->ring;
+	struct io_uring_params params;
+	struct iovec *iov;
+	int *fds, ret;
+	size_t i;
+
+	memset(ring, 0, sizeof(*ring));
+	memset(&params, 0, sizeof(params));
+
+	ring->fd = syscall(__NR_io_uring_setup, reader->num_sources, &params);
+	if (ring->fd < 0)
+		return -1;
+
+	if (!(params.features & IORING_FEAT_EXT_ARG)) {
+		errno = ENOSYS;
+		goto err_close;
+	}
+
+	ring->sq_size = params.sq_off.array +
+			params.sq_entries * sizeof(unsigned int);
+	ring->cq_size = params.cq_off.cqes +
+			params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_size > ring->sq_size)
+			ring->sq_size = ring->cq_size;
+		ring->cq_size = 0;
+	}
+
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, ring->fd,
+			    IORING_OFF_SQ_RING);
+	if (ring->sq_ptr == MAP_FAILED)
+		goto err_close;
+
+	if (ring->cq_size) {
+		ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+				    MAP_SHARED | MAP_POPULATE, ring->fd,
+				    IORING_OFF_CQ_RING);
+		if (ring->cq_ptr == MAP_FAILED)
+			goto err_unmap_sq;
+	} else {
+		ring->cq_ptr = ring->sq_ptr;
+	}
+
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, ring->fd,
+			  IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto err_unmap_cq;
+
+	ring->sq_head = (unsigned int *)((char *)ring->sq_ptr +
+					 params.sq_off.head);
+	ring->sq_tail = (unsigned int *)((char *)ring->sq_ptr +
+					 params.sq_off.tail);
+	ring->sq_mask = (unsigned int *)((char *)ring->sq_ptr +
+					 params.sq_off.ring_mask);
+	ring->sq_array = (unsigned int *)((char *)ring->sq_ptr +
+					  params.sq_off.array);
+	ring->cq_head = (unsigned int *)((char *)ring->cq_ptr +
+					 params.cq_off.head);
+	ring->cq_tail = (unsigned int *)((char *)ring->cq_ptr +
+					 params.cq_off.tail);
+	ring->cq_mask = (unsigned int *)((char *)ring->cq_ptr +
+					 params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)((char *)ring->cq_ptr +
+					     params.cq_off.cqes);
+
+	fds = calloc(reader->num_sources, sizeof(*fds));
+	iov = calloc(reader->num_sources, sizeof(*iov));
+	if (!fds || !iov) {
+		free(fds);
+		free(iov);
+		errno = ENOMEM;
+		goto err_unmap_sqes;
+	}
+
+	for (i = 0; i < reader->num_sources; i++) {
+		fds[i] = reader->sources[i].fd;
+		iov[i].iov_base = reader->sources[i].data;
+		iov[i].iov_len = reader->sources[i].size;
+	}
+
+	/*
+	 * Registering the files and buffers upfront spares the kernel from
+	 * looking up the file and pinning the pages on every read.
+	 */
+	ret = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_FILES,
+		      fds, reader->num_sources);
+	if (ret == 0)
+		ret = syscall(__NR_io_uring_register, ring->fd,
+			      IORING_REGISTER_BUFFERS, iov,
+			      reader->num_sources);
+	free(fds);
+	free(iov);
+	if (ret)
+		goto err_unmap_sqes;
+
+	return 0;
+
+err_unmap_sqes:
+	munmap(ring->sqes, ring->sqes_size);
+err_unmap_cq:
+	if (ring->cq_size)
+		munmap(ring->cq_ptr, ring->cq_size);
+err_unmap_sq:
+	munmap(ring->sq_ptr, ring->sq_size);
+err_close:
+	close(ring->fd);
+	return -1;
+}
+
+static void ring_reap(struct gpiod_event_reader *reader)
+{
+	struct reader_ring *ring = &reader->ring;
+	unsigned int head, tail;
+	struct io_uring_cqe *cqe;
+
+	head = *ring->cq_head;
+	tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+	for (; head != tail; head++) {
+		cqe = &ring->cqes[head & *ring->cq_mask];
+		if (cqe->user_data & RING_CANCEL_TAG)
+			continue;
+
+		source_complete(&reader->sources[cqe->user_data], cqe->res);
+	}
+
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static bool ring_in_flight(struct gpiod_event_reader *reader)
+{
+	size_t i;
+
+	for (i = 0; i < reader->num_sources; i++) {
+		if (reader->sources[i].in_flight)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Line request and chip file descriptors are blocking, so the reads are
+ * executed by io-wq workers which keep writing into the registered buffers
+ * until they complete. Cancel them and wait for their completions before the
+ * buffers can be released.
+ *
+ * Returns false if some read couldn't be reaped in time, in which case the
+ * buffers must not be freed.
+ */
+static bool ring_cancel(struct gpiod_event_reader *reader)
+{
+	struct reader_ring *ring = &reader->ring;
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	struct io_uring_sqe *sqe;
+	unsigned int tail, idx;
+	int timeouts = 0, ret;
+	size_t i;
+
+	ring_reap(reader);
+
+	tail = *ring->sq_tail;
+
+	/* At most one read per source is in flight so the SQ has room. */
+	for (i = 0; i < reader->num_sources; i++) {
+		if (!reader->sources[i].in_flight)
+			continue;
+
+		idx = tail & *ring->sq_mask;
+		sqe = &ring->sqes[idx];
+		memset(sqe, 0, sizeof(*sqe));
+
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = i;
+		sqe->user_data = RING_CANCEL_TAG | i;
+
+		ring->sq_array[idx] = idx;
+		tail++;
+	}
+
+	__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+	memset(&arg, 0, sizeof(arg));
+	ts.tv_sec = 0;
+	ts.tv_nsec = RING_CANCEL_TIMEOUT_NS;
+	arg.ts = (uintptr_t)&ts;
+
+	while (ring_in_flight(reader) && timeouts < RING_CANCEL_TRIES) {
+		ret = syscall(__NR_io_uring_enter, ring->fd,
+			      tail - __atomic_load_n(ring->sq_head,
+						     __ATOMIC_ACQUIRE),
+			      1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+			      &arg, sizeof(arg));
+		if (ret < 0) {
+			if (errno == ETIME)
+				timeouts++;
+			else if (errno != EINTR)
+				break;
+		}
+
+		ring_reap(reader);
+	}
+
+	return !ring_in_flight(reader);
+}
+
+static bool ring_teardown(struct gpiod_event_reader *reader)
+{
+	struct reader_ring *ring = &reader->ring;
+	bool idle;
+
+	idle = ring_cancel(reader);
+	if (idle)
+		syscall(__NR_io_uring_register, ring->fd,
+			IORING_UNREGISTER_BUFFERS, NULL, 0);
+
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_size)
+		munmap(ring->cq_ptr, ring->cq_size);
+	munmap(ring->sq_ptr, ring->sq_size);
+	close(ring->fd);
+
+	return idle;
+}
+
+static int ring_wait(struct gpiod_event_reader *reader, int64_t timeout_ns)
+{
+	struct reader_ring *ring = &reader->ring;
+	struct io_uring_getevents_arg arg;
+	unsigned int tail, idx, to_submit;
+	struct reader_source *source;
+	struct __kernel_timespec ts;
+	struct io_uring_sqe *sqe;
+	unsigned int flags, min_complete = 0;
+	size_t i;
+	int ret;
+
+	tail = *ring->sq_tail;
+
+	for (i = 0; i < reader->num_sources; i++) {
+		source = &reader->sources[i];
+
+		if (source->in_flight || source_pending(source))
+			continue;
+
+		idx = tail & *ring->sq_mask;
+		sqe = &ring->sqes[idx];
+		memset(sqe, 0, sizeof(*sqe));
+
+		sqe->opcode = IORING_OP_READ_FIXED;
+		sqe->flags = IOSQE_FIXED_FILE;
+		sqe->fd = i;
+		sqe->off = (uint64_t)-1;
+		sqe->addr = (uintptr_t)source->data;
+		sqe->len = source->size;
+		sqe->buf_index = i;
+		sqe->user_data = i;
+
+		ring->sq_array[idx] = idx;
+		source->in_flight = true;
+		tail++;
+	}
+
+	__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+	to_submit = tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	memset(&arg, 0, sizeof(arg));
+	flags = IORING_ENTER_EXT_ARG;
+
+	if (timeout_ns != 0 &&
+	    *ring->cq_head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+		flags |= IORING_ENTER_GETEVENTS;
+		min_complete = 1;
+
+		if (timeout_ns > 0) {
+			ts.tv_sec = timeout_ns / 1000000000ULL;
+			ts.tv_nsec = timeout_ns % 1000000000ULL;
+			arg.ts = (uintptr_t)&ts;
+		}
+	}
+
+	if (to_submit || min_complete) {
+		ret = syscall(__NR_io_uring_enter, ring->fd, to_submit,
+			      min_complete, flags, &arg, sizeof(arg));
+		if (ret < 0 && errno != ETIME)
+			return -1;
+	}
+
+	ring_reap(reader);
+
+	return 0;
+}
+
+#endif /* GPIOD_IO_URING */
+
+static int poll_wait(struct gpiod_event_reader *reader, int64_t timeout_ns)
+{
+	struct reader_source *source;
+	struct timespec ts;
+	ssize_t rd;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < reader->num_sources; i++) {
+		source = &reader->sources[i];
+
+		/* Negative descriptors are ignored by ppoll(). */
+		reader->pfds[i].fd = source_pending(source) ? -1 : source->fd;
+		reader->pfds[i].events = POLLIN | POLLPRI;
+		reader->pfds[i].revents = 0;
+	}
+
+	if (timeout_ns >= 0) {
+		ts.tv_sec = timeout_ns / 1000000000ULL;
+		ts.tv_nsec = timeout_ns % 1000000000ULL;
+	}
+
+	ret = ppoll(reader->pfds, reader->num_sources,
+		    timeout_ns < 0 ? NULL : &ts, NULL);
+	if (ret <= 0)
+		return ret;
+
+	for (i = 0; i < reader->num_sources; i++) {
+		if (!reader->pfds[i].revents)
+			continue;
+
+		source = &reader->sources[i];
+		rd = source->backend->read(source->fd, source->data,
+					   source->size);
+		source_complete(source, rd < 0 ? -errno : rd);
+	}
+
+	return 0;
+}
+
+static int reader_start(struct gpiod_event_reader *reader)
+{
+	size_t i;
+
+	if (!reader->num_sources) {
+		errno = EINVAL;
+		return -1;
+	}
+
+#ifdef GPIOD_IO_URING
+	for (i = 0; i < reader->num_sources; i++) {
+		if (reader->sources[i].backend != &gpiod_kernel_backend)
+			break;
+	}
+
+	/* Any failure to set up the ring means falling back to ppoll(). */
+	if (i == reader->num_sources && ring_setup(reader) == 0) {
+		reader->uring = true;
+		reader->started = true;
+		return 0;
+	}
+#endif
+
+	reader->pfds = calloc(reader->num_sources, sizeof(*reader->pfds));
+	if (!reader->pfds)
+		return -1;
+
+	for (i = 0; i < reader->num_sources; i++)
+		reader->pfds[i].fd = -1;
+
+	reader->started = true;
+
+	return 0;
+}
+
+static int reader_add_source(struct gpiod_event_reader *reader, int type,
+			     int fd, const struct gpiod_backend *backend,
+			     size_t size)
+{
+	struct reader_source *sources, *source;
+	void *data;
+
+	if (reader->started) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	data = malloc(size);
+	if (!data)
+		return -1;
+
+	sources = realloc(reader->sources,
+			  sizeof(*sources) * (reader->num_sources + 1));
+	if (!sources) {
+		free(data);
+		return -1;
+	}
+
+	reader->sources = sources;
+	source = &reader->sources[reader->num_sources];
+	memset(source, 0, sizeof(*source));
+
+	source->type = type;
+	source->fd = fd;
+	source->backend = backend;
+	source->data = data;
+	source->size = size;
+
+	return reader->num_sources++;
+}
+
+static struct reader_source *
+reader_get_source(struct gpiod_event_reader *reader, unsigned int index,
+		  int type)
+{
+	struct reader_source *source;
+
+	if (index >= reader->num_sources ||
+	    reader->sources[index].type != type) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	source = &reader->sources[index];
+
+	if (source->error) {
+		errno = source->error;
+		source->error = 0;
+		return NULL;
+	}
+
+	if (source->pos >= source->len) {
+		errno = EAGAIN;
+		return NULL;
+	}
+
+	return source;
+}
+
+GPIOD_API struct gpiod_event_reader *gpiod_event_reader_new(void)
+{
+	struct gpiod_event_reader *reader;
+
+	reader = malloc(sizeof(*reader));
+	if (!reader)
+		return NULL;
+
+	memset(reader, 0, sizeof(*reader));
+
+	return reader;
+}
+
+GPIOD_API void gpiod_event_reader_free(struct gpiod_event_reader *reader)
+{
+	bool idle = true;
+	size_t i;
+
+	if (!reader)
+		return;
+
+#ifdef GPIOD_IO_URING
+	if (reader->uring)
+		idle = ring_teardown(reader);
+#endif
+
+	/*
+	 * Leaking the buffers is the lesser evil if a read outlived the
+	 * cancellation - the kernel may still write into them.
+	 */
+	for (i = 0; i < reader->num_sources && idle; i++)
+		free(reader->sources[i].data);
+
+	free(reader->sources);
+	free(reader->pfds);
+	free(reader);
+}
+
+GPIOD_API int
+gpiod_event_reader_add_request(struct gpiod_event_reader *reader,
+			       struct gpiod_line_request *request)
+{
+	assert(reader);
+
+	if (!request) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return reader_add_source(reader, READER_SOURCE_REQUEST,
+				 gpiod_line_request_get_fd(request),
+				 gpiod_line_request_get_backend(request),
+				 READER_EDGE_EVENTS *
+					sizeof(struct gpio_v2_line_event));
+}
+
+GPIOD_API int gpiod_event_reader_add_chip(struct gpiod_event_reader *reader,
+					  struct gpiod_chip *chip)
+{
+	assert(reader);
+
+	if (!chip) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return reader_add_source(reader, READER_SOURCE_CHIP,
+				 gpiod_chip_get_fd(chip),
+				 gpiod_chip_get_backend(chip),
+				 READER_INFO_EVENTS *
+				     sizeof(struct gpio_v2_line_info_changed));
+}
+
+GPIOD_API int gpiod_event_reader_wait(struct gpiod_event_reader *reader,
+				      int64_t timeout_ns)
+{
+	size_t i, pending = 0;
+	int ret;
+
+	assert(reader);
+
+	if (!reader->started) {
+		ret = reader_start(reader);
+		if (ret)
+			return -1;
+	}
+
+	for (i = 0; i < reader->num_sources; i++) {
+		if (source_pending(&reader->sources[i]))
+			pending++;
+	}
+
+	/* Don't block if there's still something to consume. */
+	if (pending)
+		timeout_ns = 0;
+
+#ifdef GPIOD_IO_URING
+	if (reader->uring)
+		ret = ring_wait(reader, timeout_ns);
+	else
+#endif
+		ret = poll_wait(reader, timeout_ns);
+	if (ret < 0)
+		return -1;
+
+	for (i = 0, pending = 0; i < reader->num_sources; i++) {
+		if (source_pending(&reader->sources[i]))
+			pending++;
+	}
+
+	return pending;
+}
+
+GPIOD_API int gpiod_event_reader_next_ready(struct gpiod_event_reader *reader)
+{
+	size_t i, index;
+
+	assert(reader);
+
+	for (i = 0; i < reader->num_sources; i++) {
+		index = (reader->cursor + i) % reader->num_sources;
+
+		if (source_pending(&reader->sources[index])) {
+			reader->cursor = index + 1;
+			return index;
+		}
+	}
+
+	errno = EAGAIN;
+	return -1;
+}
+
+GPIOD_API int
+gpiod_event_reader_read_edge_events(struct gpiod_event_reader *reader,
+				    unsigned int source,
+				    struct gpiod_edge_event_buffer *buffer,
+				    size_t max_events)
+{
+	struct reader_source *src;
+	size_t avail, num;
+
+	assert(reader);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	src = reader_get_source(reader, source, READER_SOURCE_REQUEST);
+	if (!src)
+		return -1;
+
+	avail = (src->len - src->pos) / sizeof(struct gpio_v2_line_event);
+	if (!avail) {
+		src->pos = src->len;
+		errno = EIO;
+		return -1;
+	}
+
+	if (max_events > avail)
+		max_events = avail;
+
+	num = gpiod_edge_event_buffer_from_uapi(buffer,
+				(struct gpio_v2_line_event *)
+					((char *)src->data + src->pos),
+				max_events);
+	src->pos += num * sizeof(struct gpio_v2_line_event);
+
+	return num;
+}
+
+GPIOD_API struct gpiod_info_event *
+gpiod_event_reader_read_info_event(struct gpiod_event_reader *reader,
+				   unsigned int source)
+{
+	struct gpio_v2_line_info_changed *uapi_evt;
+	struct reader_source *src;
+
+	assert(reader);
+
+	src = reader_get_source(reader, source, READER_SOURCE_CHIP);
+	if (!src)
+		return NULL;
+
+	if (src->len - src->pos < sizeof(*uapi_evt)) {
+		src->pos = src->len;
+		errno = EIO;
+		return NULL;
+	}
+
+	uapi_evt = (struct gpio_v2_line_info_changed *)
+				((char *)src->data + src->pos);
+	src->pos += sizeof(*uapi_evt);
+
+	return gpiod_info_event_from_uapi(uapi_evt);
+}
+
+GPIOD_API bool
+gpiod_event_reader_uses_io_uring(struct gpiod_event_reader *reader)
+{
+	assert(reader);
+
+	return reader->uring;
+}
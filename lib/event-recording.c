@@ -0,0 +1,919 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Recording layout, all fixed-width fields are little-endian:
+ *
+ * header:	"GPIODREC", u32 version, u32 number of lines,
+ *		char chip_name[32], u32 offsets[number of lines]
+ * blocks:	"GBLK", u32 number of events, u32 payload size, u32 reserved,
+ *		u64 timestamp of the first event, u64 global seqno of the first
+ *		event, payload
+ * index:	for every block: u64 file offset, u64 timestamp of the first
+ *		event, u64 index of the first event in the recording
+ * trailer:	"GPIODIDX", u64 file offset of the index, u64 number of blocks
+ *
+ * Every event in a block's payload is stored as four LEB128 varints:
+ *
+ *   - index of the line in the header's table shifted left by one with the
+ *     lowest bit set for falling edges,
+ *   - zigzag-encoded difference between the event's timestamp and that of
+ *     the previous event in the block (or the block's first timestamp),
+ *   - zigzag-encoded difference between the event's global seqno and the
+ *     previous one plus one,
+ *   - zigzag-encoded difference between the event's line seqno and the
+ *     previous one for the same line in the block plus one (zero before the
+ *     first event of the line in the block).
+ *
+ * For a steady stream of events this takes 4-6 bytes per event. Blocks can
+ * be decoded independently and the index and trailer are optional: a
+ * recording that was cut short is read by walking the block headers.
+ */
+
+#include <assert.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define RECORDING_MAGIC			"GPIODREC"
+#define RECORDING_VERSION		1
+#define RECORDING_BLOCK_MAGIC		"GBLK"
+#define RECORDING_INDEX_MAGIC		"GPIODIDX"
+#define RECORDING_BLOCK_EVENTS		1024
+/* Four varints of at most 10 bytes each. */
+#define RECORDING_MAX_EVENT_SIZE	40
+#define RECORDING_HEADER_SIZE		(8 + 4 + 4 + GPIO_MAX_NAME_SIZE)
+#define RECORDING_BLOCK_HEADER_SIZE	32
+#define RECORDING_INDEX_ENTRY_SIZE	24
+#define RECORDING_TRAILER_SIZE		24
+
+struct recording_index_entry {
+	uint64_t offset;
+	uint64_t first_timestamp;
+	uint64_t first_index;
+};
+
+struct gpiod_event_recorder {
+	int fd;
+	bool finished;
+	size_t num_lines;
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	uint64_t pos;
+	uint64_t num_events;
+	/* State of the block being built. */
+	uint8_t *payload;
+	size_t payload_size;
+	uint32_t block_events;
+	uint64_t block_timestamp;
+	uint64_t block_seqno;
+	uint64_t prev_timestamp;
+	uint64_t prev_seqno;
+	uint64_t prev_line_seqno[GPIO_V2_LINES_MAX];
+	struct recording_index_entry *index;
+	size_t num_blocks;
+	size_t max_blocks;
+};
+
+struct recording_block {
+	const uint8_t *payload;
+	uint32_t payload_size;
+	uint32_t num_events;
+	uint64_t first_timestamp;
+	uint64_t first_seqno;
+	uint64_t first_index;
+};
+
+struct recording_cursor {
+	size_t block;
+	size_t pos;
+	uint32_t event;
+	uint64_t index;
+	uint64_t prev_timestamp;
+	uint64_t prev_seqno;
+	uint64_t prev_line_seqno[GPIO_V2_LINES_MAX];
+};
+
+struct gpiod_event_recording {
+	const uint8_t *data;
+	size_t size;
+	char chip_name[GPIO_MAX_NAME_SIZE + 1];
+	size_t num_lines;
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	struct recording_block *blocks;
+	size_t num_blocks;
+	uint64_t num_events;
+	struct recording_cursor cursor;
+	struct gpio_v2_line_event *scratch;
+	size_t scratch_size;
+};
+
+static void put_le32(uint8_t *buf, uint32_t val)
+{
+	val = htole32(val);
+	memcpy(buf, &val, sizeof(val));
+}
+
+static void put_le64(uint8_t *buf, uint64_t val)
+{
+	val = htole64(val);
+	memcpy(buf, &val, sizeof(val));
+}
+
+static uint32_t get_le32(const uint8_t *buf)
+{
+	uint32_t val;
+
+	memcpy(&val, buf, sizeof(val));
+
+	return le32toh(val);
+}
+
+static uint64_t get_le64(const uint8_t *buf)
+{
+	uint64_t val;
+
+	memcpy(&val, buf, sizeof(val));
+
+	return le64toh(val);
+}
+
+static size_t put_varint(uint8_t *buf, uint64_t val)
+{
+	size_t len = 0;
+
+	while (val >= 0x80) {
+		buf[len++] = (val & 0x7f) | 0x80;
+		val >>= 7;
+	}
+
+	buf[len++] = val;
+
+	return len;
+}
+
+static bool get_varint(const uint8_t *buf, size_t size, size_t *pos,
+		       uint64_t *val)
+{
+	unsigned int shift = 0;
+	uint64_t res = 0;
+	uint8_t byte;
+
+	do {
+		if (*pos >= size || shift > 63)
+			return false;
+
+		byte = buf[(*pos)++];
+		res |= (uint64_t)(byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	*val = res;
+
+	return true;
+}
+
+static uint64_t zigzag_encode(uint64_t delta)
+{
+	return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+}
+
+static uint64_t zigzag_decode(uint64_t val)
+{
+	return (val >> 1) ^ (uint64_t)-(int64_t)(val & 1);
+}
+
+/*
+ * The number of bytes that made it to the file is stored in written even on
+ * failure, the recorder's position must follow the file and not what it meant
+ * to write.
+ */
+static int write_all(int fd, struct iovec *iov, int iovcnt, size_t *written)
+{
+	ssize_t wr;
+
+	*written = 0;
+
+	while (iovcnt) {
+		wr = writev(fd, iov, iovcnt);
+		if (wr < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return -1;
+		}
+
+		*written += wr;
+
+		while (iovcnt && (size_t)wr >= iov->iov_len) {
+			wr -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+
+		if (iovcnt) {
+			iov->iov_base = (uint8_t *)iov->iov_base + wr;
+			iov->iov_len -= wr;
+		}
+	}
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_event_recorder *
+gpiod_event_recorder_new(int fd, const char *chip_name,
+			 const unsigned int *offsets, size_t num_offsets)
+{
+	uint8_t header[RECORDING_HEADER_SIZE + 4 * GPIO_V2_LINES_MAX];
+	struct gpiod_event_recorder *recorder;
+	size_t i, size, written;
+	struct iovec iov;
+	int ret;
+
+	if (fd < 0 || !chip_name || !offsets || !num_offsets ||
+	    num_offsets > GPIO_V2_LINES_MAX) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	recorder = malloc(sizeof(*recorder));
+	if (!recorder)
+		return NULL;
+
+	memset(recorder, 0, sizeof(*recorder));
+
+	recorder->payload = malloc(RECORDING_BLOCK_EVENTS *
+				   RECORDING_MAX_EVENT_SIZE);
+	if (!recorder->payload)
+		goto err_free;
+
+	recorder->fd = fd;
+	recorder->num_lines = num_offsets;
+	memcpy(recorder->offsets, offsets, num_offsets * sizeof(*offsets));
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, RECORDING_MAGIC, 8);
+	put_le32(header + 8, RECORDING_VERSION);
+	put_le32(header + 12, num_offsets);
+	strncpy((char *)header + 16, chip_name, GPIO_MAX_NAME_SIZE - 1);
+	for (i = 0; i < num_offsets; i++)
+		put_le32(header + RECORDING_HEADER_SIZE + 4 * i, offsets[i]);
+
+	size = RECORDING_HEADER_SIZE + 4 * num_offsets;
+	iov.iov_base = header;
+	iov.iov_len = size;
+
+	ret = write_all(fd, &iov, 1, &written);
+	if (ret)
+		goto err_free;
+
+	recorder->pos = size;
+
+	return recorder;
+
+err_free:
+	free(recorder->payload);
+	free(recorder);
+	return NULL;
+}
+
+GPIOD_API void gpiod_event_recorder_free(struct gpiod_event_recorder *recorder)
+{
+	if (!recorder)
+		return;
+
+	free(recorder->payload);
+	free(recorder->index);
+	free(recorder);
+}
+
+static int recorder_add_index_entry(struct gpiod_event_recorder *recorder)
+{
+	struct recording_index_entry *index, *entry;
+	size_t max;
+
+	if (recorder->num_blocks == recorder->max_blocks) {
+		max = recorder->max_blocks ? recorder->max_blocks * 2 : 64;
+		index = realloc(recorder->index, max * sizeof(*index));
+		if (!index)
+			return -1;
+
+		recorder->index = index;
+		recorder->max_blocks = max;
+	}
+
+	entry = &recorder->index[recorder->num_blocks++];
+	entry->offset = recorder->pos;
+	entry->first_timestamp = recorder->block_timestamp;
+	entry->first_index = recorder->num_events - recorder->block_events;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_event_recorder_flush(struct gpiod_event_recorder *recorder)
+{
+	uint8_t header[RECORDING_BLOCK_HEADER_SIZE];
+	struct iovec iov[2];
+	size_t written;
+	int ret;
+
+	assert(recorder);
+
+	if (!recorder->block_events)
+		return 0;
+
+	ret = recorder_add_index_entry(recorder);
+	if (ret)
+		return -1;
+
+	memcpy(header, RECORDING_BLOCK_MAGIC, 4);
+	put_le32(header + 4, recorder->block_events);
+	put_le32(header + 8, recorder->payload_size);
+	put_le32(header + 12, 0);
+	put_le64(header + 16, recorder->block_timestamp);
+	put_le64(header + 24, recorder->block_seqno);
+
+	iov[0].iov_base = header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = recorder->payload;
+	iov[1].iov_len = recorder->payload_size;
+
+	/*
+	 * A partially written block stays in the file. It's not indexed and
+	 * the retried block is written after it.
+	 */
+	ret = write_all(recorder->fd, iov, 2, &written);
+	recorder->pos += written;
+	if (ret) {
+		recorder->num_blocks--;
+		return -1;
+	}
+
+	recorder->payload_size = 0;
+	recorder->block_events = 0;
+
+	return 0;
+}
+
+static int recorder_line_index(struct gpiod_event_recorder *recorder,
+			       unsigned int offset)
+{
+	size_t i;
+
+	for (i = 0; i < recorder->num_lines; i++) {
+		if (recorder->offsets[i] == offset)
+			return i;
+	}
+
+	return -1;
+}
+
+GPIOD_API int gpiod_event_recorder_write(struct gpiod_event_recorder *recorder,
+					 struct gpiod_edge_event_buffer *buffer)
+{
+	uint64_t timestamp, seqno, line_seqno;
+	struct gpiod_edge_event *event;
+	size_t num_events, i;
+	uint8_t *payload;
+	int idx, ret;
+
+	assert(recorder);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (recorder->finished) {
+		errno = EPIPE;
+		return -1;
+	}
+
+	num_events = gpiod_edge_event_buffer_get_num_events(buffer);
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		timestamp = gpiod_edge_event_get_timestamp_ns(event);
+		seqno = gpiod_edge_event_get_global_seqno(event);
+		line_seqno = gpiod_edge_event_get_line_seqno(event);
+
+		idx = recorder_line_index(recorder,
+					gpiod_edge_event_get_line_offset(event));
+		if (idx < 0) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		if (!recorder->block_events) {
+			recorder->block_timestamp = timestamp;
+			recorder->block_seqno = seqno;
+			recorder->prev_timestamp = timestamp;
+			recorder->prev_seqno = seqno - 1;
+			memset(recorder->prev_line_seqno, 0,
+			       sizeof(recorder->prev_line_seqno));
+		}
+
+		payload = recorder->payload + recorder->payload_size;
+		payload += put_varint(payload, (idx << 1) |
+			(gpiod_edge_event_get_event_type(event) ==
+					GPIOD_EDGE_EVENT_FALLING_EDGE));
+		payload += put_varint(payload, zigzag_encode(
+				timestamp - recorder->prev_timestamp));
+		payload += put_varint(payload, zigzag_encode(
+				seqno - recorder->prev_seqno - 1));
+		payload += put_varint(payload, zigzag_encode(
+				line_seqno - recorder->prev_line_seqno[idx] - 1));
+
+		recorder->payload_size = payload - recorder->payload;
+		recorder->prev_timestamp = timestamp;
+		recorder->prev_seqno = seqno;
+		recorder->prev_line_seqno[idx] = line_seqno;
+		recorder->block_events++;
+		recorder->num_events++;
+
+		if (recorder->block_events == RECORDING_BLOCK_EVENTS) {
+			ret = gpiod_event_recorder_flush(recorder);
+			if (ret)
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+GPIOD_API int gpiod_event_recorder_finish(struct gpiod_event_recorder *recorder)
+{
+	uint8_t trailer[RECORDING_TRAILER_SIZE], *index;
+	struct recording_index_entry *entry;
+	size_t i, size, written;
+	struct iovec iov[2];
+	int ret;
+
+	assert(recorder);
+
+	if (recorder->finished) {
+		errno = EPIPE;
+		return -1;
+	}
+
+	ret = gpiod_event_recorder_flush(recorder);
+	if (ret)
+		return -1;
+
+	size = recorder->num_blocks * RECORDING_INDEX_ENTRY_SIZE;
+	index = malloc(size ?: 1);
+	if (!index)
+		return -1;
+
+	for (i = 0; i < recorder->num_blocks; i++) {
+		entry = &recorder->index[i];
+		put_le64(index + i * RECORDING_INDEX_ENTRY_SIZE,
+			 entry->offset);
+		put_le64(index + i * RECORDING_INDEX_ENTRY_SIZE + 8,
+			 entry->first_timestamp);
+		put_le64(index + i * RECORDING_INDEX_ENTRY_SIZE + 16,
+			 entry->first_index);
+	}
+
+	memcpy(trailer, RECORDING_INDEX_MAGIC, 8);
+	put_le64(trailer + 8, recorder->pos);
+	put_le64(trailer + 16, recorder->num_blocks);
+
+	iov[0].iov_base = index;
+	iov[0].iov_len = size;
+	iov[1].iov_base = trailer;
+	iov[1].iov_len = sizeof(trailer);
+
+	ret = write_all(recorder->fd, iov, 2, &written);
+	free(index);
+	recorder->pos += written;
+	if (ret)
+		return -1;
+
+	recorder->finished = true;
+
+	return 0;
+}
+
+static void recording_cursor_reset(struct gpiod_event_recording *recording,
+				   size_t block)
+{
+	struct recording_cursor *cursor = &recording->cursor;
+
+	memset(cursor, 0, sizeof(*cursor));
+	cursor->block = block;
+	cursor->index = recording->blocks[block].first_index;
+	cursor->prev_timestamp = recording->blocks[block].first_timestamp;
+	cursor->prev_seqno = recording->blocks[block].first_seqno - 1;
+}
+
+static bool recording_add_block(struct gpiod_event_recording *recording,
+				uint64_t offset, size_t *max_blocks)
+{
+	struct recording_block *blocks, *block;
+	const uint8_t *hdr;
+	uint32_t payload_size;
+
+	if (offset > recording->size ||
+	    recording->size - offset < RECORDING_BLOCK_HEADER_SIZE)
+		return false;
+
+	hdr = recording->data + offset;
+	if (memcmp(hdr, RECORDING_BLOCK_MAGIC, 4) != 0)
+		return false;
+
+	payload_size = get_le32(hdr + 8);
+	if (recording->size - offset - RECORDING_BLOCK_HEADER_SIZE <
+	    payload_size)
+		return false;
+
+	if (recording->num_blocks == *max_blocks) {
+		*max_blocks = *max_blocks ? *max_blocks * 2 : 64;
+		blocks = realloc(recording->blocks,
+				 *max_blocks * sizeof(*blocks));
+		if (!blocks)
+			return false;
+
+		recording->blocks = blocks;
+	}
+
+	block = &recording->blocks[recording->num_blocks++];
+	block->payload = hdr + RECORDING_BLOCK_HEADER_SIZE;
+	block->payload_size = payload_size;
+	block->num_events = get_le32(hdr + 4);
+	block->first_timestamp = get_le64(hdr + 16);
+	block->first_seqno = get_le64(hdr + 24);
+	block->first_index = recording->num_events;
+	recording->num_events += block->num_events;
+
+	return true;
+}
+
+static int recording_load_blocks(struct gpiod_event_recording *recording,
+				 size_t data_start)
+{
+	const uint8_t *trailer;
+	uint64_t index_offset, num_blocks, i, offset;
+	size_t max_blocks = 0;
+
+	if (recording->size - data_start >= RECORDING_TRAILER_SIZE) {
+		trailer = recording->data + recording->size -
+			  RECORDING_TRAILER_SIZE;
+		index_offset = get_le64(trailer + 8);
+		num_blocks = get_le64(trailer + 16);
+
+		if (memcmp(trailer, RECORDING_INDEX_MAGIC, 8) == 0 &&
+		    index_offset >= data_start &&
+		    num_blocks <= (recording->size - index_offset) /
+						RECORDING_INDEX_ENTRY_SIZE &&
+		    index_offset + num_blocks * RECORDING_INDEX_ENTRY_SIZE +
+			RECORDING_TRAILER_SIZE == recording->size) {
+			for (i = 0; i < num_blocks; i++) {
+				offset = get_le64(recording->data +
+						  index_offset +
+						  i * RECORDING_INDEX_ENTRY_SIZE);
+				if (!recording_add_block(recording, offset,
+							 &max_blocks)) {
+					errno = EIO;
+					return -1;
+				}
+			}
+
+			return 0;
+		}
+	}
+
+	/* No index - the recording was not finished, walk the blocks. */
+	offset = data_start;
+	while (recording_add_block(recording, offset, &max_blocks)) {
+		offset += RECORDING_BLOCK_HEADER_SIZE +
+			  recording->blocks[recording->num_blocks - 1].payload_size;
+	}
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_event_recording *
+gpiod_event_recording_open(const char *path)
+{
+	struct gpiod_event_recording *recording;
+	size_t i, data_start;
+	struct stat st;
+	void *data;
+	int fd, ret;
+
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	recording = malloc(sizeof(*recording));
+	if (!recording)
+		return NULL;
+
+	memset(recording, 0, sizeof(*recording));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		goto err_free;
+
+	ret = fstat(fd, &st);
+	if (ret)
+		goto err_close;
+
+	if (st.st_size < RECORDING_HEADER_SIZE) {
+		errno = EIO;
+		goto err_close;
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		goto err_close;
+
+	close(fd);
+	recording->data = data;
+	recording->size = st.st_size;
+
+	if (memcmp(recording->data, RECORDING_MAGIC, 8) != 0 ||
+	    get_le32(recording->data + 8) != RECORDING_VERSION) {
+		errno = EIO;
+		goto err_unmap;
+	}
+
+	recording->num_lines = get_le32(recording->data + 12);
+	data_start = RECORDING_HEADER_SIZE + 4 * recording->num_lines;
+	if (!recording->num_lines ||
+	    recording->num_lines > GPIO_V2_LINES_MAX ||
+	    recording->size < data_start) {
+		errno = EIO;
+		goto err_unmap;
+	}
+
+	memcpy(recording->chip_name, recording->data + 16, GPIO_MAX_NAME_SIZE);
+	for (i = 0; i < recording->num_lines; i++)
+		recording->offsets[i] = get_le32(recording->data +
+						 RECORDING_HEADER_SIZE + 4 * i);
+
+	ret = recording_load_blocks(recording, data_start);
+	if (ret)
+		goto err_unmap;
+
+	if (recording->num_blocks)
+		recording_cursor_reset(recording, 0);
+
+	return recording;
+
+err_close:
+	close(fd);
+	goto err_free;
+err_unmap:
+	munmap((void *)recording->data, recording->size);
+err_free:
+	free(recording->blocks);
+	free(recording);
+	return NULL;
+}
+
+GPIOD_API void
+gpiod_event_recording_close(struct gpiod_event_recording *recording)
+{
+	if (!recording)
+		return;
+
+	munmap((void *)recording->data, recording->size);
+	free(recording->blocks);
+	free(recording->scratch);
+	free(recording);
+}
+
+GPIOD_API const char *
+gpiod_event_recording_get_chip_name(struct gpiod_event_recording *recording)
+{
+	assert(recording);
+
+	return recording->chip_name;
+}
+
+GPIOD_API size_t
+gpiod_event_recording_get_num_lines(struct gpiod_event_recording *recording)
+{
+	assert(recording);
+
+	return recording->num_lines;
+}
+
+GPIOD_API size_t
+gpiod_event_recording_get_line_offsets(struct gpiod_event_recording *recording,
+				       unsigned int *offsets,
+				       size_t max_offsets)
+{
+	size_t num;
+
+	assert(recording);
+
+	if (!offsets)
+		return 0;
+
+	num = max_offsets < recording->num_lines ? max_offsets :
+						   recording->num_lines;
+	memcpy(offsets, recording->offsets, num * sizeof(*offsets));
+
+	return num;
+}
+
+GPIOD_API uint64_t
+gpiod_event_recording_get_num_events(struct gpiod_event_recording *recording)
+{
+	assert(recording);
+
+	return recording->num_events;
+}
+
+static size_t recording_find_block(struct gpiod_event_recording *recording,
+				   uint64_t index)
+{
+	size_t lo = 0, hi = recording->num_blocks, mid;
+
+	/* Last block whose first event is not after the index. */
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (recording->blocks[mid].first_index <= index)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static int recording_decode_next(struct gpiod_event_recording *recording,
+				 struct gpio_v2_line_event *event)
+{
+	struct recording_cursor *cursor = &recording->cursor;
+	uint64_t tag, ts_delta, seqno_delta, line_seqno_delta;
+	struct recording_block *block;
+	size_t idx;
+
+	while (cursor->event == recording->blocks[cursor->block].num_events) {
+		if (cursor->block + 1 == recording->num_blocks) {
+			errno = EIO;
+			return -1;
+		}
+
+		recording_cursor_reset(recording, cursor->block + 1);
+	}
+
+	block = &recording->blocks[cursor->block];
+
+	if (!get_varint(block->payload, block->payload_size, &cursor->pos,
+			&tag) ||
+	    !get_varint(block->payload, block->payload_size, &cursor->pos,
+			&ts_delta) ||
+	    !get_varint(block->payload, block->payload_size, &cursor->pos,
+			&seqno_delta) ||
+	    !get_varint(block->payload, block->payload_size, &cursor->pos,
+			&line_seqno_delta)) {
+		errno = EIO;
+		return -1;
+	}
+
+	idx = tag >> 1;
+	if (idx >= recording->num_lines) {
+		errno = EIO;
+		return -1;
+	}
+
+	cursor->prev_timestamp += zigzag_decode(ts_delta);
+	cursor->prev_seqno += zigzag_decode(seqno_delta) + 1;
+	cursor->prev_line_seqno[idx] += zigzag_decode(line_seqno_delta) + 1;
+	cursor->event++;
+	cursor->index++;
+
+	if (event) {
+		memset(event, 0, sizeof(*event));
+		event->timestamp_ns = cursor->prev_timestamp;
+		event->id = (tag & 1) ? GPIO_V2_LINE_EVENT_FALLING_EDGE :
+					GPIO_V2_LINE_EVENT_RISING_EDGE;
+		event->offset = recording->offsets[idx];
+		event->seqno = cursor->prev_seqno;
+		event->line_seqno = cursor->prev_line_seqno[idx];
+	}
+
+	return 0;
+}
+
+static int recording_seek(struct gpiod_event_recording *recording,
+			  uint64_t index)
+{
+	struct recording_cursor *cursor = &recording->cursor;
+	size_t block;
+	int ret;
+
+	if (cursor->index == index)
+		return 0;
+
+	block = recording_find_block(recording, index);
+	if (cursor->block != block || cursor->index > index)
+		recording_cursor_reset(recording, block);
+
+	while (cursor->index < index) {
+		ret = recording_decode_next(recording, NULL);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_event_recording_read_events(struct gpiod_event_recording *recording,
+				  uint64_t index,
+				  struct gpiod_edge_event_buffer *buffer,
+				  size_t max_events)
+{
+	struct gpio_v2_line_event *scratch;
+	size_t num, i;
+	int ret;
+
+	assert(recording);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (index >= recording->num_events)
+		return 0;
+
+	num = gpiod_edge_event_buffer_get_capacity(buffer);
+	if (max_events < num)
+		num = max_events;
+	if (recording->num_events - index < num)
+		num = recording->num_events - index;
+
+	if (num > recording->scratch_size) {
+		scratch = realloc(recording->scratch, num * sizeof(*scratch));
+		if (!scratch)
+			return -1;
+
+		recording->scratch = scratch;
+		recording->scratch_size = num;
+	}
+
+	ret = recording_seek(recording, index);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < num; i++) {
+		ret = recording_decode_next(recording, &recording->scratch[i]);
+		if (ret)
+			return -1;
+	}
+
+	return gpiod_edge_event_buffer_from_uapi(buffer, recording->scratch,
+						 num);
+}
+
+GPIOD_API uint64_t
+gpiod_event_recording_find_timestamp(struct gpiod_event_recording *recording,
+				     uint64_t timestamp_ns)
+{
+	size_t lo = 0, hi, mid;
+	uint64_t index;
+
+	assert(recording);
+
+	if (!recording->num_blocks)
+		return 0;
+
+	/* Last block starting at or before the timestamp. */
+	hi = recording->num_blocks;
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (recording->blocks[mid].first_timestamp <= timestamp_ns)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	recording_cursor_reset(recording, lo);
+
+	for (index = recording->blocks[lo].first_index;
+	     index < recording->num_events; index++) {
+		if (recording_decode_next(recording, NULL))
+			break;
+
+		if (recording->cursor.prev_timestamp >= timestamp_ns)
+			return index;
+	}
+
+	return recording->num_events;
+}
@@ -86,14 +86,15 @@ gpiod_info_event_get_line_info(struct gpiod_info_event *event)
 	return event->info;
 }
 
-struct gpiod_info_event *gpiod_info_event_read_fd(int fd)
+struct gpiod_info_event *
+gpiod_info_event_read_fd(const struct gpiod_backend *backend, int fd)
 {
 	struct gpio_v2_line_info_changed uapi_evt;
 	ssize_t rd;
 
 	memset(&uapi_evt, 0, sizeof(uapi_evt));
 
-	rd = read(fd, &uapi_evt, sizeof(uapi_evt));
+	rd = backend->read(fd, &uapi_evt, sizeof(uapi_evt));
 	if (rd < 0) {
 		return NULL;
 	} else if ((unsigned int)rd < sizeof(uapi_evt)) {
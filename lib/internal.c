@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -11,6 +12,7 @@
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "internal.h"
@@ -82,7 +84,22 @@ out:
 	return ret;
 }
 
-int gpiod_poll_fd(int fd, int64_t timeout_ns)
+static int kernel_open(const char *path)
+{
+	return open(path, O_RDWR | O_CLOEXEC);
+}
+
+static void kernel_close(int fd)
+{
+	close(fd);
+}
+
+static int kernel_ioctl(int fd, unsigned long request, void *arg)
+{
+	return ioctl(fd, request, arg);
+}
+
+static int kernel_poll(int fd, int64_t timeout_ns)
 {
 	struct timespec ts;
 	struct pollfd pfd;
@@ -106,6 +123,49 @@ int gpiod_poll_fd(int fd, int64_t timeout_ns)
 	return 1;
 }
 
+static int kernel_set_nonblocking(int fd, bool nonblocking)
+{
+	int flags;
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags < 0)
+		return -1;
+
+	if (nonblocking)
+		flags |= O_NONBLOCK;
+	else
+		flags &= ~O_NONBLOCK;
+
+	return fcntl(fd, F_SETFL, flags);
+}
+
+const struct gpiod_backend gpiod_kernel_backend = {
+	.is_chip_device = gpiod_check_gpiochip_device,
+	.open = kernel_open,
+	.close = kernel_close,
+	.ioctl = kernel_ioctl,
+	.read = read,
+	.poll = kernel_poll,
+	.set_nonblocking = kernel_set_nonblocking,
+};
+
+const struct gpiod_backend *
+gpiod_backend_for_path(const char *path GPIOD_UNUSED)
+{
+#ifdef GPIOD_MOCK_BACKEND
+	if (gpiod_mock_owns_path(path))
+		return &gpiod_mock_backend;
+#endif
+
+	return &gpiod_kernel_backend;
+}
+
+int gpiod_poll_fd(const struct gpiod_backend *backend, int fd,
+		  int64_t timeout_ns)
+{
+	return backend->poll(fd, timeout_ns);
+}
+
 int gpiod_set_output_value(enum gpiod_line_value in, enum gpiod_line_value *out)
 {
 	switch (in) {
@@ -122,11 +182,12 @@ int gpiod_set_output_value(enum gpiod_line_value in, enum gpiod_line_value *out)
 	return 0;
 }
 
-int gpiod_ioctl(int fd, unsigned long request, void *arg)
+int gpiod_ioctl(const struct gpiod_backend *backend, int fd,
+		unsigned long request, void *arg)
 {
 	int ret;
 
-	ret = ioctl(fd, request, arg);
+	ret = backend->ioctl(fd, request, arg);
 	if (ret <= 0)
 		return ret;
 
@@ -134,6 +195,15 @@ int gpiod_ioctl(int fd, unsigned long request, void *arg)
 	return -1;
 }
 
+uint64_t gpiod_clock_get_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 void gpiod_line_mask_zero(uint64_t *mask)
 {
 	*mask = 0ULL;
@@ -7,6 +7,8 @@
 #include <gpiod.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
 
 #include "uapi/gpio.h"
 
@@ -14,31 +16,88 @@
 
 #define GPIOD_API	__attribute__((visibility("default")))
 #define GPIOD_BIT(nr)	(1UL << (nr))
+#define GPIOD_UNUSED	__attribute__((unused))
+
+/*
+ * I/O backend. All accesses to the GPIO character devices go through one of
+ * these. The kernel backend is the default, other backends may claim paths
+ * (and the file descriptors opened from them) for themselves.
+ */
+struct gpiod_backend {
+	bool (*is_chip_device)(const char *path, bool set_errno);
+	int (*open)(const char *path);
+	void (*close)(int fd);
+	int (*ioctl)(int fd, unsigned long request, void *arg);
+	ssize_t (*read)(int fd, void *buf, size_t count);
+	int (*poll)(int fd, int64_t timeout_ns);
+	int (*set_nonblocking)(int fd, bool nonblocking);
+};
+
+extern const struct gpiod_backend gpiod_kernel_backend;
+#ifdef GPIOD_MOCK_BACKEND
+extern const struct gpiod_backend gpiod_mock_backend;
+bool gpiod_mock_owns_path(const char *path);
+#endif
+
+const struct gpiod_backend *gpiod_backend_for_path(const char *path);
 
 bool gpiod_check_gpiochip_device(const char *path, bool set_errno);
 
+bool gpiod_chip_registry_is_active(void);
+bool gpiod_chip_registry_lookup(const char *path, dev_t *devt);
+void gpiod_chip_registry_add(const char *path, dev_t devt);
+bool gpiod_chip_registry_get_info(dev_t devt, struct gpiochip_info *info);
+void gpiod_chip_registry_set_info(dev_t devt,
+				  const struct gpiochip_info *info);
+
 struct gpiod_chip_info *
 gpiod_chip_info_from_uapi(struct gpiochip_info *uapi_info);
 struct gpiod_line_info *
 gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info);
+bool gpiod_line_info_update_from_uapi(struct gpiod_line_info *info,
+				      struct gpio_v2_line_info *uapi_info);
 void gpiod_request_config_to_uapi(struct gpiod_request_config *config,
 				  struct gpio_v2_line_request *uapi_req);
 int gpiod_line_config_to_uapi(struct gpiod_line_config *config,
 			      struct gpio_v2_line_request *uapi_cfg);
 struct gpiod_line_request *
 gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req,
-			     const char *chip_name);
-int gpiod_edge_event_buffer_read_fd(int fd,
+			     const char *chip_name,
+			     const struct gpiod_backend *backend);
+const struct gpiod_backend *
+gpiod_chip_get_backend(struct gpiod_chip *chip);
+const struct gpiod_backend *
+gpiod_line_request_get_backend(struct gpiod_line_request *request);
+size_t gpiod_edge_event_buffer_from_uapi(struct gpiod_edge_event_buffer *buffer,
+					 const struct gpio_v2_line_event *data,
+					 size_t num_events);
+int gpiod_edge_event_buffer_reserve(struct gpiod_edge_event_buffer *buffer,
+				    size_t capacity);
+int gpiod_edge_event_buffer_drain_fd(const struct gpiod_backend *backend,
+				     int fd,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events);
+int gpiod_edge_event_buffer_read_fd_busy(const struct gpiod_backend *backend,
+					 int fd,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events, int64_t spin_ns,
+					 int64_t timeout_ns, bool *spun);
+int gpiod_edge_event_buffer_read_fd(const struct gpiod_backend *backend,
+				    int fd,
 				    struct gpiod_edge_event_buffer *buffer,
 				    size_t max_events);
 struct gpiod_info_event *
 gpiod_info_event_from_uapi(struct gpio_v2_line_info_changed *uapi_evt);
-struct gpiod_info_event *gpiod_info_event_read_fd(int fd);
+struct gpiod_info_event *
+gpiod_info_event_read_fd(const struct gpiod_backend *backend, int fd);
 
-int gpiod_poll_fd(int fd, int64_t timeout);
+int gpiod_poll_fd(const struct gpiod_backend *backend, int fd,
+		  int64_t timeout);
 int gpiod_set_output_value(enum gpiod_line_value in,
 			   enum gpiod_line_value *out);
-int gpiod_ioctl(int fd, unsigned long request, void *arg);
+int gpiod_ioctl(const struct gpiod_backend *backend, int fd,
+		unsigned long request, void *arg);
+uint64_t gpiod_clock_get_ns(clockid_t clock);
 
 void gpiod_line_mask_zero(uint64_t *mask);
 bool gpiod_line_mask_test_bit(const uint64_t *mask, int nr);
@@ -134,17 +134,12 @@ gpiod_line_info_get_debounce_period_us(struct gpiod_line_info *info)
 	return info->debounce_period_us;
 }
 
-struct gpiod_line_info *
-gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info)
+static void line_info_fill_from_uapi(struct gpiod_line_info *info,
+				     struct gpio_v2_line_info *uapi_info)
 {
 	struct gpio_v2_line_attribute *attr;
-	struct gpiod_line_info *info;
 	size_t i;
 
-	info = malloc(sizeof(*info));
-	if (!info)
-		return NULL;
-
 	memset(info, 0, sizeof(*info));
 
 	info->offset = uapi_info->offset;
@@ -206,6 +201,34 @@ gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info)
 			info->debounce_period_us = attr->debounce_period_us;
 		}
 	}
+}
+
+struct gpiod_line_info *
+gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info)
+{
+	struct gpiod_line_info *info;
+
+	info = malloc(sizeof(*info));
+	if (!info)
+		return NULL;
+
+	line_info_fill_from_uapi(info, uapi_info);
 
 	return info;
 }
+
+bool gpiod_line_info_update_from_uapi(struct gpiod_line_info *info,
+				      struct gpio_v2_line_info *uapi_info)
+{
+	struct gpiod_line_info new;
+
+	line_info_fill_from_uapi(&new, uapi_info);
+
+	/* Both structures are zeroed before being filled, padding included. */
+	if (memcmp(info, &new, sizeof(new)) == 0)
+		return false;
+
+	memcpy(info, &new, sizeof(new));
+
+	return true;
+}
@@ -7,20 +7,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
-#include <unistd.h>
 
 #include "internal.h"
 
 struct gpiod_line_request {
+	const struct gpiod_backend *backend;
 	char *chip_name;
 	unsigned int offsets[GPIO_V2_LINES_MAX];
 	size_t num_lines;
 	int fd;
+	bool nonblocking;
 };
 
 struct gpiod_line_request *
 gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req,
-			     const char *chip_name)
+			     const char *chip_name,
+			     const struct gpiod_backend *backend)
 {
 	struct gpiod_line_request *request;
 
@@ -36,6 +38,7 @@ gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req,
 		return NULL;
 	}
 
+	request->backend = backend;
 	request->fd = uapi_req->fd;
 	request->num_lines = uapi_req->num_lines;
 	memcpy(request->offsets, uapi_req->offsets,
@@ -49,7 +52,7 @@ GPIOD_API void gpiod_line_request_release(struct gpiod_line_request *request)
 	if (!request)
 		return;
 
-	close(request->fd);
+	request->backend->close(request->fd);
 	free(request->chip_name);
 	free(request);
 }
@@ -152,8 +155,8 @@ gpiod_line_request_get_values_subset(struct gpiod_line_request *request,
 
 	uapi_values.mask = mask;
 
-	ret = gpiod_ioctl(request->fd, GPIO_V2_LINE_GET_VALUES_IOCTL,
-			  &uapi_values);
+	ret = gpiod_ioctl(request->backend, request->fd,
+			  GPIO_V2_LINE_GET_VALUES_IOCTL, &uapi_values);
 	if (ret)
 		return -1;
 
@@ -218,8 +221,8 @@ gpiod_line_request_set_values_subset(struct gpiod_line_request *request,
 	uapi_values.mask = mask;
 	uapi_values.bits = bits;
 
-	return gpiod_ioctl(request->fd, GPIO_V2_LINE_SET_VALUES_IOCTL,
-			   &uapi_values);
+	return gpiod_ioctl(request->backend, request->fd,
+			   GPIO_V2_LINE_SET_VALUES_IOCTL, &uapi_values);
 }
 
 GPIOD_API int gpiod_line_request_set_values(struct gpiod_line_request *request,
@@ -272,8 +275,8 @@ gpiod_line_request_reconfigure_lines(struct gpiod_line_request *request,
 		return -1;
 	}
 
-	ret = gpiod_ioctl(request->fd, GPIO_V2_LINE_SET_CONFIG_IOCTL,
-			  &uapi_cfg.config);
+	ret = gpiod_ioctl(request->backend, request->fd,
+			  GPIO_V2_LINE_SET_CONFIG_IOCTL, &uapi_cfg.config);
 	if (ret)
 		return ret;
 
@@ -287,13 +290,19 @@ GPIOD_API int gpiod_line_request_get_fd(struct gpiod_line_request *request)
 	return request->fd;
 }
 
+const struct gpiod_backend *
+gpiod_line_request_get_backend(struct gpiod_line_request *request)
+{
+	return request->backend;
+}
+
 GPIOD_API int
 gpiod_line_request_wait_edge_events(struct gpiod_line_request *request,
 				    int64_t timeout_ns)
 {
 	assert(request);
 
-	return gpiod_poll_fd(request->fd, timeout_ns);
+	return gpiod_poll_fd(request->backend, request->fd, timeout_ns);
 }
 
 GPIOD_API int
@@ -303,5 +312,66 @@ gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
 {
 	assert(request);
 
-	return gpiod_edge_event_buffer_read_fd(request->fd, buffer, max_events);
+	return gpiod_edge_event_buffer_read_fd(request->backend, request->fd,
+					       buffer, max_events);
+}
+
+GPIOD_API int
+gpiod_line_request_set_nonblocking(struct gpiod_line_request *request,
+				   bool nonblocking)
+{
+	int ret;
+
+	assert(request);
+
+	ret = request->backend->set_nonblocking(request->fd, nonblocking);
+	if (ret)
+		return -1;
+
+	request->nonblocking = nonblocking;
+
+	return 0;
+}
+
+GPIOD_API bool
+gpiod_line_request_is_nonblocking(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->nonblocking;
+}
+
+GPIOD_API int
+gpiod_line_request_drain_edge_events(struct gpiod_line_request *request,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events)
+{
+	assert(request);
+
+	if (!request->nonblocking) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return gpiod_edge_event_buffer_drain_fd(request->backend, request->fd,
+						buffer, max_events);
+}
+
+GPIOD_API int
+gpiod_line_request_read_edge_events_busy(struct gpiod_line_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events, int64_t spin_ns,
+					 int64_t timeout_ns, bool *spun)
+{
+	assert(request);
+
+	if (!request->nonblocking) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return gpiod_edge_event_buffer_read_fd_busy(request->backend,
+						    request->fd, buffer,
+						    max_events, spin_ns,
+						    timeout_ns, spun);
 }
@@ -0,0 +1,685 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define RESOLVER_CACHE_MAGIC	"GPIODLRC"
+#define RESOLVER_CACHE_VERSION	1
+#define RESOLVER_MAX_THREADS	8
+
+struct resolver_chip {
+	char *path;
+	char label[GPIO_MAX_NAME_SIZE];
+	uint64_t ctime_ns;
+	unsigned int num_lines;
+	char (*names)[GPIO_MAX_NAME_SIZE];
+	/* Line names were taken from the cache file. */
+	bool cached;
+	int error;
+};
+
+struct resolver_entry {
+	const char *name;
+	unsigned int chip;
+	unsigned int offset;
+	struct resolver_entry *next;
+};
+
+struct gpiod_line_resolver {
+	struct resolver_chip *chips;
+	size_t num_chips;
+	struct resolver_entry *entries;
+	struct resolver_entry **buckets;
+	size_t num_buckets;
+};
+
+struct resolver_cache {
+	char *data;
+	size_t size;
+	struct resolver_cache_chip {
+		const char *path;
+		const char *label;
+		uint64_t ctime_ns;
+		unsigned int num_lines;
+		const char *names;
+	} *chips;
+	size_t num_chips;
+};
+
+struct resolver_scan {
+	struct gpiod_line_resolver *resolver;
+	struct resolver_cache *cache;
+	size_t next;
+};
+
+static int chip_dir_filter(const struct dirent *entry)
+{
+	struct stat sb;
+	char path[sizeof("/dev/") + sizeof(entry->d_name)];
+
+	if (strncmp(entry->d_name, "gpiochip", 8) != 0)
+		return 0;
+
+	snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
+
+	return lstat(path, &sb) == 0 && !S_ISLNK(sb.st_mode) &&
+	       gpiod_check_gpiochip_device(path, false);
+}
+
+static uint32_t name_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	/* FNV-1a */
+	for (; *name; name++) {
+		hash ^= (unsigned char)*name;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static bool cache_read_u32(struct resolver_cache *cache, size_t *pos,
+			   uint32_t *val)
+{
+	if (cache->size - *pos < sizeof(*val))
+		return false;
+
+	memcpy(val, cache->data + *pos, sizeof(*val));
+	*pos += sizeof(*val);
+
+	return true;
+}
+
+static bool cache_read_u64(struct resolver_cache *cache, size_t *pos,
+			   uint64_t *val)
+{
+	if (cache->size - *pos < sizeof(*val))
+		return false;
+
+	memcpy(val, cache->data + *pos, sizeof(*val));
+	*pos += sizeof(*val);
+
+	return true;
+}
+
+static const char *cache_read_str(struct resolver_cache *cache, size_t *pos,
+				  size_t len)
+{
+	const char *str;
+
+	if (cache->size - *pos < len || !len)
+		return NULL;
+
+	str = cache->data + *pos;
+	if (str[len - 1] != '\0')
+		return NULL;
+
+	*pos += len;
+
+	return str;
+}
+
+static void cache_free(struct resolver_cache *cache)
+{
+	free(cache->data);
+	free(cache->chips);
+}
+
+/*
+ * Any inconsistency in the cache file makes us treat it as absent - it will
+ * be rewritten once the chips are scanned.
+ */
+static bool cache_load(struct resolver_cache *cache, const char *path)
+{
+	struct resolver_cache_chip *chip;
+	size_t pos = 0, i;
+	uint32_t val;
+	struct stat st;
+	FILE *fp;
+
+	memset(cache, 0, sizeof(*cache));
+
+	fp = fopen(path, "re");
+	if (!fp)
+		return false;
+
+	if (fstat(fileno(fp), &st) || st.st_size < 16)
+		goto err_close;
+
+	cache->size = st.st_size;
+	cache->data = malloc(cache->size);
+	if (!cache->data)
+		goto err_close;
+
+	if (fread(cache->data, 1, cache->size, fp) != cache->size)
+		goto err_free;
+
+	fclose(fp);
+	fp = NULL;
+
+	if (memcmp(cache->data, RESOLVER_CACHE_MAGIC, 8) != 0)
+		goto err_free;
+	pos = 8;
+
+	if (!cache_read_u32(cache, &pos, &val) ||
+	    val != RESOLVER_CACHE_VERSION)
+		goto err_free;
+
+	if (!cache_read_u32(cache, &pos, &val) || val > cache->size)
+		goto err_free;
+
+	cache->num_chips = val;
+	cache->chips = calloc(cache->num_chips, sizeof(*cache->chips));
+	if (!cache->chips && cache->num_chips)
+		goto err_free;
+
+	for (i = 0; i < cache->num_chips; i++) {
+		chip = &cache->chips[i];
+
+		if (!cache_read_u32(cache, &pos, &val))
+			goto err_free;
+
+		chip->path = cache_read_str(cache, &pos, val);
+		chip->label = cache_read_str(cache, &pos, GPIO_MAX_NAME_SIZE);
+		if (!chip->path || !chip->label ||
+		    !cache_read_u64(cache, &pos, &chip->ctime_ns))
+			goto err_free;
+
+		if (!cache_read_u32(cache, &pos, &val) ||
+		    val > (cache->size - pos) / GPIO_MAX_NAME_SIZE)
+			goto err_free;
+
+		chip->num_lines = val;
+		chip->names = cache->data + pos;
+		pos += (size_t)val * GPIO_MAX_NAME_SIZE;
+	}
+
+	return true;
+
+err_free:
+	cache_free(cache);
+	memset(cache, 0, sizeof(*cache));
+err_close:
+	if (fp)
+		fclose(fp);
+	return false;
+}
+
+static void cache_store(struct gpiod_line_resolver *resolver, const char *path)
+{
+	struct resolver_chip *chip;
+	char *tmp, *dir, *sep;
+	uint32_t val;
+	bool ok = true;
+	size_t i;
+	FILE *fp;
+	int fd;
+
+	dir = strdup(path);
+	if (!dir)
+		return;
+
+	sep = strrchr(dir, '/');
+	if (sep && sep != dir) {
+		*sep = '\0';
+		mkdir(dir, 0755);
+	}
+	free(dir);
+
+	if (asprintf(&tmp, "%s.XXXXXX", path) < 0)
+		return;
+
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0)
+		goto out_free;
+
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		goto out_unlink;
+	}
+
+	fchmod(fd, 0644);
+
+	ok = fwrite(RESOLVER_CACHE_MAGIC, 8, 1, fp) == 1;
+	val = RESOLVER_CACHE_VERSION;
+	ok = ok && fwrite(&val, sizeof(val), 1, fp) == 1;
+
+	for (i = 0, val = 0; i < resolver->num_chips; i++) {
+		if (!resolver->chips[i].error)
+			val++;
+	}
+	ok = ok && fwrite(&val, sizeof(val), 1, fp) == 1;
+
+	for (i = 0; i < resolver->num_chips && ok; i++) {
+		chip = &resolver->chips[i];
+		if (chip->error)
+			continue;
+
+		val = strlen(chip->path) + 1;
+		ok = fwrite(&val, sizeof(val), 1, fp) == 1 &&
+		     fwrite(chip->path, val, 1, fp) == 1 &&
+		     fwrite(chip->label, sizeof(chip->label), 1, fp) == 1 &&
+		     fwrite(&chip->ctime_ns, sizeof(chip->ctime_ns), 1, fp) == 1;
+
+		val = chip->num_lines;
+		ok = ok && fwrite(&val, sizeof(val), 1, fp) == 1;
+		if (val)
+			ok = ok && fwrite(chip->names, GPIO_MAX_NAME_SIZE, val,
+					  fp) == val;
+	}
+
+	if (fclose(fp))
+		ok = false;
+
+	if (ok && rename(tmp, path) == 0)
+		goto out_free;
+
+out_unlink:
+	unlink(tmp);
+out_free:
+	free(tmp);
+}
+
+static const struct resolver_cache_chip *
+cache_find_chip(struct resolver_cache *cache, const char *path)
+{
+	size_t i;
+
+	if (!cache)
+		return NULL;
+
+	for (i = 0; i < cache->num_chips; i++) {
+		if (strcmp(cache->chips[i].path, path) == 0)
+			return &cache->chips[i];
+	}
+
+	return NULL;
+}
+
+static void scan_chip(struct resolver_chip *rchip,
+		      const struct resolver_cache_chip *cached)
+{
+	struct gpiod_chip_info *chip_info;
+	struct gpiod_line_info *line_info;
+	struct gpiod_chip *chip;
+	unsigned int offset;
+	const char *name;
+	struct stat st;
+
+	/*
+	 * The device node is recreated whenever the chip is re-registered,
+	 * which catches chips coming back with the same label and number of
+	 * lines but different line names.
+	 */
+	if (stat(rchip->path, &st)) {
+		rchip->error = errno;
+		return;
+	}
+
+	rchip->ctime_ns = (uint64_t)st.st_ctim.tv_sec * 1000000000ULL +
+			  st.st_ctim.tv_nsec;
+
+	chip = gpiod_chip_open(rchip->path);
+	if (!chip) {
+		rchip->error = errno;
+		return;
+	}
+
+	chip_info = gpiod_chip_get_info(chip);
+	if (!chip_info) {
+		rchip->error = errno;
+		goto out_close;
+	}
+
+	strncpy(rchip->label, gpiod_chip_info_get_label(chip_info),
+		sizeof(rchip->label) - 1);
+	rchip->num_lines = gpiod_chip_info_get_num_lines(chip_info);
+	gpiod_chip_info_free(chip_info);
+
+	rchip->names = calloc(rchip->num_lines ?: 1, sizeof(*rchip->names));
+	if (!rchip->names) {
+		rchip->error = ENOMEM;
+		goto out_close;
+	}
+
+	/* Only the line names are cached, the chip itself is always queried. */
+	if (cached && cached->num_lines == rchip->num_lines &&
+	    cached->ctime_ns == rchip->ctime_ns &&
+	    strcmp(cached->label, rchip->label) == 0) {
+		memcpy(rchip->names, cached->names,
+		       rchip->num_lines * sizeof(*rchip->names));
+		rchip->cached = true;
+		goto out_close;
+	}
+
+	for (offset = 0; offset < rchip->num_lines; offset++) {
+		line_info = gpiod_chip_get_line_info(chip, offset);
+		if (!line_info) {
+			rchip->error = errno;
+			goto out_close;
+		}
+
+		name = gpiod_line_info_get_name(line_info);
+		if (name)
+			strncpy(rchip->names[offset], name,
+				sizeof(rchip->names[offset]) - 1);
+
+		gpiod_line_info_free(line_info);
+	}
+
+out_close:
+	gpiod_chip_close(chip);
+}
+
+static void *scan_thread(void *data)
+{
+	struct resolver_scan *scan = data;
+	struct gpiod_line_resolver *resolver = scan->resolver;
+	struct resolver_chip *chip;
+	size_t i;
+
+	for (;;) {
+		i = __atomic_fetch_add(&scan->next, 1, __ATOMIC_RELAXED);
+		if (i >= resolver->num_chips)
+			break;
+
+		chip = &resolver->chips[i];
+		scan_chip(chip, cache_find_chip(scan->cache, chip->path));
+	}
+
+	return NULL;
+}
+
+static void resolver_scan(struct gpiod_line_resolver *resolver,
+			  struct resolver_cache *cache)
+{
+	pthread_t threads[RESOLVER_MAX_THREADS];
+	struct resolver_scan scan;
+	size_t num_threads, i;
+	long cpus;
+	int ret;
+
+	memset(&scan, 0, sizeof(scan));
+	scan.resolver = resolver;
+	scan.cache = cache;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	num_threads = cpus > 0 ? (size_t)cpus : 1;
+	if (num_threads > RESOLVER_MAX_THREADS)
+		num_threads = RESOLVER_MAX_THREADS;
+	if (num_threads > resolver->num_chips)
+		num_threads = resolver->num_chips;
+
+	/*
+	 * The calling thread takes part in the scan so that a single chip
+	 * doesn't require spawning anything.
+	 */
+	for (i = 1; i < num_threads; i++) {
+		ret = pthread_create(&threads[i], NULL, scan_thread, &scan);
+		if (ret)
+			break;
+	}
+
+	num_threads = i;
+	scan_thread(&scan);
+
+	for (i = 1; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+}
+
+static int resolver_build_index(struct gpiod_line_resolver *resolver)
+{
+	struct resolver_entry *entry;
+	struct resolver_chip *chip;
+	size_t num_entries = 0, i, idx;
+	unsigned int offset;
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		chip = &resolver->chips[i];
+		for (offset = 0; offset < chip->num_lines; offset++) {
+			if (chip->names[offset][0])
+				num_entries++;
+		}
+	}
+
+	for (resolver->num_buckets = 16;
+	     resolver->num_buckets < num_entries * 2;
+	     resolver->num_buckets *= 2)
+		;
+
+	resolver->buckets = calloc(resolver->num_buckets,
+				   sizeof(*resolver->buckets));
+	resolver->entries = calloc(num_entries ?: 1,
+				   sizeof(*resolver->entries));
+	if (!resolver->buckets || !resolver->entries)
+		return -1;
+
+	/*
+	 * Insert in reverse so that each bucket lists the lines in chip and
+	 * offset order and the first match is the one a serial scan would find.
+	 */
+	entry = resolver->entries;
+	for (i = resolver->num_chips; i-- > 0;) {
+		chip = &resolver->chips[i];
+		for (offset = chip->num_lines; offset-- > 0;) {
+			if (!chip->names[offset][0])
+				continue;
+
+			entry->name = chip->names[offset];
+			entry->chip = i;
+			entry->offset = offset;
+
+			idx = name_hash(entry->name) &
+			      (resolver->num_buckets - 1);
+			entry->next = resolver->buckets[idx];
+			resolver->buckets[idx] = entry;
+			entry++;
+		}
+	}
+
+	return 0;
+}
+
+/* Chips we're not allowed to open are skipped, like the tools do. */
+static int resolver_drop_inaccessible(struct gpiod_line_resolver *resolver)
+{
+	struct resolver_chip *chip;
+	size_t i, j;
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		chip = &resolver->chips[i];
+		if (chip->error && chip->error != EACCES) {
+			errno = chip->error;
+			return -1;
+		}
+	}
+
+	for (i = 0, j = 0; i < resolver->num_chips; i++) {
+		chip = &resolver->chips[i];
+		if (chip->error) {
+			free(chip->path);
+			free(chip->names);
+			continue;
+		}
+
+		resolver->chips[j++] = *chip;
+	}
+
+	resolver->num_chips = j;
+
+	return 0;
+}
+
+static bool resolver_cache_is_stale(struct gpiod_line_resolver *resolver,
+				    struct resolver_cache *cache)
+{
+	size_t i;
+
+	if (cache->num_chips != resolver->num_chips)
+		return true;
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		if (!resolver->chips[i].cached)
+			return true;
+	}
+
+	return false;
+}
+
+GPIOD_API struct gpiod_line_resolver *
+gpiod_line_resolver_new(const char *cache_path)
+{
+	struct gpiod_line_resolver *resolver;
+	struct resolver_cache cache;
+	bool have_cache = false;
+	struct dirent **entries;
+	int num, ret, i;
+
+	resolver = malloc(sizeof(*resolver));
+	if (!resolver)
+		return NULL;
+
+	memset(resolver, 0, sizeof(*resolver));
+
+	num = scandir("/dev/", &entries, chip_dir_filter, versionsort);
+	if (num < 0)
+		goto err_free;
+
+	resolver->chips = calloc(num ?: 1, sizeof(*resolver->chips));
+	if (!resolver->chips)
+		goto err_free_entries;
+
+	for (i = 0; i < num; i++) {
+		if (asprintf(&resolver->chips[i].path, "/dev/%s",
+			     entries[i]->d_name) < 0)
+			goto err_free_entries;
+
+		resolver->num_chips++;
+	}
+
+	for (i = 0; i < num; i++)
+		free(entries[i]);
+	free(entries);
+
+	if (cache_path)
+		have_cache = cache_load(&cache, cache_path);
+
+	resolver_scan(resolver, have_cache ? &cache : NULL);
+
+	ret = resolver_drop_inaccessible(resolver);
+	if (ret)
+		goto err_free_cache;
+
+	ret = resolver_build_index(resolver);
+	if (ret)
+		goto err_free_cache;
+
+	if (cache_path &&
+	    (!have_cache || resolver_cache_is_stale(resolver, &cache)))
+		cache_store(resolver, cache_path);
+
+	if (have_cache)
+		cache_free(&cache);
+
+	return resolver;
+
+err_free_entries:
+	for (i = 0; i < num; i++)
+		free(entries[i]);
+	free(entries);
+err_free_cache:
+	if (have_cache)
+		cache_free(&cache);
+err_free:
+	gpiod_line_resolver_free(resolver);
+	return NULL;
+}
+
+GPIOD_API void gpiod_line_resolver_free(struct gpiod_line_resolver *resolver)
+{
+	size_t i;
+
+	if (!resolver)
+		return;
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		free(resolver->chips[i].path);
+		free(resolver->chips[i].names);
+	}
+
+	free(resolver->chips);
+	free(resolver->entries);
+	free(resolver->buckets);
+	free(resolver);
+}
+
+GPIOD_API size_t
+gpiod_line_resolver_get_num_chips(struct gpiod_line_resolver *resolver)
+{
+	assert(resolver);
+
+	return resolver->num_chips;
+}
+
+GPIOD_API const char *
+gpiod_line_resolver_get_chip_path(struct gpiod_line_resolver *resolver,
+				  size_t index)
+{
+	assert(resolver);
+
+	if (index >= resolver->num_chips) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return resolver->chips[index].path;
+}
+
+GPIOD_API int gpiod_line_resolver_find(struct gpiod_line_resolver *resolver,
+				       const char *name, size_t *chip_index,
+				       unsigned int *offset)
+{
+	struct resolver_entry *entry, *first = NULL;
+	int count = 0;
+
+	assert(resolver);
+
+	if (!name) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	entry = resolver->buckets[name_hash(name) &
+				  (resolver->num_buckets - 1)];
+	for (; entry; entry = entry->next) {
+		if (strcmp(entry->name, name) != 0)
+			continue;
+
+		if (!first)
+			first = entry;
+		count++;
+	}
+
+	if (first) {
+		if (chip_index)
+			*chip_index = first->chip;
+		if (offset)
+			*offset = first->offset;
+	}
+
+	return count;
+}
@@ -7,7 +7,7 @@
 
 GPIOD_API bool gpiod_is_gpiochip_device(const char *path)
 {
-	return gpiod_check_gpiochip_device(path, false);
+	return gpiod_backend_for_path(path)->is_chip_device(path, false);
 }
 
 GPIOD_API const char *gpiod_api_version(void)
@@ -0,0 +1,1273 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/* In-process mock I/O backend. */
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod-mock.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define MOCK_PATH_PREFIX	"/dev/gpiomock"
+#define MOCK_DEFAULT_LABEL	"gpio-mock"
+
+#define LINE_EDGE_FLAGS		(GPIO_V2_LINE_FLAG_EDGE_RISING | \
+				 GPIO_V2_LINE_FLAG_EDGE_FALLING)
+
+struct mock_line {
+	char name[GPIO_MAX_NAME_SIZE];
+	enum gpiod_line_value pull;
+	enum gpiod_line_value value;
+	struct mock_handle *request;
+	uint64_t flags;
+	uint32_t debounce_period_us;
+	bool gen_enabled;
+	uint64_t gen_period_ns;
+	uint64_t gen_count;
+};
+
+struct gpiod_mock_chip {
+	unsigned int refcnt;
+	char path[32];
+	char name[GPIO_MAX_NAME_SIZE];
+	char label[GPIO_MAX_NAME_SIZE];
+	size_t num_lines;
+	struct mock_line *lines;
+	struct gpiod_mock_chip *next;
+};
+
+/*
+ * Fixed-size FIFO. When full, the oldest element is dropped - just like the
+ * kernel does with its kfifos.
+ */
+struct mock_queue {
+	void *data;
+	size_t elsize;
+	size_t capacity;
+	size_t head;
+	size_t len;
+};
+
+/* State of a synthetic edge stream on a requested line. */
+struct mock_gen {
+	uint64_t start_ns;
+	uint64_t emitted;
+};
+
+enum {
+	MOCK_HANDLE_CHIP = 1,
+	MOCK_HANDLE_REQUEST,
+};
+
+/* Open file descriptor - either a chip or a line request. */
+struct mock_handle {
+	int type;
+	int fd;
+	struct gpiod_mock_chip *chip;
+	struct mock_handle *next;
+	bool nonblocking;
+
+	/* Chip handles. */
+	bool *watched;
+	struct mock_queue info_events;
+
+	/* Request handles. */
+	char consumer[GPIO_MAX_NAME_SIZE];
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	size_t num_lines;
+	struct mock_queue edge_events;
+	struct mock_gen gens[GPIO_V2_LINES_MAX];
+	uint32_t seqno;
+	uint32_t line_seqnos[GPIO_V2_LINES_MAX];
+};
+
+static pthread_mutex_t mock_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t mock_env_once = PTHREAD_ONCE_INIT;
+static struct gpiod_mock_chip *mock_chips;
+static struct mock_handle *mock_handles;
+static unsigned int mock_next_id;
+
+static int mock_queue_init(struct mock_queue *queue, size_t elsize,
+			   size_t capacity)
+{
+	queue->data = calloc(capacity, elsize);
+	if (!queue->data)
+		return -1;
+
+	queue->elsize = elsize;
+	queue->capacity = capacity;
+	queue->head = 0;
+	queue->len = 0;
+
+	return 0;
+}
+
+static void mock_queue_push(struct mock_queue *queue, const void *elem)
+{
+	size_t tail;
+
+	if (queue->len == queue->capacity) {
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->len--;
+	}
+
+	tail = (queue->head + queue->len) % queue->capacity;
+	memcpy((char *)queue->data + tail * queue->elsize, elem, queue->elsize);
+	queue->len++;
+}
+
+static bool mock_queue_pop(struct mock_queue *queue, void *elem)
+{
+	if (!queue->len)
+		return false;
+
+	memcpy(elem, (char *)queue->data + queue->head * queue->elsize,
+	       queue->elsize);
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->len--;
+
+	return true;
+}
+
+static bool mock_test_bit(uint64_t mask, size_t nr)
+{
+	return mask & (1ULL << nr);
+}
+
+static struct gpiod_mock_chip *mock_find_chip(const char *path)
+{
+	struct gpiod_mock_chip *chip;
+
+	for (chip = mock_chips; chip; chip = chip->next) {
+		if (strcmp(chip->path, path) == 0)
+			return chip;
+	}
+
+	return NULL;
+}
+
+static struct mock_handle *mock_find_handle(int fd)
+{
+	struct mock_handle *handle;
+
+	for (handle = mock_handles; handle; handle = handle->next) {
+		if (handle->fd == fd)
+			return handle;
+	}
+
+	errno = EBADF;
+	return NULL;
+}
+
+static void mock_chip_put(struct gpiod_mock_chip *chip)
+{
+	if (--chip->refcnt)
+		return;
+
+	free(chip->lines);
+	free(chip);
+}
+
+static struct gpiod_mock_chip *mock_chip_create(size_t num_lines,
+						const char *label)
+{
+	struct gpiod_mock_chip *chip;
+	unsigned int id;
+
+	if (num_lines == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	chip = malloc(sizeof(*chip));
+	if (!chip)
+		return NULL;
+
+	memset(chip, 0, sizeof(*chip));
+
+	chip->lines = calloc(num_lines, sizeof(*chip->lines));
+	if (!chip->lines) {
+		free(chip);
+		return NULL;
+	}
+
+	id = mock_next_id++;
+	snprintf(chip->path, sizeof(chip->path), MOCK_PATH_PREFIX "%u", id);
+	snprintf(chip->name, sizeof(chip->name), "gpiomock%u", id);
+	strncpy(chip->label, label ?: MOCK_DEFAULT_LABEL,
+		sizeof(chip->label) - 1);
+	chip->num_lines = num_lines;
+	chip->refcnt = 1;
+	chip->next = mock_chips;
+	mock_chips = chip;
+
+	return chip;
+}
+
+static void mock_init_from_env(void)
+{
+	const char *chips, *rate;
+	struct gpiod_mock_chip *chip;
+	unsigned long num_lines;
+	uint64_t rate_hz = 0;
+	unsigned int i;
+	char *end;
+
+	chips = getenv("GPIOD_MOCK_CHIPS");
+	if (!chips)
+		return;
+
+	rate = getenv("GPIOD_MOCK_EDGE_RATE");
+	if (rate)
+		rate_hz = strtoull(rate, NULL, 10);
+
+	pthread_mutex_lock(&mock_lock);
+
+	while (*chips) {
+		num_lines = strtoul(chips, &end, 10);
+		if (end == chips)
+			break;
+
+		chip = mock_chip_create(num_lines, NULL);
+		if (chip && rate) {
+			for (i = 0; i < chip->num_lines; i++) {
+				chip->lines[i].gen_enabled = true;
+				chip->lines[i].gen_period_ns =
+					rate_hz ? 1000000000ULL / rate_hz : 0;
+			}
+		}
+
+		chips = *end == ',' ? end + 1 : end;
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+}
+
+bool gpiod_mock_owns_path(const char *path)
+{
+	if (!path)
+		return false;
+
+	pthread_once(&mock_env_once, mock_init_from_env);
+
+	return strncmp(path, MOCK_PATH_PREFIX,
+		       sizeof(MOCK_PATH_PREFIX) - 1) == 0;
+}
+
+static bool mock_is_chip_device(const char *path, bool set_errno)
+{
+	bool ret;
+
+	pthread_mutex_lock(&mock_lock);
+	ret = mock_find_chip(path) != NULL;
+	pthread_mutex_unlock(&mock_lock);
+
+	errno = ret || !set_errno ? 0 : ENOENT;
+
+	return ret;
+}
+
+static int mock_open(const char *path)
+{
+	struct gpiod_mock_chip *chip;
+	struct mock_handle *handle;
+	size_t capacity;
+
+	pthread_mutex_lock(&mock_lock);
+
+	chip = mock_find_chip(path);
+	if (!chip) {
+		errno = ENOENT;
+		goto err_unlock;
+	}
+
+	handle = malloc(sizeof(*handle));
+	if (!handle)
+		goto err_unlock;
+
+	memset(handle, 0, sizeof(*handle));
+	handle->type = MOCK_HANDLE_CHIP;
+	handle->chip = chip;
+
+	handle->watched = calloc(chip->num_lines, sizeof(*handle->watched));
+	if (!handle->watched)
+		goto err_free_handle;
+
+	capacity = chip->num_lines * 16;
+	if (mock_queue_init(&handle->info_events,
+			    sizeof(struct gpio_v2_line_info_changed), capacity))
+		goto err_free_watched;
+
+	handle->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (handle->fd < 0)
+		goto err_free_queue;
+
+	chip->refcnt++;
+	handle->next = mock_handles;
+	mock_handles = handle;
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return handle->fd;
+
+err_free_queue:
+	free(handle->info_events.data);
+err_free_watched:
+	free(handle->watched);
+err_free_handle:
+	free(handle);
+err_unlock:
+	pthread_mutex_unlock(&mock_lock);
+
+	return -1;
+}
+
+static void mock_fill_line_info(struct gpiod_mock_chip *chip,
+				unsigned int offset,
+				struct gpio_v2_line_info *info)
+{
+	struct mock_line *line = &chip->lines[offset];
+
+	memset(info, 0, sizeof(*info));
+	info->offset = offset;
+	memcpy(info->name, line->name, sizeof(info->name));
+
+	if (!line->request) {
+		info->flags = GPIO_V2_LINE_FLAG_INPUT;
+		return;
+	}
+
+	info->flags = line->flags | GPIO_V2_LINE_FLAG_USED;
+	memcpy(info->consumer, line->request->consumer,
+	       sizeof(info->consumer));
+
+	if (line->debounce_period_us) {
+		info->attrs[0].id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+		info->attrs[0].debounce_period_us = line->debounce_period_us;
+		info->num_attrs = 1;
+	}
+}
+
+static void mock_notify(int fd)
+{
+	uint64_t one = 1;
+	ssize_t wr GPIOD_UNUSED;
+
+	wr = write(fd, &one, sizeof(one));
+}
+
+static void mock_emit_info_event(struct gpiod_mock_chip *chip,
+				 unsigned int offset, uint32_t event_type)
+{
+	struct gpio_v2_line_info_changed event;
+	struct mock_handle *handle;
+
+	for (handle = mock_handles; handle; handle = handle->next) {
+		if (handle->type != MOCK_HANDLE_CHIP || handle->chip != chip ||
+		    !handle->watched[offset])
+			continue;
+
+		memset(&event, 0, sizeof(event));
+		mock_fill_line_info(chip, offset, &event.info);
+		event.timestamp_ns = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		event.event_type = event_type;
+
+		mock_queue_push(&handle->info_events, &event);
+		mock_notify(handle->fd);
+	}
+}
+
+static uint64_t mock_config_line_flags(struct gpio_v2_line_config *config,
+				       size_t idx)
+{
+	struct gpio_v2_line_config_attribute *attr;
+	uint64_t flags = config->flags;
+	size_t i;
+
+	for (i = 0; i < config->num_attrs; i++) {
+		attr = &config->attrs[i];
+
+		if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_FLAGS &&
+		    mock_test_bit(attr->mask, idx))
+			flags = attr->attr.flags;
+	}
+
+	return flags;
+}
+
+static void mock_config_line_attrs(struct gpio_v2_line_config *config,
+				   size_t idx, struct mock_line *line)
+{
+	struct gpio_v2_line_config_attribute *attr;
+	size_t i;
+
+	line->debounce_period_us = 0;
+
+	for (i = 0; i < config->num_attrs; i++) {
+		attr = &config->attrs[i];
+
+		if (!mock_test_bit(attr->mask, idx))
+			continue;
+
+		switch (attr->attr.id) {
+		case GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES:
+			line->value = mock_test_bit(attr->attr.values, idx);
+			if (line->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+				line->value = !line->value;
+			break;
+		case GPIO_V2_LINE_ATTR_ID_DEBOUNCE:
+			line->debounce_period_us =
+					attr->attr.debounce_period_us;
+			break;
+		}
+	}
+}
+
+static int mock_validate_config(struct gpio_v2_line_config *config,
+				size_t num_lines)
+{
+	uint64_t flags;
+	size_t i;
+
+	for (i = 0; i < num_lines; i++) {
+		flags = mock_config_line_flags(config, i);
+
+		if ((flags & GPIO_V2_LINE_FLAG_INPUT) &&
+		    (flags & GPIO_V2_LINE_FLAG_OUTPUT))
+			goto err_inval;
+
+		if ((flags & LINE_EDGE_FLAGS) &&
+		    !(flags & GPIO_V2_LINE_FLAG_INPUT))
+			goto err_inval;
+	}
+
+	return 0;
+
+err_inval:
+	errno = EINVAL;
+	return -1;
+}
+
+static void mock_apply_config(struct mock_handle *handle,
+			      struct gpio_v2_line_config *config,
+			      uint32_t event_type)
+{
+	struct gpiod_mock_chip *chip = handle->chip;
+	struct mock_line *line;
+	uint64_t now;
+	size_t i;
+
+	now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	for (i = 0; i < handle->num_lines; i++) {
+		line = &chip->lines[handle->offsets[i]];
+
+		line->flags = mock_config_line_flags(config, i);
+		mock_config_line_attrs(config, i, line);
+
+		handle->gens[i].start_ns = now;
+		handle->gens[i].emitted = 0;
+
+		mock_emit_info_event(chip, handle->offsets[i], event_type);
+	}
+}
+
+static void mock_rearm(struct mock_handle *handle);
+
+static int mock_request_lines(struct mock_handle *chip_handle,
+			      struct gpio_v2_line_request *req)
+{
+	struct gpiod_mock_chip *chip = chip_handle->chip;
+	struct mock_handle *handle;
+	size_t i, j, capacity;
+	unsigned int offset;
+
+	if (req->num_lines == 0 || req->num_lines > GPIO_V2_LINES_MAX)
+		goto err_inval;
+
+	for (i = 0; i < req->num_lines; i++) {
+		offset = req->offsets[i];
+
+		if (offset >= chip->num_lines)
+			goto err_inval;
+
+		if (chip->lines[offset].request)
+			goto err_busy;
+
+		for (j = 0; j < i; j++) {
+			if (req->offsets[j] == offset)
+				goto err_busy;
+		}
+	}
+
+	if (mock_validate_config(&req->config, req->num_lines))
+		return -1;
+
+	handle = malloc(sizeof(*handle));
+	if (!handle)
+		return -1;
+
+	memset(handle, 0, sizeof(*handle));
+	handle->type = MOCK_HANDLE_REQUEST;
+	handle->chip = chip;
+	handle->num_lines = req->num_lines;
+	memcpy(handle->offsets, req->offsets,
+	       sizeof(*handle->offsets) * req->num_lines);
+	if (req->consumer[0])
+		memcpy(handle->consumer, req->consumer,
+		       sizeof(handle->consumer) - 1);
+	else
+		strcpy(handle->consumer, "?");
+
+	capacity = req->event_buffer_size ?: req->num_lines * 16;
+	if (mock_queue_init(&handle->edge_events,
+			    sizeof(struct gpio_v2_line_event), capacity)) {
+		free(handle);
+		return -1;
+	}
+
+	handle->fd = timerfd_create(CLOCK_MONOTONIC,
+				    TFD_CLOEXEC | TFD_NONBLOCK);
+	if (handle->fd < 0) {
+		free(handle->edge_events.data);
+		free(handle);
+		return -1;
+	}
+
+	for (i = 0; i < req->num_lines; i++)
+		chip->lines[req->offsets[i]].request = handle;
+
+	chip->refcnt++;
+	handle->next = mock_handles;
+	mock_handles = handle;
+
+	mock_apply_config(handle, &req->config, GPIOLINE_CHANGED_REQUESTED);
+	mock_rearm(handle);
+
+	req->fd = handle->fd;
+
+	return 0;
+
+err_inval:
+	errno = EINVAL;
+	return -1;
+err_busy:
+	errno = EBUSY;
+	return -1;
+}
+
+static int mock_chip_ioctl(struct mock_handle *handle, unsigned int request,
+			   void *arg)
+{
+	struct gpiod_mock_chip *chip = handle->chip;
+	struct gpio_v2_line_info *line_info;
+	struct gpiochip_info *chip_info;
+	unsigned int offset;
+
+	switch (request) {
+	case GPIO_GET_CHIPINFO_IOCTL:
+		chip_info = arg;
+		memset(chip_info, 0, sizeof(*chip_info));
+		memcpy(chip_info->name, chip->name, sizeof(chip_info->name));
+		memcpy(chip_info->label, chip->label,
+		       sizeof(chip_info->label));
+		chip_info->lines = chip->num_lines;
+		return 0;
+	case GPIO_V2_GET_LINEINFO_IOCTL:
+	case GPIO_V2_GET_LINEINFO_WATCH_IOCTL:
+		line_info = arg;
+		offset = line_info->offset;
+		if (offset >= chip->num_lines)
+			goto err_inval;
+
+		if (request == GPIO_V2_GET_LINEINFO_WATCH_IOCTL) {
+			if (handle->watched[offset]) {
+				errno = EBUSY;
+				return -1;
+			}
+
+			handle->watched[offset] = true;
+		}
+
+		mock_fill_line_info(chip, offset, line_info);
+		return 0;
+	case GPIO_GET_LINEINFO_UNWATCH_IOCTL:
+		offset = *(unsigned int *)arg;
+		if (offset >= chip->num_lines)
+			goto err_inval;
+
+		if (!handle->watched[offset]) {
+			errno = EBUSY;
+			return -1;
+		}
+
+		handle->watched[offset] = false;
+		return 0;
+	case GPIO_V2_GET_LINE_IOCTL:
+		return mock_request_lines(handle, arg);
+	}
+
+	errno = ENOTTY;
+	return -1;
+
+err_inval:
+	errno = EINVAL;
+	return -1;
+}
+
+static int mock_request_ioctl(struct mock_handle *handle,
+			      unsigned int request, void *arg)
+{
+	struct gpiod_mock_chip *chip = handle->chip;
+	struct gpio_v2_line_values *values;
+	struct gpio_v2_line_config *config;
+	struct mock_line *line;
+	uint64_t bits = 0;
+	int value;
+	size_t i;
+
+	switch (request) {
+	case GPIO_V2_LINE_GET_VALUES_IOCTL:
+		values = arg;
+
+		for (i = 0; i < handle->num_lines; i++) {
+			if (!mock_test_bit(values->mask, i))
+				continue;
+
+			line = &chip->lines[handle->offsets[i]];
+			value = line->flags & GPIO_V2_LINE_FLAG_OUTPUT ?
+						line->value : line->pull;
+			if (line->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+				value = !value;
+
+			gpiod_line_mask_assign_bit(&bits, i, value);
+		}
+
+		values->bits = bits;
+		return 0;
+	case GPIO_V2_LINE_SET_VALUES_IOCTL:
+		values = arg;
+
+		for (i = 0; i < handle->num_lines; i++) {
+			if (!mock_test_bit(values->mask, i))
+				continue;
+
+			line = &chip->lines[handle->offsets[i]];
+			if (!(line->flags & GPIO_V2_LINE_FLAG_OUTPUT)) {
+				errno = EPERM;
+				return -1;
+			}
+		}
+
+		for (i = 0; i < handle->num_lines; i++) {
+			if (!mock_test_bit(values->mask, i))
+				continue;
+
+			line = &chip->lines[handle->offsets[i]];
+			line->value = mock_test_bit(values->bits, i);
+			if (line->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+				line->value = !line->value;
+		}
+
+		return 0;
+	case GPIO_V2_LINE_SET_CONFIG_IOCTL:
+		config = arg;
+
+		if (mock_validate_config(config, handle->num_lines))
+			return -1;
+
+		mock_apply_config(handle, config, GPIOLINE_CHANGED_CONFIG);
+		mock_rearm(handle);
+		return 0;
+	}
+
+	errno = ENOTTY;
+	return -1;
+}
+
+static int mock_ioctl(int fd, unsigned long request, void *arg)
+{
+	struct mock_handle *handle;
+	int ret = -1;
+
+	pthread_mutex_lock(&mock_lock);
+
+	/*
+	 * Like the kernel, only look at the lower 32 bits of the request
+	 * number - callers may pass a sign-extended int.
+	 */
+	handle = mock_find_handle(fd);
+	if (handle) {
+		if (handle->type == MOCK_HANDLE_CHIP)
+			ret = mock_chip_ioctl(handle, request, arg);
+		else
+			ret = mock_request_ioctl(handle, request, arg);
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+static uint32_t mock_edge_id(struct mock_line *line, bool rising)
+{
+	if (line->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+		rising = !rising;
+
+	return rising ? GPIO_V2_LINE_EVENT_RISING_EDGE :
+			GPIO_V2_LINE_EVENT_FALLING_EDGE;
+}
+
+static bool mock_edge_enabled(struct mock_line *line, uint32_t id)
+{
+	if (id == GPIO_V2_LINE_EVENT_RISING_EDGE)
+		return line->flags & GPIO_V2_LINE_FLAG_EDGE_RISING;
+
+	return line->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING;
+}
+
+static void mock_fill_edge_event(struct mock_handle *handle, size_t idx,
+				 uint32_t id, uint64_t timestamp_ns,
+				 struct gpio_v2_line_event *event)
+{
+	struct mock_line *line = &handle->chip->lines[handle->offsets[idx]];
+
+	if (line->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME)
+		timestamp_ns += gpiod_clock_get_ns(CLOCK_REALTIME) -
+				gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	memset(event, 0, sizeof(*event));
+	event->timestamp_ns = timestamp_ns;
+	event->id = id;
+	event->offset = handle->offsets[idx];
+	event->seqno = ++handle->seqno;
+	event->line_seqno = ++handle->line_seqnos[idx];
+}
+
+static bool mock_gen_active(struct mock_handle *handle, size_t idx)
+{
+	struct mock_line *line = &handle->chip->lines[handle->offsets[idx]];
+
+	if (!line->gen_enabled || !(line->flags & LINE_EDGE_FLAGS))
+		return false;
+
+	return !line->gen_count || handle->gens[idx].emitted < line->gen_count;
+}
+
+/* Timestamp of the next synthetic event on given line. */
+static uint64_t mock_gen_next_ns(struct mock_handle *handle, size_t idx,
+				 uint64_t now)
+{
+	struct mock_line *line = &handle->chip->lines[handle->offsets[idx]];
+	struct mock_gen *gen = &handle->gens[idx];
+
+	if (!line->gen_period_ns)
+		return now;
+
+	return gen->start_ns + (gen->emitted + 1) * line->gen_period_ns;
+}
+
+static void mock_gen_emit(struct mock_handle *handle, size_t idx,
+			  uint64_t timestamp_ns,
+			  struct gpio_v2_line_event *event)
+{
+	struct mock_line *line = &handle->chip->lines[handle->offsets[idx]];
+	uint32_t id;
+
+	if ((line->flags & LINE_EDGE_FLAGS) == LINE_EDGE_FLAGS) {
+		line->pull = !line->pull;
+		id = mock_edge_id(line, line->pull);
+	} else if (line->flags & GPIO_V2_LINE_FLAG_EDGE_RISING) {
+		id = GPIO_V2_LINE_EVENT_RISING_EDGE;
+	} else {
+		id = GPIO_V2_LINE_EVENT_FALLING_EDGE;
+	}
+
+	mock_fill_edge_event(handle, idx, id, timestamp_ns, event);
+	handle->gens[idx].emitted++;
+}
+
+/*
+ * Store up to max_events pending events in buf: first the ones queued by
+ * gpiod_mock_chip_set_pull(), then the synthetic ones that are due, in
+ * timestamp order.
+ */
+static size_t mock_take_edge_events(struct mock_handle *handle,
+				    struct gpio_v2_line_event *buf,
+				    size_t max_events)
+{
+	uint64_t now, next, min;
+	size_t num = 0, i;
+	int idx;
+
+	while (num < max_events &&
+	       mock_queue_pop(&handle->edge_events, &buf[num]))
+		num++;
+
+	now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	while (num < max_events) {
+		idx = -1;
+		min = UINT64_MAX;
+
+		for (i = 0; i < handle->num_lines; i++) {
+			if (!mock_gen_active(handle, i))
+				continue;
+
+			/*
+			 * Lines generating events as fast as possible all
+			 * have their next event due now - take turns.
+			 */
+			next = mock_gen_next_ns(handle, i, now);
+			if (next > now || next > min ||
+			    (next == min &&
+			     handle->gens[i].emitted >= handle->gens[idx].emitted))
+				continue;
+
+			min = next;
+			idx = i;
+		}
+
+		if (idx < 0)
+			break;
+
+		mock_gen_emit(handle, idx, min, &buf[num++]);
+	}
+
+	return num;
+}
+
+/*
+ * Make the timerfd backing the request readable exactly when there are
+ * events to read.
+ */
+static void mock_rearm(struct mock_handle *handle)
+{
+	struct itimerspec its;
+	uint64_t next, min = 0, now, ticks;
+	ssize_t rd GPIOD_UNUSED;
+	size_t i;
+
+	rd = read(handle->fd, &ticks, sizeof(ticks));
+
+	now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	if (handle->edge_events.len) {
+		min = 1;
+	} else {
+		for (i = 0; i < handle->num_lines; i++) {
+			if (!mock_gen_active(handle, i))
+				continue;
+
+			next = mock_gen_next_ns(handle, i, now);
+			if (!min || next < min)
+				min = next;
+		}
+	}
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = min / 1000000000ULL;
+	its.it_value.tv_nsec = min % 1000000000ULL;
+
+	timerfd_settime(handle->fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static ssize_t mock_read_edge_events(struct mock_handle *handle, void *buf,
+				     size_t count)
+{
+	size_t max_events, num;
+
+	max_events = count / sizeof(struct gpio_v2_line_event);
+	if (!max_events) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	num = mock_take_edge_events(handle, buf, max_events);
+	if (!num) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	mock_rearm(handle);
+
+	return num * sizeof(struct gpio_v2_line_event);
+}
+
+static ssize_t mock_read_info_events(struct mock_handle *handle, void *buf,
+				     size_t count)
+{
+	struct gpio_v2_line_info_changed *events = buf;
+	size_t max_events, num = 0;
+	uint64_t cnt;
+	ssize_t rd GPIOD_UNUSED;
+
+	max_events = count / sizeof(*events);
+	if (!max_events) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	while (num < max_events &&
+	       mock_queue_pop(&handle->info_events, &events[num]))
+		num++;
+
+	if (!num) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	if (!handle->info_events.len)
+		rd = read(handle->fd, &cnt, sizeof(cnt));
+
+	return num * sizeof(*events);
+}
+
+static ssize_t mock_read(int fd, void *buf, size_t count)
+{
+	struct mock_handle *handle;
+	struct pollfd pfd;
+	ssize_t ret;
+
+	pthread_mutex_lock(&mock_lock);
+
+	for (;;) {
+		handle = mock_find_handle(fd);
+		if (!handle) {
+			ret = -1;
+			break;
+		}
+
+		if (handle->type == MOCK_HANDLE_CHIP)
+			ret = mock_read_info_events(handle, buf, count);
+		else
+			ret = mock_read_edge_events(handle, buf, count);
+
+		if (ret >= 0 || errno != EAGAIN || handle->nonblocking)
+			break;
+
+		/* Nothing to read yet - block like the kernel would. */
+		pthread_mutex_unlock(&mock_lock);
+
+		memset(&pfd, 0, sizeof(pfd));
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+
+		ret = poll(&pfd, 1, -1);
+		if (ret < 0)
+			return -1;
+
+		pthread_mutex_lock(&mock_lock);
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+static int mock_poll(int fd, int64_t timeout_ns)
+{
+	/* Mock file descriptors are real, pollable eventfds and timerfds. */
+	return gpiod_kernel_backend.poll(fd, timeout_ns);
+}
+
+static int mock_set_nonblocking(int fd, bool nonblocking)
+{
+	struct mock_handle *handle;
+	int ret = -1;
+
+	pthread_mutex_lock(&mock_lock);
+
+	handle = mock_find_handle(fd);
+	if (handle) {
+		handle->nonblocking = nonblocking;
+		ret = 0;
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+static void mock_close(int fd)
+{
+	struct mock_handle *handle, **prev;
+	struct gpiod_mock_chip *chip;
+	size_t i;
+
+	pthread_mutex_lock(&mock_lock);
+
+	for (prev = &mock_handles; *prev; prev = &(*prev)->next) {
+		if ((*prev)->fd == fd)
+			break;
+	}
+
+	handle = *prev;
+	if (!handle) {
+		pthread_mutex_unlock(&mock_lock);
+		return;
+	}
+
+	*prev = handle->next;
+	chip = handle->chip;
+
+	if (handle->type == MOCK_HANDLE_REQUEST) {
+		for (i = 0; i < handle->num_lines; i++) {
+			chip->lines[handle->offsets[i]].request = NULL;
+			chip->lines[handle->offsets[i]].flags = 0;
+			chip->lines[handle->offsets[i]].debounce_period_us = 0;
+			mock_emit_info_event(chip, handle->offsets[i],
+					     GPIOLINE_CHANGED_RELEASED);
+		}
+
+		free(handle->edge_events.data);
+	} else {
+		free(handle->watched);
+		free(handle->info_events.data);
+	}
+
+	close(handle->fd);
+	free(handle);
+	mock_chip_put(chip);
+
+	pthread_mutex_unlock(&mock_lock);
+}
+
+const struct gpiod_backend gpiod_mock_backend = {
+	.is_chip_device = mock_is_chip_device,
+	.open = mock_open,
+	.close = mock_close,
+	.ioctl = mock_ioctl,
+	.read = mock_read,
+	.poll = mock_poll,
+	.set_nonblocking = mock_set_nonblocking,
+};
+
+GPIOD_API struct gpiod_mock_chip *gpiod_mock_chip_new(size_t num_lines,
+						      const char *label)
+{
+	struct gpiod_mock_chip *chip;
+
+	pthread_once(&mock_env_once, mock_init_from_env);
+
+	pthread_mutex_lock(&mock_lock);
+	chip = mock_chip_create(num_lines, label);
+	pthread_mutex_unlock(&mock_lock);
+
+	return chip;
+}
+
+GPIOD_API void gpiod_mock_chip_free(struct gpiod_mock_chip *chip)
+{
+	struct gpiod_mock_chip **prev;
+
+	if (!chip)
+		return;
+
+	pthread_mutex_lock(&mock_lock);
+
+	for (prev = &mock_chips; *prev; prev = &(*prev)->next) {
+		if (*prev == chip) {
+			*prev = chip->next;
+			break;
+		}
+	}
+
+	mock_chip_put(chip);
+
+	pthread_mutex_unlock(&mock_lock);
+}
+
+GPIOD_API const char *gpiod_mock_chip_get_path(struct gpiod_mock_chip *chip)
+{
+	assert(chip);
+
+	return chip->path;
+}
+
+GPIOD_API const char *gpiod_mock_chip_get_name(struct gpiod_mock_chip *chip)
+{
+	assert(chip);
+
+	return chip->name;
+}
+
+static struct mock_line *mock_chip_get_line(struct gpiod_mock_chip *chip,
+					    unsigned int offset)
+{
+	if (offset >= chip->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return &chip->lines[offset];
+}
+
+GPIOD_API int gpiod_mock_chip_set_line_name(struct gpiod_mock_chip *chip,
+					    unsigned int offset,
+					    const char *name)
+{
+	struct mock_line *line;
+
+	assert(chip);
+
+	if (!name) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	line = mock_chip_get_line(chip, offset);
+	if (!line)
+		return -1;
+
+	pthread_mutex_lock(&mock_lock);
+	memset(line->name, 0, sizeof(line->name));
+	strncpy(line->name, name, sizeof(line->name) - 1);
+	pthread_mutex_unlock(&mock_lock);
+
+	return 0;
+}
+
+static size_t mock_request_line_idx(struct mock_handle *handle,
+				    unsigned int offset)
+{
+	size_t i;
+
+	for (i = 0; i < handle->num_lines; i++) {
+		if (handle->offsets[i] == offset)
+			break;
+	}
+
+	return i;
+}
+
+GPIOD_API int gpiod_mock_chip_set_pull(struct gpiod_mock_chip *chip,
+				       unsigned int offset,
+				       enum gpiod_line_value value)
+{
+	struct gpio_v2_line_event event;
+	struct mock_handle *handle;
+	struct mock_line *line;
+	uint32_t id;
+	size_t idx;
+
+	assert(chip);
+
+	if (value != GPIOD_LINE_VALUE_ACTIVE &&
+	    value != GPIOD_LINE_VALUE_INACTIVE) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	line = mock_chip_get_line(chip, offset);
+	if (!line)
+		return -1;
+
+	pthread_mutex_lock(&mock_lock);
+
+	if (line->pull == value)
+		goto out;
+
+	line->pull = value;
+	handle = line->request;
+
+	if (!handle || !(line->flags & GPIO_V2_LINE_FLAG_INPUT))
+		goto out;
+
+	id = mock_edge_id(line, value == GPIOD_LINE_VALUE_ACTIVE);
+	if (!mock_edge_enabled(line, id))
+		goto out;
+
+	idx = mock_request_line_idx(handle, offset);
+	mock_fill_edge_event(handle, idx, id,
+			     gpiod_clock_get_ns(CLOCK_MONOTONIC), &event);
+	mock_queue_push(&handle->edge_events, &event);
+	mock_rearm(handle);
+
+out:
+	pthread_mutex_unlock(&mock_lock);
+
+	return 0;
+}
+
+GPIOD_API enum gpiod_line_value
+gpiod_mock_chip_get_value(struct gpiod_mock_chip *chip, unsigned int offset)
+{
+	enum gpiod_line_value value;
+	struct mock_line *line;
+
+	assert(chip);
+
+	line = mock_chip_get_line(chip, offset);
+	if (!line)
+		return GPIOD_LINE_VALUE_ERROR;
+
+	pthread_mutex_lock(&mock_lock);
+	value = line->flags & GPIO_V2_LINE_FLAG_OUTPUT ? line->value :
+							 line->pull;
+	pthread_mutex_unlock(&mock_lock);
+
+	return value;
+}
+
+static int mock_set_generator(struct gpiod_mock_chip *chip,
+			      unsigned int offset, bool enabled,
+			      uint64_t rate_hz, uint64_t count)
+{
+	struct mock_handle *handle;
+	struct mock_line *line;
+	size_t idx;
+
+	assert(chip);
+
+	line = mock_chip_get_line(chip, offset);
+	if (!line)
+		return -1;
+
+	if (rate_hz > 1000000000ULL) {
+		errno = ERANGE;
+		return -1;
+	}
+
+	pthread_mutex_lock(&mock_lock);
+
+	line->gen_enabled = enabled;
+	line->gen_period_ns = rate_hz ? 1000000000ULL / rate_hz : 0;
+	line->gen_count = count;
+
+	handle = line->request;
+	if (handle) {
+		idx = mock_request_line_idx(handle, offset);
+		handle->gens[idx].start_ns =
+				gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		handle->gens[idx].emitted = 0;
+		mock_rearm(handle);
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_mock_chip_generate_edges(struct gpiod_mock_chip *chip,
+					     unsigned int offset,
+					     uint64_t rate_hz, uint64_t count)
+{
+	return mock_set_generator(chip, offset, true, rate_hz, count);
+}
+
+GPIOD_API int gpiod_mock_chip_stop_edges(struct gpiod_mock_chip *chip,
+					 unsigned int offset)
+{
+	return mock_set_generator(chip, offset, false, 0, 0);
+}
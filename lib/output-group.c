@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+struct output_member {
+	struct gpiod_output_group *group;
+	struct gpiod_line_request *request;
+	pthread_t thread;
+	enum gpiod_line_value *values;
+	size_t num_lines;
+	/* values were staged and are written by the next apply */
+	bool staged;
+	int error;
+	/* when the set_values call of the last apply returned */
+	uint64_t done;
+};
+
+struct gpiod_output_group {
+	struct output_member *members;
+	size_t num_members;
+	/*
+	 * Every member thread and the caller of apply meet at start, and again
+	 * at done once all the writes completed.
+	 */
+	pthread_barrier_t start;
+	pthread_barrier_t done;
+	/* only used to hold the threads back until all of them exist */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool ready;
+	bool stopping;
+	uint64_t num_applies;
+	uint64_t last_skew;
+	uint64_t total_skew;
+	uint64_t max_skew;
+};
+
+static void *output_group_thread_func(void *data)
+{
+	struct output_member *member = data;
+	struct gpiod_output_group *group = member->group;
+	bool stopping;
+
+	pthread_mutex_lock(&group->lock);
+	while (!group->ready && !group->stopping)
+		pthread_cond_wait(&group->cond, &group->lock);
+	stopping = group->stopping;
+	pthread_mutex_unlock(&group->lock);
+
+	if (stopping)
+		return NULL;
+
+	for (;;) {
+		pthread_barrier_wait(&group->start);
+
+		if (group->stopping)
+			break;
+
+		if (member->staged) {
+			member->error = 0;
+			if (gpiod_line_request_set_values(member->request,
+							  member->values))
+				member->error = errno;
+
+			member->done = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		}
+
+		pthread_barrier_wait(&group->done);
+	}
+
+	return NULL;
+}
+
+static void output_group_release_threads(struct gpiod_output_group *group,
+					 size_t num_threads, bool stopping)
+{
+	size_t i;
+
+	pthread_mutex_lock(&group->lock);
+	group->ready = !stopping;
+	group->stopping = stopping;
+	pthread_cond_broadcast(&group->cond);
+	pthread_mutex_unlock(&group->lock);
+
+	if (!stopping)
+		return;
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(group->members[i].thread, NULL);
+}
+
+GPIOD_API struct gpiod_output_group *
+gpiod_output_group_new(struct gpiod_line_request **requests,
+		       size_t num_requests)
+{
+	struct gpiod_output_group *group;
+	struct output_member *member;
+	size_t i;
+	int ret;
+
+	assert(requests);
+
+	if (!num_requests) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	for (i = 0; i < num_requests; i++) {
+		if (!requests[i]) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	group = malloc(sizeof(*group));
+	if (!group)
+		return NULL;
+
+	memset(group, 0, sizeof(*group));
+	group->num_members = num_requests;
+
+	group->members = calloc(num_requests, sizeof(*group->members));
+	if (!group->members)
+		goto err_free;
+
+	for (i = 0; i < num_requests; i++) {
+		member = &group->members[i];
+		member->group = group;
+		member->request = requests[i];
+		member->num_lines =
+			gpiod_line_request_get_num_requested_lines(requests[i]);
+		member->values = calloc(member->num_lines ?: 1,
+					sizeof(*member->values));
+		if (!member->values)
+			goto err_free_values;
+	}
+
+	ret = pthread_barrier_init(&group->start, NULL, num_requests + 1);
+	if (ret)
+		goto err_errno;
+
+	ret = pthread_barrier_init(&group->done, NULL, num_requests + 1);
+	if (ret) {
+		pthread_barrier_destroy(&group->start);
+		goto err_errno;
+	}
+
+	ret = pthread_mutex_init(&group->lock, NULL);
+	if (ret)
+		goto err_destroy_barriers;
+
+	ret = pthread_cond_init(&group->cond, NULL);
+	if (ret)
+		goto err_destroy_lock;
+
+	for (i = 0; i < num_requests; i++) {
+		ret = pthread_create(&group->members[i].thread, NULL,
+				     output_group_thread_func,
+				     &group->members[i]);
+		if (ret) {
+			/* The threads never got to the barriers, just end them. */
+			output_group_release_threads(group, i, true);
+			pthread_cond_destroy(&group->cond);
+			goto err_destroy_lock;
+		}
+	}
+
+	output_group_release_threads(group, num_requests, false);
+
+	return group;
+
+err_destroy_lock:
+	pthread_mutex_destroy(&group->lock);
+err_destroy_barriers:
+	pthread_barrier_destroy(&group->done);
+	pthread_barrier_destroy(&group->start);
+err_errno:
+	errno = ret;
+err_free_values:
+	for (i = 0; i < num_requests; i++)
+		free(group->members[i].values);
+err_free:
+	free(group->members);
+	free(group);
+	return NULL;
+}
+
+GPIOD_API void gpiod_output_group_free(struct gpiod_output_group *group)
+{
+	size_t i;
+
+	if (!group)
+		return;
+
+	group->stopping = true;
+	pthread_barrier_wait(&group->start);
+
+	for (i = 0; i < group->num_members; i++) {
+		pthread_join(group->members[i].thread, NULL);
+		free(group->members[i].values);
+	}
+
+	pthread_cond_destroy(&group->cond);
+	pthread_mutex_destroy(&group->lock);
+	pthread_barrier_destroy(&group->done);
+	pthread_barrier_destroy(&group->start);
+	free(group->members);
+	free(group);
+}
+
+GPIOD_API int
+gpiod_output_group_stage_values(struct gpiod_output_group *group,
+				size_t index,
+				const enum gpiod_line_value *values)
+{
+	struct output_member *member;
+
+	assert(group);
+	assert(values);
+
+	if (index >= group->num_members) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	member = &group->members[index];
+	memcpy(member->values, values,
+	       member->num_lines * sizeof(*member->values));
+	member->staged = true;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_output_group_apply(struct gpiod_output_group *group)
+{
+	uint64_t first = UINT64_MAX, last = 0, skew;
+	struct output_member *member;
+	size_t i, num_staged = 0;
+	int error = 0;
+
+	assert(group);
+
+	for (i = 0; i < group->num_members; i++) {
+		if (group->members[i].staged)
+			num_staged++;
+	}
+
+	if (!num_staged)
+		return 0;
+
+	pthread_barrier_wait(&group->start);
+	pthread_barrier_wait(&group->done);
+
+	for (i = 0; i < group->num_members; i++) {
+		member = &group->members[i];
+		if (!member->staged)
+			continue;
+
+		if (member->done < first)
+			first = member->done;
+		if (member->done > last)
+			last = member->done;
+		if (member->error && !error)
+			error = member->error;
+
+		member->staged = false;
+	}
+
+	/*
+	 * The skew is the spread of the completion times and is only
+	 * meaningful if more than one request was written.
+	 */
+	if (num_staged > 1) {
+		skew = last - first;
+		group->last_skew = skew;
+		group->total_skew += skew;
+		group->num_applies++;
+		if (skew > group->max_skew)
+			group->max_skew = skew;
+	}
+
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API uint64_t
+gpiod_output_group_get_last_skew_ns(struct gpiod_output_group *group)
+{
+	assert(group);
+
+	return group->last_skew;
+}
+
+GPIOD_API uint64_t
+gpiod_output_group_get_mean_skew_ns(struct gpiod_output_group *group)
+{
+	assert(group);
+
+	if (!group->num_applies)
+		return 0;
+
+	return group->total_skew / group->num_applies;
+}
+
+GPIOD_API uint64_t
+gpiod_output_group_get_max_skew_ns(struct gpiod_output_group *group)
+{
+	assert(group);
+
+	return group->max_skew;
+}
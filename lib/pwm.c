@@ -0,0 +1,588 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+struct pwm_channel {
+	unsigned int offset;
+	uint64_t period;
+	uint64_t duty;
+	/* settings to apply at the start of the next period */
+	uint64_t new_period;
+	uint64_t new_duty;
+	bool update;
+	/* channel is enabled and has an entry in the heap */
+	bool scheduled;
+	uint64_t period_start;
+	uint64_t next_edge;
+	/* the next edge starts a new period */
+	bool next_is_start;
+	/* last value written or -1 if not known */
+	int value;
+	uint64_t first_rise;
+	uint64_t last_rise;
+	uint64_t num_rises;
+};
+
+struct gpiod_pwm {
+	struct gpiod_line_request *request;
+	struct pwm_channel *channels;
+	size_t num_channels;
+	/* min-heap of indices of scheduled channels keyed by the next edge */
+	unsigned int *heap;
+	size_t heap_size;
+	/*
+	 * Scratch space for the edges processed in one go, only used by the
+	 * PWM thread.
+	 */
+	unsigned int *due;
+	unsigned int *chans;
+	unsigned int *offsets;
+	enum gpiod_line_value *values;
+	uint64_t *edges;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool running;
+	bool stopping;
+	int error;
+	uint64_t num_edges;
+	uint64_t num_writes;
+	uint64_t total_jitter;
+	uint64_t max_jitter;
+};
+
+static bool pwm_heap_less(struct gpiod_pwm *pwm, unsigned int a,
+			  unsigned int b)
+{
+	uint64_t edge_a = pwm->channels[a].next_edge,
+		 edge_b = pwm->channels[b].next_edge;
+
+	return edge_a < edge_b || (edge_a == edge_b && a < b);
+}
+
+static void pwm_heap_swap(struct gpiod_pwm *pwm, size_t i, size_t j)
+{
+	unsigned int tmp = pwm->heap[i];
+
+	pwm->heap[i] = pwm->heap[j];
+	pwm->heap[j] = tmp;
+}
+
+static void pwm_heap_push(struct gpiod_pwm *pwm, unsigned int idx)
+{
+	size_t pos = pwm->heap_size++, parent;
+
+	pwm->heap[pos] = idx;
+
+	while (pos) {
+		parent = (pos - 1) / 2;
+		if (!pwm_heap_less(pwm, pwm->heap[pos], pwm->heap[parent]))
+			break;
+
+		pwm_heap_swap(pwm, pos, parent);
+		pos = parent;
+	}
+}
+
+static unsigned int pwm_heap_pop(struct gpiod_pwm *pwm)
+{
+	unsigned int top = pwm->heap[0];
+	size_t pos = 0, child;
+
+	pwm->heap[0] = pwm->heap[--pwm->heap_size];
+
+	for (;;) {
+		child = pos * 2 + 1;
+		if (child >= pwm->heap_size)
+			break;
+
+		if (child + 1 < pwm->heap_size &&
+		    pwm_heap_less(pwm, pwm->heap[child + 1], pwm->heap[child]))
+			child++;
+
+		if (!pwm_heap_less(pwm, pwm->heap[child], pwm->heap[pos]))
+			break;
+
+		pwm_heap_swap(pwm, pos, child);
+		pos = child;
+	}
+
+	return top;
+}
+
+static struct pwm_channel *pwm_find_channel(struct gpiod_pwm *pwm,
+					    unsigned int offset)
+{
+	size_t i;
+
+	for (i = 0; i < pwm->num_channels; i++) {
+		if (pwm->channels[i].offset == offset)
+			return &pwm->channels[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Process the due edge of the channel. Returns the value the line must be
+ * set to or -1 if it stays unchanged.
+ */
+static int pwm_channel_advance(struct pwm_channel *chan, uint64_t now)
+{
+	int value;
+
+	if (!chan->next_is_start) {
+		chan->next_edge = chan->period_start + chan->period;
+		chan->next_is_start = true;
+		value = GPIOD_LINE_VALUE_INACTIVE;
+		goto out;
+	}
+
+	if (chan->update) {
+		chan->period = chan->new_period;
+		chan->duty = chan->new_duty;
+		chan->update = false;
+	}
+
+	/* Disabled channels leave their lines inactive. */
+	if (!chan->period) {
+		chan->scheduled = false;
+		value = GPIOD_LINE_VALUE_INACTIVE;
+		goto out;
+	}
+
+	chan->period_start = chan->next_edge;
+
+	/* Skip whole periods missed rather than bursting to catch up. */
+	if (now - chan->period_start >= chan->period)
+		chan->period_start += (now - chan->period_start) /
+				      chan->period * chan->period;
+
+	if (chan->duty && chan->duty < chan->period) {
+		chan->next_edge = chan->period_start + chan->duty;
+		chan->next_is_start = false;
+	} else {
+		chan->next_edge = chan->period_start + chan->period;
+	}
+
+	value = chan->duty ? GPIOD_LINE_VALUE_ACTIVE :
+			     GPIOD_LINE_VALUE_INACTIVE;
+
+out:
+	if (value == chan->value)
+		return -1;
+
+	return value;
+}
+
+static void pwm_account(struct gpiod_pwm *pwm, size_t num, uint64_t done)
+{
+	struct pwm_channel *chan;
+	uint64_t jitter;
+	size_t i;
+
+	pwm->num_writes++;
+	pwm->num_edges += num;
+
+	/* The jitter includes the time the write took, done is its end. */
+	for (i = 0; i < num; i++) {
+		jitter = done > pwm->edges[i] ? done - pwm->edges[i] : 0;
+		pwm->total_jitter += jitter;
+		if (jitter > pwm->max_jitter)
+			pwm->max_jitter = jitter;
+
+		if (pwm->values[i] != GPIOD_LINE_VALUE_ACTIVE)
+			continue;
+
+		chan = &pwm->channels[pwm->chans[i]];
+		if (!chan->num_rises)
+			chan->first_rise = done;
+		chan->last_rise = done;
+		chan->num_rises++;
+	}
+}
+
+static void *pwm_thread_func(void *data)
+{
+	struct gpiod_pwm *pwm = data;
+	size_t num_due, num, i;
+	struct pwm_channel *chan;
+	uint64_t now, edge, done;
+	struct timespec ts;
+	int value, ret;
+
+	pthread_mutex_lock(&pwm->lock);
+
+	while (!pwm->stopping) {
+		if (!pwm->heap_size) {
+			pthread_cond_wait(&pwm->cond, &pwm->lock);
+			continue;
+		}
+
+		now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		edge = pwm->channels[pwm->heap[0]].next_edge;
+		if (edge > now) {
+			ts.tv_sec = edge / 1000000000ULL;
+			ts.tv_nsec = edge % 1000000000ULL;
+			/* Re-evaluate after timeouts and settings changes. */
+			pthread_cond_timedwait(&pwm->cond, &pwm->lock, &ts);
+			continue;
+		}
+
+		/*
+		 * Collect every channel due by now first so that a lagging
+		 * channel is advanced at most once per write.
+		 */
+		for (num_due = 0; pwm->heap_size &&
+		     pwm->channels[pwm->heap[0]].next_edge <= now; num_due++)
+			pwm->due[num_due] = pwm_heap_pop(pwm);
+
+		for (i = 0, num = 0; i < num_due; i++) {
+			chan = &pwm->channels[pwm->due[i]];
+			edge = chan->next_edge;
+
+			value = pwm_channel_advance(chan, now);
+			if (chan->scheduled)
+				pwm_heap_push(pwm, pwm->due[i]);
+
+			if (value < 0)
+				continue;
+
+			chan->value = value;
+			pwm->chans[num] = pwm->due[i];
+			pwm->offsets[num] = chan->offset;
+			pwm->values[num] = value;
+			pwm->edges[num] = edge;
+			num++;
+		}
+
+		if (!num)
+			continue;
+
+		/*
+		 * Don't block the callers changing the settings or reading the
+		 * statistics for the duration of the ioctl. The scratch arrays
+		 * only belong to this thread.
+		 */
+		pthread_mutex_unlock(&pwm->lock);
+		ret = gpiod_line_request_set_values_subset(pwm->request, num,
+							   pwm->offsets,
+							   pwm->values);
+		done = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		pthread_mutex_lock(&pwm->lock);
+
+		if (ret) {
+			pwm->error = errno;
+			break;
+		}
+
+		pwm_account(pwm, num, done);
+	}
+
+	pthread_mutex_unlock(&pwm->lock);
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_pwm *gpiod_pwm_new(struct gpiod_line_request *request)
+{
+	pthread_condattr_t condattr;
+	struct gpiod_pwm *pwm;
+	size_t i, num;
+	int ret;
+
+	assert(request);
+
+	pwm = malloc(sizeof(*pwm));
+	if (!pwm)
+		return NULL;
+
+	memset(pwm, 0, sizeof(*pwm));
+	pwm->request = request;
+
+	num = gpiod_line_request_get_num_requested_lines(request);
+	pwm->num_channels = num;
+
+	pwm->channels = calloc(num, sizeof(*pwm->channels));
+	pwm->heap = calloc(num, sizeof(*pwm->heap));
+	pwm->due = calloc(num, sizeof(*pwm->due));
+	pwm->chans = calloc(num, sizeof(*pwm->chans));
+	pwm->offsets = calloc(num, sizeof(*pwm->offsets));
+	pwm->values = calloc(num, sizeof(*pwm->values));
+	pwm->edges = calloc(num, sizeof(*pwm->edges));
+	if (!pwm->channels || !pwm->heap || !pwm->due || !pwm->chans ||
+	    !pwm->offsets || !pwm->values || !pwm->edges)
+		goto err_free;
+
+	gpiod_line_request_get_requested_offsets(request, pwm->offsets, num);
+	for (i = 0; i < num; i++) {
+		pwm->channels[i].offset = pwm->offsets[i];
+		pwm->channels[i].value = -1;
+	}
+
+	ret = pthread_condattr_init(&condattr);
+	if (ret)
+		goto err_errno;
+
+	ret = pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+	if (!ret)
+		ret = pthread_cond_init(&pwm->cond, &condattr);
+	pthread_condattr_destroy(&condattr);
+	if (ret)
+		goto err_errno;
+
+	ret = pthread_mutex_init(&pwm->lock, NULL);
+	if (ret) {
+		pthread_cond_destroy(&pwm->cond);
+		goto err_errno;
+	}
+
+	return pwm;
+
+err_errno:
+	errno = ret;
+err_free:
+	free(pwm->channels);
+	free(pwm->heap);
+	free(pwm->due);
+	free(pwm->chans);
+	free(pwm->offsets);
+	free(pwm->values);
+	free(pwm->edges);
+	free(pwm);
+	return NULL;
+}
+
+GPIOD_API void gpiod_pwm_free(struct gpiod_pwm *pwm)
+{
+	if (!pwm)
+		return;
+
+	gpiod_pwm_stop(pwm);
+
+	pthread_cond_destroy(&pwm->cond);
+	pthread_mutex_destroy(&pwm->lock);
+	free(pwm->channels);
+	free(pwm->heap);
+	free(pwm->due);
+	free(pwm->chans);
+	free(pwm->offsets);
+	free(pwm->values);
+	free(pwm->edges);
+	free(pwm);
+}
+
+GPIOD_API int gpiod_pwm_set_channel(struct gpiod_pwm *pwm, unsigned int offset,
+				    uint64_t period_ns, uint64_t duty_ns)
+{
+	struct pwm_channel *chan;
+
+	assert(pwm);
+
+	chan = pwm_find_channel(pwm, offset);
+	if (!chan || duty_ns > period_ns) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&pwm->lock);
+
+	if (chan->scheduled) {
+		chan->new_period = period_ns;
+		chan->new_duty = duty_ns;
+		chan->update = true;
+	} else if (period_ns) {
+		chan->period = period_ns;
+		chan->duty = duty_ns;
+		chan->scheduled = true;
+		chan->next_is_start = true;
+		/* The start time is set when the thread starts otherwise. */
+		chan->next_edge = pwm->running ?
+				gpiod_clock_get_ns(CLOCK_MONOTONIC) : 0;
+		pwm_heap_push(pwm, chan - pwm->channels);
+		pthread_cond_signal(&pwm->cond);
+	}
+
+	pthread_mutex_unlock(&pwm->lock);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_pwm_start(struct gpiod_pwm *pwm)
+{
+	struct pwm_channel *chan;
+	uint64_t now;
+	size_t i;
+	int ret;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+
+	if (pwm->running) {
+		pthread_mutex_unlock(&pwm->lock);
+		errno = EBUSY;
+		return -1;
+	}
+
+	/* Start a new period on all enabled channels. */
+	now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+	pwm->heap_size = 0;
+	for (i = 0; i < pwm->num_channels; i++) {
+		chan = &pwm->channels[i];
+		if (!chan->scheduled)
+			continue;
+
+		chan->next_edge = now;
+		chan->next_is_start = true;
+		pwm_heap_push(pwm, i);
+	}
+
+	pwm->error = 0;
+	pwm->stopping = false;
+
+	ret = pthread_create(&pwm->thread, NULL, pwm_thread_func, pwm);
+	if (ret) {
+		pthread_mutex_unlock(&pwm->lock);
+		errno = ret;
+		return -1;
+	}
+
+	pwm->running = true;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_pwm_stop(struct gpiod_pwm *pwm)
+{
+	int error;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+
+	if (!pwm->running) {
+		pthread_mutex_unlock(&pwm->lock);
+		return 0;
+	}
+
+	pwm->stopping = true;
+	pthread_cond_signal(&pwm->cond);
+	pthread_mutex_unlock(&pwm->lock);
+
+	pthread_join(pwm->thread, NULL);
+
+	pwm->running = false;
+	error = pwm->error;
+	pwm->error = 0;
+
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API uint64_t gpiod_pwm_get_num_edges(struct gpiod_pwm *pwm)
+{
+	uint64_t num;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+	num = pwm->num_edges;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return num;
+}
+
+GPIOD_API uint64_t gpiod_pwm_get_num_writes(struct gpiod_pwm *pwm)
+{
+	uint64_t num;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+	num = pwm->num_writes;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return num;
+}
+
+GPIOD_API uint64_t gpiod_pwm_get_mean_jitter_ns(struct gpiod_pwm *pwm)
+{
+	uint64_t jitter = 0;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+	if (pwm->num_edges)
+		jitter = pwm->total_jitter / pwm->num_edges;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return jitter;
+}
+
+GPIOD_API uint64_t gpiod_pwm_get_max_jitter_ns(struct gpiod_pwm *pwm)
+{
+	uint64_t jitter;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+	jitter = pwm->max_jitter;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return jitter;
+}
+
+GPIOD_API uint64_t gpiod_pwm_get_achieved_period_ns(struct gpiod_pwm *pwm,
+						    unsigned int offset)
+{
+	struct pwm_channel *chan;
+	uint64_t period = 0;
+
+	assert(pwm);
+
+	chan = pwm_find_channel(pwm, offset);
+	if (!chan)
+		return 0;
+
+	pthread_mutex_lock(&pwm->lock);
+	if (chan->num_rises > 1)
+		period = (chan->last_rise - chan->first_rise) /
+			 (chan->num_rises - 1);
+	pthread_mutex_unlock(&pwm->lock);
+
+	return period;
+}
+
+GPIOD_API void gpiod_pwm_reset_stats(struct gpiod_pwm *pwm)
+{
+	size_t i;
+
+	assert(pwm);
+
+	pthread_mutex_lock(&pwm->lock);
+
+	pwm->num_edges = 0;
+	pwm->num_writes = 0;
+	pwm->total_jitter = 0;
+	pwm->max_jitter = 0;
+
+	for (i = 0; i < pwm->num_channels; i++)
+		pwm->channels[i].num_rises = 0;
+
+	pthread_mutex_unlock(&pwm->lock);
+}
@@ -0,0 +1,532 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Number of edge events the reader thread decodes per read. */
+#define QUADRATURE_EVENT_BATCH		256
+#define QUADRATURE_DEFAULT_WINDOW	10000000ULL
+
+/*
+ * The state of an axis is (A << 1) | B, counting up along 00, 10, 11, 01.
+ * The table is indexed by (state << 2) | (line is B << 1) | rising edge.
+ * An edge which doesn't change the level of its line means the opposite
+ * edge was missed and is counted as an illegal transition.
+ */
+struct quadrature_transition {
+	int8_t delta;
+	uint8_t state;
+	uint8_t illegal;
+};
+
+static const struct quadrature_transition quadrature_lut[16] = {
+	{  0, 0, 1 }, {  1, 2, 0 }, {  0, 0, 1 }, { -1, 1, 0 },
+	{  0, 1, 1 }, { -1, 3, 0 }, {  1, 0, 0 }, {  0, 1, 1 },
+	{ -1, 0, 0 }, {  0, 2, 1 }, {  0, 2, 1 }, {  1, 3, 0 },
+	{  1, 1, 0 }, {  0, 3, 1 }, { -1, 2, 0 }, {  0, 3, 1 },
+};
+
+struct quadrature_axis {
+	unsigned int offset_a;
+	unsigned int offset_b;
+	/* only touched by the decoder */
+	unsigned int state;
+	int64_t delta;
+	uint64_t illegal;
+	int64_t count;
+	int64_t ref_count;
+	uint64_t ref_time;
+	/* timestamp of the last event, in the request's event clock */
+	uint64_t last_time;
+	/* CLOCK_MONOTONIC time at which the last event was decoded */
+	uint64_t last_decoded;
+	int direction;
+	/* published to the readers with atomic accesses */
+	int64_t position;
+	uint64_t num_illegal;
+	int64_t velocity;
+	uint64_t last_event;
+	int last_direction;
+};
+
+struct gpiod_quadrature {
+	struct gpiod_line_request *request;
+	unsigned int *offsets;
+	size_t num_offsets;
+	/*
+	 * The first axis is a sink for the events of lines which aren't part
+	 * of any axis, so that decoding them needs no special case. The map
+	 * holds (axis << 1) | (line is B) for every offset of the request.
+	 */
+	struct quadrature_axis *axes;
+	size_t num_axes;
+	size_t max_axes;
+	size_t *map;
+	size_t map_size;
+	uint64_t window;
+	struct gpiod_edge_event_buffer *buffer;
+	int stop_fd;
+	pthread_t thread;
+	bool running;
+	int error;
+};
+
+static struct quadrature_axis *
+quadrature_get_axis(struct gpiod_quadrature *quad, size_t axis)
+{
+	if (axis >= quad->num_axes - 1)
+		return NULL;
+
+	return &quad->axes[axis + 1];
+}
+
+static bool quadrature_has_offset(struct gpiod_quadrature *quad,
+				  unsigned int offset)
+{
+	size_t i;
+
+	for (i = 0; i < quad->num_offsets; i++) {
+		if (quad->offsets[i] == offset)
+			return true;
+	}
+
+	return false;
+}
+
+static void quadrature_publish(struct gpiod_quadrature *quad)
+{
+	struct quadrature_axis *axis;
+	uint64_t elapsed;
+	size_t i;
+
+	for (i = 1; i < quad->num_axes; i++) {
+		axis = &quad->axes[i];
+
+		if (axis->delta) {
+			__atomic_fetch_add(&axis->position, axis->delta,
+					   __ATOMIC_RELAXED);
+			axis->count += axis->delta;
+			axis->delta = 0;
+		}
+
+		if (axis->illegal) {
+			__atomic_fetch_add(&axis->num_illegal, axis->illegal,
+					   __ATOMIC_RELAXED);
+			axis->illegal = 0;
+		}
+
+		__atomic_store_n(&axis->last_direction, axis->direction,
+				 __ATOMIC_RELAXED);
+		__atomic_store_n(&axis->last_event, axis->last_decoded,
+				 __ATOMIC_RELAXED);
+
+		if (!axis->ref_time) {
+			axis->ref_time = axis->last_time;
+			axis->ref_count = axis->count;
+			continue;
+		}
+
+		/* Estimate the velocity over at least one window of events. */
+		elapsed = axis->last_time - axis->ref_time;
+		if (elapsed < quad->window)
+			continue;
+
+		/*
+		 * Don't average over a pause in the movement, start measuring
+		 * again from where it resumed.
+		 */
+		if (elapsed > 2 * quad->window) {
+			__atomic_store_n(&axis->velocity, 0, __ATOMIC_RELAXED);
+			axis->ref_time = axis->last_time;
+			axis->ref_count = axis->count;
+			continue;
+		}
+
+		__atomic_store_n(&axis->velocity,
+				 (int64_t)((axis->count - axis->ref_count) *
+					   1000000000LL / (int64_t)elapsed),
+				 __ATOMIC_RELAXED);
+		axis->ref_time = axis->last_time;
+		axis->ref_count = axis->count;
+	}
+}
+
+static void quadrature_decode(struct gpiod_quadrature *quad,
+			      struct gpiod_edge_event_buffer *buffer,
+			      size_t num_events)
+{
+	const struct quadrature_transition *trans;
+	struct gpiod_edge_event *event;
+	struct quadrature_axis *axis;
+	unsigned int offset;
+	size_t i, slot;
+	uint64_t now;
+
+	/*
+	 * The event timestamps may come from any clock, so whether an axis is
+	 * at rest is judged by when its events were decoded instead.
+	 */
+	now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		offset = gpiod_edge_event_get_line_offset(event);
+
+		slot = offset < quad->map_size ? quad->map[offset] : 0;
+		axis = &quad->axes[slot >> 1];
+
+		trans = &quadrature_lut[(axis->state << 2) |
+					((slot & 1) << 1) |
+					(gpiod_edge_event_get_event_type(event) ==
+					 GPIOD_EDGE_EVENT_RISING_EDGE)];
+
+		axis->state = trans->state;
+		axis->delta += trans->delta;
+		axis->illegal += trans->illegal;
+		axis->direction = trans->delta + (trans->delta == 0) *
+						 axis->direction;
+		axis->last_time = gpiod_edge_event_get_timestamp_ns(event);
+		axis->last_decoded = now;
+	}
+
+	quadrature_publish(quad);
+}
+
+static void *quadrature_thread_func(void *data)
+{
+	struct gpiod_quadrature *quad = data;
+	struct pollfd pfds[2];
+	int ret;
+
+	pfds[0].fd = gpiod_line_request_get_fd(quad->request);
+	pfds[0].events = POLLIN | POLLPRI;
+	pfds[1].fd = quad->stop_fd;
+	pfds[1].events = POLLIN;
+
+	for (;;) {
+		ret = poll(pfds, 2, -1);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			quad->error = errno;
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		ret = gpiod_line_request_read_edge_events(quad->request,
+							  quad->buffer,
+							  QUADRATURE_EVENT_BATCH);
+		if (ret < 0) {
+			quad->error = errno;
+			break;
+		}
+
+		quadrature_decode(quad, quad->buffer, ret);
+	}
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_quadrature *
+gpiod_quadrature_new(struct gpiod_line_request *request)
+{
+	struct gpiod_quadrature *quad;
+	size_t i;
+
+	assert(request);
+
+	quad = malloc(sizeof(*quad));
+	if (!quad)
+		return NULL;
+
+	memset(quad, 0, sizeof(*quad));
+	quad->request = request;
+	quad->window = QUADRATURE_DEFAULT_WINDOW;
+	quad->stop_fd = -1;
+	quad->num_axes = 1;
+	quad->max_axes = 4;
+
+	quad->num_offsets = gpiod_line_request_get_num_requested_lines(request);
+	quad->offsets = calloc(quad->num_offsets ?: 1, sizeof(*quad->offsets));
+	if (!quad->offsets)
+		goto err_free;
+
+	gpiod_line_request_get_requested_offsets(request, quad->offsets,
+						 quad->num_offsets);
+	for (i = 0; i < quad->num_offsets; i++) {
+		if (quad->offsets[i] >= quad->map_size)
+			quad->map_size = quad->offsets[i] + 1;
+	}
+
+	quad->map = calloc(quad->map_size ?: 1, sizeof(*quad->map));
+	quad->axes = calloc(quad->max_axes, sizeof(*quad->axes));
+	if (!quad->map || !quad->axes)
+		goto err_free;
+
+	quad->buffer = gpiod_edge_event_buffer_new(QUADRATURE_EVENT_BATCH);
+	if (!quad->buffer)
+		goto err_free;
+
+	quad->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (quad->stop_fd < 0)
+		goto err_free;
+
+	return quad;
+
+err_free:
+	gpiod_edge_event_buffer_free(quad->buffer);
+	free(quad->offsets);
+	free(quad->map);
+	free(quad->axes);
+	free(quad);
+	return NULL;
+}
+
+GPIOD_API void gpiod_quadrature_free(struct gpiod_quadrature *quad)
+{
+	if (!quad)
+		return;
+
+	gpiod_quadrature_stop(quad);
+
+	close(quad->stop_fd);
+	gpiod_edge_event_buffer_free(quad->buffer);
+	free(quad->offsets);
+	free(quad->map);
+	free(quad->axes);
+	free(quad);
+}
+
+GPIOD_API int gpiod_quadrature_add_axis(struct gpiod_quadrature *quad,
+					unsigned int offset_a,
+					unsigned int offset_b)
+{
+	enum gpiod_line_value values[2];
+	struct quadrature_axis *axes, *axis;
+	unsigned int offsets[2];
+	size_t max;
+
+	assert(quad);
+
+	if (quad->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (offset_a == offset_b || !quadrature_has_offset(quad, offset_a) ||
+	    !quadrature_has_offset(quad, offset_b) || quad->map[offset_a] ||
+	    quad->map[offset_b]) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Start decoding from the levels the lines have right now. */
+	offsets[0] = offset_a;
+	offsets[1] = offset_b;
+	if (gpiod_line_request_get_values_subset(quad->request, 2, offsets,
+						 values))
+		return -1;
+
+	if (quad->num_axes == quad->max_axes) {
+		max = quad->max_axes * 2;
+		axes = realloc(quad->axes, max * sizeof(*axes));
+		if (!axes)
+			return -1;
+
+		quad->axes = axes;
+		quad->max_axes = max;
+	}
+
+	axis = &quad->axes[quad->num_axes];
+	memset(axis, 0, sizeof(*axis));
+	axis->offset_a = offset_a;
+	axis->offset_b = offset_b;
+	axis->state = (values[0] == GPIOD_LINE_VALUE_ACTIVE) << 1 |
+		      (values[1] == GPIOD_LINE_VALUE_ACTIVE);
+
+	quad->map[offset_a] = quad->num_axes << 1;
+	quad->map[offset_b] = quad->num_axes << 1 | 1;
+
+	return quad->num_axes++ - 1;
+}
+
+GPIOD_API int gpiod_quadrature_set_velocity_window(struct gpiod_quadrature *quad,
+						   uint64_t window_ns)
+{
+	assert(quad);
+
+	if (quad->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!window_ns) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	quad->window = window_ns;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_quadrature_decode(struct gpiod_quadrature *quad,
+				      struct gpiod_edge_event_buffer *buffer,
+				      size_t num_events)
+{
+	assert(quad);
+	assert(buffer);
+
+	if (quad->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (num_events > gpiod_edge_event_buffer_get_num_events(buffer))
+		num_events = gpiod_edge_event_buffer_get_num_events(buffer);
+
+	quadrature_decode(quad, buffer, num_events);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_quadrature_start(struct gpiod_quadrature *quad)
+{
+	eventfd_t unused;
+	int ret;
+
+	assert(quad);
+
+	if (quad->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	/* Drop a stop request left over from the previous run. */
+	eventfd_read(quad->stop_fd, &unused);
+	quad->error = 0;
+
+	ret = pthread_create(&quad->thread, NULL, quadrature_thread_func,
+			     quad);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	quad->running = true;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_quadrature_stop(struct gpiod_quadrature *quad)
+{
+	int error;
+
+	assert(quad);
+
+	if (!quad->running)
+		return 0;
+
+	eventfd_write(quad->stop_fd, 1);
+	pthread_join(quad->thread, NULL);
+
+	quad->running = false;
+	error = quad->error;
+
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API int64_t gpiod_quadrature_get_position(struct gpiod_quadrature *quad,
+						size_t axis)
+{
+	struct quadrature_axis *ax;
+
+	assert(quad);
+
+	ax = quadrature_get_axis(quad, axis);
+	if (!ax)
+		return 0;
+
+	return __atomic_load_n(&ax->position, __ATOMIC_RELAXED);
+}
+
+GPIOD_API void gpiod_quadrature_set_position(struct gpiod_quadrature *quad,
+					     size_t axis, int64_t position)
+{
+	struct quadrature_axis *ax;
+
+	assert(quad);
+
+	ax = quadrature_get_axis(quad, axis);
+	if (!ax)
+		return;
+
+	__atomic_store_n(&ax->position, position, __ATOMIC_RELAXED);
+}
+
+GPIOD_API int gpiod_quadrature_get_direction(struct gpiod_quadrature *quad,
+					     size_t axis)
+{
+	struct quadrature_axis *ax;
+
+	assert(quad);
+
+	ax = quadrature_get_axis(quad, axis);
+	if (!ax)
+		return 0;
+
+	return __atomic_load_n(&ax->last_direction, __ATOMIC_RELAXED);
+}
+
+GPIOD_API int64_t gpiod_quadrature_get_velocity(struct gpiod_quadrature *quad,
+						size_t axis)
+{
+	struct quadrature_axis *ax;
+	uint64_t last;
+
+	assert(quad);
+
+	ax = quadrature_get_axis(quad, axis);
+	if (!ax)
+		return 0;
+
+	/* An axis which stopped producing events is at rest. */
+	last = __atomic_load_n(&ax->last_event, __ATOMIC_RELAXED);
+	if (!last || gpiod_clock_get_ns(CLOCK_MONOTONIC) - last > quad->window)
+		return 0;
+
+	return __atomic_load_n(&ax->velocity, __ATOMIC_RELAXED);
+}
+
+GPIOD_API uint64_t
+gpiod_quadrature_get_num_illegal(struct gpiod_quadrature *quad, size_t axis)
+{
+	struct quadrature_axis *ax;
+
+	assert(quad);
+
+	ax = quadrature_get_axis(quad, axis);
+	if (!ax)
+		return 0;
+
+	return __atomic_load_n(&ax->num_illegal, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,716 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Number of edge events handled with a single write of the outputs. */
+#define REFLEX_EVENT_BATCH	64
+
+struct reflex_rule {
+	unsigned int input_offset;
+	enum gpiod_line_edge edge;
+	enum gpiod_reflex_action action;
+	/* index of the output line in the output request */
+	size_t output;
+	uint64_t pulse_ns;
+	/* position in the order of addition */
+	size_t seq;
+};
+
+struct gpiod_reflex {
+	struct gpiod_line_request *input;
+	struct gpiod_line_request *output;
+	unsigned int *input_offsets;
+	size_t num_inputs;
+	unsigned int *output_offsets;
+	size_t num_outputs;
+	struct reflex_rule *rules;
+	size_t num_rules;
+	size_t max_rules;
+	/*
+	 * Built when the thread starts: the rules sorted by the input offset
+	 * and, for every offset up to the highest one used, the index of its
+	 * first rule, so each event only looks at the rules of its own line.
+	 */
+	struct reflex_rule *table;
+	size_t *table_index;
+	unsigned int max_input_offset;
+	struct gpiod_edge_event_buffer *buffer;
+	/* current, last written and pending pulse state of each output */
+	enum gpiod_line_value *values;
+	enum gpiod_line_value *written;
+	uint64_t *pulse_end;
+	uint64_t *pulse_len;
+	unsigned int *write_offsets;
+	enum gpiod_line_value *write_values;
+	int priority;
+	int stop_fd;
+	pthread_t thread;
+	bool running;
+	int error;
+	/* protects the statistics */
+	pthread_mutex_t lock;
+	uint64_t num_events;
+	uint64_t num_reactions;
+	uint64_t num_writes;
+	uint64_t total_latency;
+	uint64_t max_latency;
+};
+
+static bool reflex_find_offset(const unsigned int *offsets, size_t num,
+			       unsigned int offset, size_t *index)
+{
+	size_t i;
+
+	for (i = 0; i < num; i++) {
+		if (offsets[i] == offset) {
+			if (index)
+				*index = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int reflex_rule_cmp(const void *a, const void *b)
+{
+	const struct reflex_rule *ra = a, *rb = b;
+
+	if (ra->input_offset != rb->input_offset)
+		return ra->input_offset < rb->input_offset ? -1 : 1;
+
+	/* Keep the rules of a line in the order in which they were added. */
+	return ra->seq < rb->seq ? -1 : ra->seq > rb->seq;
+}
+
+static int reflex_build_table(struct gpiod_reflex *reflex)
+{
+	unsigned int offset;
+	size_t i, j;
+
+	free(reflex->table);
+	free(reflex->table_index);
+	reflex->table = NULL;
+	reflex->table_index = NULL;
+	reflex->max_input_offset = 0;
+
+	for (i = 0; i < reflex->num_rules; i++) {
+		if (reflex->rules[i].input_offset > reflex->max_input_offset)
+			reflex->max_input_offset = reflex->rules[i].input_offset;
+	}
+
+	reflex->table = calloc(reflex->num_rules ?: 1, sizeof(*reflex->table));
+	reflex->table_index = calloc(reflex->max_input_offset + 2,
+				     sizeof(*reflex->table_index));
+	if (!reflex->table || !reflex->table_index)
+		return -1;
+
+	memcpy(reflex->table, reflex->rules,
+	       reflex->num_rules * sizeof(*reflex->table));
+	qsort(reflex->table, reflex->num_rules, sizeof(*reflex->table),
+	      reflex_rule_cmp);
+
+	for (i = 0, offset = 0; offset <= reflex->max_input_offset + 1;
+	     offset++) {
+		reflex->table_index[offset] = i;
+		for (j = i; j < reflex->num_rules &&
+			    reflex->table[j].input_offset == offset; j++)
+			;
+		i = j;
+	}
+
+	return 0;
+}
+
+static bool reflex_apply_event(struct gpiod_reflex *reflex,
+			       struct gpiod_edge_event *event)
+{
+	enum gpiod_edge_event_type type;
+	struct reflex_rule *rule;
+	unsigned int offset;
+	bool matched = false;
+	size_t i, end;
+
+	offset = gpiod_edge_event_get_line_offset(event);
+	if (offset > reflex->max_input_offset)
+		return false;
+
+	type = gpiod_edge_event_get_event_type(event);
+	end = reflex->table_index[offset + 1];
+
+	for (i = reflex->table_index[offset]; i < end; i++) {
+		rule = &reflex->table[i];
+
+		if ((rule->edge == GPIOD_LINE_EDGE_RISING &&
+		     type != GPIOD_EDGE_EVENT_RISING_EDGE) ||
+		    (rule->edge == GPIOD_LINE_EDGE_FALLING &&
+		     type != GPIOD_EDGE_EVENT_FALLING_EDGE))
+			continue;
+
+		matched = true;
+		reflex->pulse_end[rule->output] = 0;
+		reflex->pulse_len[rule->output] = 0;
+
+		switch (rule->action) {
+		case GPIOD_REFLEX_ACTION_SET:
+			reflex->values[rule->output] = GPIOD_LINE_VALUE_ACTIVE;
+			break;
+		case GPIOD_REFLEX_ACTION_CLEAR:
+			reflex->values[rule->output] =
+						GPIOD_LINE_VALUE_INACTIVE;
+			break;
+		case GPIOD_REFLEX_ACTION_TOGGLE:
+			reflex->values[rule->output] =
+				reflex->values[rule->output] ==
+					GPIOD_LINE_VALUE_ACTIVE ?
+						GPIOD_LINE_VALUE_INACTIVE :
+						GPIOD_LINE_VALUE_ACTIVE;
+			break;
+		case GPIOD_REFLEX_ACTION_PULSE:
+			reflex->values[rule->output] = GPIOD_LINE_VALUE_ACTIVE;
+			/* The pulse ends relative to when it was written. */
+			reflex->pulse_len[rule->output] = rule->pulse_ns;
+			break;
+		case GPIOD_REFLEX_ACTION_FOLLOW:
+			reflex->values[rule->output] =
+				type == GPIOD_EDGE_EVENT_RISING_EDGE ?
+						GPIOD_LINE_VALUE_ACTIVE :
+						GPIOD_LINE_VALUE_INACTIVE;
+			break;
+		}
+	}
+
+	return matched;
+}
+
+static void reflex_expire_pulses(struct gpiod_reflex *reflex, uint64_t now)
+{
+	size_t i;
+
+	for (i = 0; i < reflex->num_outputs; i++) {
+		if (reflex->pulse_end[i] && reflex->pulse_end[i] <= now) {
+			reflex->values[i] = GPIOD_LINE_VALUE_INACTIVE;
+			reflex->pulse_end[i] = 0;
+		}
+	}
+}
+
+static int reflex_write(struct gpiod_reflex *reflex, uint64_t *done)
+{
+	size_t i, num = 0;
+
+	for (i = 0; i < reflex->num_outputs; i++) {
+		if (reflex->values[i] == reflex->written[i])
+			continue;
+
+		reflex->write_offsets[num] = reflex->output_offsets[i];
+		reflex->write_values[num] = reflex->values[i];
+		num++;
+	}
+
+	if (num) {
+		if (gpiod_line_request_set_values_subset(reflex->output, num,
+							 reflex->write_offsets,
+							 reflex->write_values))
+			return -1;
+
+		memcpy(reflex->written, reflex->values,
+		       reflex->num_outputs * sizeof(*reflex->written));
+	}
+
+	*done = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	for (i = 0; i < reflex->num_outputs; i++) {
+		if (reflex->pulse_len[i]) {
+			reflex->pulse_end[i] = *done + reflex->pulse_len[i];
+			reflex->pulse_len[i] = 0;
+		}
+	}
+
+	return num;
+}
+
+static uint64_t reflex_next_pulse_end(struct gpiod_reflex *reflex)
+{
+	uint64_t next = 0;
+	size_t i;
+
+	for (i = 0; i < reflex->num_outputs; i++) {
+		if (reflex->pulse_end[i] &&
+		    (!next || reflex->pulse_end[i] < next))
+			next = reflex->pulse_end[i];
+	}
+
+	return next;
+}
+
+static int reflex_handle_events(struct gpiod_reflex *reflex)
+{
+	uint64_t timestamp, done, latency, total = 0, max = 0;
+	uint64_t timestamps[REFLEX_EVENT_BATCH];
+	struct gpiod_edge_event *event;
+	size_t num_reactions = 0, i;
+	int num, written;
+
+	num = gpiod_line_request_read_edge_events(reflex->input,
+						  reflex->buffer,
+						  REFLEX_EVENT_BATCH);
+	if (num < 0)
+		return -1;
+
+	for (i = 0; i < (size_t)num; i++) {
+		event = gpiod_edge_event_buffer_get_event(reflex->buffer, i);
+		if (reflex_apply_event(reflex, event))
+			timestamps[num_reactions++] =
+				gpiod_edge_event_get_timestamp_ns(event);
+	}
+
+	reflex_expire_pulses(reflex, gpiod_clock_get_ns(CLOCK_MONOTONIC));
+
+	written = reflex_write(reflex, &done);
+	if (written < 0)
+		return -1;
+
+	for (i = 0; i < num_reactions; i++) {
+		timestamp = timestamps[i];
+		/* Timestamps from other clocks can't be compared, clamp them. */
+		latency = done > timestamp ? done - timestamp : 0;
+		total += latency;
+		if (latency > max)
+			max = latency;
+	}
+
+	pthread_mutex_lock(&reflex->lock);
+	reflex->num_events += num;
+	reflex->num_reactions += num_reactions;
+	if (written)
+		reflex->num_writes++;
+	reflex->total_latency += total;
+	if (max > reflex->max_latency)
+		reflex->max_latency = max;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return 0;
+}
+
+static void *reflex_thread_func(void *data)
+{
+	struct gpiod_reflex *reflex = data;
+	uint64_t next, now, done;
+	struct pollfd pfds[2];
+	struct timespec ts;
+	int ret, written;
+	bool timed;
+
+	pfds[0].fd = gpiod_line_request_get_fd(reflex->input);
+	pfds[0].events = POLLIN | POLLPRI;
+	pfds[1].fd = reflex->stop_fd;
+	pfds[1].events = POLLIN;
+
+	for (;;) {
+		/* Sleep until the earliest pulse ends, if there is any. */
+		next = reflex_next_pulse_end(reflex);
+		timed = next != 0;
+		if (timed) {
+			now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+			next = next > now ? next - now : 0;
+			ts.tv_sec = next / 1000000000ULL;
+			ts.tv_nsec = next % 1000000000ULL;
+		}
+
+		ret = ppoll(pfds, 2, timed ? &ts : NULL, NULL);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			reflex->error = errno;
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (pfds[0].revents) {
+			if (reflex_handle_events(reflex)) {
+				reflex->error = errno;
+				break;
+			}
+
+			continue;
+		}
+
+		reflex_expire_pulses(reflex,
+				     gpiod_clock_get_ns(CLOCK_MONOTONIC));
+
+		written = reflex_write(reflex, &done);
+		if (written < 0) {
+			reflex->error = errno;
+			break;
+		}
+
+		if (written) {
+			pthread_mutex_lock(&reflex->lock);
+			reflex->num_writes++;
+			pthread_mutex_unlock(&reflex->lock);
+		}
+	}
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_reflex *
+gpiod_reflex_new(struct gpiod_line_request *input,
+		 struct gpiod_line_request *output)
+{
+	struct gpiod_reflex *reflex;
+	size_t num_out;
+	int ret;
+
+	assert(input);
+	assert(output);
+
+	reflex = malloc(sizeof(*reflex));
+	if (!reflex)
+		return NULL;
+
+	memset(reflex, 0, sizeof(*reflex));
+	reflex->input = input;
+	reflex->output = output;
+	reflex->stop_fd = -1;
+
+	reflex->num_inputs = gpiod_line_request_get_num_requested_lines(input);
+	reflex->num_outputs = num_out =
+			gpiod_line_request_get_num_requested_lines(output);
+
+	reflex->input_offsets = calloc(reflex->num_inputs ?: 1,
+				       sizeof(*reflex->input_offsets));
+	reflex->output_offsets = calloc(num_out ?: 1,
+					sizeof(*reflex->output_offsets));
+	reflex->values = calloc(num_out ?: 1, sizeof(*reflex->values));
+	reflex->written = calloc(num_out ?: 1, sizeof(*reflex->written));
+	reflex->pulse_end = calloc(num_out ?: 1, sizeof(*reflex->pulse_end));
+	reflex->pulse_len = calloc(num_out ?: 1, sizeof(*reflex->pulse_len));
+	reflex->write_offsets = calloc(num_out ?: 1,
+				       sizeof(*reflex->write_offsets));
+	reflex->write_values = calloc(num_out ?: 1,
+				      sizeof(*reflex->write_values));
+	if (!reflex->input_offsets || !reflex->output_offsets ||
+	    !reflex->values || !reflex->written || !reflex->pulse_end ||
+	    !reflex->pulse_len || !reflex->write_offsets ||
+	    !reflex->write_values)
+		goto err_free;
+
+	gpiod_line_request_get_requested_offsets(input, reflex->input_offsets,
+						 reflex->num_inputs);
+	gpiod_line_request_get_requested_offsets(output,
+						 reflex->output_offsets,
+						 num_out);
+
+	reflex->buffer = gpiod_edge_event_buffer_new(REFLEX_EVENT_BATCH);
+	if (!reflex->buffer)
+		goto err_free;
+
+	reflex->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (reflex->stop_fd < 0)
+		goto err_free;
+
+	ret = pthread_mutex_init(&reflex->lock, NULL);
+	if (ret) {
+		errno = ret;
+		goto err_free;
+	}
+
+	return reflex;
+
+err_free:
+	if (reflex->stop_fd >= 0)
+		close(reflex->stop_fd);
+	gpiod_edge_event_buffer_free(reflex->buffer);
+	free(reflex->input_offsets);
+	free(reflex->output_offsets);
+	free(reflex->values);
+	free(reflex->written);
+	free(reflex->pulse_end);
+	free(reflex->pulse_len);
+	free(reflex->write_offsets);
+	free(reflex->write_values);
+	free(reflex);
+	return NULL;
+}
+
+GPIOD_API void gpiod_reflex_free(struct gpiod_reflex *reflex)
+{
+	if (!reflex)
+		return;
+
+	gpiod_reflex_stop(reflex);
+
+	pthread_mutex_destroy(&reflex->lock);
+	close(reflex->stop_fd);
+	gpiod_edge_event_buffer_free(reflex->buffer);
+	free(reflex->rules);
+	free(reflex->table);
+	free(reflex->table_index);
+	free(reflex->input_offsets);
+	free(reflex->output_offsets);
+	free(reflex->values);
+	free(reflex->written);
+	free(reflex->pulse_end);
+	free(reflex->pulse_len);
+	free(reflex->write_offsets);
+	free(reflex->write_values);
+	free(reflex);
+}
+
+GPIOD_API int gpiod_reflex_add_rule(struct gpiod_reflex *reflex,
+				    unsigned int input_offset,
+				    enum gpiod_line_edge edge,
+				    unsigned int output_offset,
+				    enum gpiod_reflex_action action,
+				    uint64_t pulse_ns)
+{
+	struct reflex_rule *rules, *rule;
+	size_t output, max;
+
+	assert(reflex);
+
+	if (reflex->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!reflex_find_offset(reflex->input_offsets, reflex->num_inputs,
+				input_offset, NULL) ||
+	    !reflex_find_offset(reflex->output_offsets, reflex->num_outputs,
+				output_offset, &output) ||
+	    edge < GPIOD_LINE_EDGE_RISING || edge > GPIOD_LINE_EDGE_BOTH ||
+	    action < GPIOD_REFLEX_ACTION_SET ||
+	    action > GPIOD_REFLEX_ACTION_FOLLOW ||
+	    (action == GPIOD_REFLEX_ACTION_PULSE && !pulse_ns)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (reflex->num_rules == reflex->max_rules) {
+		max = reflex->max_rules ? reflex->max_rules * 2 : 8;
+		rules = realloc(reflex->rules, max * sizeof(*rules));
+		if (!rules)
+			return -1;
+
+		reflex->rules = rules;
+		reflex->max_rules = max;
+	}
+
+	rule = &reflex->rules[reflex->num_rules++];
+	rule->input_offset = input_offset;
+	rule->edge = edge;
+	rule->action = action;
+	rule->output = output;
+	rule->pulse_ns = action == GPIOD_REFLEX_ACTION_PULSE ? pulse_ns : 0;
+	rule->seq = reflex->num_rules - 1;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_reflex_set_priority(struct gpiod_reflex *reflex,
+					int priority)
+{
+	assert(reflex);
+
+	if (reflex->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (priority && (priority < sched_get_priority_min(SCHED_FIFO) ||
+			 priority > sched_get_priority_max(SCHED_FIFO))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	reflex->priority = priority;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_reflex_start(struct gpiod_reflex *reflex)
+{
+	struct sched_param param;
+	pthread_attr_t attr;
+	eventfd_t unused;
+	size_t i;
+	int ret;
+
+	assert(reflex);
+
+	if (reflex->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (reflex_build_table(reflex))
+		return -1;
+
+	/* Start from the values the outputs have right now. */
+	ret = gpiod_line_request_get_values(reflex->output, reflex->values);
+	if (ret)
+		return -1;
+
+	memcpy(reflex->written, reflex->values,
+	       reflex->num_outputs * sizeof(*reflex->written));
+	for (i = 0; i < reflex->num_outputs; i++) {
+		reflex->pulse_end[i] = 0;
+		reflex->pulse_len[i] = 0;
+	}
+
+	/* Drop a stop request left over from the previous run. */
+	eventfd_read(reflex->stop_fd, &unused);
+	reflex->error = 0;
+
+	ret = pthread_attr_init(&attr);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	if (reflex->priority) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = reflex->priority;
+
+		ret = pthread_attr_setinheritsched(&attr,
+						   PTHREAD_EXPLICIT_SCHED);
+		if (!ret)
+			ret = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		if (!ret)
+			ret = pthread_attr_setschedparam(&attr, &param);
+	}
+
+	if (!ret)
+		ret = pthread_create(&reflex->thread, &attr, reflex_thread_func,
+				     reflex);
+	pthread_attr_destroy(&attr);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	reflex->running = true;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_reflex_stop(struct gpiod_reflex *reflex)
+{
+	int error;
+
+	assert(reflex);
+
+	if (!reflex->running)
+		return 0;
+
+	eventfd_write(reflex->stop_fd, 1);
+	pthread_join(reflex->thread, NULL);
+
+	reflex->running = false;
+	error = reflex->error;
+
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API uint64_t gpiod_reflex_get_num_events(struct gpiod_reflex *reflex)
+{
+	uint64_t num;
+
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	num = reflex->num_events;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return num;
+}
+
+GPIOD_API uint64_t gpiod_reflex_get_num_reactions(struct gpiod_reflex *reflex)
+{
+	uint64_t num;
+
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	num = reflex->num_reactions;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return num;
+}
+
+GPIOD_API uint64_t gpiod_reflex_get_num_writes(struct gpiod_reflex *reflex)
+{
+	uint64_t num;
+
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	num = reflex->num_writes;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return num;
+}
+
+GPIOD_API uint64_t
+gpiod_reflex_get_mean_latency_ns(struct gpiod_reflex *reflex)
+{
+	uint64_t latency = 0;
+
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	if (reflex->num_reactions)
+		latency = reflex->total_latency / reflex->num_reactions;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return latency;
+}
+
+GPIOD_API uint64_t gpiod_reflex_get_max_latency_ns(struct gpiod_reflex *reflex)
+{
+	uint64_t latency;
+
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	latency = reflex->max_latency;
+	pthread_mutex_unlock(&reflex->lock);
+
+	return latency;
+}
+
+GPIOD_API void gpiod_reflex_reset_stats(struct gpiod_reflex *reflex)
+{
+	assert(reflex);
+
+	pthread_mutex_lock(&reflex->lock);
+	reflex->num_events = 0;
+	reflex->num_reactions = 0;
+	reflex->num_writes = 0;
+	reflex->total_latency = 0;
+	reflex->max_latency = 0;
+	pthread_mutex_unlock(&reflex->lock);
+}
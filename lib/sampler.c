@@ -0,0 +1,386 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define SAMPLER_MAX_LINES	64
+
+struct sampler_sample {
+	uint64_t timestamp;
+	uint64_t values;
+};
+
+struct gpiod_sampler {
+	struct gpiod_line_request *request;
+	size_t num_lines;
+	enum gpiod_line_value *values;
+	uint64_t period;
+	bool changes_only;
+	gpiod_sampler_change_cb callback;
+	void *callback_data;
+	/*
+	 * Single producer, single consumer ring. The indices run freely and
+	 * are masked on access. The sampling thread only writes head, the
+	 * reader only writes tail.
+	 */
+	struct sampler_sample *ring;
+	size_t mask;
+	size_t head;
+	size_t tail;
+	uint64_t last_values;
+	bool have_last;
+	uint64_t overruns;
+	uint64_t missed;
+	/* only used to sleep and to wake up the thread for stopping */
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool running;
+	bool stopping;
+	int error;
+};
+
+static void sampler_store(struct gpiod_sampler *sampler, uint64_t timestamp,
+			  uint64_t values)
+{
+	size_t head = sampler->head;
+	struct sampler_sample *sample;
+
+	if (head - __atomic_load_n(&sampler->tail, __ATOMIC_ACQUIRE) >
+	    sampler->mask) {
+		__atomic_fetch_add(&sampler->overruns, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	sample = &sampler->ring[head & sampler->mask];
+	sample->timestamp = timestamp;
+	sample->values = values;
+
+	__atomic_store_n(&sampler->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static int sampler_take(struct gpiod_sampler *sampler)
+{
+	uint64_t timestamp, values = 0, changed;
+	size_t i;
+	int ret;
+
+	timestamp = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	ret = gpiod_line_request_get_values(sampler->request,
+					    sampler->values);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < sampler->num_lines; i++) {
+		if (sampler->values[i] == GPIOD_LINE_VALUE_ACTIVE)
+			values |= 1ULL << i;
+	}
+
+	if (sampler->have_last) {
+		changed = values ^ sampler->last_values;
+	} else {
+		changed = sampler->num_lines == SAMPLER_MAX_LINES ?
+				~0ULL : (1ULL << sampler->num_lines) - 1;
+		sampler->have_last = true;
+	}
+
+	sampler->last_values = values;
+
+	if (changed || !sampler->changes_only)
+		sampler_store(sampler, timestamp, values);
+
+	if (changed && sampler->callback)
+		sampler->callback(timestamp, values, changed,
+				  sampler->callback_data);
+
+	return 0;
+}
+
+static void *sampler_thread_func(void *data)
+{
+	struct gpiod_sampler *sampler = data;
+	uint64_t deadline, now, skipped;
+	struct timespec ts;
+	bool stopping;
+
+	deadline = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+
+	for (;;) {
+		/*
+		 * The lock is only held while sleeping so that the change
+		 * callback can stop the sampler.
+		 */
+		pthread_mutex_lock(&sampler->lock);
+
+		while (!sampler->stopping) {
+			now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+			if (deadline <= now)
+				break;
+
+			ts.tv_sec = deadline / 1000000000ULL;
+			ts.tv_nsec = deadline % 1000000000ULL;
+			pthread_cond_timedwait(&sampler->cond, &sampler->lock,
+					       &ts);
+		}
+
+		stopping = sampler->stopping;
+		pthread_mutex_unlock(&sampler->lock);
+
+		if (stopping)
+			break;
+
+		if (sampler_take(sampler)) {
+			sampler->error = errno;
+			break;
+		}
+
+		deadline += sampler->period;
+
+		/* Skip the deadlines which passed while sampling. */
+		now = gpiod_clock_get_ns(CLOCK_MONOTONIC);
+		if (now > deadline) {
+			skipped = (now - deadline) / sampler->period + 1;
+			__atomic_fetch_add(&sampler->missed, skipped,
+					   __ATOMIC_RELAXED);
+			deadline += skipped * sampler->period;
+		}
+	}
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_sampler *
+gpiod_sampler_new(struct gpiod_line_request *request, uint64_t period_ns,
+		  size_t capacity)
+{
+	pthread_condattr_t condattr;
+	struct gpiod_sampler *sampler;
+	size_t num_lines, size;
+	int ret;
+
+	assert(request);
+
+	num_lines = gpiod_line_request_get_num_requested_lines(request);
+	/* The capacity is rounded up to a power of two which must fit. */
+	if (!period_ns || !capacity || capacity > SIZE_MAX / 2 + 1 ||
+	    num_lines > SAMPLER_MAX_LINES) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	for (size = 1; size < capacity; size *= 2)
+		;
+
+	sampler = malloc(sizeof(*sampler));
+	if (!sampler)
+		return NULL;
+
+	memset(sampler, 0, sizeof(*sampler));
+	sampler->request = request;
+	sampler->num_lines = num_lines;
+	sampler->period = period_ns;
+	sampler->mask = size - 1;
+
+	sampler->values = calloc(num_lines ?: 1, sizeof(*sampler->values));
+	sampler->ring = calloc(size, sizeof(*sampler->ring));
+	if (!sampler->values || !sampler->ring)
+		goto err_free;
+
+	ret = pthread_condattr_init(&condattr);
+	if (ret)
+		goto err_errno;
+
+	ret = pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+	if (!ret)
+		ret = pthread_cond_init(&sampler->cond, &condattr);
+	pthread_condattr_destroy(&condattr);
+	if (ret)
+		goto err_errno;
+
+	ret = pthread_mutex_init(&sampler->lock, NULL);
+	if (ret) {
+		pthread_cond_destroy(&sampler->cond);
+		goto err_errno;
+	}
+
+	return sampler;
+
+err_errno:
+	errno = ret;
+err_free:
+	free(sampler->values);
+	free(sampler->ring);
+	free(sampler);
+	return NULL;
+}
+
+GPIOD_API void gpiod_sampler_free(struct gpiod_sampler *sampler)
+{
+	if (!sampler)
+		return;
+
+	gpiod_sampler_stop(sampler);
+
+	pthread_cond_destroy(&sampler->cond);
+	pthread_mutex_destroy(&sampler->lock);
+	free(sampler->values);
+	free(sampler->ring);
+	free(sampler);
+}
+
+GPIOD_API int gpiod_sampler_set_changes_only(struct gpiod_sampler *sampler,
+					     bool changes_only)
+{
+	assert(sampler);
+
+	if (sampler->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sampler->changes_only = changes_only;
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_sampler_set_change_callback(struct gpiod_sampler *sampler,
+				  gpiod_sampler_change_cb callback, void *data)
+{
+	assert(sampler);
+
+	if (sampler->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sampler->callback = callback;
+	sampler->callback_data = data;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_sampler_start(struct gpiod_sampler *sampler)
+{
+	int ret;
+
+	assert(sampler);
+
+	if (sampler->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sampler->error = 0;
+	sampler->stopping = false;
+	sampler->have_last = false;
+
+	/* Set before the thread runs the callback, which may stop it. */
+	sampler->running = true;
+
+	ret = pthread_create(&sampler->thread, NULL, sampler_thread_func,
+			     sampler);
+	if (ret) {
+		sampler->running = false;
+		errno = ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API int gpiod_sampler_stop(struct gpiod_sampler *sampler)
+{
+	int error;
+
+	assert(sampler);
+
+	if (!sampler->running)
+		return 0;
+
+	pthread_mutex_lock(&sampler->lock);
+	sampler->stopping = true;
+	pthread_cond_signal(&sampler->cond);
+	pthread_mutex_unlock(&sampler->lock);
+
+	/*
+	 * Stopping from the change callback can't join the thread it runs in.
+	 * The thread exits once the callback returns and is joined by the
+	 * next call made from another thread.
+	 */
+	if (pthread_equal(pthread_self(), sampler->thread))
+		return 0;
+
+	pthread_join(sampler->thread, NULL);
+
+	sampler->running = false;
+	error = sampler->error;
+
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API size_t gpiod_sampler_read(struct gpiod_sampler *sampler,
+				    uint64_t *timestamps, uint64_t *values,
+				    size_t max_samples)
+{
+	size_t tail, head, num, i;
+	struct sampler_sample *sample;
+
+	assert(sampler);
+
+	tail = sampler->tail;
+	head = __atomic_load_n(&sampler->head, __ATOMIC_ACQUIRE);
+
+	num = head - tail;
+	if (num > max_samples)
+		num = max_samples;
+
+	for (i = 0; i < num; i++) {
+		sample = &sampler->ring[(tail + i) & sampler->mask];
+
+		if (timestamps)
+			timestamps[i] = sample->timestamp;
+		if (values)
+			values[i] = sample->values;
+	}
+
+	__atomic_store_n(&sampler->tail, tail + num, __ATOMIC_RELEASE);
+
+	return num;
+}
+
+GPIOD_API size_t gpiod_sampler_get_num_pending(struct gpiod_sampler *sampler)
+{
+	assert(sampler);
+
+	return __atomic_load_n(&sampler->head, __ATOMIC_ACQUIRE) -
+	       __atomic_load_n(&sampler->tail, __ATOMIC_ACQUIRE);
+}
+
+GPIOD_API uint64_t gpiod_sampler_get_num_overruns(struct gpiod_sampler *sampler)
+{
+	assert(sampler);
+
+	return __atomic_load_n(&sampler->overruns, __ATOMIC_RELAXED);
+}
+
+GPIOD_API uint64_t gpiod_sampler_get_num_missed(struct gpiod_sampler *sampler)
+{
+	assert(sampler);
+
+	return __atomic_load_n(&sampler->missed, __ATOMIC_RELAXED);
+}
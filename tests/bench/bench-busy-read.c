@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Latency of gpiod_line_request_read_edge_events_busy() on gpio-sim: the time
+ * from the kernel timestamping an edge to the reader having the event, for
+ * a reader which only blocks, one which only spins and one which spins for
+ * a while before blocking.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench-common.h"
+
+#define DEFAULT_NUM_EVENTS 10000
+#define DEFAULT_SPIN_US 100
+#define DEFAULT_INTERVAL_US 100
+#define LINE_OFFSET 0
+
+struct mode {
+	const char *name;
+	int64_t spin_ns;
+};
+
+struct reader {
+	struct gpiod_line_request *request;
+	struct gpiod_edge_event_buffer *buffer;
+	struct bench_latency latency;
+	unsigned int num_events;
+	unsigned int num_spun;
+	int64_t spin_ns;
+	/* posted once the reader has the event, to keep the edges apart */
+	sem_t done;
+};
+
+static void print_help(void)
+{
+	printf("Usage: %s [OPTIONS]\n", program_invocation_short_name);
+	printf("\n");
+	printf("Measure the edge event read latency on gpio-sim for\n");
+	printf("blocking, spinning and hybrid reads.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("  -n <num>\tnumber of events per mode (default: %u)\n",
+	       DEFAULT_NUM_EVENTS);
+	printf("  -s <usec>\tspin budget of the hybrid mode (default: %u)\n",
+	       DEFAULT_SPIN_US);
+	printf("  -i <usec>\tmean interval between edges (default: %u)\n",
+	       DEFAULT_INTERVAL_US);
+	printf("  -h\t\tdisplay this help and exit\n");
+	printf("\n");
+	printf("Edges are spaced randomly between 0 and twice the interval\n");
+	printf("so that the hybrid mode catches some of them while spinning\n");
+	printf("and some after going to sleep.\n");
+}
+
+static void *reader_func(void *data)
+{
+	struct gpiod_edge_event *event;
+	struct reader *reader = data;
+	unsigned int i;
+	uint64_t now, ts;
+	bool spun;
+	int ret;
+
+	for (i = 0; i < reader->num_events; i++) {
+		ret = gpiod_line_request_read_edge_events_busy(reader->request,
+							       reader->buffer,
+							       1,
+							       reader->spin_ns,
+							       -1, &spun);
+		now = bench_now_ns();
+		if (ret < 0)
+			die_perror("error reading edge events");
+
+		event = gpiod_edge_event_buffer_get_event(reader->buffer, 0);
+		ts = gpiod_edge_event_get_timestamp_ns(event);
+		bench_latency_add(&reader->latency, now - ts);
+		if (spun)
+			reader->num_spun++;
+
+		sem_post(&reader->done);
+	}
+
+	return NULL;
+}
+
+static void run_mode(struct bench_sim *sim, struct reader *reader,
+		     const struct mode *mode, unsigned int interval_us,
+		     unsigned int *seed)
+{
+	pthread_t thread;
+	char extra[32];
+	unsigned int i;
+	int ret;
+
+	reader->spin_ns = mode->spin_ns;
+	reader->num_spun = 0;
+	reader->latency.num_samples = 0;
+
+	ret = pthread_create(&thread, NULL, reader_func, reader);
+	if (ret) {
+		errno = ret;
+		die_perror("unable to create the reader thread");
+	}
+
+	for (i = 0; i < reader->num_events; i++) {
+		if (interval_us)
+			usleep(rand_r(seed) % (2 * interval_us + 1));
+
+		bench_sim_toggle(sim, LINE_OFFSET);
+		sem_wait(&reader->done);
+	}
+
+	pthread_join(thread, NULL);
+
+	snprintf(extra, sizeof(extra), "%u%% spun",
+		 reader->num_spun * 100 / reader->num_events);
+	bench_latency_print(mode->name, &reader->latency, extra);
+}
+
+int main(int argc, char **argv)
+{
+	static const unsigned int offset = LINE_OFFSET;
+
+	unsigned int num_events = DEFAULT_NUM_EVENTS;
+	unsigned int spin_us = DEFAULT_SPIN_US;
+	unsigned int interval_us = DEFAULT_INTERVAL_US;
+	unsigned int seed = 1;
+	struct mode modes[3];
+	struct reader reader;
+	struct bench_sim sim;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "n:s:i:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			num_events = parse_uint_or_die(optarg);
+			if (!num_events)
+				die("invalid number of events: %s", optarg);
+			break;
+		case 's':
+			spin_us = parse_uint_or_die(optarg);
+			break;
+		case 'i':
+			interval_us = parse_uint_or_die(optarg);
+			break;
+		case 'h':
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			die("try %s -h", program_invocation_short_name);
+		}
+	}
+
+	modes[0].name = "blocking";
+	modes[0].spin_ns = 0;
+	modes[1].name = "spinning";
+	modes[1].spin_ns = INT64_MAX;
+	modes[2].name = "hybrid";
+	modes[2].spin_ns = (int64_t)spin_us * 1000;
+
+	bench_sim_new(&sim, 1);
+
+	memset(&reader, 0, sizeof(reader));
+	reader.num_events = num_events;
+	reader.request = bench_sim_request_edges(&sim, &offset, 1);
+	reader.buffer = gpiod_edge_event_buffer_new(1);
+	if (!reader.buffer)
+		die_perror("unable to allocate the edge event buffer");
+
+	if (gpiod_line_request_set_nonblocking(reader.request, true))
+		die_perror("unable to set the request to non-blocking mode");
+
+	bench_latency_init(&reader.latency, num_events);
+	sem_init(&reader.done, 0, 0);
+
+	bench_latency_print_header();
+
+	for (i = 0; i < 3; i++)
+		run_mode(&sim, &reader, &modes[i], interval_us, &seed);
+
+	sem_destroy(&reader.done);
+	bench_latency_free(&reader.latency);
+	gpiod_edge_event_buffer_free(reader.buffer);
+	gpiod_line_request_release(reader.request);
+	bench_sim_free(&sim);
+
+	return EXIT_SUCCESS;
+}
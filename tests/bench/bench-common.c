@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench-common.h"
+
+void die(const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	fprintf(stderr, "%s: ", program_invocation_short_name);
+	vfprintf(stderr, fmt, va);
+	fprintf(stderr, "\n");
+	va_end(va);
+
+	exit(EXIT_FAILURE);
+}
+
+void die_perror(const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	fprintf(stderr, "%s: ", program_invocation_short_name);
+	vfprintf(stderr, fmt, va);
+	fprintf(stderr, ": %s\n", strerror(errno));
+	va_end(va);
+
+	exit(EXIT_FAILURE);
+}
+
+unsigned long parse_uint_or_die(const char *option)
+{
+	unsigned long val;
+	char *end;
+
+	errno = 0;
+	val = strtoul(option, &end, 10);
+	if (errno || *end != '\0' || *option == '-' || val > UINT_MAX)
+		die("invalid number: %s", option);
+
+	return val;
+}
+
+uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void bench_sim_new(struct bench_sim *sim, size_t num_lines)
+{
+	memset(sim, 0, sizeof(*sim));
+
+	sim->ctx = gpiosim_ctx_new();
+	if (!sim->ctx)
+		die_perror("unable to create the gpio-sim context");
+
+	sim->dev = gpiosim_dev_new(sim->ctx);
+	if (!sim->dev)
+		die_perror("unable to create a gpio-sim device");
+
+	sim->bank = gpiosim_bank_new(sim->dev);
+	if (!sim->bank)
+		die_perror("unable to create a gpio-sim bank");
+
+	if (gpiosim_bank_set_num_lines(sim->bank, num_lines))
+		die_perror("unable to set the number of lines");
+
+	if (gpiosim_dev_enable(sim->dev))
+		die_perror("unable to enable the gpio-sim device");
+
+	sim->chip = gpiod_chip_open(gpiosim_bank_get_dev_path(sim->bank));
+	if (!sim->chip)
+		die_perror("unable to open the simulated chip");
+}
+
+void bench_sim_free(struct bench_sim *sim)
+{
+	gpiod_chip_close(sim->chip);
+	gpiosim_dev_disable(sim->dev);
+	gpiosim_bank_unref(sim->bank);
+	gpiosim_dev_unref(sim->dev);
+	gpiosim_ctx_unref(sim->ctx);
+}
+
+struct gpiod_line_request *
+bench_sim_request_edges(struct bench_sim *sim, const unsigned int *offsets,
+			size_t num_offsets)
+{
+	struct gpiod_line_settings *settings;
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	if (!settings || !line_cfg)
+		die("out of memory");
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	if (gpiod_line_config_add_line_settings(line_cfg, offsets, num_offsets,
+						settings))
+		die_perror("unable to add line settings");
+
+	request = gpiod_chip_request_lines(sim->chip, NULL, line_cfg);
+	if (!request)
+		die_perror("unable to request lines");
+
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+
+	return request;
+}
+
+void bench_sim_toggle(struct bench_sim *sim, unsigned int offset)
+{
+	enum gpiosim_pull pull;
+
+	pull = gpiosim_bank_get_pull(sim->bank, offset);
+	if (pull == GPIOSIM_PULL_ERROR)
+		die_perror("unable to read the pull of line %u", offset);
+
+	pull = pull == GPIOSIM_PULL_UP ? GPIOSIM_PULL_DOWN : GPIOSIM_PULL_UP;
+
+	if (gpiosim_bank_set_pull(sim->bank, offset, pull))
+		die_perror("unable to set the pull of line %u", offset);
+}
+
+void bench_latency_init(struct bench_latency *latency, size_t max_samples)
+{
+	memset(latency, 0, sizeof(*latency));
+
+	latency->samples = calloc(max_samples, sizeof(*latency->samples));
+	if (!latency->samples)
+		die("out of memory");
+
+	latency->max_samples = max_samples;
+}
+
+void bench_latency_free(struct bench_latency *latency)
+{
+	free(latency->samples);
+}
+
+void bench_latency_add(struct bench_latency *latency, uint64_t ns)
+{
+	if (latency->num_samples < latency->max_samples)
+		latency->samples[latency->num_samples++] = ns;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* samples must be sorted */
+static uint64_t percentile(struct bench_latency *latency,
+			   unsigned int permille)
+{
+	size_t pos = (latency->num_samples - 1) * permille / 1000;
+
+	return latency->samples[pos];
+}
+
+void bench_latency_print_header(void)
+{
+	printf("%-12s %8s %9s %9s %9s %9s %9s  %s\n", "mode", "events",
+	       "min", "p50", "p90", "p99", "max", "(ns)");
+}
+
+void bench_latency_print(const char *name, struct bench_latency *latency,
+			 const char *extra)
+{
+	if (!latency->num_samples) {
+		printf("%-12s %8u\n", name, 0);
+		return;
+	}
+
+	qsort(latency->samples, latency->num_samples,
+	      sizeof(*latency->samples), compare_u64);
+
+	printf("%-12s %8zu %9llu %9llu %9llu %9llu %9llu  %s\n", name,
+	       latency->num_samples,
+	       (unsigned long long)latency->samples[0],
+	       (unsigned long long)percentile(latency, 500),
+	       (unsigned long long)percentile(latency, 900),
+	       (unsigned long long)percentile(latency, 990),
+	       (unsigned long long)percentile(latency, 1000),
+	       extra ?: "");
+}
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/* SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+#ifndef __GPIOD_BENCH_COMMON_H__
+#define __GPIOD_BENCH_COMMON_H__
+
+#include <gpiod.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gpiosim.h"
+
+#define NORETURN		__attribute__((noreturn))
+#define PRINTF(fmt, arg)	__attribute__((format(printf, fmt, arg)))
+
+/* a gpio-sim chip with a single bank, along with the GPIO chip it exposes */
+struct bench_sim {
+	struct gpiosim_ctx *ctx;
+	struct gpiosim_dev *dev;
+	struct gpiosim_bank *bank;
+	struct gpiod_chip *chip;
+};
+
+/* latency samples in nanoseconds, reported as percentiles */
+struct bench_latency {
+	uint64_t *samples;
+	size_t num_samples;
+	size_t max_samples;
+};
+
+void die(const char *fmt, ...) NORETURN PRINTF(1, 2);
+void die_perror(const char *fmt, ...) NORETURN PRINTF(1, 2);
+unsigned long parse_uint_or_die(const char *option);
+
+uint64_t bench_now_ns(void);
+
+void bench_sim_new(struct bench_sim *sim, size_t num_lines);
+void bench_sim_free(struct bench_sim *sim);
+struct gpiod_line_request *
+bench_sim_request_edges(struct bench_sim *sim, const unsigned int *offsets,
+			size_t num_offsets);
+void bench_sim_toggle(struct bench_sim *sim, unsigned int offset);
+
+void bench_latency_init(struct bench_latency *latency, size_t max_samples);
+void bench_latency_free(struct bench_latency *latency);
+void bench_latency_add(struct bench_latency *latency, uint64_t ns);
+void bench_latency_print_header(void);
+void bench_latency_print(const char *name, struct bench_latency *latency,
+			 const char *extra);
+
+#endif /* __GPIOD_BENCH_COMMON_H__ */
@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Cost of collecting edge events from many line requests on gpio-sim with
+ * gpiod_event_reader, which batches the reads with io_uring if the library
+ * was built with it, compared to polling the requests with ppoll() or epoll
+ * and reading the ready ones.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench-common.h"
+
+#define DEFAULT_NUM_EVENTS 20000
+#define DEFAULT_NUM_REQUESTS 16
+#define EVENT_BUF_SIZE 64
+
+enum {
+	MODE_PPOLL = 0,
+	MODE_EPOLL,
+	MODE_READER,
+	NUM_MODES,
+};
+
+static const char *const mode_names[] = {
+	[MODE_PPOLL] = "ppoll",
+	[MODE_EPOLL] = "epoll",
+	[MODE_READER] = "reader",
+};
+
+struct bench {
+	struct bench_sim sim;
+	struct gpiod_line_request **requests;
+	struct gpiod_edge_event_buffer *buffer;
+	struct bench_latency latency;
+	unsigned int num_requests;
+	unsigned int num_events;
+	int mode;
+	bool uses_io_uring;
+	uint64_t cpu_ns;
+	/* set by the reader once it collected all events */
+	bool done;
+};
+
+static void print_help(void)
+{
+	printf("Usage: %s [OPTIONS]\n", program_invocation_short_name);
+	printf("\n");
+	printf("Measure the latency and CPU cost of collecting edge events\n");
+	printf("from many line requests with ppoll(), epoll and the event\n");
+	printf("reader.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("  -n <num>\tnumber of events per mode (default: %u)\n",
+	       DEFAULT_NUM_EVENTS);
+	printf("  -r <num>\tnumber of line requests (default: %u)\n",
+	       DEFAULT_NUM_REQUESTS);
+	printf("  -h\t\tdisplay this help and exit\n");
+}
+
+static uint64_t thread_cpu_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Returns the number of events read. */
+static unsigned int record_events(struct bench *bench, int num_events)
+{
+	struct gpiod_edge_event *event;
+	uint64_t now, ts;
+	int i;
+
+	if (num_events < 0)
+		die_perror("error reading edge events");
+
+	now = bench_now_ns();
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_edge_event_buffer_get_event(bench->buffer, i);
+		ts = gpiod_edge_event_get_timestamp_ns(event);
+		bench_latency_add(&bench->latency, now - ts);
+	}
+
+	return num_events;
+}
+
+static void read_with_ppoll(struct bench *bench)
+{
+	struct pollfd *pfds;
+	unsigned int i, count = 0;
+	int ret;
+
+	pfds = calloc(bench->num_requests, sizeof(*pfds));
+	if (!pfds)
+		die("out of memory");
+
+	for (i = 0; i < bench->num_requests; i++) {
+		pfds[i].fd = gpiod_line_request_get_fd(bench->requests[i]);
+		pfds[i].events = POLLIN;
+	}
+
+	while (count < bench->num_events) {
+		ret = ppoll(pfds, bench->num_requests, NULL, NULL);
+		if (ret < 0)
+			die_perror("error polling for events");
+
+		for (i = 0; i < bench->num_requests; i++) {
+			if (!(pfds[i].revents & POLLIN))
+				continue;
+
+			ret = gpiod_line_request_read_edge_events(
+					bench->requests[i], bench->buffer,
+					EVENT_BUF_SIZE);
+			count += record_events(bench, ret);
+		}
+	}
+
+	free(pfds);
+}
+
+static void read_with_epoll(struct bench *bench)
+{
+	struct epoll_event ev, *events;
+	unsigned int i, count = 0;
+	int epfd, ret, j;
+
+	events = calloc(bench->num_requests, sizeof(*events));
+	if (!events)
+		die("out of memory");
+
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd < 0)
+		die_perror("unable to create an epoll instance");
+
+	for (i = 0; i < bench->num_requests; i++) {
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+
+		ret = epoll_ctl(epfd, EPOLL_CTL_ADD,
+				gpiod_line_request_get_fd(bench->requests[i]),
+				&ev);
+		if (ret)
+			die_perror("unable to add a request to epoll");
+	}
+
+	while (count < bench->num_events) {
+		ret = epoll_wait(epfd, events, bench->num_requests, -1);
+		if (ret < 0)
+			die_perror("error waiting for events");
+
+		for (j = 0; j < ret; j++) {
+			i = events[j].data.u32;
+			count += record_events(bench,
+				gpiod_line_request_read_edge_events(
+					bench->requests[i], bench->buffer,
+					EVENT_BUF_SIZE));
+		}
+	}
+
+	close(epfd);
+	free(events);
+}
+
+static void read_with_reader(struct bench *bench)
+{
+	struct gpiod_event_reader *reader;
+	unsigned int i, count = 0;
+	int ret, src;
+
+	reader = gpiod_event_reader_new();
+	if (!reader)
+		die_perror("unable to create the event reader");
+
+	for (i = 0; i < bench->num_requests; i++) {
+		if (gpiod_event_reader_add_request(reader,
+						   bench->requests[i]) < 0)
+			die_perror("unable to add a request to the reader");
+	}
+
+	while (count < bench->num_events) {
+		ret = gpiod_event_reader_wait(reader, -1);
+		if (ret < 0)
+			die_perror("error waiting for events");
+
+		while ((src = gpiod_event_reader_next_ready(reader)) >= 0) {
+			ret = gpiod_event_reader_read_edge_events(reader, src,
+								  bench->buffer,
+								  EVENT_BUF_SIZE);
+			count += record_events(bench, ret);
+		}
+	}
+
+	bench->uses_io_uring = gpiod_event_reader_uses_io_uring(reader);
+	gpiod_event_reader_free(reader);
+}
+
+static void *reader_func(void *data)
+{
+	struct bench *bench = data;
+	uint64_t start;
+
+	start = thread_cpu_ns();
+
+	switch (bench->mode) {
+	case MODE_PPOLL:
+		read_with_ppoll(bench);
+		break;
+	case MODE_EPOLL:
+		read_with_epoll(bench);
+		break;
+	case MODE_READER:
+		read_with_reader(bench);
+		break;
+	}
+
+	bench->cpu_ns = thread_cpu_ns() - start;
+	__atomic_store_n(&bench->done, true, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+static void run_mode(struct bench *bench, int mode)
+{
+	unsigned int *offsets, i;
+	pthread_t thread;
+	char extra[64];
+	int ret;
+
+	offsets = calloc(bench->num_requests, sizeof(*offsets));
+	if (!offsets)
+		die("out of memory");
+
+	for (i = 0; i < bench->num_requests; i++) {
+		offsets[i] = i;
+		bench->requests[i] = bench_sim_request_edges(&bench->sim,
+							     &offsets[i], 1);
+	}
+
+	bench->mode = mode;
+	bench->done = false;
+	bench->uses_io_uring = false;
+	bench->latency.num_samples = 0;
+
+	ret = pthread_create(&thread, NULL, reader_func, bench);
+	if (ret) {
+		errno = ret;
+		die_perror("unable to create the reader thread");
+	}
+
+	/* Cycle through the lines for as long as the reader wants events. */
+	for (i = 0; !__atomic_load_n(&bench->done, __ATOMIC_ACQUIRE); i++)
+		bench_sim_toggle(&bench->sim, i % bench->num_requests);
+
+	pthread_join(thread, NULL);
+
+	snprintf(extra, sizeof(extra), "%llu ns cpu/event%s",
+		 (unsigned long long)(bench->cpu_ns /
+				      bench->latency.num_samples),
+		 bench->uses_io_uring ? ", io_uring" : "");
+	bench_latency_print(mode_names[mode], &bench->latency, extra);
+
+	for (i = 0; i < bench->num_requests; i++)
+		gpiod_line_request_release(bench->requests[i]);
+
+	free(offsets);
+}
+
+int main(int argc, char **argv)
+{
+	struct bench bench;
+	int opt, mode;
+
+	memset(&bench, 0, sizeof(bench));
+	bench.num_events = DEFAULT_NUM_EVENTS;
+	bench.num_requests = DEFAULT_NUM_REQUESTS;
+
+	while ((opt = getopt(argc, argv, "n:r:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			bench.num_events = parse_uint_or_die(optarg);
+			if (!bench.num_events)
+				die("invalid number of events: %s", optarg);
+			break;
+		case 'r':
+			bench.num_requests = parse_uint_or_die(optarg);
+			if (!bench.num_requests)
+				die("invalid number of requests: %s", optarg);
+			break;
+		case 'h':
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			die("try %s -h", program_invocation_short_name);
+		}
+	}
+
+	bench_sim_new(&bench.sim, bench.num_requests);
+
+	bench.requests = calloc(bench.num_requests, sizeof(*bench.requests));
+	if (!bench.requests)
+		die("out of memory");
+
+	bench.buffer = gpiod_edge_event_buffer_new(EVENT_BUF_SIZE);
+	if (!bench.buffer)
+		die_perror("unable to allocate the edge event buffer");
+
+	/* The last batch may overshoot the number of events wanted. */
+	bench_latency_init(&bench.latency,
+			   bench.num_events + EVENT_BUF_SIZE * bench.num_requests);
+
+	bench_latency_print_header();
+
+	for (mode = 0; mode < NUM_MODES; mode++)
+		run_mode(&bench, mode);
+
+	bench_latency_free(&bench.latency);
+	gpiod_edge_event_buffer_free(bench.buffer);
+	free(bench.requests);
+	bench_sim_free(&bench.sim);
+
+	return EXIT_SUCCESS;
+}
@@ -47,6 +47,46 @@ typedef struct gpiod_edge_event_buffer struct_gpiod_edge_event_buffer;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_buffer,
 			      gpiod_edge_event_buffer_free);
 
+typedef struct gpiod_event_reader struct_gpiod_event_reader;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_reader,
+			      gpiod_event_reader_free);
+
+typedef struct gpiod_event_merger struct_gpiod_event_merger;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_merger,
+			      gpiod_event_merger_free);
+
+typedef struct gpiod_event_recorder struct_gpiod_event_recorder;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_recorder,
+			      gpiod_event_recorder_free);
+
+typedef struct gpiod_event_recording struct_gpiod_event_recording;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_recording,
+			      gpiod_event_recording_close);
+
+typedef struct gpiod_pwm struct_gpiod_pwm;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_pwm, gpiod_pwm_free);
+
+typedef struct gpiod_sampler struct_gpiod_sampler;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_sampler, gpiod_sampler_free);
+
+typedef struct gpiod_output_group struct_gpiod_output_group;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_output_group,
+			      gpiod_output_group_free);
+
+typedef struct gpiod_reflex struct_gpiod_reflex;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_reflex, gpiod_reflex_free);
+
+typedef struct gpiod_quadrature struct_gpiod_quadrature;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_quadrature, gpiod_quadrature_free);
+
+typedef struct gpiod_line_resolver struct_gpiod_line_resolver;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_resolver,
+			      gpiod_line_resolver_free);
+
+typedef struct gpiod_chip_mirror struct_gpiod_chip_mirror;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_chip_mirror,
+			      gpiod_chip_mirror_free);
+
 #define gpiod_test_open_chip_or_fail(_path) \
 	({ \
 		struct gpiod_chip *_chip = gpiod_chip_open(_path); \
@@ -159,6 +199,26 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_buffer,
 		_request; \
 	})
 
+/*
+ * Request lines sharing the same direction and edge detection, which is all
+ * most tests need.
+ */
+#define gpiod_test_request_lines_or_fail(_chip, _offsets, _num_offsets, \
+					 _direction, _edge) \
+	({ \
+		g_autoptr(struct_gpiod_line_settings) _line_settings = NULL; \
+		g_autoptr(struct_gpiod_line_config) _line_config = NULL; \
+		\
+		_line_settings = gpiod_test_create_line_settings_or_fail(); \
+		_line_config = gpiod_test_create_line_config_or_fail(); \
+		gpiod_line_settings_set_direction(_line_settings, _direction); \
+		gpiod_line_settings_set_edge_detection(_line_settings, _edge); \
+		gpiod_test_line_config_add_line_settings_or_fail( \
+			_line_config, _offsets, _num_offsets, _line_settings); \
+		gpiod_test_chip_request_lines_or_fail(_chip, NULL, \
+						      _line_config); \
+	})
+
 #define gpiod_test_line_request_reconfigure_lines_or_fail(_request, _line_cfg) \
 	do { \
 		gint _ret = gpiod_line_request_reconfigure_lines(_request, \
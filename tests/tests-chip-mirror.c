@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "chip-mirror"
+
+GPIOD_TEST_CASE(initial_state)
+{
+	static const GPIOSimLineName names[] = {
+		{ .offset = 2, .name = "foo", },
+		{ }
+	};
+
+	g_autoptr(GVariant) vnames = g_gpiosim_package_line_names(names);
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+	struct gpiod_line_info *info;
+
+	sim = g_gpiosim_chip_new("num-lines", 8, "line-names", vnames, NULL);
+
+	mirror = gpiod_chip_mirror_new(g_gpiosim_chip_get_dev_path(sim));
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_chip_mirror_get_num_lines(mirror), ==, 8);
+	g_assert_cmpuint(gpiod_chip_mirror_get_generation(mirror), ==, 0);
+
+	info = gpiod_chip_mirror_get_line_info(mirror, 2);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+	g_assert_cmpstr(gpiod_line_info_get_name(info), ==, "foo");
+	g_assert_false(gpiod_line_info_is_used(info));
+	g_assert_cmpuint(gpiod_chip_mirror_get_line_generation(mirror, 2),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(offset_out_of_range)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+
+	mirror = gpiod_chip_mirror_new(g_gpiosim_chip_get_dev_path(sim));
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	g_assert_null(gpiod_chip_mirror_get_line_info(mirror, 4));
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpuint(gpiod_chip_mirror_get_line_generation(mirror, 4),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(update_applies_info_events)
+{
+	static const guint offset = 5;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_line_info *info;
+	const gchar *path = g_gpiosim_chip_get_dev_path(sim);
+	guint64 gen;
+
+	mirror = gpiod_chip_mirror_new(path);
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	/* Nothing pending. */
+	g_assert_cmpint(gpiod_chip_mirror_update(mirror), ==, 0);
+
+	chip = gpiod_test_open_chip_or_fail(path);
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_request_config_set_consumer(req_cfg, "mirror-test");
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_chip_request_lines_or_fail(chip, req_cfg,
+							line_cfg);
+
+	g_assert_cmpint(gpiod_chip_mirror_update(mirror), ==, 1);
+
+	info = gpiod_chip_mirror_get_line_info(mirror, 5);
+	g_assert_true(gpiod_line_info_is_used(info));
+	g_assert_cmpstr(gpiod_line_info_get_consumer(info), ==, "mirror-test");
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+
+	gen = gpiod_chip_mirror_get_generation(mirror);
+	g_assert_cmpuint(gen, ==, 1);
+	g_assert_cmpuint(gpiod_chip_mirror_get_line_generation(mirror, 5),
+			 ==, gen);
+	g_assert_cmpuint(gpiod_chip_mirror_get_line_generation(mirror, 4),
+			 ==, 0);
+
+	gpiod_line_request_release(request);
+	request = NULL;
+
+	g_assert_cmpint(gpiod_chip_mirror_update(mirror), ==, 1);
+	g_assert_false(gpiod_line_info_is_used(info));
+	g_assert_cmpuint(gpiod_chip_mirror_get_line_generation(mirror, 5),
+			 >, gen);
+}
+
+GPIOD_TEST_CASE(resync_without_changes)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+
+	mirror = gpiod_chip_mirror_new(g_gpiosim_chip_get_dev_path(sim));
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_chip_mirror_resync(mirror), ==, 0);
+	g_assert_cmpuint(gpiod_chip_mirror_get_generation(mirror), ==, 0);
+}
+
+GPIOD_TEST_CASE(update_counts_each_line_once)
+{
+	static const guint offsets[] = { 5, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_line_request *request;
+	const gchar *path = g_gpiosim_chip_get_dev_path(sim);
+
+	mirror = gpiod_chip_mirror_new(path);
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(path);
+
+	/* Two events for each line: requested and released. */
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+	gpiod_line_request_release(request);
+
+	g_assert_cmpint(gpiod_chip_mirror_update(mirror), ==, 2);
+	g_assert_cmpuint(gpiod_chip_mirror_get_generation(mirror), ==, 4);
+}
+
+GPIOD_TEST_CASE(resync_counts_pending_events)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip_mirror) mirror = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_line_request *request;
+	const gchar *path = g_gpiosim_chip_get_dev_path(sim);
+
+	mirror = gpiod_chip_mirror_new(path);
+	g_assert_nonnull(mirror);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(path);
+
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+	gpiod_line_request_release(request);
+
+	g_assert_cmpint(gpiod_chip_mirror_resync(mirror), ==, 1);
+	g_assert_false(gpiod_line_info_is_used(
+			gpiod_chip_mirror_get_line_info(mirror, 3)));
+}
@@ -198,3 +198,50 @@ GPIOD_TEST_CASE(find_line_null_name)
 	g_assert_cmpint(ret, ==, -1);
 	gpiod_test_expect_errno(EINVAL);
 }
+
+GPIOD_TEST_CASE(open_chip_with_registry)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8,
+							"label", "foobar",
+							NULL);
+	g_autoptr(struct_gpiod_chip) first = NULL;
+	g_autoptr(struct_gpiod_chip) second = NULL;
+	g_autoptr(struct_gpiod_chip_info) info = NULL;
+	gint ret;
+
+	ret = gpiod_chip_registry_enable(TRUE);
+	g_assert_cmpint(ret, ==, 0);
+
+	first = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	info = gpiod_test_chip_get_info_or_fail(first);
+	g_clear_pointer(&info, gpiod_chip_info_free);
+
+	second = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	info = gpiod_test_chip_get_info_or_fail(second);
+
+	g_assert_cmpstr(gpiod_chip_info_get_name(info), ==,
+			g_gpiosim_chip_get_name(sim));
+	g_assert_cmpstr(gpiod_chip_info_get_label(info), ==, "foobar");
+	g_assert_cmpuint(gpiod_chip_info_get_num_lines(info), ==, 8);
+
+	gpiod_chip_registry_disable();
+}
+
+GPIOD_TEST_CASE(registry_doesnt_cache_invalid_paths)
+{
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	gint ret;
+
+	ret = gpiod_chip_registry_enable(FALSE);
+	g_assert_cmpint(ret, ==, 0);
+
+	chip = gpiod_chip_open("/dev/null");
+	g_assert_null(chip);
+	gpiod_test_expect_errno(ENODEV);
+
+	chip = gpiod_chip_open("/dev/null");
+	g_assert_null(chip);
+	gpiod_test_expect_errno(ENODEV);
+
+	gpiod_chip_registry_disable();
+}
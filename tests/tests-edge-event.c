@@ -682,3 +682,239 @@ GPIOD_TEST_CASE(get_edge_event_index_out_of_bounds)
 	g_assert_null(event);
 	gpiod_test_expect_errno(EINVAL);
 }
+
+GPIOD_TEST_CASE(drain_requires_nonblocking_mode)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_assert_false(gpiod_line_request_is_nonblocking(request));
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(nonblocking_read_with_no_events)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_nonblocking(request, true);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_true(gpiod_line_request_is_nonblocking(request));
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EAGAIN);
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_events(buffer), ==, 0);
+}
+
+GPIOD_TEST_CASE(drain_grows_the_buffer)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(2);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_nonblocking(request, true);
+	g_assert_cmpint(ret, ==, 0);
+
+	for (i = 0; i < 5; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, i % 2 ? G_GPIOSIM_PULL_DOWN :
+							G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 5);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), >=, 5);
+
+	for (i = 0; i < 5; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		g_assert_cmpuint(gpiod_edge_event_get_line_seqno(event), ==,
+				 i + 1);
+	}
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(busy_read_needs_nonblocking_mode)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_request_read_edge_events_busy(request, buffer, 4,
+						       1000000, 0, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(busy_read_timeout)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_request_set_nonblocking(request, true);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_line_request_read_edge_events_busy(request, buffer, 4,
+						       1000000, 2000000, NULL);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_line_request_read_edge_events_busy(request, buffer, 4,
+						       1000000, 0, NULL);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(busy_read_event_caught_while_spinning)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	bool spun = false;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_request_set_nonblocking(request, true);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events_busy(request, buffer, 4,
+						       1000000, 1000000000,
+						       &spun);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+	g_assert_true(spun);
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+}
+
+GPIOD_TEST_CASE(busy_read_without_spinning)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	bool spun = true;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_request_set_nonblocking(request, true);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events_busy(request, buffer, 4,
+						       0, 1000000000, &spun);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_false(spun);
+}
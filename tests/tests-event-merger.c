@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "event-merger"
+
+static void toggle_line(GPIOSimChip *sim, guint offset)
+{
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+}
+
+GPIOD_TEST_CASE(invalid_clock)
+{
+	struct gpiod_event_merger *merger;
+
+	merger = gpiod_event_merger_new(1234, 1000000);
+	g_assert_null(merger);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(merge_requests_on_multiple_chips)
+{
+	static const guint expected_sources[] = { 0, 0, 1, 1, 0, 0 };
+	static const guint offset0 = 2;
+	static const guint offset1 = 5;
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	struct gpiod_edge_event *event;
+	guint64 ts, prev_ts = 0;
+	unsigned int sources[8];
+	gint ret, num = 0, i;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = gpiod_test_request_lines_or_fail(chip0, &offset0, 1,
+						    GPIOD_LINE_DIRECTION_INPUT,
+						    GPIOD_LINE_EDGE_BOTH);
+	request1 = gpiod_test_request_lines_or_fail(chip1, &offset1, 1,
+						    GPIOD_LINE_DIRECTION_INPUT,
+						    GPIOD_LINE_EDGE_BOTH);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(8);
+
+	merger = gpiod_event_merger_new(GPIOD_LINE_CLOCK_MONOTONIC, 10000000);
+	g_assert_nonnull(merger);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, request0), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, request1), ==, 1);
+
+	toggle_line(sim0, 2);
+	toggle_line(sim1, 5);
+	toggle_line(sim0, 2);
+
+	while (num < 6) {
+		ret = gpiod_event_merger_wait(merger, 1000000000);
+		g_assert_cmpint(ret, ==, 1);
+		gpiod_test_return_if_failed();
+
+		ret = gpiod_event_merger_read(merger, buffer, sources + num,
+					      8 - num);
+		g_assert_cmpint(ret, >, 0);
+		gpiod_test_return_if_failed();
+
+		for (i = 0; i < ret; i++) {
+			event = gpiod_edge_event_buffer_get_event(buffer, i);
+			ts = gpiod_edge_event_get_timestamp_ns(event);
+			g_assert_cmpuint(ts, >=, prev_ts);
+			prev_ts = ts;
+		}
+
+		num += ret;
+	}
+
+	g_assert_cmpint(num, ==, 6);
+
+	for (i = 0; i < 6; i++)
+		g_assert_cmpuint(sources[i], ==, expected_sources[i]);
+
+	g_assert_cmpuint(gpiod_event_merger_get_num_pending(merger), ==, 0);
+}
+
+GPIOD_TEST_CASE(pushed_events_wait_for_all_sources_or_window)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) events = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	unsigned int sources[4];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+	events = gpiod_test_create_edge_event_buffer_or_fail(4);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+
+	toggle_line(sim, 3);
+
+	ret = gpiod_line_request_read_edge_events(request, events, 4);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	/* A window this long never elapses during the test. */
+	merger = gpiod_event_merger_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					3600000000000ULL);
+	g_assert_nonnull(merger);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_merger_add_source(merger), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_add_source(merger), ==, 1);
+
+	g_assert_cmpint(gpiod_event_merger_push(merger, 1, events), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_wait(merger, 0), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_read(merger, buffer, sources, 4),
+			==, 0);
+
+	/* Now the first event of source 1 is known to be the oldest. */
+	toggle_line(sim, 3);
+	ret = gpiod_line_request_read_edge_events(request, events, 4);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_merger_push(merger, 0, events), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_wait(merger, 0), ==, 1);
+
+	ret = gpiod_event_merger_read(merger, buffer, sources, 4);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(sources[0], ==, 1);
+	g_assert_cmpuint(sources[1], ==, 1);
+
+	ret = gpiod_event_merger_flush(merger, buffer, sources, 4);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(sources[0], ==, 0);
+	g_assert_cmpuint(sources[1], ==, 0);
+
+	g_assert_cmpuint(gpiod_event_merger_get_num_pending(merger), ==, 0);
+}
+
+GPIOD_TEST_CASE(push_to_invalid_source)
+{
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+
+	merger = gpiod_event_merger_new(GPIOD_LINE_CLOCK_MONOTONIC, 1000000);
+	g_assert_nonnull(merger);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_merger_push(merger, 0, buffer), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
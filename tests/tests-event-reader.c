@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "event-reader"
+
+GPIOD_TEST_CASE(wait_without_sources)
+{
+	g_autoptr(struct_gpiod_event_reader) reader = NULL;
+
+	reader = gpiod_event_reader_new();
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_reader_wait(reader, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(add_source_after_wait)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_event_reader) reader = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first = gpiod_test_request_lines_or_fail(chip, &offsets[0], 1,
+						 GPIOD_LINE_DIRECTION_INPUT,
+						 GPIOD_LINE_EDGE_BOTH);
+	second = gpiod_test_request_lines_or_fail(chip, &offsets[1], 1,
+						  GPIOD_LINE_DIRECTION_INPUT,
+						  GPIOD_LINE_EDGE_BOTH);
+
+	reader = gpiod_event_reader_new();
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_reader_add_request(reader, first), ==, 0);
+	g_assert_cmpint(gpiod_event_reader_wait(reader, 0), ==, 0);
+	g_assert_cmpint(gpiod_event_reader_add_request(reader, second), ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+}
+
+GPIOD_TEST_CASE(read_edge_events_from_multiple_chips)
+{
+	static const guint offset0 = 2;
+	static const guint offset1 = 5;
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_reader) reader = NULL;
+	struct gpiod_edge_event *event;
+	gint ret, src0, src1;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = gpiod_test_request_lines_or_fail(chip0, &offset0, 1,
+						    GPIOD_LINE_DIRECTION_INPUT,
+						    GPIOD_LINE_EDGE_BOTH);
+	request1 = gpiod_test_request_lines_or_fail(chip1, &offset1, 1,
+						    GPIOD_LINE_DIRECTION_INPUT,
+						    GPIOD_LINE_EDGE_BOTH);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	reader = gpiod_event_reader_new();
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	src0 = gpiod_event_reader_add_request(reader, request0);
+	src1 = gpiod_event_reader_add_request(reader, request1);
+	g_assert_cmpint(src0, ==, 0);
+	g_assert_cmpint(src1, ==, 1);
+
+	ret = gpiod_event_reader_wait(reader, 100000000);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(gpiod_event_reader_next_ready(reader), ==, -1);
+	gpiod_test_expect_errno(EAGAIN);
+
+	g_gpiosim_chip_set_pull(sim1, 5, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim1, 5, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_event_reader_wait(reader, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpint(gpiod_event_reader_next_ready(reader), ==, src1);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_event_reader_read_edge_events(reader, src0, buffer, 64);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EAGAIN);
+
+	ret = gpiod_event_reader_read_edge_events(reader, src1, buffer, 1);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, 5);
+
+	/* The falling edge is either pending already or arrives shortly. */
+	ret = gpiod_event_reader_wait(reader, -1);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_event_reader_read_edge_events(reader, src1, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+
+	g_gpiosim_chip_set_pull(sim0, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_reader_wait(reader, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpint(gpiod_event_reader_next_ready(reader), ==, src0);
+}
+
+GPIOD_TEST_CASE(read_info_event)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_chip) other = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_info_event) event = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_reader) reader = NULL;
+	gint ret, src;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	other = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	info = gpiod_test_chip_watch_line_info_or_fail(chip, 3);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	reader = gpiod_event_reader_new();
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	src = gpiod_event_reader_add_chip(reader, chip);
+	g_assert_cmpint(src, ==, 0);
+
+	request = gpiod_test_request_lines_or_fail(other, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_event_reader_wait(reader, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	/* Chip sources don't deliver edge events. */
+	ret = gpiod_event_reader_read_edge_events(reader, src, buffer, 64);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	event = gpiod_event_reader_read_info_event(reader, src);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_info_event_get_event_type(event), ==,
+			GPIOD_INFO_EVENT_LINE_REQUESTED);
+	g_assert_cmpuint(gpiod_line_info_get_offset(
+				gpiod_info_event_get_line_info(event)), ==, 3);
+}
+
+GPIOD_TEST_CASE(free_with_reads_pending)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_event_reader *reader;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	reader = gpiod_event_reader_new();
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_reader_add_request(reader, request), ==, 0);
+
+	/* Leaves a read queued on the request. */
+	ret = gpiod_event_reader_wait(reader, 10000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	gpiod_event_reader_free(reader);
+
+	/*
+	 * The queued read must be gone by now, otherwise it would consume the
+	 * event into the freed buffer.
+	 */
+	g_gpiosim_chip_set_pull(sim, 4, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+}
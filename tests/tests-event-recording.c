@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+#include <unistd.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "event-recording"
+
+static void toggle_lines(GPIOSimChip *sim, const guint *offsets,
+			 gsize num_offsets, guint count)
+{
+	guint i;
+
+	for (i = 0; i < count; i++) {
+		g_gpiosim_chip_set_pull(sim, offsets[i % num_offsets],
+					(i / num_offsets) % 2 ?
+						G_GPIOSIM_PULL_DOWN :
+						G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+}
+
+static gchar *make_recording_path(gchar **dir)
+{
+	g_autoptr(GError) err = NULL;
+
+	*dir = g_dir_make_tmp("gpiod-test-XXXXXX", &err);
+	g_assert_no_error(err);
+
+	return g_build_filename(*dir, "events.rec", NULL);
+}
+
+GPIOD_TEST_CASE(record_and_read_back)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) readback = NULL;
+	g_autoptr(struct_gpiod_event_recorder) recorder = NULL;
+	g_autoptr(struct_gpiod_event_recording) recording = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *path = NULL;
+	struct gpiod_edge_event *orig, *read;
+	unsigned int rec_offsets[2];
+	gint fd, ret, i;
+
+	path = make_recording_path(&dir);
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+	readback = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	toggle_lines(sim, offsets, 2, 8);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 8);
+	gpiod_test_return_if_failed();
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	g_assert_cmpint(fd, >=, 0);
+	gpiod_test_return_if_failed();
+
+	recorder = gpiod_event_recorder_new(fd, "gpiochip-test", offsets, 2);
+	g_assert_nonnull(recorder);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_recorder_write(recorder, buffer), ==, 0);
+	g_assert_cmpint(gpiod_event_recorder_finish(recorder), ==, 0);
+	close(fd);
+
+	recording = gpiod_event_recording_open(path);
+	g_assert_nonnull(recording);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpstr(gpiod_event_recording_get_chip_name(recording), ==,
+			"gpiochip-test");
+	g_assert_cmpuint(gpiod_event_recording_get_num_lines(recording), ==, 2);
+	g_assert_cmpuint(gpiod_event_recording_get_line_offsets(recording,
+								rec_offsets, 2),
+			 ==, 2);
+	g_assert_cmpuint(rec_offsets[0], ==, 2);
+	g_assert_cmpuint(rec_offsets[1], ==, 5);
+	g_assert_cmpuint(gpiod_event_recording_get_num_events(recording), ==, 8);
+
+	ret = gpiod_event_recording_read_events(recording, 0, readback, 16);
+	g_assert_cmpint(ret, ==, 8);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 8; i++) {
+		orig = gpiod_edge_event_buffer_get_event(buffer, i);
+		read = gpiod_edge_event_buffer_get_event(readback, i);
+
+		g_assert_cmpint(gpiod_edge_event_get_event_type(read), ==,
+				gpiod_edge_event_get_event_type(orig));
+		g_assert_cmpuint(gpiod_edge_event_get_timestamp_ns(read), ==,
+				 gpiod_edge_event_get_timestamp_ns(orig));
+		g_assert_cmpuint(gpiod_edge_event_get_line_offset(read), ==,
+				 gpiod_edge_event_get_line_offset(orig));
+		g_assert_cmpuint(gpiod_edge_event_get_global_seqno(read), ==,
+				 gpiod_edge_event_get_global_seqno(orig));
+		g_assert_cmpuint(gpiod_edge_event_get_line_seqno(read), ==,
+				 gpiod_edge_event_get_line_seqno(orig));
+	}
+
+	/* Random access. */
+	ret = gpiod_event_recording_read_events(recording, 5, readback, 16);
+	g_assert_cmpint(ret, ==, 3);
+	g_assert_cmpuint(gpiod_edge_event_get_global_seqno(
+			gpiod_edge_event_buffer_get_event(readback, 0)), ==,
+			 gpiod_edge_event_get_global_seqno(
+			gpiod_edge_event_buffer_get_event(buffer, 5)));
+
+	g_assert_cmpuint(gpiod_event_recording_find_timestamp(recording,
+		gpiod_edge_event_get_timestamp_ns(
+			gpiod_edge_event_buffer_get_event(buffer, 3))), ==, 3);
+	g_assert_cmpuint(gpiod_event_recording_find_timestamp(recording,
+							      G_MAXUINT64),
+			 ==, 8);
+
+	ret = gpiod_event_recording_read_events(recording, 8, readback, 16);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_unlink(path);
+	g_rmdir(dir);
+}
+
+GPIOD_TEST_CASE(read_unfinished_recording)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_recorder) recorder = NULL;
+	g_autoptr(struct_gpiod_event_recording) recording = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *path = NULL;
+	gint fd, ret;
+
+	path = make_recording_path(&dir);
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	toggle_lines(sim, &offset, 1, 4);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 4);
+	gpiod_test_return_if_failed();
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	g_assert_cmpint(fd, >=, 0);
+	gpiod_test_return_if_failed();
+
+	recorder = gpiod_event_recorder_new(fd, "gpiochip-test", &offset, 1);
+	g_assert_nonnull(recorder);
+	gpiod_test_return_if_failed();
+
+	/* Flushed but never finished - there's no index. */
+	g_assert_cmpint(gpiod_event_recorder_write(recorder, buffer), ==, 0);
+	g_assert_cmpint(gpiod_event_recorder_flush(recorder), ==, 0);
+	close(fd);
+
+	recording = gpiod_event_recording_open(path);
+	g_assert_nonnull(recording);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_event_recording_get_num_events(recording), ==, 4);
+
+	g_unlink(path);
+	g_rmdir(dir);
+}
+
+GPIOD_TEST_CASE(write_event_from_unknown_line)
+{
+	static const guint offset = 3;
+	static const guint other = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_event_recorder) recorder = NULL;
+	gint fd, ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	toggle_lines(sim, &offset, 1, 1);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+
+	fd = open("/dev/null", O_WRONLY);
+	g_assert_cmpint(fd, >=, 0);
+	gpiod_test_return_if_failed();
+
+	recorder = gpiod_event_recorder_new(fd, "gpiochip-test", &other, 1);
+	g_assert_nonnull(recorder);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_recorder_write(recorder, buffer), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	close(fd);
+}
+
+GPIOD_TEST_CASE(open_invalid_recording)
+{
+	g_autoptr(struct_gpiod_event_recording) recording = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *path = NULL;
+	g_autoptr(GError) err = NULL;
+
+	path = make_recording_path(&dir);
+
+	g_file_set_contents(path, "This is not a GPIO event recording file.",
+			    -1, &err);
+	g_assert_no_error(err);
+
+	recording = gpiod_event_recording_open(path);
+	g_assert_null(recording);
+	gpiod_test_expect_errno(EIO);
+
+	g_unlink(path);
+	g_rmdir(dir);
+}
@@ -298,3 +298,86 @@ GPIOD_TEST_CASE(unwatch_and_check_that_no_events_are_generated)
 	ret = gpiod_chip_wait_info_event(chip, 100000000);
 	g_assert_cmpint(ret, ==, 0);
 }
+
+GPIOD_TEST_CASE(watch_multiple_lines)
+{
+	static const guint offsets[] = { 1, 3, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event) event = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_line_info *infos[3];
+	guint i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_watch_lines(chip, offsets, 3, infos);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 3; i++) {
+		g_assert_cmpuint(gpiod_line_info_get_offset(infos[i]), ==,
+				 offsets[i]);
+		gpiod_line_info_free(infos[i]);
+	}
+
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[2],
+							 1, NULL);
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_chip_wait_info_event(chip, 100000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_chip_read_info_event(chip);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_line_info_get_offset(
+				gpiod_info_event_get_line_info(event)), ==, 6);
+}
+
+GPIOD_TEST_CASE(watch_multiple_lines_without_infos)
+{
+	static const guint offsets[] = { 0, 7 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_watch_lines(chip, offsets, 2, NULL);
+	g_assert_cmpint(ret, ==, 0);
+
+	/* Lines are already watched. */
+	ret = gpiod_chip_watch_lines(chip, offsets, 2, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+}
+
+GPIOD_TEST_CASE(watch_multiple_lines_rolls_back_on_failure)
+{
+	static const guint offsets[] = { 2, 4, 8 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_line_info *infos[3];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_watch_lines(chip, offsets, 3, infos);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_null(infos[0]);
+	g_assert_null(infos[1]);
+
+	/* The lines that were watched before the failure were unwatched. */
+	ret = gpiod_chip_watch_lines(chip, offsets, 2, NULL);
+	g_assert_cmpint(ret, ==, 0);
+}
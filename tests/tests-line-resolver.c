@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "line-resolver"
+
+static const GPIOSimLineName first_names[] = {
+	{ .offset = 1, .name = "resolver-foo", },
+	{ .offset = 3, .name = "resolver-dup", },
+	{ }
+};
+
+static const GPIOSimLineName second_names[] = {
+	{ .offset = 0, .name = "resolver-dup", },
+	{ .offset = 6, .name = "resolver-bar", },
+	{ }
+};
+
+static void check_resolver(struct gpiod_line_resolver *resolver,
+			   GPIOSimChip *first, GPIOSimChip *second)
+{
+	unsigned int offset;
+	size_t chip_index;
+
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-foo",
+						 &chip_index, &offset), ==, 1);
+	g_assert_cmpstr(gpiod_line_resolver_get_chip_path(resolver, chip_index),
+			==, g_gpiosim_chip_get_dev_path(first));
+	g_assert_cmpuint(offset, ==, 1);
+
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-bar",
+						 &chip_index, &offset), ==, 1);
+	g_assert_cmpstr(gpiod_line_resolver_get_chip_path(resolver, chip_index),
+			==, g_gpiosim_chip_get_dev_path(second));
+	g_assert_cmpuint(offset, ==, 6);
+
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-none",
+						 NULL, NULL), ==, 0);
+}
+
+GPIOD_TEST_CASE(find_lines_on_multiple_chips)
+{
+	g_autoptr(GVariant) vnames_first =
+			g_gpiosim_package_line_names(first_names);
+	g_autoptr(GVariant) vnames_second =
+			g_gpiosim_package_line_names(second_names);
+	g_autoptr(GPIOSimChip) first = NULL;
+	g_autoptr(GPIOSimChip) second = NULL;
+	g_autoptr(struct_gpiod_line_resolver) resolver = NULL;
+
+	first = g_gpiosim_chip_new("num-lines", 8,
+				   "line-names", vnames_first, NULL);
+	second = g_gpiosim_chip_new("num-lines", 8,
+				    "line-names", vnames_second, NULL);
+
+	resolver = gpiod_line_resolver_new(NULL);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_line_resolver_get_num_chips(resolver), >=, 2);
+	check_resolver(resolver, first, second);
+}
+
+GPIOD_TEST_CASE(duplicate_names_return_first_match)
+{
+	g_autoptr(GVariant) vnames_first =
+			g_gpiosim_package_line_names(first_names);
+	g_autoptr(GVariant) vnames_second =
+			g_gpiosim_package_line_names(second_names);
+	g_autoptr(GPIOSimChip) first = NULL;
+	g_autoptr(GPIOSimChip) second = NULL;
+	g_autoptr(struct_gpiod_line_resolver) resolver = NULL;
+	unsigned int offset;
+	size_t chip_index;
+
+	first = g_gpiosim_chip_new("num-lines", 8,
+				   "line-names", vnames_first, NULL);
+	second = g_gpiosim_chip_new("num-lines", 8,
+				    "line-names", vnames_second, NULL);
+
+	resolver = gpiod_line_resolver_new(NULL);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-dup",
+						 &chip_index, &offset), ==, 2);
+	g_assert_cmpstr(gpiod_line_resolver_get_chip_path(resolver, chip_index),
+			==, g_gpiosim_chip_get_dev_path(first));
+	g_assert_cmpuint(offset, ==, 3);
+}
+
+GPIOD_TEST_CASE(chip_index_out_of_range)
+{
+	g_autoptr(struct_gpiod_line_resolver) resolver = NULL;
+	size_t num_chips;
+
+	resolver = gpiod_line_resolver_new(NULL);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+
+	num_chips = gpiod_line_resolver_get_num_chips(resolver);
+	g_assert_null(gpiod_line_resolver_get_chip_path(resolver, num_chips));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(cache_file)
+{
+	g_autoptr(GVariant) vnames_first =
+			g_gpiosim_package_line_names(first_names);
+	g_autoptr(GVariant) vnames_second =
+			g_gpiosim_package_line_names(second_names);
+	g_autoptr(GPIOSimChip) first = NULL;
+	g_autoptr(GPIOSimChip) second = NULL;
+	g_autoptr(struct_gpiod_line_resolver) resolver = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *path = NULL;
+	g_autoptr(GError) err = NULL;
+
+	dir = g_dir_make_tmp("gpiod-test-XXXXXX", &err);
+	g_assert_no_error(err);
+	gpiod_test_return_if_failed();
+
+	path = g_build_filename(dir, "line-names.cache", NULL);
+
+	first = g_gpiosim_chip_new("num-lines", 8,
+				   "line-names", vnames_first, NULL);
+	second = g_gpiosim_chip_new("num-lines", 8,
+				    "line-names", vnames_second, NULL);
+
+	resolver = gpiod_line_resolver_new(path);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+	g_assert_true(g_file_test(path, G_FILE_TEST_IS_REGULAR));
+	gpiod_line_resolver_free(resolver);
+
+	/* Second run takes the names from the cache. */
+	resolver = gpiod_line_resolver_new(path);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+	check_resolver(resolver, first, second);
+	gpiod_line_resolver_free(resolver);
+
+	/* A corrupted cache is ignored and rewritten. */
+	g_assert_true(g_file_set_contents(path, "garbage", -1, &err));
+	g_assert_no_error(err);
+
+	resolver = gpiod_line_resolver_new(path);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+	check_resolver(resolver, first, second);
+
+	g_unlink(path);
+	g_rmdir(dir);
+}
+
+GPIOD_TEST_CASE(stale_cache_is_rescanned)
+{
+	static const GPIOSimLineName other_names[] = {
+		{ .offset = 1, .name = "resolver-other", },
+		{ }
+	};
+
+	g_autoptr(GVariant) vnames = g_gpiosim_package_line_names(first_names);
+	g_autoptr(GVariant) vnames_other =
+			g_gpiosim_package_line_names(other_names);
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_line_resolver) resolver = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *path = NULL;
+	g_autoptr(GError) err = NULL;
+
+	dir = g_dir_make_tmp("gpiod-test-XXXXXX", &err);
+	g_assert_no_error(err);
+	gpiod_test_return_if_failed();
+
+	path = g_build_filename(dir, "line-names.cache", NULL);
+
+	sim = g_gpiosim_chip_new("num-lines", 8, "line-names", vnames, NULL);
+	resolver = gpiod_line_resolver_new(path);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+	gpiod_line_resolver_free(resolver);
+	g_clear_object(&sim);
+
+	/* Same number of lines but different names. */
+	sim = g_gpiosim_chip_new("num-lines", 8,
+				 "line-names", vnames_other, NULL);
+	resolver = gpiod_line_resolver_new(path);
+	g_assert_nonnull(resolver);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-foo",
+						 NULL, NULL), ==, 0);
+	g_assert_cmpint(gpiod_line_resolver_find(resolver, "resolver-other",
+						 NULL, NULL), ==, 1);
+
+	g_unlink(path);
+	g_rmdir(dir);
+}
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-mock.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "mock"
+
+typedef struct gpiod_mock_chip struct_gpiod_mock_chip;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_mock_chip, gpiod_mock_chip_free);
+
+GPIOD_TEST_CASE(open_mock_chip)
+{
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_chip_info) info = NULL;
+
+	mock = gpiod_mock_chip_new(8, "foobar");
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	g_assert_true(gpiod_is_gpiochip_device(gpiod_mock_chip_get_path(mock)));
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	info = gpiod_test_chip_get_info_or_fail(chip);
+
+	g_assert_cmpstr(gpiod_chip_info_get_name(info), ==,
+			gpiod_mock_chip_get_name(mock));
+	g_assert_cmpstr(gpiod_chip_info_get_label(info), ==, "foobar");
+	g_assert_cmpuint(gpiod_chip_info_get_num_lines(info), ==, 8);
+}
+
+GPIOD_TEST_CASE(open_removed_mock_chip)
+{
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_mock_chip *mock;
+	gchar *path;
+
+	mock = gpiod_mock_chip_new(8, NULL);
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	path = g_strdup(gpiod_mock_chip_get_path(mock));
+	gpiod_mock_chip_free(mock);
+
+	chip = gpiod_chip_open(path);
+	g_free(path);
+	g_assert_null(chip);
+	gpiod_test_expect_errno(ENOENT);
+}
+
+GPIOD_TEST_CASE(mock_line_name_and_usage)
+{
+	static const guint offset = 3;
+
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+
+	mock = gpiod_mock_chip_new(8, NULL);
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_mock_chip_set_line_name(mock, offset, "foo"),
+			==, 0);
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "foo"), ==,
+			offset);
+
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+	info = gpiod_test_chip_get_line_info_or_fail(chip, offset);
+
+	g_assert_true(gpiod_line_info_is_used(info));
+	g_assert_cmpstr(gpiod_line_info_get_name(info), ==, "foo");
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_INPUT);
+}
+
+GPIOD_TEST_CASE(mock_set_and_get_values)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret;
+
+	mock = gpiod_mock_chip_new(4, NULL);
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[0],
+							 1, settings);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[1],
+							 1, settings);
+
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_value(request, 0, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(gpiod_mock_chip_get_value(mock, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_mock_chip_set_pull(mock, 1,
+						 GPIOD_LINE_VALUE_ACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_line_request_set_value(request, 1, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EPERM);
+}
+
+GPIOD_TEST_CASE(mock_pull_generates_edge_event)
+{
+	static const guint offset = 2;
+
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	gint ret;
+
+	mock = gpiod_mock_chip_new(4, NULL);
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_request_wait_edge_events(request, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	gpiod_mock_chip_set_pull(mock, offset, GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 4);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, offset);
+	g_assert_cmpuint(gpiod_edge_event_get_global_seqno(event), ==, 1);
+}
+
+GPIOD_TEST_CASE(mock_generate_edges_as_fast_as_read)
+{
+	static const guint offset = 1;
+
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *prev, *curr;
+	gint ret, i;
+
+	mock = gpiod_mock_chip_new(4, NULL);
+	g_assert_nonnull(mock);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(8);
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_mock_chip_generate_edges(mock, offset, 0, 8);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 8);
+	g_assert_cmpint(ret, ==, 8);
+	gpiod_test_return_if_failed();
+
+	for (i = 1; i < 8; i++) {
+		prev = gpiod_edge_event_buffer_get_event(buffer, i - 1);
+		curr = gpiod_edge_event_buffer_get_event(buffer, i);
+
+		g_assert_cmpint(gpiod_edge_event_get_event_type(prev), !=,
+				gpiod_edge_event_get_event_type(curr));
+		g_assert_cmpuint(gpiod_edge_event_get_line_seqno(curr), ==,
+				 gpiod_edge_event_get_line_seqno(prev) + 1);
+	}
+
+	ret = gpiod_line_request_wait_edge_events(request, 0);
+	g_assert_cmpint(ret, ==, 0);
+}
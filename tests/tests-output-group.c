@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "output-group"
+
+GPIOD_TEST_CASE(no_requests)
+{
+	struct gpiod_line_request *requests[1];
+	struct gpiod_output_group *group;
+
+	group = gpiod_output_group_new(requests, 0);
+	g_assert_null(group);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(null_request)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_line_request *requests[2];
+	struct gpiod_output_group *group;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	requests[0] = request;
+	requests[1] = NULL;
+
+	group = gpiod_output_group_new(requests, 2);
+	g_assert_null(group);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(stage_invalid_index)
+{
+	static const guint offset = 3;
+	static const enum gpiod_line_value value = GPIOD_LINE_VALUE_ACTIVE;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_output_group) group = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	group = gpiod_output_group_new(&request, 1);
+	g_assert_nonnull(group);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_output_group_stage_values(group, 1, &value), ==,
+			-1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(apply_to_multiple_chips)
+{
+	static const guint offsets0[] = { 1, 4 };
+	static const guint offset1 = 6;
+	static const enum gpiod_line_value values0[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+	};
+	static const enum gpiod_line_value value1 = GPIOD_LINE_VALUE_ACTIVE;
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_output_group) group = NULL;
+	struct gpiod_line_request *requests[2];
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = gpiod_test_request_lines_or_fail(chip0, offsets0, 2,
+						    GPIOD_LINE_DIRECTION_OUTPUT,
+						    GPIOD_LINE_EDGE_NONE);
+	request1 = gpiod_test_request_lines_or_fail(chip1, &offset1, 1,
+						    GPIOD_LINE_DIRECTION_OUTPUT,
+						    GPIOD_LINE_EDGE_NONE);
+	requests[0] = request0;
+	requests[1] = request1;
+
+	group = gpiod_output_group_new(requests, 2);
+	g_assert_nonnull(group);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_output_group_stage_values(group, 0, values0), ==,
+			0);
+	g_assert_cmpint(gpiod_output_group_stage_values(group, 1, &value1), ==,
+			0);
+	g_assert_cmpint(gpiod_output_group_apply(group), ==, 0);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 1), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 4), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 6), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	g_assert_cmpuint(gpiod_output_group_get_last_skew_ns(group), ==,
+			 gpiod_output_group_get_max_skew_ns(group));
+	g_assert_cmpuint(gpiod_output_group_get_mean_skew_ns(group), ==,
+			 gpiod_output_group_get_max_skew_ns(group));
+}
+
+GPIOD_TEST_CASE(only_staged_requests_are_written)
+{
+	static const guint offset = 2;
+	static const enum gpiod_line_value value = GPIOD_LINE_VALUE_ACTIVE;
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_output_group) group = NULL;
+	struct gpiod_line_request *requests[2];
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = gpiod_test_request_lines_or_fail(chip0, &offset, 1,
+						    GPIOD_LINE_DIRECTION_OUTPUT,
+						    GPIOD_LINE_EDGE_NONE);
+	request1 = gpiod_test_request_lines_or_fail(chip1, &offset, 1,
+						    GPIOD_LINE_DIRECTION_OUTPUT,
+						    GPIOD_LINE_EDGE_NONE);
+	requests[0] = request0;
+	requests[1] = request1;
+
+	group = gpiod_output_group_new(requests, 2);
+	g_assert_nonnull(group);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_output_group_stage_values(group, 1, &value), ==,
+			0);
+	g_assert_cmpint(gpiod_output_group_apply(group), ==, 0);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 2), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 2), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	/* A single request has no skew to speak of. */
+	g_assert_cmpuint(gpiod_output_group_get_max_skew_ns(group), ==, 0);
+
+	/* Nothing staged, nothing to do. */
+	g_assert_cmpint(gpiod_output_group_apply(group), ==, 0);
+}
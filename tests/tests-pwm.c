@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "pwm"
+
+GPIOD_TEST_CASE(invalid_channel_settings)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	pwm = gpiod_pwm_new(request);
+	g_assert_nonnull(pwm);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 3, 1000000, 500000), ==,
+			-1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 2, 1000000, 2000000), ==,
+			-1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_pwm_get_achieved_period_ns(pwm, 3), ==, 0);
+}
+
+GPIOD_TEST_CASE(start_twice)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	pwm = gpiod_pwm_new(request);
+	g_assert_nonnull(pwm);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pwm_start(pwm), ==, 0);
+	g_assert_cmpint(gpiod_pwm_start(pwm), ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+	g_assert_cmpint(gpiod_pwm_stop(pwm), ==, 0);
+}
+
+GPIOD_TEST_CASE(simultaneous_edges_are_coalesced)
+{
+	static const guint offsets[] = { 1, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+	guint64 period;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	pwm = gpiod_pwm_new(request);
+	g_assert_nonnull(pwm);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 1, 10000000, 5000000), ==,
+			0);
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 6, 10000000, 5000000), ==,
+			0);
+
+	g_assert_cmpint(gpiod_pwm_start(pwm), ==, 0);
+	g_usleep(200000);
+	g_assert_cmpint(gpiod_pwm_stop(pwm), ==, 0);
+
+	g_assert_cmpuint(gpiod_pwm_get_num_writes(pwm), >, 0);
+	g_assert_cmpuint(gpiod_pwm_get_num_edges(pwm), ==,
+			 2 * gpiod_pwm_get_num_writes(pwm));
+	g_assert_cmpuint(gpiod_pwm_get_max_jitter_ns(pwm), >=,
+			 gpiod_pwm_get_mean_jitter_ns(pwm));
+
+	period = gpiod_pwm_get_achieved_period_ns(pwm, 1);
+	g_assert_cmpuint(period, >, 9000000);
+	g_assert_cmpuint(period, <, 11000000);
+}
+
+GPIOD_TEST_CASE(constant_duty_cycles)
+{
+	static const guint offsets[] = { 0, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	pwm = gpiod_pwm_new(request);
+	g_assert_nonnull(pwm);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 0, 1000000, 1000000), ==,
+			0);
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 3, 1000000, 0), ==, 0);
+
+	g_assert_cmpint(gpiod_pwm_start(pwm), ==, 0);
+	g_usleep(50000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+
+	g_assert_cmpint(gpiod_pwm_stop(pwm), ==, 0);
+
+	/* Only the initial write, the lines don't change after that. */
+	g_assert_cmpuint(gpiod_pwm_get_num_writes(pwm), ==, 1);
+	g_assert_cmpuint(gpiod_pwm_get_num_edges(pwm), ==, 2);
+}
+
+GPIOD_TEST_CASE(disabled_channel_is_inactive)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_OUTPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	pwm = gpiod_pwm_new(request);
+	g_assert_nonnull(pwm);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 2, 1000000, 1000000), ==,
+			0);
+	g_assert_cmpint(gpiod_pwm_start(pwm), ==, 0);
+	g_usleep(20000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_pwm_set_channel(pwm, 2, 0, 0), ==, 0);
+	g_usleep(20000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+
+	g_assert_cmpint(gpiod_pwm_stop(pwm), ==, 0);
+}
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "quadrature"
+
+static void step(GPIOSimChip *sim, guint offset, GPIOSimPull pull)
+{
+	g_gpiosim_chip_set_pull(sim, offset, pull);
+	g_usleep(5000);
+}
+
+/* One full period of the signals with A leading B: four counts up. */
+static void period_forward(GPIOSimChip *sim, guint a, guint b)
+{
+	step(sim, a, G_GPIOSIM_PULL_UP);
+	step(sim, b, G_GPIOSIM_PULL_UP);
+	step(sim, a, G_GPIOSIM_PULL_DOWN);
+	step(sim, b, G_GPIOSIM_PULL_DOWN);
+}
+
+GPIOD_TEST_CASE(invalid_axis)
+{
+	static const guint offsets[] = { 0, 1, 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_quadrature) quad = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 3,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	quad = gpiod_quadrature_new(request);
+	g_assert_nonnull(quad);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 0, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 0, 5), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 0, 1), ==, 0);
+
+	/* A line can only belong to a single axis. */
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 1, 2), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_quadrature_set_velocity_window(quad, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* Axes which don't exist read as zero. */
+	g_assert_cmpint(gpiod_quadrature_get_position(quad, 1), ==, 0);
+}
+
+GPIOD_TEST_CASE(count_in_reader_thread)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_quadrature) quad = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+
+	quad = gpiod_quadrature_new(request);
+	g_assert_nonnull(quad);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 2, 5), ==, 0);
+	g_assert_cmpint(gpiod_quadrature_start(quad), ==, 0);
+	g_assert_cmpint(gpiod_quadrature_set_velocity_window(quad, 1000000),
+			==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	period_forward(sim, 2, 5);
+	period_forward(sim, 2, 5);
+	g_assert_cmpint(gpiod_quadrature_get_position(quad, 0), ==, 8);
+	g_assert_cmpint(gpiod_quadrature_get_direction(quad, 0), ==, 1);
+
+	/* Swapping the lines runs the same signals backwards. */
+	period_forward(sim, 5, 2);
+	g_assert_cmpint(gpiod_quadrature_get_position(quad, 0), ==, 4);
+	g_assert_cmpint(gpiod_quadrature_get_direction(quad, 0), ==, -1);
+
+	gpiod_quadrature_set_position(quad, 0, 100);
+	step(sim, 2, G_GPIOSIM_PULL_UP);
+	g_assert_cmpint(gpiod_quadrature_get_position(quad, 0), ==, 101);
+
+	g_assert_cmpint(gpiod_quadrature_stop(quad), ==, 0);
+	g_assert_cmpuint(gpiod_quadrature_get_num_illegal(quad, 0), ==, 0);
+}
+
+GPIOD_TEST_CASE(decode_buffer)
+{
+	static const guint offsets[] = { 0, 1, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_quadrature) quad = NULL;
+	gint num;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 3,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_BOTH);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	quad = gpiod_quadrature_new(request);
+	g_assert_nonnull(quad);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 0, 1), ==, 0);
+
+	period_forward(sim, 0, 1);
+	/* Events of lines outside of any axis are ignored. */
+	step(sim, 3, G_GPIOSIM_PULL_UP);
+
+	num = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(num, ==, 5);
+	g_assert_cmpint(gpiod_quadrature_decode(quad, buffer, num), ==, 0);
+
+	g_assert_cmpint(gpiod_quadrature_get_position(quad, 0), ==, 4);
+	g_assert_cmpuint(gpiod_quadrature_get_num_illegal(quad, 0), ==, 0);
+}
+
+GPIOD_TEST_CASE(velocity_with_realtime_clock)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_quadrature) quad = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_line_settings_set_event_clock(settings,
+					    GPIOD_LINE_CLOCK_REALTIME);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+	request = gpiod_test_chip_request_lines_or_fail(chip, NULL, line_cfg);
+
+	quad = gpiod_quadrature_new(request);
+	g_assert_nonnull(quad);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_quadrature_add_axis(quad, 2, 5), ==, 0);
+	g_assert_cmpint(gpiod_quadrature_start(quad), ==, 0);
+
+	/* Steps are 5ms apart, which is well within the default window. */
+	period_forward(sim, 2, 5);
+	period_forward(sim, 2, 5);
+	g_assert_cmpint(gpiod_quadrature_get_velocity(quad, 0), >, 0);
+
+	/* The axis is at rest once no events arrive for a whole window. */
+	g_usleep(50000);
+	g_assert_cmpint(gpiod_quadrature_get_velocity(quad, 0), ==, 0);
+
+	g_assert_cmpint(gpiod_quadrature_stop(quad), ==, 0);
+}
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "reflex"
+
+GPIOD_TEST_CASE(invalid_rules)
+{
+	static const guint input_offset = 1;
+	static const guint output_offset = 5;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_reflex) reflex = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = gpiod_test_request_lines_or_fail(chip, &input_offset, 1,
+						 GPIOD_LINE_DIRECTION_INPUT,
+						 GPIOD_LINE_EDGE_BOTH);
+	output = gpiod_test_request_lines_or_fail(chip, &output_offset, 1,
+						  GPIOD_LINE_DIRECTION_OUTPUT,
+						  GPIOD_LINE_EDGE_NONE);
+
+	reflex = gpiod_reflex_new(input, output);
+	g_assert_nonnull(reflex);
+	gpiod_test_return_if_failed();
+
+	/* Offsets must be part of their requests. */
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 5, GPIOD_LINE_EDGE_RISING,
+					      5, GPIOD_REFLEX_ACTION_SET, 0),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 1, GPIOD_LINE_EDGE_RISING,
+					      1, GPIOD_REFLEX_ACTION_SET, 0),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 1, GPIOD_LINE_EDGE_NONE,
+					      5, GPIOD_REFLEX_ACTION_SET, 0),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* Pulses need a length. */
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 1, GPIOD_LINE_EDGE_RISING,
+					      5, GPIOD_REFLEX_ACTION_PULSE, 0),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_reflex_start(reflex), ==, 0);
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 1, GPIOD_LINE_EDGE_RISING,
+					      5, GPIOD_REFLEX_ACTION_SET, 0),
+			==, -1);
+	gpiod_test_expect_errno(EBUSY);
+	g_assert_cmpint(gpiod_reflex_stop(reflex), ==, 0);
+}
+
+GPIOD_TEST_CASE(follow_and_toggle)
+{
+	static const guint input_offsets[] = { 0, 2 };
+	static const guint output_offsets[] = { 4, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_reflex) reflex = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = gpiod_test_request_lines_or_fail(chip, input_offsets, 2,
+						 GPIOD_LINE_DIRECTION_INPUT,
+						 GPIOD_LINE_EDGE_BOTH);
+	output = gpiod_test_request_lines_or_fail(chip, output_offsets, 2,
+						  GPIOD_LINE_DIRECTION_OUTPUT,
+						  GPIOD_LINE_EDGE_NONE);
+
+	reflex = gpiod_reflex_new(input, output);
+	g_assert_nonnull(reflex);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 0, GPIOD_LINE_EDGE_BOTH,
+					      4, GPIOD_REFLEX_ACTION_FOLLOW, 0),
+			==, 0);
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 2,
+					      GPIOD_LINE_EDGE_FALLING, 6,
+					      GPIOD_REFLEX_ACTION_TOGGLE, 0),
+			==, 0);
+	g_assert_cmpint(gpiod_reflex_start(reflex), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 0, G_GPIOSIM_PULL_UP);
+	g_usleep(10000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 4), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	g_gpiosim_chip_set_pull(sim, 0, G_GPIOSIM_PULL_DOWN);
+	g_usleep(10000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 4), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+
+	/* The rising edge doesn't trigger the toggle. */
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(10000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(10000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_reflex_stop(reflex), ==, 0);
+
+	g_assert_cmpuint(gpiod_reflex_get_num_events(reflex), ==, 4);
+	g_assert_cmpuint(gpiod_reflex_get_num_reactions(reflex), ==, 3);
+	g_assert_cmpuint(gpiod_reflex_get_num_writes(reflex), ==, 3);
+	g_assert_cmpuint(gpiod_reflex_get_max_latency_ns(reflex), >=,
+			 gpiod_reflex_get_mean_latency_ns(reflex));
+
+	gpiod_reflex_reset_stats(reflex);
+	g_assert_cmpuint(gpiod_reflex_get_num_events(reflex), ==, 0);
+	g_assert_cmpuint(gpiod_reflex_get_max_latency_ns(reflex), ==, 0);
+}
+
+GPIOD_TEST_CASE(pulse)
+{
+	static const guint input_offset = 3;
+	static const guint output_offset = 7;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_reflex) reflex = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = gpiod_test_request_lines_or_fail(chip, &input_offset, 1,
+						 GPIOD_LINE_DIRECTION_INPUT,
+						 GPIOD_LINE_EDGE_BOTH);
+	output = gpiod_test_request_lines_or_fail(chip, &output_offset, 1,
+						  GPIOD_LINE_DIRECTION_OUTPUT,
+						  GPIOD_LINE_EDGE_NONE);
+
+	reflex = gpiod_reflex_new(input, output);
+	g_assert_nonnull(reflex);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_reflex_add_rule(reflex, 3, GPIOD_LINE_EDGE_RISING,
+					      7, GPIOD_REFLEX_ACTION_PULSE,
+					      50000000), ==, 0);
+	g_assert_cmpint(gpiod_reflex_start(reflex), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 3, G_GPIOSIM_PULL_UP);
+	g_usleep(10000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 7), ==,
+			G_GPIOSIM_VALUE_ACTIVE);
+
+	g_usleep(100000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 7), ==,
+			G_GPIOSIM_VALUE_INACTIVE);
+
+	g_assert_cmpint(gpiod_reflex_stop(reflex), ==, 0);
+	g_assert_cmpuint(gpiod_reflex_get_num_writes(reflex), ==, 2);
+}
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2025 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <gpiod-test.h>
+#include <gpiod-test-common.h>
+#include <gpiosim-glib.h>
+
+#include "helpers.h"
+
+#define GPIOD_TEST_GROUP "sampler"
+
+GPIOD_TEST_CASE(invalid_period)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_sampler *sampler;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	sampler = gpiod_sampler_new(request, 0, 16);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(capacity_too_large)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_sampler *sampler;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	/* Can't be rounded up to a power of two. */
+	sampler = gpiod_sampler_new(request, 1000000, G_MAXSIZE);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(sample_every_period)
+{
+	static const guint offsets[] = { 1, 4 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_sampler) sampler = NULL;
+	guint64 timestamps[256], values[256];
+	gsize num, i;
+
+	g_gpiosim_chip_set_pull(sim, 4, G_GPIOSIM_PULL_UP);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	sampler = gpiod_sampler_new(request, 1000000, 256);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_sampler_start(sampler), ==, 0);
+	g_usleep(50000);
+	g_assert_cmpint(gpiod_sampler_stop(sampler), ==, 0);
+
+	num = gpiod_sampler_read(sampler, timestamps, values, 256);
+	g_assert_cmpuint(num, >, 1);
+
+	for (i = 0; i < num; i++) {
+		g_assert_cmphex(values[i], ==, 0x2);
+		if (i)
+			g_assert_cmpuint(timestamps[i], >, timestamps[i - 1]);
+	}
+
+	g_assert_cmpuint(gpiod_sampler_get_num_pending(sampler), ==, 0);
+	g_assert_cmpuint(gpiod_sampler_get_num_overruns(sampler), ==, 0);
+}
+
+GPIOD_TEST_CASE(changes_only)
+{
+	static const guint offsets[] = { 0, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_sampler) sampler = NULL;
+	guint64 values[16];
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 2,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	sampler = gpiod_sampler_new(request, 1000000, 16);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_sampler_set_changes_only(sampler, true), ==, 0);
+	g_assert_cmpint(gpiod_sampler_start(sampler), ==, 0);
+	g_assert_cmpint(gpiod_sampler_set_changes_only(sampler, false), ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	g_usleep(30000);
+	g_gpiosim_chip_set_pull(sim, 0, G_GPIOSIM_PULL_UP);
+	g_usleep(30000);
+	g_assert_cmpint(gpiod_sampler_stop(sampler), ==, 0);
+
+	g_assert_cmpuint(gpiod_sampler_read(sampler, NULL, values, 16), ==, 2);
+	g_assert_cmphex(values[0], ==, 0x0);
+	g_assert_cmphex(values[1], ==, 0x1);
+}
+
+struct callback_data {
+	guint num_calls;
+	guint64 changed;
+};
+
+static void change_callback(guint64 timestamp G_GNUC_UNUSED,
+			    guint64 values G_GNUC_UNUSED, guint64 changed,
+			    void *data)
+{
+	struct callback_data *cb_data = data;
+
+	cb_data->num_calls++;
+	cb_data->changed = changed;
+}
+
+GPIOD_TEST_CASE(change_callback)
+{
+	static const guint offsets[] = { 2, 3, 7 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_sampler) sampler = NULL;
+	struct callback_data cb_data = { 0 };
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, offsets, 3,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	sampler = gpiod_sampler_new(request, 1000000, 4);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_sampler_set_change_callback(sampler,
+							  change_callback,
+							  &cb_data), ==, 0);
+	g_assert_cmpint(gpiod_sampler_start(sampler), ==, 0);
+
+	g_usleep(30000);
+	g_gpiosim_chip_set_pull(sim, 7, G_GPIOSIM_PULL_UP);
+	g_usleep(30000);
+	g_assert_cmpint(gpiod_sampler_stop(sampler), ==, 0);
+
+	/* The first sample counts as a change of all lines. */
+	g_assert_cmpuint(cb_data.num_calls, ==, 2);
+	g_assert_cmphex(cb_data.changed, ==, 0x4);
+
+	/* The buffer is too small to hold all samples. */
+	g_assert_cmpuint(gpiod_sampler_get_num_pending(sampler), ==, 4);
+	g_assert_cmpuint(gpiod_sampler_get_num_overruns(sampler), >, 0);
+}
+
+static void stop_callback(guint64 timestamp G_GNUC_UNUSED,
+			  guint64 values G_GNUC_UNUSED,
+			  guint64 changed G_GNUC_UNUSED, void *data)
+{
+	struct gpiod_sampler *sampler = data;
+
+	g_assert_cmpint(gpiod_sampler_stop(sampler), ==, 0);
+}
+
+GPIOD_TEST_CASE(stop_from_callback)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_sampler) sampler = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = gpiod_test_request_lines_or_fail(chip, &offset, 1,
+						   GPIOD_LINE_DIRECTION_INPUT,
+						   GPIOD_LINE_EDGE_NONE);
+
+	sampler = gpiod_sampler_new(request, 1000000, 16);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_sampler_set_change_callback(sampler,
+							  stop_callback,
+							  sampler), ==, 0);
+	g_assert_cmpint(gpiod_sampler_start(sampler), ==, 0);
+
+	g_usleep(30000);
+	g_assert_cmpint(gpiod_sampler_stop(sampler), ==, 0);
+
+	/* Only the first sample was taken before the callback stopped it. */
+	g_assert_cmpuint(gpiod_sampler_get_num_pending(sampler), ==, 1);
+}
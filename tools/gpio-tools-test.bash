@@ -103,6 +103,29 @@ test_gpiodetect_multiple_chips() {
 	status_is 0
 }
 
+test_gpiodetect_multiple_chips_in_order() {
+	gpiosim_chip sim0 num_lines=4
+	gpiosim_chip sim1 num_lines=8
+	gpiosim_chip sim2 num_lines=16
+	gpiosim_chip sim3 num_lines=32
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local sim1=${GPIOSIM_CHIP_NAME[sim1]}
+	local sim2=${GPIOSIM_CHIP_NAME[sim2]}
+	local sim3=${GPIOSIM_CHIP_NAME[sim3]}
+
+	dut_run_redirect gpiodetect "$sim3" "$sim1" "$sim2" "$sim0"
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+	num_lines_is 4
+	regex_matches "^$sim3 .* \(32 lines\)$" "${lines[0]}"
+	regex_matches "^$sim1 .* \(8 lines\)$" "${lines[1]}"
+	regex_matches "^$sim2 .* \(16 lines\)$" "${lines[2]}"
+	regex_matches "^$sim0 .* \(4 lines\)$" "${lines[3]}"
+}
+
 test_gpiodetect_with_nonexistent_chip() {
 	run_prog gpiodetect nonexistent-chip
 
@@ -155,6 +178,40 @@ test_gpioinfo_all_chips_with_some_used_lines() {
 	status_is 0
 }
 
+test_gpioinfo_all_chips_in_order() {
+	gpiosim_chip sim0 num_lines=4
+	gpiosim_chip sim1 num_lines=64
+	gpiosim_chip sim2 num_lines=16
+	gpiosim_chip sim3 num_lines=32
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local sim1=${GPIOSIM_CHIP_NAME[sim1]}
+	local sim2=${GPIOSIM_CHIP_NAME[sim2]}
+	local sim3=${GPIOSIM_CHIP_NAME[sim3]}
+
+	run_prog gpioinfo
+
+	status_is 0
+
+	# chips are scanned in parallel but must be listed in /dev order,
+	# each followed by all of its lines in offset order
+	local chips
+	chips=$(echo "$output" | awk '
+		/ - [0-9]+ lines:$/ {
+			if (chip) print chip, num, ok
+			chip = $1; num = 0; ok = "ok"; next
+		}
+		{ if ($2 != num ":") ok = "bad"; num++ }
+		END { if (chip) print chip, num, ok }' |
+		grep -E "^($sim0|$sim1|$sim2|$sim3) ")
+
+	local expected
+	expected=$(printf "%s\n" "$sim0 4 ok" "$sim1 64 ok" "$sim2 16 ok" \
+			"$sim3 32 ok" | sort -V)
+
+	assertEquals " chips:" "$expected" "$chips"
+}
+
 test_gpioinfo_a_chip() {
 	gpiosim_chip sim0 num_lines=8
 	gpiosim_chip sim1 num_lines=4
@@ -516,6 +573,28 @@ test_gpioget_by_name() {
 	status_is 0
 }
 
+test_gpioget_by_name_with_line_cache() {
+	local cache=$SHUNIT_TMPDIR/line-names.cache
+
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	gpiosim_set_pull sim0 1 pull-up
+
+	GPIOD_LINE_CACHE=$cache run_prog gpioget foo
+
+	output_is "\"foo\"=active"
+	status_is 0
+	assertTrue " cache not written" "[ -s \"$cache\" ]"
+
+	# The second run takes the names from the cache.
+	GPIOD_LINE_CACHE=$cache run_prog gpioget foo
+
+	output_is "\"foo\"=active"
+	status_is 0
+
+	rm -f "$cache"
+}
+
 test_gpioget_by_offset() {
 	gpiosim_chip sim0 num_lines=8
 
@@ -744,6 +823,81 @@ test_gpioget_with_hold_period() {
 	status_is 0
 }
 
+test_gpioget_with_sample_rate() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	gpiosim_set_pull sim0 1 pull-up
+
+	run_prog gpioget --sample-rate=100 --count=5 foo bar
+
+	status_is 0
+	num_lines_is 5
+
+	local line
+	while read -r line; do
+		regex_matches "^[0-9]+\.[0-9]{9} 10$" "$line"
+	done <<< "$output"
+}
+
+test_gpioget_with_sample_rate_and_binary_output() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run_redirect gpioget --sample-rate=100 --count=3 \
+		--output-format=binary --chip "$sim0" 1
+	dut_wait
+	status_is 0
+
+	output=$(head -c 8 "$SHUNIT_TMPDIR/$DUT_OUTPUT")
+	output_is "GPIODSMP"
+
+	# header of three words followed by two words per sample
+	assertEquals " output size:" 72 \
+		"$(stat -c %s "$SHUNIT_TMPDIR/$DUT_OUTPUT")"
+}
+
+test_gpioget_with_invalid_sample_rate() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioget --sample-rate=0 foo
+
+	output_regex_match ".*invalid sample rate: 0"
+	status_is 1
+}
+
+test_gpioget_with_too_high_sample_rate() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioget --sample-rate=2000000000 foo
+
+	output_regex_match ".*invalid sample rate: 2000000000"
+	status_is 1
+}
+
+test_gpioget_with_count_but_no_sample_rate() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioget --count=5 foo
+
+	output_regex_match ".*--count and binary output require --sample-rate"
+	status_is 1
+}
+
+test_gpioget_with_sample_rate_and_numeric() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioget --sample-rate=100 --numeric foo
+
+	output_regex_match ".*--numeric and --unquoted can't be used with --sample-rate"
+	status_is 1
+
+	run_prog gpioget --sample-rate=100 --unquoted foo
+
+	output_regex_match ".*--numeric and --unquoted can't be used with --sample-rate"
+	status_is 1
+}
+
 test_gpioget_with_strict_named_line_check() {
 	gpiosim_chip sim0 num_lines=4 line_name=1:foo line_name=2:bar \
 				      line_name=3:foobar
@@ -1364,6 +1518,285 @@ test_gpioset_toggle_terminated() {
 	status_is 0
 }
 
+test_gpioset_toggle_with_timing_report() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioset --timing-report --toggle 10ms,10ms,10ms,0 foo=1
+
+	status_is 0
+	num_lines_is 11
+	output_regex_match "toggles: 3"
+	output_regex_match ".*period error histogram:.*"
+	gpiosim_check_value sim0 1 0
+}
+
+test_gpioset_waveform_timing_report_skips_zero_periods() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	local waveform=$SHUNIT_TMPDIR/waveform.txt
+
+	echo "0 0x1 0x1" > "$waveform"
+
+	run_prog gpioset --timing-report --waveform "$waveform" foo=0
+
+	status_is 0
+	num_lines_is 3
+	output_regex_match "toggles: 1"
+	output_regex_match "lateness \(us\): mean [0-9.]+, max [0-9.]+"
+}
+
+test_gpioset_toggle_with_sync_outputs() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+	gpiosim_chip sim1 num_lines=8 line_name=3:bar
+
+	run_prog gpioset --sync-outputs --timing-report \
+		--toggle 10ms,10ms,10ms,0 foo=1 bar=0
+
+	status_is 0
+	num_lines_is 12
+	output_regex_match "toggles: 3"
+	output_regex_match ".*chip skew \(us\): last [0-9.]+, mean [0-9.]+, max [0-9.]+"
+	gpiosim_check_value sim0 1 0
+	gpiosim_check_value sim1 3 1
+}
+
+test_gpioset_toggle_with_timing_report_after_SIGTERM() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	dut_run_redirect gpioset --timing-report --toggle 10ms foo=1
+
+	sleep 0.2
+	dut_kill -SIGTERM
+	dut_wait
+
+	status_is 143
+	dut_read_redirect
+	output_regex_match "toggles: [0-9]+"
+}
+
+test_gpioset_with_timing_report_but_no_toggle() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioset --timing-report foo=1
+
+	output_regex_match ".*timing report requires toggle, waveform or script"
+	status_is 1
+}
+
+test_gpioset_with_invalid_realtime_priority() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioset --realtime 0 --toggle 10ms,0 foo=1
+
+	output_regex_match ".*invalid realtime priority: 0"
+	status_is 1
+}
+
+test_gpioset_with_waveform() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	local waveform=$SHUNIT_TMPDIR/waveform.txt
+
+	cat > "$waveform" << EOF
+# time mask bits
+0 0x3 0x1
+300ms 0x3 0x2
+600ms 0x1 0x1
+EOF
+
+	dut_run gpioset --hold-period 300ms --waveform "$waveform" foo=0 bar=0
+
+	gpiosim_wait_value sim0 1 1
+	gpiosim_check_value sim0 4 0
+
+	gpiosim_wait_value sim0 4 1
+	gpiosim_check_value sim0 1 0
+
+	gpiosim_wait_value sim0 1 1
+	gpiosim_check_value sim0 4 1
+
+	dut_wait
+	status_is 0
+}
+
+test_gpioset_with_vcd_waveform() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	local waveform=$SHUNIT_TMPDIR/waveform.vcd
+
+	cat > "$waveform" << 'EOF'
+$timescale 1ms $end
+$scope module fixture $end
+$var wire 1 ! foo $end
+$var wire 1 " bar $end
+$upscope $end
+$enddefinitions $end
+#0
+1!
+0"
+#300
+0!
+1"
+EOF
+
+	dut_run gpioset --hold-period 300ms --waveform "$waveform" foo=0 bar=0
+
+	gpiosim_wait_value sim0 1 1
+	gpiosim_check_value sim0 4 0
+
+	gpiosim_wait_value sim0 4 1
+	gpiosim_check_value sim0 1 0
+
+	dut_wait
+	status_is 0
+}
+
+test_gpioset_with_vcd_waveform_written_by_gpiomon() {
+	gpiosim_chip sim0 num_lines=8 "line_name=1:foo bar"
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local waveform=$SHUNIT_TMPDIR/waveform.vcd
+
+	# gpiomon replaces unsafe chars and names unnamed lines by offset.
+	cat > "$waveform" << 'EOF'
+$timescale 1ms $end
+$scope module gpio $end
+$var wire 1 ! foo_bar $end
+$var wire 1 " line4 $end
+$upscope $end
+$enddefinitions $end
+#0
+1!
+0"
+#300
+0!
+1"
+EOF
+
+	dut_run gpioset --hold-period 300ms --waveform "$waveform" \
+		-c "$sim0" 1=0 4=0
+
+	gpiosim_wait_value sim0 1 1
+	gpiosim_check_value sim0 4 0
+
+	gpiosim_wait_value sim0 4 1
+	gpiosim_check_value sim0 1 0
+
+	dut_wait
+	status_is 0
+}
+
+test_gpioset_with_invalid_waveform() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	local waveform=$SHUNIT_TMPDIR/waveform.txt
+
+	echo "0 0x2 0x2" > "$waveform"
+
+	run_prog gpioset --waveform "$waveform" foo=0
+
+	output_regex_match ".*waveform.txt:1: invalid mask: 0x2"
+	status_is 1
+}
+
+test_gpioset_with_vcd_waveform_time_out_of_range() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	local waveform=$SHUNIT_TMPDIR/waveform.vcd
+
+	cat > "$waveform" << 'EOF'
+$timescale 1s $end
+$var wire 1 ! foo $end
+$enddefinitions $end
+#0
+1!
+#18446744074
+0!
+EOF
+
+	run_prog gpioset --waveform "$waveform" foo=0
+
+	output_regex_match ".*waveform.vcd: VCD time out of range: #18446744074"
+	status_is 1
+}
+
+test_gpioset_with_waveform_and_toggle() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	run_prog gpioset --waveform /dev/null --toggle 1s foo=0
+
+	output_regex_match ".*can't combine toggle with waveform"
+	status_is 1
+}
+
+test_gpioset_with_script() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	local script=$SHUNIT_TMPDIR/script.txt
+
+	cat > "$script" << EOF
+# set both lines at once
+set foo=1 bar=1
+get
+sleep 300ms
+toggle foo
+get foo
+sleep 300ms
+EOF
+
+	dut_run_redirect gpioset --script "$script" foo=0 bar=0
+
+	gpiosim_wait_value sim0 1 1
+	gpiosim_check_value sim0 4 1
+
+	gpiosim_wait_value sim0 1 0
+	gpiosim_check_value sim0 4 1
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+	output_regex_match "\"foo\"=active \"bar\"=active"
+	output_regex_match "\"foo\"=inactive"
+	num_lines_is 2
+}
+
+test_gpioset_with_stdin_batch() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	run_prog gpioset --stdin-batch --unquoted foo=1 bar=0 << EOF
+toggle
+get bar foo
+EOF
+
+	output_is "bar=active foo=inactive"
+	status_is 0
+}
+
+test_gpioset_with_script_quoted_line_names() {
+	gpiosim_chip sim0 num_lines=8 "line_name=1:foo bar" line_name=4:baz
+
+	run_prog gpioset --stdin-batch "\"foo bar\"=0" baz=1 << EOF
+set "foo bar"=1
+toggle baz
+get "foo bar" baz
+EOF
+
+	output_is "\"foo bar\"=active \"baz\"=inactive"
+	status_is 0
+}
+
+test_gpioset_with_invalid_script() {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+
+	run_prog gpioset --stdin-batch foo=1 << EOF
+set foo=0
+toggle bar
+EOF
+
+	output_regex_match ".*<stdin>:2: unknown line: 'bar'"
+	status_is 1
+}
+
 test_gpioset_with_invalid_toggle_period() {
 	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar \
 				      line_name=7:baz
@@ -1854,6 +2287,206 @@ test_gpiomon_with_idle_timeout() {
 	num_lines_is 0
 }
 
+# Print the edge and offset of each event stored in a recording written by
+# gpiomon --output-format=binary, walking the blocks following the header.
+recorded_events() {
+	local -a bytes
+	read -r -a bytes <<< "$(od -An -v -t u1 "$1" | tr '\n' ' ')"
+
+	le32() {
+		echo $((bytes[$1] | bytes[$1 + 1] << 8 | bytes[$1 + 2] << 16 |
+			bytes[$1 + 3] << 24))
+	}
+
+	local num_lines pos num_events size idx i j k
+	num_lines=$(le32 12)
+	pos=$((48 + 4 * num_lines))
+
+	# blocks start with "GBLK"
+	while [ "${bytes[*]:pos:4}" = "71 66 76 75" ]
+	do
+		num_events=$(le32 $((pos + 4)))
+		size=$(le32 $((pos + 8)))
+		i=$((pos + 32))
+
+		for ((j = 0; j < num_events; j++))
+		do
+			# line index and edge, then three varint deltas
+			idx=${bytes[i]}
+			i=$((i + 1))
+			for k in 1 2 3
+			do
+				while ((bytes[i] & 0x80)); do i=$((i + 1)); done
+				i=$((i + 1))
+			done
+
+			if ((idx & 1))
+			then
+				echo "falling $(le32 $((48 + 4 * (idx >> 1))))"
+			else
+				echo "rising $(le32 $((48 + 4 * (idx >> 1))))"
+			fi
+		done
+
+		pos=$((pos + 32 + size))
+	done
+}
+
+test_gpiomon_with_binary_output_format() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run_redirect gpiomon --output-format=binary --num-events=4 \
+		--chip "$sim0" 4
+
+	gpiosim_set_pull sim0 4 pull-up
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-down
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-up
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-down
+	sleep 0.01
+
+	dut_wait
+	status_is 0
+	output=$(head -c 8 "$SHUNIT_TMPDIR/$DUT_OUTPUT")
+	output_is "GPIODREC"
+	output=$(recorded_events "$SHUNIT_TMPDIR/$DUT_OUTPUT")
+	output_is "rising 4
+falling 4
+rising 4
+falling 4"
+}
+
+test_gpiomon_with_binary_output_format_and_no_events() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run_redirect gpiomon --output-format=binary --idle-timeout 10ms \
+		--chip "$sim0" 4
+
+	dut_wait
+	status_is 0
+	output=$(head -c 8 "$SHUNIT_TMPDIR/$DUT_OUTPUT")
+	output_is "GPIODREC"
+	output=$(recorded_events "$SHUNIT_TMPDIR/$DUT_OUTPUT")
+	output_is ""
+}
+
+test_gpiomon_with_vcd_output_format() {
+	gpiosim_chip sim0 num_lines=8 line_name=4:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run_redirect gpiomon --output-format=vcd --num-events=2 \
+		--chip "$sim0" 4 6
+
+	gpiosim_set_pull sim0 4 pull-up
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-down
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+	output_regex_match "\\\$timescale 1ns \\\$end"
+	output_regex_match "\\\$scope module $sim0 \\\$end"
+	output_regex_match "\\\$var wire 1 ! foo \\\$end"
+	output_regex_match "\\\$var wire 1 \" line6 \\\$end"
+	output_regex_match "\\\$enddefinitions \\\$end"
+	num_lines_is 18
+	regex_matches "^0!$" "${lines[11]}"
+	regex_matches "^#[0-9]+$" "${lines[14]}"
+	regex_matches "^1!$" "${lines[15]}"
+	regex_matches "^#[0-9]+$" "${lines[16]}"
+	regex_matches "^0!$" "${lines[17]}"
+}
+
+test_gpiomon_with_stats() {
+	gpiosim_chip sim0 num_lines=8 line_name=4:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run_redirect gpiomon --stats --num-events=4 --chip "$sim0" 4
+
+	gpiosim_set_pull sim0 4 pull-up
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-down
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-up
+	sleep 0.01
+	gpiosim_set_pull sim0 4 pull-down
+	sleep 0.01
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+	regex_matches "^chip +offset +name +events +rising +falling .*" "${lines[0]}"
+	output_regex_match ".*$sim0 +4 foo +4 +2 +2 .* 0"
+}
+
+test_gpiomon_with_threads() {
+	gpiosim_chip sim0 num_lines=4 line_name=1:foo line_name=2:bar
+	gpiosim_chip sim1 num_lines=8 line_name=0:baz line_name=4:xyz
+
+	dut_run gpiomon --banner --threads --format=%l foo bar baz
+	dut_regex_match "Monitoring lines .*"
+
+	gpiosim_set_pull sim0 2 pull-up
+	dut_regex_match "bar"
+	gpiosim_set_pull sim1 0 pull-up
+	dut_regex_match "baz"
+	gpiosim_set_pull sim0 1 pull-up
+	dut_regex_match "foo"
+
+	assert_fail dut_readable
+}
+
+test_gpiomon_with_threads_and_reorder_window() {
+	gpiosim_chip sim0 num_lines=4 line_name=1:foo
+	gpiosim_chip sim1 num_lines=4 line_name=3:bar
+
+	dut_run gpiomon --banner --threads --reorder-window=10ms --format=%l \
+		foo bar
+	dut_regex_match "Monitoring lines .*"
+
+	gpiosim_set_pull sim1 3 pull-up
+	dut_regex_match "bar"
+	gpiosim_set_pull sim0 1 pull-up
+	dut_regex_match "foo"
+
+	assert_fail dut_readable
+}
+
+test_gpiomon_reorder_window_without_threads() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_prog gpiomon --reorder-window=10ms -c "$sim0" 0
+
+	output_regex_match ".*--reorder-window can only be used with --threads"
+	status_is 1
+}
+
+test_gpiomon_with_buffer_size() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run gpiomon --banner --buffer-size=1 --format=%o --chip "$sim0" 4 5
+	dut_regex_match "Monitoring lines .*"
+
+	gpiosim_set_pull sim0 4 pull-up
+	dut_regex_match "4"
+	gpiosim_set_pull sim0 5 pull-up
+	dut_regex_match "5"
+
+	assert_fail dut_readable
+}
+
 test_gpiomon_multiple_lines() {
 	gpiosim_chip sim0 num_lines=8
 
@@ -2092,6 +2725,60 @@ test_gpiomon_with_invalid_idle_timeout() {
 	status_is 1
 }
 
+test_gpiomon_with_invalid_output_format() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_prog gpiomon --output-format=bad -c "$sim0" 0
+
+	output_regex_match ".*invalid output format: bad"
+	status_is 1
+}
+
+test_gpiomon_binary_output_with_multiple_chips() {
+	gpiosim_chip sim0 num_lines=4 line_name=0:foo
+	gpiosim_chip sim1 num_lines=4 line_name=0:bar
+
+	run_prog gpiomon --output-format=binary foo bar
+
+	output_regex_match ".*binary output supports lines from a single chip only"
+	status_is 1
+}
+
+test_gpiomon_vcd_output_with_custom_format() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_prog gpiomon --output-format=vcd --format=%o -c "$sim0" 0
+
+	output_regex_match ".*--format and --banner can't be used with binary or vcd output"
+	status_is 1
+}
+
+test_gpiomon_stats_with_custom_format() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_prog gpiomon --stats --format=%o -c "$sim0" 0
+
+	output_regex_match ".*--stats can't be used with --format.*"
+	status_is 1
+}
+
+test_gpiomon_with_invalid_buffer_size() {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_prog gpiomon --buffer-size=0 -c "$sim0" 0
+
+	output_regex_match ".*invalid buffer size: 0"
+	status_is 1
+}
+
 test_gpiomon_with_custom_format_event_type_offset() {
 	gpiosim_chip sim0 num_lines=8
 
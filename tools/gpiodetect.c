@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
 #include <stdio.h>
@@ -59,66 +60,108 @@ static int parse_config(int argc, char **argv)
 	return optind;
 }
 
-static int print_chip_info(const char *path)
-{
+struct chip_scan {
+	/* path of the chip or NULL if the lookup failed */
+	char *path;
+	const char *id;
+
 	struct gpiod_chip_info *info;
+	bool open_failed;
+	int error;
+};
+
+static void scan_chip(int job, void *data)
+{
+	struct chip_scan *scan = (struct chip_scan *)data + job;
 	struct gpiod_chip *chip;
 
-	chip = gpiod_chip_open(path);
+	if (!scan->path)
+		return;
+
+	chip = gpiod_chip_open(scan->path);
 	if (!chip) {
-		print_perror("unable to open chip '%s'", path);
+		scan->open_failed = true;
+		scan->error = errno;
+		return;
+	}
+
+	scan->info = gpiod_chip_get_info(chip);
+	if (!scan->info)
+		scan->error = errno;
+
+	gpiod_chip_close(chip);
+}
+
+static int print_chip_info(struct chip_scan *scan)
+{
+	if (!scan->path) {
+		print_error("cannot find GPIO chip character device '%s'",
+			    scan->id);
 		return 1;
 	}
 
-	info = gpiod_chip_get_info(chip);
-	if (!info)
-		die_perror("unable to read info for '%s'", path);
+	if (scan->open_failed) {
+		errno = scan->error;
+		print_perror("unable to open chip '%s'", scan->path);
+		return 1;
+	}
 
-	printf("%s [%s] (%zu lines)\n", gpiod_chip_info_get_name(info),
-	       gpiod_chip_info_get_label(info),
-	       gpiod_chip_info_get_num_lines(info));
+	if (!scan->info) {
+		errno = scan->error;
+		die_perror("unable to read info for '%s'", scan->path);
+	}
 
-	gpiod_chip_info_free(info);
-	gpiod_chip_close(chip);
+	printf("%s [%s] (%zu lines)\n", gpiod_chip_info_get_name(scan->info),
+	       gpiod_chip_info_get_label(scan->info),
+	       gpiod_chip_info_get_num_lines(scan->info));
 
 	return 0;
 }
 
 int main(int argc, char **argv)
 {
-	int num_chips, i, ret = EXIT_SUCCESS;
-	char **paths, *path;
+	int num_chips = 0, num_scans, i, ret = EXIT_SUCCESS;
+	struct chip_scan *scans;
+	char **paths = NULL;
 
 	set_prog_name(argv[0]);
 	i = parse_config(argc, argv);
 	argc -= i;
 	argv += i;
 
-	if (argc == 0) {
+	if (argc == 0)
 		num_chips = all_chip_paths(&paths);
-		for (i = 0; i < num_chips; i++) {
-			if (print_chip_info(paths[i]))
-				ret = EXIT_FAILURE;
 
-			free(paths[i]);
-		}
+	num_scans = num_chips + argc;
+	scans = calloc(num_scans, sizeof(*scans));
+	if (num_scans && !scans)
+		die("out of memory");
 
-		free(paths);
-	}
+	for (i = 0; i < num_chips; i++)
+		scans[i].path = paths[i];
 
 	for (i = 0; i < argc; i++) {
-		if (chip_path_lookup(argv[i], &path)) {
-			if (print_chip_info(path))
-				ret = EXIT_FAILURE;
-
-			free(path);
-		} else {
-			print_error(
-				"cannot find GPIO chip character device '%s'",
-				argv[i]);
+		scans[num_chips + i].id = argv[i];
+		if (!chip_path_lookup(argv[i], &scans[num_chips + i].path))
+			scans[num_chips + i].path = NULL;
+	}
+
+	/*
+	 * Reading the info may take a while for chips behind slow buses, so
+	 * scan them concurrently and only print the results in order.
+	 */
+	run_parallel(num_scans, scan_chip, scans);
+
+	for (i = 0; i < num_scans; i++) {
+		if (print_chip_info(&scans[i]))
 			ret = EXIT_FAILURE;
-		}
+
+		gpiod_chip_info_free(scans[i].info);
+		free(scans[i].path);
 	}
 
+	free(scans);
+	free(paths);
+
 	return ret;
 }
@@ -2,15 +2,30 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <endian.h>
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "tools-common.h"
 
+#define SAMPLE_BINARY_MAGIC		"GPIODSMP"
+#define SAMPLE_BINARY_MAX_LINES		64
+/* flush the sample output at least this often */
+#define SAMPLE_FLUSH_INTERVAL_NS	100000000ULL
+
+enum {
+	OUTPUT_FORMAT_TEXT = 0,
+	OUTPUT_FORMAT_BINARY,
+};
+
 struct config {
 	bool active_low;
 	bool by_name;
@@ -20,6 +35,9 @@ struct config {
 	enum gpiod_line_bias bias;
 	enum gpiod_line_direction direction;
 	unsigned long long hold_period_us;
+	unsigned int sample_rate;
+	unsigned long long count;
+	int output_format;
 	const char *chip_id;
 	const char *consumer;
 };
@@ -39,16 +57,71 @@ static void print_help(void)
 	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
 	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
 	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpioget')\n");
+	printf("      --count <num>\texit after taking num samples\n");
 	printf("  -h, --help\t\tdisplay this help and exit\n");
 	printf("  -l, --active-low\ttreat the line as active low\n");
 	printf("  -p, --hold-period <period>\n");
 	printf("\t\t\twait between requesting the lines and reading the values\n");
 	printf("      --numeric\t\tdisplay line values as '0' (inactive) or '1' (active)\n");
+	printf("      --output-format <format>\n");
+	printf("\t\t\tspecify the output format of samples\n");
+	printf("\t\t\tPossible values: 'text', 'binary'.\n");
+	printf("\t\t\t(default is 'text')\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
+	printf("      --sample-rate <hz>\n");
+	printf("\t\t\tkeep the lines requested and sample them at the given rate\n");
 	printf("      --unquoted\tdon't quote line names\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
 	print_chip_help();
 	print_period_help();
+	printf("\n");
+	printf("Sampling:\n");
+	printf("    Samples are taken on absolute deadlines until the count is reached or\n");
+	printf("    gpioget is terminated. In text format each sample is printed as:\n");
+	printf("\n");
+	printf("        <timestamp> <values>\n");
+	printf("\n");
+	printf("    with the CLOCK_MONOTONIC timestamp in seconds and the numeric values of\n");
+	printf("    the lines in the order given on the command line.\n");
+	printf("    The binary format starts with the '%s' magic, followed by the\n",
+	       SAMPLE_BINARY_MAGIC);
+	printf("    sampling period in nanoseconds and the number of lines, then has one\n");
+	printf("    record per sample holding the timestamp in nanoseconds and a bitmap of\n");
+	printf("    the values. All fields are 64-bit little-endian.\n");
+	printf("    Missed deadlines are reported at exit.\n");
+}
+
+static int parse_output_format_or_die(const char *option)
+{
+	if (strcmp(option, "binary") == 0)
+		return OUTPUT_FORMAT_BINARY;
+	if (strcmp(option, "text") != 0)
+		die("invalid output format: %s", option);
+
+	return OUTPUT_FORMAT_TEXT;
+}
+
+static unsigned int parse_sample_rate_or_die(const char *option)
+{
+	int rate = parse_uint(option);
+
+	/* Higher rates would round the sampling period down to 0. */
+	if (rate <= 0 || rate > 1000000000)
+		die("invalid sample rate: %s", option);
+
+	return rate;
+}
+
+static unsigned long long parse_count_or_die(const char *option)
+{
+	unsigned long long count;
+	char *end;
+
+	count = strtoull(option, &end, 10);
+	if (*end != '\0' || !count || option[0] == '-')
+		die("invalid count: %s", option);
+
+	return count;
 }
 
 static int parse_config(int argc, char **argv, struct config *cfg)
@@ -60,9 +133,12 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "by-name",	no_argument,		NULL,	'B' },
 		{ "chip",	required_argument,	NULL,	'c' },
 		{ "consumer",	required_argument,	NULL,	'C' },
+		{ "count",	required_argument,	NULL,	'n' },
 		{ "help",	no_argument,		NULL,	'h' },
 		{ "hold-period", required_argument,	NULL,	'p' },
 		{ "numeric",	no_argument,		NULL,	'N' },
+		{ "output-format", required_argument,	NULL,	'O' },
+		{ "sample-rate", required_argument,	NULL,	'S' },
 		{ "strict",	no_argument,		NULL,	's' },
 		{ "unquoted",	no_argument,		NULL,	'Q' },
 		{ "version",	no_argument,		NULL,	'v' },
@@ -101,9 +177,15 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'l':
 			cfg->active_low = true;
 			break;
+		case 'n':
+			cfg->count = parse_count_or_die(optarg);
+			break;
 		case 'N':
 			cfg->numeric = true;
 			break;
+		case 'O':
+			cfg->output_format = parse_output_format_or_die(optarg);
+			break;
 		case 'p':
 			cfg->hold_period_us = parse_period_or_die(optarg);
 			break;
@@ -113,6 +195,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 's':
 			cfg->strict = true;
 			break;
+		case 'S':
+			cfg->sample_rate = parse_sample_rate_or_die(optarg);
+			break;
 		case 'h':
 			print_help();
 			exit(EXIT_SUCCESS);
@@ -128,13 +213,119 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		}
 	}
 
+	if (!cfg->sample_rate &&
+	    (cfg->count || cfg->output_format == OUTPUT_FORMAT_BINARY))
+		die("--count and binary output require --sample-rate");
+
+	/* Samples carry no line names and always show the values as digits. */
+	if (cfg->sample_rate && (cfg->numeric || cfg->unquoted))
+		die("--numeric and --unquoted can't be used with --sample-rate");
+
 	return optind;
 }
 
+static void append_le64(struct output_buffer *out, uint64_t val)
+{
+	val = htole64(val);
+	output_buffer_append(out, (const char *)&val, sizeof(val));
+}
+
+static void append_sample(struct output_buffer *out, int format,
+			  struct line_resolver *resolver, uint64_t timestamp)
+{
+	uint64_t bits = 0;
+	int i;
+
+	if (format == OUTPUT_FORMAT_BINARY) {
+		for (i = 0; i < resolver->num_lines; i++)
+			if (resolver->lines[i].value)
+				bits |= 1ULL << i;
+
+		append_le64(out, timestamp);
+		append_le64(out, bits);
+		return;
+	}
+
+	output_buffer_append_event_time(out, timestamp, 0);
+	output_buffer_append_char(out, ' ');
+	for (i = 0; i < resolver->num_lines; i++)
+		output_buffer_append_char(out, '0' + resolver->lines[i].value);
+	output_buffer_append_char(out, '\n');
+}
+
+/*
+ * Sample the lines on absolute deadlines, reading all lines of a chip with
+ * a single call. Deadlines which passed before the previous sample was done
+ * are skipped rather than sampled late in a burst, and counted as missed.
+ */
+static void sample_lines(struct config *cfg,
+			 struct gpiod_line_request **requests,
+			 struct line_resolver *resolver,
+			 enum gpiod_line_value *values)
+{
+	uint64_t period_ns = 1000000000ULL / cfg->sample_rate;
+	unsigned long long taken = 0, missed = 0, skipped;
+	uint64_t deadline, now, timestamp, last_flush;
+	struct output_buffer out;
+	int i;
+
+	output_buffer_init(&out);
+
+	if (cfg->output_format == OUTPUT_FORMAT_BINARY) {
+		output_buffer_append(&out, SAMPLE_BINARY_MAGIC,
+				     strlen(SAMPLE_BINARY_MAGIC));
+		append_le64(&out, period_ns);
+		append_le64(&out, resolver->num_lines);
+	}
+
+	deadline = last_flush = clock_ns(CLOCK_MONOTONIC);
+
+	while (!cfg->count || taken < cfg->count) {
+		if (!wait_deadline(deadline))
+			break;
+
+		timestamp = clock_ns(CLOCK_MONOTONIC);
+
+		for (i = 0; i < resolver->num_chips; i++) {
+			if (gpiod_line_request_get_values(requests[i], values))
+				die_perror("unable to read GPIO line values");
+
+			set_line_values(resolver, i, values);
+		}
+
+		append_sample(&out, cfg->output_format, resolver, timestamp);
+		taken++;
+
+		now = clock_ns(CLOCK_MONOTONIC);
+		if (output_buffer_is_full(&out) ||
+		    now - last_flush >= SAMPLE_FLUSH_INTERVAL_NS) {
+			output_buffer_flush(&out);
+			fflush(stdout);
+			last_flush = now;
+		}
+
+		deadline += period_ns;
+		if (now > deadline) {
+			skipped = (now - deadline) / period_ns + 1;
+			missed += skipped;
+			deadline += skipped * period_ns;
+		}
+	}
+
+	output_buffer_flush(&out);
+	fflush(stdout);
+	output_buffer_release(&out);
+
+	if (missed)
+		print_error("%llu of %llu sample deadlines missed",
+			    missed, missed + taken);
+}
+
 int main(int argc, char **argv)
 {
 	struct gpiod_line_settings *settings;
 	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_request **requests;
 	struct gpiod_line_request *request;
 	struct gpiod_line_config *line_cfg;
 	struct line_resolver *resolver;
@@ -158,9 +349,15 @@ int main(int argc, char **argv)
 				 cfg.by_name);
 	validate_resolution(resolver, cfg.chip_id);
 
+	if (cfg.output_format == OUTPUT_FORMAT_BINARY &&
+	    resolver->num_lines > SAMPLE_BINARY_MAX_LINES)
+		die("binary output supports at most %d lines",
+		    SAMPLE_BINARY_MAX_LINES);
+
 	offsets = calloc(resolver->num_lines, sizeof(*offsets));
 	values = calloc(resolver->num_lines, sizeof(*values));
-	if (!offsets || !values)
+	requests = calloc(resolver->num_chips, sizeof(*requests));
+	if (!offsets || !values || !requests)
 		die("out of memory");
 
 	settings = gpiod_line_settings_new();
@@ -204,6 +401,12 @@ int main(int argc, char **argv)
 		if (!request)
 			die_perror("unable to request lines");
 
+		if (cfg.sample_rate) {
+			requests[i] = request;
+			gpiod_chip_close(chip);
+			continue;
+		}
+
 		if (cfg.hold_period_us)
 			sleep_us(cfg.hold_period_us);
 
@@ -217,6 +420,22 @@ int main(int argc, char **argv)
 		gpiod_chip_close(chip);
 	}
 
+	if (cfg.sample_rate) {
+		if (cfg.hold_period_us)
+			sleep_us(cfg.hold_period_us);
+
+		setup_signals(NULL);
+		sample_lines(&cfg, requests, resolver, values);
+
+		for (i = 0; i < resolver->num_chips; i++)
+			gpiod_line_request_release(requests[i]);
+
+		if (caught_signal)
+			reraise_signal(caught_signal);
+
+		goto out;
+	}
+
 	fmt = cfg.unquoted ? "%s=%s" : "\"%s\"=%s";
 
 	for (i = 0; i < resolver->num_lines; i++) {
@@ -232,6 +451,8 @@ int main(int argc, char **argv)
 	}
 	printf("\n");
 
+out:
+	free(requests);
 	free_line_resolver(resolver);
 	gpiod_request_config_free(req_cfg);
 	gpiod_line_config_free(line_cfg);
@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
 #include <stdarg.h>
@@ -166,22 +167,107 @@ static void print_line_info(struct gpiod_line_info *info, bool unquoted_strings)
 	print_line_attributes(info, unquoted_strings);
 }
 
+struct chip_scan {
+	const char *path;
+	struct gpiod_chip *chip;
+	struct gpiod_chip_info *info;
+
+	/*
+	 * Info of all lines, read up front when all of them are going to be
+	 * needed anyway, otherwise NULL and the lines are read on demand.
+	 */
+	struct gpiod_line_info **lines;
+	bool read_lines;
+	unsigned int num_read;
+
+	/* errno of the first operation that failed */
+	int error;
+};
+
+static void scan_chip(int job, void *data)
+{
+	struct chip_scan *scan = (struct chip_scan *)data + job;
+	size_t num_lines;
+
+	scan->chip = gpiod_chip_open(scan->path);
+	if (!scan->chip) {
+		scan->error = errno;
+		return;
+	}
+
+	scan->info = gpiod_chip_get_info(scan->chip);
+	if (!scan->info) {
+		scan->error = errno;
+		return;
+	}
+
+	if (!scan->read_lines)
+		return;
+
+	num_lines = gpiod_chip_info_get_num_lines(scan->info);
+
+	/* Without the memory for it, just read the lines on demand. */
+	scan->lines = calloc(num_lines ?: 1, sizeof(*scan->lines));
+	if (!scan->lines)
+		return;
+
+	for (; scan->num_read < num_lines; scan->num_read++) {
+		scan->lines[scan->num_read] =
+			gpiod_chip_get_line_info(scan->chip, scan->num_read);
+		if (!scan->lines[scan->num_read]) {
+			scan->error = errno;
+			break;
+		}
+	}
+}
+
+static struct gpiod_line_info *scan_get_line_info(struct chip_scan *scan,
+						  unsigned int offset)
+{
+	struct gpiod_line_info *info;
+
+	if (!scan->lines)
+		return gpiod_chip_get_line_info(scan->chip, offset);
+
+	if (offset >= scan->num_read) {
+		errno = scan->error;
+		return NULL;
+	}
+
+	/* The caller takes ownership. */
+	info = scan->lines[offset];
+	scan->lines[offset] = NULL;
+
+	return info;
+}
+
+static void scan_release(struct chip_scan *scan)
+{
+	unsigned int i;
+
+	if (scan->lines) {
+		for (i = 0; i < scan->num_read; i++)
+			gpiod_line_info_free(scan->lines[i]);
+
+		free(scan->lines);
+	}
+
+	gpiod_chip_info_free(scan->info);
+	if (scan->chip)
+		gpiod_chip_close(scan->chip);
+}
+
 /*
  * based on resolve_lines, but prints lines immediately rather than collecting
  * details in the resolver.
  */
-static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
+static void list_lines(struct line_resolver *resolver, struct chip_scan *scan,
 		       int chip_num, struct config *cfg)
 {
-	struct gpiod_chip_info *chip_info;
+	struct gpiod_chip_info *chip_info = scan->info;
 	struct gpiod_line_info *info;
 	int offset, num_lines;
 
-	chip_info = gpiod_chip_get_info(chip);
-	if (!chip_info)
-		die_perror("unable to read info from chip %s",
-			   gpiod_chip_get_path(chip));
-
 	num_lines = gpiod_chip_info_get_num_lines(chip_info);
 
 	if ((chip_num == 0) && (cfg->chip_id && !cfg->by_name))
@@ -190,7 +276,7 @@ static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
 	for (offset = 0; ((offset < num_lines) &&
 			  !(resolver->num_lines && resolve_done(resolver)));
 	     offset++) {
-		info = gpiod_chip_get_line_info(chip, offset);
+		info = scan_get_line_info(scan, offset);
 		if (!info)
 			die_perror("unable to read info for line %d from %s",
 				   offset, gpiod_chip_info_get_name(chip_info));
@@ -219,15 +305,13 @@ static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
 		gpiod_line_info_free(info);
 		resolver->num_found++;
 	}
-
-	gpiod_chip_info_free(chip_info);
 }
 
 int main(int argc, char **argv)
 {
 	struct line_resolver *resolver = NULL;
 	int num_chips, i, ret = EXIT_SUCCESS;
-	struct gpiod_chip *chip;
+	struct chip_scan *scans;
 	struct config cfg;
 	char **paths;
 
@@ -246,12 +330,33 @@ int main(int argc, char **argv)
 	resolver = resolver_init(argc, argv, num_chips, cfg.strict,
 				 cfg.by_name);
 
+	scans = calloc(num_chips ?: 1, sizeof(*scans));
+	if (!scans)
+		die("out of memory");
+
 	for (i = 0; i < num_chips; i++) {
-		chip = gpiod_chip_open(paths[i]);
-		if (chip) {
-			list_lines(resolver, chip, i, &cfg);
-			gpiod_chip_close(chip);
+		scans[i].path = paths[i];
+		/* Otherwise the search may stop before reaching all lines. */
+		scans[i].read_lines = !argc || cfg.strict;
+	}
+
+	/*
+	 * Chips behind slow buses may take milliseconds per line, so scan
+	 * them concurrently, then resolve and print in chip order.
+	 */
+	run_parallel(num_chips, scan_chip, scans);
+
+	for (i = 0; i < num_chips; i++) {
+		if (scans[i].chip && !scans[i].info) {
+			errno = scans[i].error;
+			die_perror("unable to read info from chip %s",
+				   paths[i]);
+		}
+
+		if (scans[i].chip) {
+			list_lines(resolver, &scans[i], i, &cfg);
 		} else {
+			errno = scans[i].error;
 			print_perror("unable to open chip '%s'", paths[i]);
 
 			if (cfg.chip_id)
@@ -259,8 +364,11 @@ int main(int argc, char **argv)
 
 			ret = EXIT_FAILURE;
 		}
+
+		scan_release(&scans[i]);
 		free(paths[i]);
 	}
+	free(scans);
 	free(paths);
 
 	validate_resolution(resolver, cfg.chip_id);
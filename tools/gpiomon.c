@@ -2,18 +2,43 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <poll.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "tools-common.h"
 
 #define EVENT_BUF_SIZE 32
+/* Rough upper bound of a line of text output, used to size stdout buffer. */
+#define EVENT_TEXT_SIZE 128
+/* Default period between statistics updates. */
+#define STATS_INTERVAL_US 1000000
+/* Number of update periods the average rate is calculated over. */
+#define STATS_WINDOW 10
+/* Number of event buffers each reader thread can queue ahead of the output. */
+#define READER_NUM_BUFFERS 4
+/*
+ * Default time to hold back events from one chip waiting for older ones from
+ * the others, as they may have just arrived and not been read yet.
+ */
+#define REORDER_WINDOW_US 1000
+
+enum {
+	OUTPUT_FORMAT_TEXT = 0,
+	OUTPUT_FORMAT_BINARY,
+	OUTPUT_FORMAT_VCD,
+};
 
 struct config {
 	bool active_low;
@@ -32,6 +57,12 @@ struct config {
 	enum gpiod_line_clock event_clock;
 	int timestamp_fmt;
 	long long idle_timeout;
+	int output_format;
+	unsigned int buffer_size;
+	bool stats;
+	long long stats_interval;
+	bool threads;
+	long long reorder_window_us;
 };
 
 static void print_help(void)
@@ -49,6 +80,9 @@ static void print_help(void)
 	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
 	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
 	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpiomon')\n");
+	printf("      --buffer-size <num>\n");
+	printf("\t\t\tmaximum number of events read from the kernel at once\n");
+	printf("\t\t\t(default is %d)\n", EVENT_BUF_SIZE);
 	printf("  -e, --edges <edges>\tspecify the edges to monitor\n");
 	printf("\t\t\tPossible values: 'falling', 'rising', 'both'.\n");
 	printf("\t\t\t(default is 'both')\n");
@@ -66,10 +100,28 @@ static void print_help(void)
 	printf("      --localtime\tformat event timestamps as local time\n");
 	printf("  -n, --num-events <num>\n");
 	printf("\t\t\texit after processing num events\n");
+	printf("      --output-format <format>\n");
+	printf("\t\t\tspecify the output format\n");
+	printf("\t\t\tPossible values: 'text', 'binary', 'vcd'.\n");
+	printf("\t\t\t(default is 'text')\n");
+	printf("\t\t\tThe binary format is the libgpiod edge event recording\n");
+	printf("\t\t\tformat and only supports lines from a single chip.\n");
+	printf("\t\t\tThe vcd format is a Value Change Dump with a wire per\n");
+	printf("\t\t\tline and timestamps in ns from the start of monitoring.\n");
 	printf("  -p, --debounce-period <period>\n");
 	printf("\t\t\tdebounce the line(s) with the specified period\n");
 	printf("  -q, --quiet\t\tdon't generate any output\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
+	printf("      --threads\t\tread the events of each chip in a separate thread and\n");
+	printf("\t\t\tmerge them in timestamp order\n");
+	printf("      --reorder-window <period>\n");
+	printf("\t\t\thow long to hold back events of one chip waiting for\n");
+	printf("\t\t\tolder events of the others with --threads\n");
+	printf("\t\t\t(default is 1ms)\n");
+	printf("      --stats\t\tperiodically print per-line statistics instead of\n");
+	printf("\t\t\tthe events\n");
+	printf("      --stats-interval <period>\n");
+	printf("\t\t\tthe period between statistics updates (default is 1s)\n");
 	printf("      --unquoted\tdon't quote line or consumer names\n");
 	printf("      --utc\t\tformat event timestamps as UTC (default for 'realtime')\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
@@ -111,6 +163,18 @@ static int parse_event_clock_or_die(const char *option)
 	return GPIOD_LINE_CLOCK_MONOTONIC;
 }
 
+static int parse_output_format_or_die(const char *option)
+{
+	if (strcmp(option, "binary") == 0)
+		return OUTPUT_FORMAT_BINARY;
+	if (strcmp(option, "vcd") == 0)
+		return OUTPUT_FORMAT_VCD;
+	if (strcmp(option, "text") != 0)
+		die("invalid output format: %s", option);
+
+	return OUTPUT_FORMAT_TEXT;
+}
+
 static int parse_config(int argc, char **argv, struct config *cfg)
 {
 	static const char *const shortopts = "+b:c:C:e:E:hF:ln:p:qshv";
@@ -119,6 +183,7 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "active-low",	no_argument,	NULL,		'l' },
 		{ "banner",	no_argument,	NULL,		'-'},
 		{ "bias",	required_argument, NULL,	'b' },
+		{ "buffer-size", required_argument, NULL,	'Z' },
 		{ "by-name",	no_argument,	NULL,		'B'},
 		{ "chip",	required_argument, NULL,	'c' },
 		{ "consumer",	required_argument, NULL,	'C' },
@@ -130,9 +195,14 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "idle-timeout",	required_argument,	NULL,		'i' },
 		{ "localtime",	no_argument,	&cfg->timestamp_fmt,	2 },
 		{ "num-events",	required_argument, NULL,	'n' },
+		{ "output-format", required_argument, NULL,	'O' },
 		{ "quiet",	no_argument,	NULL,		'q' },
+		{ "reorder-window", required_argument, NULL,	'W' },
 		{ "silent",	no_argument,	NULL,		'q' },
+		{ "stats",	no_argument,	NULL,		'T' },
+		{ "stats-interval", required_argument, NULL,	'I' },
 		{ "strict",	no_argument,	NULL,		's' },
+		{ "threads",	no_argument,	NULL,		't' },
 		{ "unquoted",	no_argument,	NULL,		'Q' },
 		{ "utc",	no_argument,	&cfg->timestamp_fmt,	1 },
 		{ "version",	no_argument,	NULL,		'v' },
@@ -145,6 +215,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 	cfg->edges = GPIOD_LINE_EDGE_BOTH;
 	cfg->consumer = "gpiomon";
 	cfg->idle_timeout = -1;
+	cfg->buffer_size = EVENT_BUF_SIZE;
+	cfg->stats_interval = STATS_INTERVAL_US;
+	cfg->reorder_window_us = -1;
 
 	for (;;) {
 		optc = getopt_long(argc, argv, shortopts, longopts, &opti);
@@ -179,12 +252,20 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'i':
 			cfg->idle_timeout = parse_period_or_die(optarg);
 			break;
+		case 'I':
+			cfg->stats_interval = parse_period_or_die(optarg);
+			if (cfg->stats_interval == 0)
+				die("invalid period: %s", optarg);
+			break;
 		case 'l':
 			cfg->active_low = true;
 			break;
 		case 'n':
 			cfg->events_wanted = parse_uint_or_die(optarg);
 			break;
+		case 'O':
+			cfg->output_format = parse_output_format_or_die(optarg);
+			break;
 		case 'p':
 			cfg->debounce_period_us = parse_period_or_die(optarg);
 			break;
@@ -197,6 +278,20 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 's':
 			cfg->strict = true;
 			break;
+		case 't':
+			cfg->threads = true;
+			break;
+		case 'T':
+			cfg->stats = true;
+			break;
+		case 'W':
+			cfg->reorder_window_us = parse_period_or_die(optarg);
+			break;
+		case 'Z':
+			cfg->buffer_size = parse_uint_or_die(optarg);
+			if (cfg->buffer_size == 0)
+				die("invalid buffer size: %s", optarg);
+			break;
 		case 'h':
 			print_help();
 			exit(EXIT_SUCCESS);
@@ -223,6 +318,24 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		cfg->timestamp_fmt = 1;
 	}
 
+	if (cfg->output_format != OUTPUT_FORMAT_TEXT &&
+	    (cfg->fmt || cfg->banner))
+		die("--format and --banner can't be used with binary or vcd output");
+
+	if (cfg->stats && (cfg->fmt || cfg->quiet ||
+			   cfg->output_format != OUTPUT_FORMAT_TEXT))
+		die("--stats can't be used with --format, --quiet, binary or vcd output");
+
+	if (cfg->threads &&
+	    (cfg->stats || cfg->output_format != OUTPUT_FORMAT_TEXT))
+		die("--threads can't be used with --stats, binary or vcd output");
+
+	if (cfg->reorder_window_us >= 0 && !cfg->threads)
+		die("--reorder-window can only be used with --threads");
+
+	if (cfg->reorder_window_us < 0)
+		cfg->reorder_window_us = REORDER_WINDOW_US;
+
 	return optind;
 }
 
@@ -242,80 +355,68 @@ static void print_banner(int num_lines, char **lines)
 	}
 }
 
+#define FORMAT_CONVERSIONS "ceElLoSU"
+
 static void event_print_formatted(struct gpiod_edge_event *event,
 				  struct line_resolver *resolver, int chip_num,
-				  struct config *cfg)
+				  struct output_format *format,
+				  struct output_buffer *out)
 {
-	const char *lname, *prev, *curr;
+	struct format_op *op;
 	unsigned int offset;
+	const char *lname;
 	uint64_t evtime;
-	int evtype;
-	char fmt;
+	int evtype, i;
 
 	offset = gpiod_edge_event_get_line_offset(event);
 	evtime = gpiod_edge_event_get_timestamp_ns(event);
 	evtype = gpiod_edge_event_get_event_type(event);
 
-	for (prev = curr = cfg->fmt;;) {
-		curr = strchr(curr, '%');
-		if (!curr) {
-			fputs(prev, stdout);
-			break;
-		}
-
-		if (prev != curr)
-			fwrite(prev, curr - prev, 1, stdout);
+	for (i = 0; i < format->num_ops; i++) {
+		op = &format->ops[i];
 
-		fmt = *(curr + 1);
-
-		switch (fmt) {
+		switch (op->conv) {
 		case 'c':
-			fputs(get_chip_name(resolver, chip_num), stdout);
+			output_buffer_append_str(out,
+					get_chip_name(resolver, chip_num));
 			break;
 		case 'e':
-			printf("%d", evtype);
+			output_buffer_append_int(out, evtype);
 			break;
 		case 'E':
 			if (evtype == GPIOD_EDGE_EVENT_RISING_EDGE)
-				fputs("rising", stdout);
+				output_buffer_append(out, "rising", 6);
 			else
-				fputs("falling", stdout);
+				output_buffer_append(out, "falling", 7);
 			break;
 		case 'l':
 			lname = get_line_name(resolver, chip_num, offset);
 			if (!lname)
 				lname = "unnamed";
-			fputs(lname, stdout);
+			output_buffer_append_str(out, lname);
 			break;
 		case 'L':
-			print_event_time(evtime, 2);
+			output_buffer_append_event_time(out, evtime, 2);
 			break;
 		case 'o':
-			printf("%u", offset);
+			output_buffer_append_uint(out, offset);
 			break;
 		case 'S':
-			print_event_time(evtime, 0);
+			output_buffer_append_event_time(out, evtime, 0);
 			break;
 		case 'U':
-			print_event_time(evtime, 1);
-			break;
-		case '%':
-			fputc('%', stdout);
+			output_buffer_append_event_time(out, evtime, 1);
 			break;
-		case '\0':
-			fputc('%', stdout);
-			goto end;
 		default:
-			fwrite(curr, 2, 1, stdout);
+			output_buffer_append(out, op->text, op->len);
 			break;
 		}
-
-		curr += 2;
-		prev = curr;
 	}
 
-end:
-	fputc('\n', stdout);
+	output_buffer_append_char(out, '\n');
+
+	if (output_buffer_is_full(out))
+		output_buffer_flush(out);
 }
 
 static void event_print_human_readable(struct gpiod_edge_event *event,
@@ -340,22 +441,841 @@ static void event_print_human_readable(struct gpiod_edge_event *event,
 	fputc('\n', stdout);
 }
 
+struct line_stats {
+	const char *chip_name;
+	const char *name;
+	unsigned int offset;
+
+	uint64_t events;
+	uint64_t rising;
+	uint64_t falling;
+	/* events lost to kernel buffer overflows, from line_seqno gaps */
+	uint64_t dropped;
+
+	/* the previous event */
+	uint64_t last_ts;
+	unsigned long last_seqno;
+	int last_type;
+
+	/* time between consecutive edges */
+	uint64_t min_interval;
+	uint64_t max_interval;
+	uint64_t total_interval;
+	uint64_t num_intervals;
+
+	/* time spent high and low, from rising/falling edge pairs */
+	uint64_t high_ns;
+	uint64_t low_ns;
+
+	/* event counts of the most recent update periods */
+	unsigned long window[STATS_WINDOW];
+	unsigned long period_events;
+};
+
+struct stats {
+	int num_lines;
+	struct line_stats *lines;
+	/* per chip map from offset to entry in lines, or NULL */
+	struct line_stats ***by_offset;
+	int num_chips;
+
+	uint64_t interval_ns;
+	uint64_t next_update;
+	unsigned int window_pos;
+	unsigned int window_fill;
+	bool redraw;
+};
+
+static struct stats *stats_new(struct line_resolver *resolver,
+			       long long interval_us)
+{
+	struct resolved_line *line;
+	struct line_stats *entry;
+	struct stats *stats;
+	size_t num_offsets;
+	int i;
+
+	stats = calloc(1, sizeof(*stats));
+	if (!stats)
+		die("out of memory");
+
+	stats->num_lines = resolver->num_lines;
+	stats->num_chips = resolver->num_chips;
+	stats->lines = calloc(resolver->num_lines, sizeof(*stats->lines));
+	stats->by_offset = calloc(resolver->num_chips,
+				  sizeof(*stats->by_offset));
+	if (!stats->lines || !stats->by_offset)
+		die("out of memory");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		num_offsets = gpiod_chip_info_get_num_lines(
+						resolver->chips[i].info);
+		stats->by_offset[i] = calloc(num_offsets,
+					     sizeof(*stats->by_offset[i]));
+		if (!stats->by_offset[i])
+			die("out of memory");
+	}
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		line = &resolver->lines[i];
+		entry = &stats->lines[i];
+
+		entry->chip_name = get_chip_name(resolver, line->chip_num);
+		entry->name = get_line_name(resolver, line->chip_num,
+					    line->offset);
+		entry->offset = line->offset;
+		entry->min_interval = UINT64_MAX;
+		stats->by_offset[line->chip_num][line->offset] = entry;
+	}
+
+	stats->interval_ns = interval_us * 1000;
+	stats->next_update = clock_ns(CLOCK_MONOTONIC) + stats->interval_ns;
+	stats->redraw = isatty(STDOUT_FILENO);
+
+	return stats;
+}
+
+static void stats_free(struct stats *stats)
+{
+	int i;
+
+	for (i = 0; i < stats->num_chips; i++)
+		free(stats->by_offset[i]);
+
+	free(stats->by_offset);
+	free(stats->lines);
+	free(stats);
+}
+
+static void stats_add_events(struct stats *stats, int chip_num,
+			     struct gpiod_edge_event_buffer *buffer,
+			     int num_events)
+{
+	struct gpiod_edge_event *event;
+	struct line_stats *line;
+	unsigned long seqno;
+	uint64_t ts, delta;
+	int i, type;
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		line = stats->by_offset[chip_num][
+				gpiod_edge_event_get_line_offset(event)];
+		ts = gpiod_edge_event_get_timestamp_ns(event);
+		type = gpiod_edge_event_get_event_type(event);
+		seqno = gpiod_edge_event_get_line_seqno(event);
+
+		if (type == GPIOD_EDGE_EVENT_RISING_EDGE)
+			line->rising++;
+		else
+			line->falling++;
+
+		if (line->events) {
+			if (seqno > line->last_seqno + 1)
+				line->dropped += seqno - line->last_seqno - 1;
+
+			delta = ts - line->last_ts;
+			if (delta < line->min_interval)
+				line->min_interval = delta;
+			if (delta > line->max_interval)
+				line->max_interval = delta;
+			line->total_interval += delta;
+			line->num_intervals++;
+
+			/*
+			 * Only count time between opposite edges, if an edge
+			 * went missing it's unknown what the level was.
+			 */
+			if (line->last_type == GPIOD_EDGE_EVENT_RISING_EDGE &&
+			    type == GPIOD_EDGE_EVENT_FALLING_EDGE)
+				line->high_ns += delta;
+			else if (line->last_type ==
+					GPIOD_EDGE_EVENT_FALLING_EDGE &&
+				 type == GPIOD_EDGE_EVENT_RISING_EDGE)
+				line->low_ns += delta;
+		}
+
+		line->events++;
+		line->period_events++;
+		line->last_ts = ts;
+		line->last_seqno = seqno;
+		line->last_type = type;
+	}
+}
+
+static void print_interval(uint64_t ns)
+{
+	if (ns < 1000)
+		printf(" %8" PRIu64 "ns", ns);
+	else if (ns < 1000000)
+		printf(" %8.1fus", ns / 1000.0);
+	else if (ns < 1000000000)
+		printf(" %8.1fms", ns / 1000000.0);
+	else
+		printf(" %8.1fs ", ns / 1000000000.0);
+}
+
+static void stats_print(struct stats *stats)
+{
+	unsigned long last, total;
+	struct line_stats *line;
+	double period;
+	unsigned int j;
+	int i;
+
+	if (stats->redraw)
+		fputs("\033[H\033[J", stdout);
+
+	printf("%-16s %6s %-16s %10s %10s %10s %10s %10s %10s %10s %10s %6s %8s\n",
+	       "chip", "offset", "name", "events", "rising", "falling",
+	       "rate/s", "avg/s", "min", "mean", "max", "high%", "dropped");
+
+	period = stats->interval_ns / 1000000000.0;
+
+	for (i = 0; i < stats->num_lines; i++) {
+		line = &stats->lines[i];
+
+		last = 0;
+		total = 0;
+		if (stats->window_fill) {
+			last = line->window[(stats->window_pos + STATS_WINDOW -
+					     1) % STATS_WINDOW];
+			for (j = 0; j < stats->window_fill; j++)
+				total += line->window[j];
+		}
+
+		printf("%-16s %6u %-16s %10" PRIu64 " %10" PRIu64 " %10" PRIu64,
+		       line->chip_name, line->offset,
+		       line->name ?: "unnamed", line->events, line->rising,
+		       line->falling);
+
+		printf(" %10.1f %10.1f", last / period,
+		       stats->window_fill ?
+				total / (period * stats->window_fill) : 0.0);
+
+		if (line->num_intervals) {
+			print_interval(line->min_interval);
+			print_interval(line->total_interval /
+				       line->num_intervals);
+			print_interval(line->max_interval);
+		} else {
+			printf(" %10s %10s %10s", "-", "-", "-");
+		}
+
+		if (line->high_ns + line->low_ns)
+			printf(" %6.1f", 100.0 * line->high_ns /
+					 (line->high_ns + line->low_ns));
+		else
+			printf(" %6s", "-");
+
+		printf(" %8" PRIu64 "\n", line->dropped);
+	}
+
+	if (!stats->redraw)
+		fputc('\n', stdout);
+
+	fflush(stdout);
+}
+
+/*
+ * Close the update periods which have elapsed and print the table. Returns
+ * the time left until the next update.
+ */
+static uint64_t stats_update(struct stats *stats)
+{
+	uint64_t now = clock_ns(CLOCK_MONOTONIC);
+	struct line_stats *line;
+	int i;
+
+	if (now < stats->next_update)
+		return stats->next_update - now;
+
+	for (i = 0; i < stats->num_lines; i++) {
+		line = &stats->lines[i];
+		line->window[stats->window_pos] = line->period_events;
+		line->period_events = 0;
+	}
+
+	stats->window_pos = (stats->window_pos + 1) % STATS_WINDOW;
+	if (stats->window_fill < STATS_WINDOW)
+		stats->window_fill++;
+
+	/* If we fell behind, skip the missed updates. */
+	stats->next_update += stats->interval_ns;
+	if (stats->next_update <= now)
+		stats->next_update = now + stats->interval_ns;
+
+	stats_print(stats);
+
+	return stats->next_update - now;
+}
+
+/*
+ * Figure out how long to wait for events, which is until the next update or
+ * until the idle timeout expires, whichever comes first.
+ */
+static struct timespec *stats_wait_time(struct stats *stats,
+					long long idle_timeout,
+					uint64_t last_event,
+					struct timespec *ts)
+{
+	uint64_t wait_ns, idle_end, now;
+
+	wait_ns = stats_update(stats);
+
+	if (idle_timeout > 0) {
+		idle_end = last_event + idle_timeout * 1000;
+		now = clock_ns(CLOCK_MONOTONIC);
+
+		if (idle_end <= now)
+			wait_ns = 0;
+		else if (idle_end - now < wait_ns)
+			wait_ns = idle_end - now;
+	}
+
+	ts->tv_sec = wait_ns / 1000000000;
+	ts->tv_nsec = wait_ns % 1000000000;
+
+	return ts;
+}
+
+/* Identifier codes of VCD variables are made of printable ASCII characters. */
+#define VCD_ID_FIRST	'!'
+#define VCD_ID_RANGE	('~' - '!' + 1)
+#define VCD_ID_SIZE	4
+
+struct vcd {
+	/* per chip map from offset to index of the line, plus one, or 0 */
+	int **by_offset;
+	int num_chips;
+	char (*ids)[VCD_ID_SIZE];
+
+	/* timestamps are output relative to the start of the capture */
+	uint64_t start;
+	bool have_start;
+	uint64_t last_time;
+};
+
+static void vcd_make_id(char *id, int index)
+{
+	int i = 0;
+
+	do {
+		id[i++] = VCD_ID_FIRST + index % VCD_ID_RANGE;
+		index /= VCD_ID_RANGE;
+	} while (index);
+
+	id[i] = '\0';
+}
+
+static void vcd_append_name(struct output_buffer *out, const char *name)
+{
+	for (; *name; name++)
+		output_buffer_append_char(out, vcd_name_char(*name));
+}
+
+/*
+ * Write the header declaring a wire for each requested line, grouped in a
+ * scope per chip, followed by the initial values of all lines at time 0.
+ */
+static struct vcd *vcd_new(struct line_resolver *resolver,
+			   struct gpiod_line_request **requests,
+			   struct config *cfg, struct output_buffer *out)
+{
+	enum gpiod_line_value *values;
+	struct resolved_line *line;
+	unsigned int *offsets;
+	const char *name;
+	size_t num_offsets;
+	int i, j, num_lines;
+	struct vcd *vcd;
+
+	vcd = calloc(1, sizeof(*vcd));
+	if (!vcd)
+		die("out of memory");
+
+	vcd->num_chips = resolver->num_chips;
+	vcd->by_offset = calloc(resolver->num_chips, sizeof(*vcd->by_offset));
+	vcd->ids = calloc(resolver->num_lines, sizeof(*vcd->ids));
+	if (!vcd->by_offset || !vcd->ids)
+		die("out of memory");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		num_offsets = gpiod_chip_info_get_num_lines(
+						resolver->chips[i].info);
+		vcd->by_offset[i] = calloc(num_offsets,
+					   sizeof(*vcd->by_offset[i]));
+		if (!vcd->by_offset[i])
+			die("out of memory");
+	}
+
+	output_buffer_append_str(out, "$version libgpiod ");
+	output_buffer_append_str(out, gpiod_api_version());
+	output_buffer_append_str(out, " $end\n");
+	output_buffer_append_str(out, "$timescale 1ns $end\n");
+	output_buffer_append_str(out, "$scope module gpio $end\n");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		output_buffer_append_str(out, "$scope module ");
+		vcd_append_name(out, get_chip_name(resolver, i));
+		output_buffer_append_str(out, " $end\n");
+
+		for (j = 0; j < resolver->num_lines; j++) {
+			line = &resolver->lines[j];
+			if (line->chip_num != i)
+				continue;
+
+			vcd_make_id(vcd->ids[j], j);
+			vcd->by_offset[i][line->offset] = j + 1;
+
+			output_buffer_append_str(out, "$var wire 1 ");
+			output_buffer_append_str(out, vcd->ids[j]);
+			output_buffer_append_char(out, ' ');
+
+			name = get_line_name(resolver, i, line->offset);
+			if (name) {
+				vcd_append_name(out, name);
+			} else {
+				output_buffer_append_str(out, "line");
+				output_buffer_append_uint(out, line->offset);
+			}
+
+			output_buffer_append_str(out, " $end\n");
+		}
+
+		output_buffer_append_str(out, "$upscope $end\n");
+	}
+
+	output_buffer_append_str(out, "$upscope $end\n");
+	output_buffer_append_str(out, "$enddefinitions $end\n");
+
+	/*
+	 * Events carry timestamps of the selected clock, but HTE timestamps
+	 * can't be related to any clock available to us, so those are
+	 * relative to the first event instead.
+	 */
+	if (cfg->event_clock != GPIOD_LINE_CLOCK_HTE) {
+		vcd->start = clock_ns(
+				cfg->event_clock == GPIOD_LINE_CLOCK_REALTIME ?
+					CLOCK_REALTIME : CLOCK_MONOTONIC);
+		vcd->have_start = true;
+	}
+
+	output_buffer_append_str(out, "#0\n$dumpvars\n");
+
+	offsets = calloc(resolver->num_lines, sizeof(*offsets));
+	values = calloc(resolver->num_lines, sizeof(*values));
+	if (!offsets || !values)
+		die("out of memory");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		num_lines = get_line_offsets_and_values(resolver, i, offsets,
+							NULL);
+		if (gpiod_line_request_get_values_subset(requests[i], num_lines,
+							 offsets, values))
+			die_perror("unable to read the initial line values");
+
+		for (j = 0; j < num_lines; j++) {
+			output_buffer_append_char(out,
+				values[j] == GPIOD_LINE_VALUE_ACTIVE ?
+								'1' : '0');
+			output_buffer_append_str(out,
+				vcd->ids[vcd->by_offset[i][offsets[j]] - 1]);
+			output_buffer_append_char(out, '\n');
+		}
+	}
+
+	free(offsets);
+	free(values);
+
+	output_buffer_append_str(out, "$end\n");
+	output_buffer_flush(out);
+
+	return vcd;
+}
+
+static void vcd_free(struct vcd *vcd)
+{
+	int i;
+
+	for (i = 0; i < vcd->num_chips; i++)
+		free(vcd->by_offset[i]);
+
+	free(vcd->by_offset);
+	free(vcd->ids);
+	free(vcd);
+}
+
+static void vcd_add_event(struct vcd *vcd, struct gpiod_edge_event *event,
+			  int chip_num, struct output_buffer *out)
+{
+	uint64_t evtime, time;
+	int index;
+
+	index = vcd->by_offset[chip_num][gpiod_edge_event_get_line_offset(event)];
+	evtime = gpiod_edge_event_get_timestamp_ns(event);
+
+	if (!vcd->have_start) {
+		vcd->start = evtime;
+		vcd->have_start = true;
+	}
+
+	time = evtime > vcd->start ? evtime - vcd->start : 0;
+
+	/*
+	 * Events of different chips are read in batches and so may be
+	 * slightly out of order, but VCD time can't go backwards.
+	 */
+	if (time < vcd->last_time)
+		time = vcd->last_time;
+
+	if (time != vcd->last_time) {
+		output_buffer_append_char(out, '#');
+		output_buffer_append_uint(out, time);
+		output_buffer_append_char(out, '\n');
+		vcd->last_time = time;
+	}
+
+	if (gpiod_edge_event_get_event_type(event) ==
+	    GPIOD_EDGE_EVENT_RISING_EDGE)
+		output_buffer_append_char(out, '1');
+	else
+		output_buffer_append_char(out, '0');
+
+	output_buffer_append_str(out, vcd->ids[index - 1]);
+	output_buffer_append_char(out, '\n');
+
+	if (output_buffer_is_full(out))
+		output_buffer_flush(out);
+}
+
+static struct gpiod_event_recorder *
+make_recorder(struct line_resolver *resolver, unsigned int *offsets)
+{
+	struct gpiod_event_recorder *recorder;
+	int num_lines;
+
+	if (resolver->num_chips > 1)
+		die("binary output supports lines from a single chip only");
+
+	num_lines = get_line_offsets_and_values(resolver, 0, offsets, NULL);
+
+	recorder = gpiod_event_recorder_new(STDOUT_FILENO,
+			gpiod_chip_info_get_name(resolver->chips[0].info),
+			offsets, num_lines);
+	if (!recorder)
+		die_perror("unable to start the event recording");
+
+	return recorder;
+}
+
+static void flush_output(struct gpiod_event_recorder *recorder,
+			 struct output_buffer *out)
+{
+	if (!recorder) {
+		output_buffer_flush(out);
+		fflush(stdout);
+		return;
+	}
+
+	if (gpiod_event_recorder_flush(recorder))
+		die_perror("unable to write the event recording");
+}
+
 static void event_print(struct gpiod_edge_event *event,
 			struct line_resolver *resolver, int chip_num,
-			struct config *cfg)
+			struct config *cfg, struct output_format *format,
+			struct vcd *vcd, struct output_buffer *out)
 {
 	if (cfg->quiet)
 		return;
 
-	if (cfg->fmt)
-		event_print_formatted(event, resolver, chip_num, cfg);
+	if (vcd)
+		vcd_add_event(vcd, event, chip_num, out);
+	else if (format)
+		event_print_formatted(event, resolver, chip_num, format, out);
 	else
 		event_print_human_readable(event, resolver, chip_num, cfg);
 }
 
+struct readers;
+
+struct reader {
+	struct readers *readers;
+	pthread_t thread;
+	struct gpiod_line_request *request;
+	struct gpiod_edge_event_buffer *buffer;
+	/* index of the merger source, which is also the chip number */
+	unsigned int source;
+	int error;
+};
+
+struct readers {
+	/* not thread-safe, only ever accessed with the lock held */
+	struct gpiod_event_merger *merger;
+	pthread_mutex_t lock;
+	/* signalled when a reader queues events or fails */
+	pthread_cond_t events;
+	/* signalled when the writer takes events out of the merger */
+	pthread_cond_t space;
+
+	struct reader *readers;
+	int num_readers;
+	unsigned int max_events;
+	size_t max_pending;
+	int stop_fd;
+	bool stop;
+};
+
+static void *reader_thread(void *data)
+{
+	struct reader *reader = data;
+	struct readers *readers = reader->readers;
+	struct pollfd pollfds[2];
+	int ret;
+
+	pollfds[0].fd = gpiod_line_request_get_fd(reader->request);
+	pollfds[0].events = POLLIN;
+	pollfds[1].fd = readers->stop_fd;
+	pollfds[1].events = POLLIN;
+
+	for (;;) {
+		ret = poll(pollfds, 2, -1);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			ret = errno;
+			break;
+		}
+
+		if (pollfds[1].revents)
+			return NULL;
+
+		ret = gpiod_line_request_read_edge_events(reader->request,
+							  reader->buffer,
+							  readers->max_events);
+		if (ret < 0) {
+			ret = errno;
+			break;
+		}
+
+		pthread_mutex_lock(&readers->lock);
+
+		while (!readers->stop &&
+		       gpiod_event_merger_get_num_pending(readers->merger) >=
+				readers->max_pending)
+			pthread_cond_wait(&readers->space, &readers->lock);
+
+		if (readers->stop) {
+			pthread_mutex_unlock(&readers->lock);
+			return NULL;
+		}
+
+		ret = gpiod_event_merger_push(readers->merger, reader->source,
+					      reader->buffer);
+		if (ret) {
+			reader->error = errno;
+			pthread_cond_signal(&readers->events);
+			pthread_mutex_unlock(&readers->lock);
+			return NULL;
+		}
+
+		pthread_cond_signal(&readers->events);
+		pthread_mutex_unlock(&readers->lock);
+	}
+
+	pthread_mutex_lock(&readers->lock);
+	reader->error = ret;
+	pthread_cond_signal(&readers->events);
+	pthread_mutex_unlock(&readers->lock);
+
+	return NULL;
+}
+
+/*
+ * Each chip is serviced by its own thread so that a chip flooding with
+ * events can't starve the others. The threads queue the events in an event
+ * merger from which the main thread outputs them in timestamp order.
+ */
+static void monitor_threaded(struct gpiod_line_request **requests,
+			     struct line_resolver *resolver,
+			     struct config *cfg, struct output_format *format,
+			     struct output_buffer *out)
+{
+	struct gpiod_edge_event_buffer *buffer;
+	struct gpiod_edge_event *event;
+	uint64_t last_event, deadline, window_end, window_ns;
+	pthread_condattr_t condattr;
+	unsigned int *sources;
+	struct readers readers;
+	struct reader *reader;
+	int i, ret, num_events;
+	int events_done = 0;
+	struct timespec tsp;
+
+	memset(&readers, 0, sizeof(readers));
+	readers.num_readers = resolver->num_chips;
+	readers.max_events = cfg->buffer_size;
+	readers.max_pending = (size_t)READER_NUM_BUFFERS * cfg->buffer_size *
+			      readers.num_readers;
+
+	window_ns = cfg->reorder_window_us * 1000;
+	readers.merger = gpiod_event_merger_new(cfg->event_clock, window_ns);
+	if (!readers.merger)
+		die_perror("unable to create the event merger");
+
+	readers.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (readers.stop_fd < 0)
+		die_perror("unable to create an eventfd");
+
+	pthread_mutex_init(&readers.lock, NULL);
+	pthread_condattr_init(&condattr);
+	pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+	pthread_cond_init(&readers.events, &condattr);
+	pthread_cond_init(&readers.space, NULL);
+	pthread_condattr_destroy(&condattr);
+
+	buffer = gpiod_edge_event_buffer_new(cfg->buffer_size);
+	if (!buffer)
+		die_perror("unable to allocate the line event buffer");
+
+	sources = calloc(cfg->buffer_size, sizeof(*sources));
+	readers.readers = calloc(readers.num_readers,
+				 sizeof(*readers.readers));
+	if (!sources || !readers.readers)
+		die("out of memory");
+
+	for (i = 0; i < readers.num_readers; i++) {
+		reader = &readers.readers[i];
+		reader->readers = &readers;
+		reader->request = requests[i];
+
+		ret = gpiod_event_merger_add_source(readers.merger);
+		if (ret < 0)
+			die_perror("unable to add an event merger source");
+		reader->source = ret;
+
+		reader->buffer = gpiod_edge_event_buffer_new(cfg->buffer_size);
+		if (!reader->buffer)
+			die_perror("unable to allocate the line event buffer");
+	}
+
+	for (i = 0; i < readers.num_readers; i++) {
+		ret = pthread_create(&readers.readers[i].thread, NULL,
+				     reader_thread, &readers.readers[i]);
+		if (ret) {
+			errno = ret;
+			die_perror("unable to create a reader thread");
+		}
+	}
+
+	last_event = clock_ns(CLOCK_MONOTONIC);
+
+	pthread_mutex_lock(&readers.lock);
+
+	for (;;) {
+		for (i = 0; i < readers.num_readers; i++) {
+			if (readers.readers[i].error) {
+				errno = readers.readers[i].error;
+				die_perror("error reading line events");
+			}
+		}
+
+		num_events = gpiod_event_merger_read(readers.merger, buffer,
+						     sources, cfg->buffer_size);
+		if (num_events < 0)
+			die_perror("error merging line events");
+
+		if (num_events > 0) {
+			pthread_cond_broadcast(&readers.space);
+			pthread_mutex_unlock(&readers.lock);
+
+			for (i = 0; i < num_events; i++) {
+				event = gpiod_edge_event_buffer_get_event(buffer,
+									  i);
+				event_print(event, resolver, sources[i], cfg,
+					    format, NULL, out);
+
+				events_done++;
+
+				if (cfg->events_wanted &&
+				    events_done >= cfg->events_wanted) {
+					pthread_mutex_lock(&readers.lock);
+					goto out;
+				}
+			}
+
+			last_event = clock_ns(CLOCK_MONOTONIC);
+			pthread_mutex_lock(&readers.lock);
+			continue;
+		}
+
+		pthread_mutex_unlock(&readers.lock);
+		flush_output(NULL, out);
+		pthread_mutex_lock(&readers.lock);
+
+		deadline = 0;
+
+		if (cfg->idle_timeout > 0)
+			deadline = last_event + cfg->idle_timeout * 1000;
+
+		/*
+		 * Queued events are held back for at most the reorder window.
+		 * HTE timestamps don't advance with time but only with new
+		 * events, which the readers signal anyway.
+		 */
+		if (cfg->event_clock != GPIOD_LINE_CLOCK_HTE &&
+		    gpiod_event_merger_get_num_pending(readers.merger)) {
+			window_end = clock_ns(CLOCK_MONOTONIC) + window_ns;
+			if (!deadline || window_end < deadline)
+				deadline = window_end;
+		}
+
+		if (!deadline) {
+			pthread_cond_wait(&readers.events, &readers.lock);
+			continue;
+		}
+
+		tsp.tv_sec = deadline / 1000000000;
+		tsp.tv_nsec = deadline % 1000000000;
+		pthread_cond_timedwait(&readers.events, &readers.lock, &tsp);
+
+		if (cfg->idle_timeout > 0 &&
+		    clock_ns(CLOCK_MONOTONIC) - last_event >=
+				(uint64_t)cfg->idle_timeout * 1000)
+			break;
+	}
+
+out:
+	readers.stop = true;
+	pthread_cond_broadcast(&readers.space);
+	pthread_mutex_unlock(&readers.lock);
+
+	if (eventfd_write(readers.stop_fd, 1))
+		die_perror("unable to stop the reader threads");
+
+	for (i = 0; i < readers.num_readers; i++) {
+		reader = &readers.readers[i];
+		pthread_join(reader->thread, NULL);
+		gpiod_edge_event_buffer_free(reader->buffer);
+	}
+
+	free(readers.readers);
+	free(sources);
+	gpiod_edge_event_buffer_free(buffer);
+	close(readers.stop_fd);
+	pthread_cond_destroy(&readers.space);
+	pthread_cond_destroy(&readers.events);
+	pthread_mutex_destroy(&readers.lock);
+	gpiod_event_merger_free(readers.merger);
+}
+
 int main(int argc, char **argv)
 {
 	struct gpiod_edge_event_buffer *event_buffer;
+	struct gpiod_event_recorder *recorder = NULL;
+	struct output_format *format = NULL;
 	struct gpiod_line_settings *settings;
 	struct gpiod_request_config *req_cfg;
 	struct gpiod_line_request **requests;
@@ -363,10 +1283,17 @@ int main(int argc, char **argv)
 	int num_lines, events_done = 0;
 	struct gpiod_edge_event *event;
 	struct line_resolver *resolver;
-	struct timespec idle_timeout;
+	struct timespec idle_timeout, stats_timeout, no_wait = { 0, 0 };
+	struct timespec *timeout;
+	struct stats *stats = NULL;
+	struct vcd *vcd = NULL;
+	uint64_t last_event = 0;
+	sigset_t *wait_mask = NULL, orig_mask;
+	struct output_buffer out;
 	struct gpiod_chip *chip;
 	struct pollfd *pollfds;
 	unsigned int *offsets;
+	size_t max_events;
 	struct config cfg;
 	int ret, i, j;
 
@@ -413,7 +1340,7 @@ int main(int argc, char **argv)
 
 	gpiod_request_config_set_consumer(req_cfg, cfg.consumer);
 
-	event_buffer = gpiod_edge_event_buffer_new(EVENT_BUF_SIZE);
+	event_buffer = gpiod_edge_event_buffer_new(cfg.buffer_size);
 	if (!event_buffer)
 		die_perror("unable to allocate the line event buffer");
 
@@ -454,9 +1381,48 @@ int main(int argc, char **argv)
 	gpiod_line_config_free(line_cfg);
 	gpiod_line_settings_free(settings);
 
+	/*
+	 * SIGINT and SIGTERM stay blocked except while waiting for events, so
+	 * that gpiomon exits through the regular path and finishes its output.
+	 * In binary mode the index would be missing otherwise and the last
+	 * block would be lost.
+	 */
+	if (cfg.output_format == OUTPUT_FORMAT_BINARY && !cfg.quiet) {
+		recorder = make_recorder(resolver, offsets);
+		setup_signals(&orig_mask);
+		wait_mask = &orig_mask;
+	} else if (cfg.stats) {
+		/* Print the final statistics when interrupted. */
+		stats = stats_new(resolver, cfg.stats_interval);
+		setup_signals(&orig_mask);
+		wait_mask = &orig_mask;
+		last_event = clock_ns(CLOCK_MONOTONIC);
+	} else if (!cfg.quiet && !isatty(STDOUT_FILENO)) {
+		/* Let a whole batch of events go out in a single write. */
+		setvbuf(stdout, NULL, _IOFBF,
+			(size_t)cfg.buffer_size * EVENT_TEXT_SIZE);
+	}
+
+	if (cfg.fmt)
+		format = parse_output_format(cfg.fmt, FORMAT_CONVERSIONS);
+
+	output_buffer_init(&out);
+
+	if (cfg.output_format == OUTPUT_FORMAT_VCD && !cfg.quiet) {
+		/* Make sure the pending value changes go out when interrupted. */
+		vcd = vcd_new(resolver, requests, &cfg, &out);
+		setup_signals(&orig_mask);
+		wait_mask = &orig_mask;
+	}
+
 	if (cfg.banner)
 		print_banner(argc, argv);
 
+	if (cfg.threads) {
+		monitor_threaded(requests, resolver, &cfg, format, &out);
+		goto done;
+	}
+
 	if (cfg.idle_timeout > 0) {
 		idle_timeout.tv_sec = cfg.idle_timeout / 1000000;
 		idle_timeout.tv_nsec =
@@ -464,32 +1430,88 @@ int main(int argc, char **argv)
 	}
 
 	for (;;) {
-		fflush(stdout);
+		/*
+		 * Only flush the output once there are no more events pending,
+		 * so that bursts are written out in as few syscalls as
+		 * possible.
+		 */
+		ret = ppoll(pollfds, resolver->num_chips, &no_wait, wait_mask);
+		if (ret == 0) {
+			flush_output(recorder, &out);
+
+			if (stats)
+				timeout = stats_wait_time(stats,
+							  cfg.idle_timeout,
+							  last_event,
+							  &stats_timeout);
+			else
+				timeout = cfg.idle_timeout > 0 ?
+							&idle_timeout : NULL;
+
+			ret = ppoll(pollfds, resolver->num_chips, timeout,
+				    wait_mask);
+		}
+		if (ret < 0) {
+			if (errno == EINTR && caught_signal)
+				goto done;
 
-		ret = ppoll(pollfds, resolver->num_chips,
-			    cfg.idle_timeout > 0 ? &idle_timeout : NULL, NULL);
-		if (ret < 0)
 			die_perror("error polling for events");
+		}
+
+		if (ret == 0) {
+			/* Woken up for a statistics update. */
+			if (stats && (cfg.idle_timeout <= 0 ||
+				      clock_ns(CLOCK_MONOTONIC) - last_event <
+					(uint64_t)cfg.idle_timeout * 1000))
+				continue;
 
-		if (ret == 0)
 			goto done;
+		}
 
 		for (i = 0; i < resolver->num_chips; i++) {
 			if (pollfds[i].revents == 0)
 				continue;
 
+			max_events = cfg.buffer_size;
+			if (cfg.events_wanted &&
+			    (size_t)(cfg.events_wanted - events_done) < max_events)
+				max_events = cfg.events_wanted - events_done;
+
 			ret = gpiod_line_request_read_edge_events(requests[i],
-					 event_buffer, EVENT_BUF_SIZE);
+					 event_buffer, max_events);
 			if (ret < 0)
 				die_perror("error reading line events");
 
+			if (recorder || stats) {
+				if (recorder &&
+				    gpiod_event_recorder_write(recorder,
+							       event_buffer))
+					die_perror("unable to record events");
+
+				if (stats) {
+					stats_add_events(stats, i, event_buffer,
+							 ret);
+					last_event = clock_ns(CLOCK_MONOTONIC);
+					stats_update(stats);
+				}
+
+				events_done += ret;
+
+				if (cfg.events_wanted &&
+				    events_done >= cfg.events_wanted)
+					goto done;
+
+				continue;
+			}
+
 			for (j = 0; j < ret; j++) {
 				event = gpiod_edge_event_buffer_get_event(
 						event_buffer, j);
 				if (!event)
 					die_perror("unable to retrieve event from buffer");
 
-				event_print(event, resolver, i, &cfg);
+				event_print(event, resolver, i, &cfg, format,
+					    vcd, &out);
 
 				events_done++;
 
@@ -501,6 +1523,21 @@ int main(int argc, char **argv)
 	}
 
 done:
+	if (recorder) {
+		if (gpiod_event_recorder_finish(recorder))
+			die_perror("unable to write the event recording");
+
+		gpiod_event_recorder_free(recorder);
+	}
+
+	if (stats) {
+		stats_print(stats);
+		stats_free(stats);
+	}
+
+	if (vcd)
+		vcd_free(vcd);
+
 	for (i = 0; i < resolver->num_chips; i++)
 		gpiod_line_request_release(requests[i]);
 
@@ -508,6 +1545,12 @@ done:
 	free_line_resolver(resolver);
 	gpiod_edge_event_buffer_free(event_buffer);
 	free(offsets);
+	output_buffer_flush(&out);
+	output_buffer_release(&out);
+	free_output_format(format);
+
+	if (caught_signal)
+		reraise_signal(caught_signal);
 
 	return EXIT_SUCCESS;
 }
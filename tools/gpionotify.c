@@ -180,21 +180,17 @@ static void print_banner(int num_lines, char **lines)
 	}
 }
 
-static void print_event_type(int evtype)
+static const char *event_type_name(int evtype)
 {
 	switch (evtype) {
 	case GPIOD_INFO_EVENT_LINE_REQUESTED:
-		fputs("requested", stdout);
-		break;
+		return "requested";
 	case GPIOD_INFO_EVENT_LINE_RELEASED:
-		fputs("released", stdout);
-		break;
+		return "released";
 	case GPIOD_INFO_EVENT_LINE_CONFIG_CHANGED:
-		fputs("reconfigured", stdout);
-		break;
+		return "reconfigured";
 	default:
-		fputs("unknown", stdout);
-		break;
+		return "unknown";
 	}
 }
 
@@ -230,40 +226,38 @@ static uint64_t monotonic_to_realtime(uint64_t evtime)
 	return evtime;
 }
 
+#define FORMAT_CONVERSIONS "aCceElLoSU"
+
 static void event_print_formatted(struct gpiod_info_event *event,
 				  struct line_resolver *resolver, int chip_num,
-				  struct config *cfg)
+				  struct config *cfg,
+				  struct output_format *format,
+				  struct output_buffer *out)
 {
-	const char *lname, *prev, *curr, *consumer;
+	const char *lname, *consumer;
 	struct gpiod_line_info *info;
+	struct format_op *op;
 	unsigned int offset;
 	uint64_t evtime;
-	int evtype;
-	char fmt;
+	int evtype, i;
 
 	info = gpiod_info_event_get_line_info(event);
 	evtime = gpiod_info_event_get_timestamp_ns(event);
 	evtype = gpiod_info_event_get_event_type(event);
 	offset = gpiod_line_info_get_offset(info);
 
-	for (prev = curr = cfg->fmt;;) {
-		curr = strchr(curr, '%');
-		if (!curr) {
-			fputs(prev, stdout);
-			break;
-		}
-
-		if (prev != curr)
-			fwrite(prev, curr - prev, 1, stdout);
+	for (i = 0; i < format->num_ops; i++) {
+		op = &format->ops[i];
 
-		fmt = *(curr + 1);
-
-		switch (fmt) {
+		switch (op->conv) {
 		case 'a':
+			/* Rarely used, let stdio do the formatting. */
+			output_buffer_flush(out);
 			print_line_attributes(info, cfg->unquoted);
 			break;
 		case 'c':
-			fputs(get_chip_name(resolver, chip_num), stdout);
+			output_buffer_append_str(out,
+					get_chip_name(resolver, chip_num));
 			break;
 		case 'C':
 			if (!gpiod_line_info_is_used(info)) {
@@ -273,49 +267,44 @@ static void event_print_formatted(struct gpiod_info_event *event,
 				if (!consumer)
 					consumer = "kernel";
 			}
-			fputs(consumer, stdout);
+			output_buffer_append_str(out, consumer);
 			break;
 		case 'e':
-			printf("%d", evtype);
+			output_buffer_append_int(out, evtype);
 			break;
 		case 'E':
-			print_event_type(evtype);
+			output_buffer_append_str(out, event_type_name(evtype));
 			break;
 		case 'l':
 			lname = gpiod_line_info_get_name(info);
 			if (!lname)
 				lname = "unnamed";
-			fputs(lname, stdout);
+			output_buffer_append_str(out, lname);
 			break;
 		case 'L':
-			print_event_time(monotonic_to_realtime(evtime), 2);
+			output_buffer_append_event_time(out,
+					monotonic_to_realtime(evtime), 2);
 			break;
 		case 'o':
-			printf("%u", offset);
+			output_buffer_append_uint(out, offset);
 			break;
 		case 'S':
-			print_event_time(evtime, 0);
+			output_buffer_append_event_time(out, evtime, 0);
 			break;
 		case 'U':
-			print_event_time(monotonic_to_realtime(evtime), 1);
-			break;
-		case '%':
-			fputc('%', stdout);
+			output_buffer_append_event_time(out,
+					monotonic_to_realtime(evtime), 1);
 			break;
-		case '\0':
-			fputc('%', stdout);
-			goto end;
 		default:
-			fwrite(curr, 2, 1, stdout);
+			output_buffer_append(out, op->text, op->len);
 			break;
 		}
-
-		curr += 2;
-		prev = curr;
 	}
 
-end:
-	fputc('\n', stdout);
+	output_buffer_append_char(out, '\n');
+
+	if (output_buffer_is_full(out))
+		output_buffer_flush(out);
 }
 
 static void event_print_human_readable(struct gpiod_info_event *event,
@@ -325,7 +314,6 @@ static void event_print_human_readable(struct gpiod_info_event *event,
 	struct gpiod_line_info *info;
 	unsigned int offset;
 	uint64_t evtime;
-	char *evname;
 	int evtype;
 
 	info = gpiod_info_event_get_line_info(event);
@@ -333,46 +321,37 @@ static void event_print_human_readable(struct gpiod_info_event *event,
 	evtype = gpiod_info_event_get_event_type(event);
 	offset = gpiod_line_info_get_offset(info);
 
-	switch (evtype) {
-	case GPIOD_INFO_EVENT_LINE_REQUESTED:
-		evname = "requested";
-		break;
-	case GPIOD_INFO_EVENT_LINE_RELEASED:
-		evname = "released";
-		break;
-	case GPIOD_INFO_EVENT_LINE_CONFIG_CHANGED:
-		evname = "reconfigured";
-		break;
-	default:
-		evname = "unknown";
-	}
-
 	if (cfg->timestamp_fmt)
 		evtime = monotonic_to_realtime(evtime);
 
 	print_event_time(evtime, cfg->timestamp_fmt);
-	printf("\t%s\t", evname);
+	printf("\t%s\t", event_type_name(evtype));
 	print_line_id(resolver, chip_num, offset, cfg->chip_id, cfg->unquoted);
 	fputc('\n', stdout);
 }
 
 static void event_print(struct gpiod_info_event *event,
 			struct line_resolver *resolver, int chip_num,
-			struct config *cfg)
+			struct config *cfg, struct output_format *format,
+			struct output_buffer *out)
 {
 	if (cfg->quiet)
 		return;
 
-	if (cfg->fmt)
-		event_print_formatted(event, resolver, chip_num, cfg);
+	if (format)
+		event_print_formatted(event, resolver, chip_num, cfg, format,
+				      out);
 	else
 		event_print_human_readable(event, resolver, chip_num, cfg);
 }
 
 int main(int argc, char **argv)
 {
-	int i, j, ret, events_done = 0, evtype;
+	int i, ret, events_done = 0, evtype, num_lines;
+	struct output_format *format = NULL;
 	struct line_resolver *resolver;
+	struct output_buffer out;
+	unsigned int *offsets;
 	struct gpiod_info_event *event;
 	struct timespec idle_timeout;
 	struct gpiod_chip **chips;
@@ -396,7 +375,8 @@ int main(int argc, char **argv)
 	validate_resolution(resolver, cfg.chip_id);
 	chips = calloc(resolver->num_chips, sizeof(*chips));
 	pollfds = calloc(resolver->num_chips, sizeof(*pollfds));
-	if (!pollfds)
+	offsets = calloc(resolver->num_lines, sizeof(*offsets));
+	if (!pollfds || !offsets)
 		die("out of memory");
 
 	for (i = 0; i < resolver->num_chips; i++) {
@@ -405,18 +385,22 @@ int main(int argc, char **argv)
 			die_perror("unable to open chip '%s'",
 				   resolver->chips[i].path);
 
-		for (j = 0; j < resolver->num_lines; j++)
-			if ((resolver->lines[j].chip_num == i) &&
-			    !gpiod_chip_watch_line_info(
-				    chip, resolver->lines[j].offset))
-				die_perror("unable to watch line on chip '%s'",
-					   resolver->chips[i].path);
+		num_lines = get_line_offsets_and_values(resolver, i, offsets,
+							NULL);
+		if (gpiod_chip_watch_lines(chip, offsets, num_lines, NULL))
+			die_perror("unable to watch lines on chip '%s'",
+				   resolver->chips[i].path);
 
 		chips[i] = chip;
 		pollfds[i].fd = gpiod_chip_get_fd(chip);
 		pollfds[i].events = POLLIN;
 	}
 
+	if (cfg.fmt)
+		format = parse_output_format(cfg.fmt, FORMAT_CONVERSIONS);
+
+	output_buffer_init(&out);
+
 	if (cfg.banner)
 		print_banner(argc, argv);
 
@@ -427,6 +411,7 @@ int main(int argc, char **argv)
 	}
 
 	for (;;) {
+		output_buffer_flush(&out);
 		fflush(stdout);
 
 		ret = ppoll(pollfds, resolver->num_chips,
@@ -451,7 +436,7 @@ int main(int argc, char **argv)
 					continue;
 			}
 
-			event_print(event, resolver, i, &cfg);
+			event_print(event, resolver, i, &cfg, format, &out);
 
 			events_done++;
 
@@ -465,7 +450,11 @@ done:
 		gpiod_chip_close(chips[i]);
 
 	free(chips);
+	free(offsets);
 	free_line_resolver(resolver);
+	output_buffer_flush(&out);
+	output_buffer_release(&out);
+	free_output_format(format);
 
 	return EXIT_SUCCESS;
 }
@@ -3,13 +3,20 @@
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
 #include <ctype.h>
+#include <endian.h>
+#include <errno.h>
 #include <gpiod.h>
 #include <getopt.h>
 #include <limits.h>
 #include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 #ifdef GPIOSET_INTERACTIVE
 #include <editline/readline.h>
@@ -17,6 +24,53 @@
 
 #include "tools-common.h"
 
+/* Buckets of the timing report histogram are decades starting at 1us. */
+#define TIMING_BUCKETS	6
+
+struct timing_stats {
+	unsigned long long toggles;
+	/* toggles with a non-zero requested period */
+	unsigned long long periods;
+	unsigned long long overruns;
+	uint64_t prev_ns;
+	uint64_t prev_deadline_ns;
+	int64_t min_error_ns;
+	int64_t max_error_ns;
+	int64_t total_error_ns;
+	uint64_t max_late_ns;
+	uint64_t total_late_ns;
+	unsigned long long histogram[TIMING_BUCKETS];
+};
+
+#define WAVEFORM_MAX_LINES	64
+#define WAVEFORM_BINARY_MAGIC	"GPIODWAV"
+
+struct waveform_step {
+	/* time relative to the start of the playback */
+	uint64_t time_ns;
+	/* bit N set if the step sets the Nth requested line */
+	uint64_t mask;
+	uint64_t bits;
+};
+
+struct waveform {
+	struct waveform_step *steps;
+	size_t num_steps;
+	size_t capacity;
+};
+
+struct vcd_signal {
+	char *id;
+	int line;
+};
+
+/*
+ * With --sync-outputs the values of the chips are staged and then written
+ * by the output group all at once, otherwise each chip is written right
+ * away.
+ */
+static struct gpiod_output_group *output_group;
+
 struct config {
 	bool active_low;
 	bool banner;
@@ -24,14 +78,19 @@ struct config {
 	bool daemonize;
 	bool interactive;
 	bool strict;
+	bool sync_outputs;
+	bool timing_report;
 	bool unquoted;
 	enum gpiod_line_bias bias;
 	enum gpiod_line_drive drive;
+	int realtime_priority;
 	int toggles;
 	unsigned long long *toggle_periods;
 	unsigned long long hold_period_us;
 	const char *chip_id;
 	const char *consumer;
+	const char *script;
+	const char *waveform;
 };
 
 static void print_help(void)
@@ -65,16 +124,49 @@ static void print_help(void)
 	printf("  -l, --active-low\ttreat the line as active low\n");
 	printf("  -p, --hold-period <period>\n");
 	printf("\t\t\tthe minimum time period to hold lines at the requested values\n");
+	printf("      --realtime <priority>\n");
+	printf("\t\t\trun with the SCHED_FIFO policy at the given priority and\n");
+	printf("\t\t\tlock the process memory to reduce toggle jitter\n");
+	printf("      --script <file>\trun the commands from the file then exit\n");
+	printf("\t\t\tIf the file is '-' then the commands are read from\n");
+	printf("\t\t\tstandard input.\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
+	printf("      --stdin-batch\tsame as '--script -'\n");
+	printf("      --sync-outputs\tupdate the lines on all chips at once from a thread\n");
+	printf("\t\t\tper chip to minimize the skew between the chips\n");
+	printf("\t\t\tThe skew is included in the timing report.\n");
+	printf("      --timing-report\tprint statistics of the achieved toggle timing at exit\n");
 	printf("  -t, --toggle <period>[,period]...\n");
 	printf("\t\t\ttoggle the line(s) after the specified period(s)\n");
 	printf("\t\t\tIf the last period is 0 then gpioset exits else the sequence repeats.\n");
+	printf("\t\t\tPeriods are measured from the start of the sequence so that\n");
+	printf("\t\t\tthe time spent setting the lines doesn't accumulate.\n");
 	printf("      --unquoted\tdon't quote line names\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
+	printf("  -w, --waveform <file>\n");
+	printf("\t\t\tplay back the waveform from the file then exit\n");
 	printf("  -z, --daemonize\tset values then detach from the controlling terminal\n");
 	print_chip_help();
 	print_period_help();
 	printf("\n");
+	printf("Waveforms:\n");
+	printf("    The file is either a VCD, a binary waveform or text with one step per line:\n");
+	printf("\n");
+	printf("        <time> <mask> <bits>\n");
+	printf("\n");
+	printf("    The time is a period measured from the start of the playback. Bit N of\n");
+	printf("    the mask and bits refers to the Nth line on the command line. Lines in the\n");
+	printf("    mask are set to the value of the corresponding bit at the given time.\n");
+	printf("    VCD signals are matched with the requested lines by name.\n");
+	printf("    Values on the command line are the initial values of the lines.\n");
+	printf("\n");
+	printf("Scripts:\n");
+	printf("    The file contains one command per line, out of 'set <line=value>...',\n");
+	printf("    'toggle [line]...', 'sleep <period>', 'get [line]...' and 'exit', as in\n");
+	printf("    the interactive mode. The whole file is parsed before any command is run.\n");
+	printf("    Sleeps are measured from the start of the script so that the time spent\n");
+	printf("    running the commands doesn't accumulate.\n");
+	printf("\n");
 	printf("*Note*\n");
 	printf("    It should not be assumed that a line will retain its state after gpioset exits.\n");
 	printf("    When a process exits, any GPIO lines it has requested are automatically released.\n");
@@ -94,6 +186,17 @@ static int parse_drive_or_die(const char *option)
 	return 0;
 }
 
+static int parse_realtime_priority_or_die(const char *option)
+{
+	int prio = parse_uint(option);
+
+	if (prio < sched_get_priority_min(SCHED_FIFO) ||
+	    prio > sched_get_priority_max(SCHED_FIFO))
+		die("invalid realtime priority: %s", option);
+
+	return prio;
+}
+
 static int parse_periods_or_die(char *option, unsigned long long **periods)
 {
 	int i, num_periods = 1;
@@ -138,17 +241,23 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 #ifdef GPIOSET_INTERACTIVE
 		{ "interactive", no_argument,		NULL,	'i' },
 #endif
+		{ "realtime",	required_argument,	NULL,	'R' },
+		{ "script",	required_argument,	NULL,	'S' },
+		{ "stdin-batch", no_argument,		NULL,	'I' },
 		{ "strict",	no_argument,		NULL,	's' },
+		{ "sync-outputs", no_argument,		NULL,	'Y' },
+		{ "timing-report", no_argument,		NULL,	'T' },
 		{ "toggle",	required_argument,	NULL,	't' },
 		{ "unquoted",	no_argument,		NULL,	'Q' },
 		{ "version",	no_argument,		NULL,	'v' },
+		{ "waveform",	required_argument,	NULL,	'w' },
 		{ GETOPT_NULL_LONGOPT },
 	};
 
 #ifdef GPIOSET_INTERACTIVE
-	static const char *const shortopts = "+b:c:C:d:hilp:st:vz";
+	static const char *const shortopts = "+b:c:C:d:hilp:st:vw:z";
 #else
-	static const char *const shortopts = "+b:c:C:d:hlp:st:vz";
+	static const char *const shortopts = "+b:c:C:d:hlp:st:vw:z";
 #endif
 
 	int opti, optc;
@@ -194,13 +303,32 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'Q':
 			cfg->unquoted = true;
 			break;
+		case 'R':
+			cfg->realtime_priority = parse_realtime_priority_or_die(
+									optarg);
+			break;
 		case 's':
 			cfg->strict = true;
 			break;
+		case 'S':
+			cfg->script = optarg;
+			break;
+		case 'I':
+			cfg->script = "-";
+			break;
+		case 'Y':
+			cfg->sync_outputs = true;
+			break;
+		case 'T':
+			cfg->timing_report = true;
+			break;
 		case 't':
 			cfg->toggles = parse_periods_or_die(optarg,
 						 &cfg->toggle_periods);
 			break;
+		case 'w':
+			cfg->waveform = optarg;
+			break;
 		case 'z':
 			cfg->daemonize = true;
 			break;
@@ -222,8 +350,22 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 #ifdef GPIOSET_INTERACTIVE
 	if (cfg->toggles && cfg->interactive)
 		die("can't combine interactive with toggle");
+	if (cfg->waveform && cfg->interactive)
+		die("can't combine interactive with waveform");
+	if (cfg->script && cfg->interactive)
+		die("can't combine interactive with script");
 #endif
 
+	if (cfg->waveform && cfg->toggles)
+		die("can't combine toggle with waveform");
+
+	if (cfg->script && (cfg->toggles || cfg->waveform))
+		die("can't combine script with toggle or waveform");
+
+	if (cfg->timing_report && !cfg->toggles && !cfg->waveform &&
+	    !cfg->script)
+		die("timing report requires toggle, waveform or script");
+
 	return optind;
 }
 
@@ -344,6 +486,37 @@ static void wait_fd(int fd)
 		die_perror("error waiting on request");
 }
 
+/*
+ * Set the values of the lines of a chip from the resolver, or only stage
+ * them if the chips are updated together, in which case they take effect
+ * with commit_chip_values().
+ * offset and values are scratch pads for working.
+ */
+static void set_chip_values(struct gpiod_line_request **requests,
+			    struct line_resolver *resolver, int chip_num,
+			    unsigned int *offsets, enum gpiod_line_value *values)
+{
+	get_line_offsets_and_values(resolver, chip_num, offsets, values);
+
+	if (output_group) {
+		if (gpiod_output_group_stage_values(output_group, chip_num,
+						    values))
+			die_perror("unable to stage values for '%s'",
+				   get_chip_name(resolver, chip_num));
+		return;
+	}
+
+	if (gpiod_line_request_set_values(requests[chip_num], values))
+		print_perror("unable to set values on '%s'",
+			     get_chip_name(resolver, chip_num));
+}
+
+static void commit_chip_values(void)
+{
+	if (output_group && gpiod_output_group_apply(output_group))
+		print_perror("unable to set values");
+}
+
 /*
  * Apply values from the resolver to the requests.
  * offset and values are scratch pads for working.
@@ -354,12 +527,10 @@ static void apply_values(struct gpiod_line_request **requests,
 {
 	int i;
 
-	for (i = 0; i < resolver->num_chips; i++) {
-		get_line_offsets_and_values(resolver, i, offsets, values);
-		if (gpiod_line_request_set_values(requests[i], values))
-			print_perror("unable to set values on '%s'",
-				     get_chip_name(resolver, i));
-	}
+	for (i = 0; i < resolver->num_chips; i++)
+		set_chip_values(requests, resolver, i, offsets, values);
+
+	commit_chip_values();
 }
 
 /* Toggle the values of all lines in the resolver */
@@ -371,27 +542,160 @@ static void toggle_all_lines(struct line_resolver *resolver)
 		resolver->lines[i].value = !resolver->lines[i].value;
 }
 
+static void setup_realtime(int priority)
+{
+	struct sched_param param;
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE))
+		die_perror("unable to lock process memory");
+
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+
+	if (sched_setscheduler(0, SCHED_FIFO, &param))
+		die_perror("unable to set realtime scheduling policy");
+}
+
+static void timing_stats_init(struct timing_stats *stats, uint64_t start_ns)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->prev_ns = start_ns;
+	stats->prev_deadline_ns = start_ns;
+	stats->min_error_ns = INT64_MAX;
+	stats->max_error_ns = INT64_MIN;
+}
+
+/*
+ * Account for a toggle scheduled at deadline_ns that completed at now_ns.
+ * The period error is the difference between the achieved and the requested
+ * period, while lateness is measured against the absolute deadline. Toggles
+ * due at the same time as the previous one - such as the first step of a
+ * waveform or updates not separated by a sleep - have no period to miss and
+ * only count towards the lateness.
+ */
+static void timing_stats_add(struct timing_stats *stats, uint64_t deadline_ns,
+			     uint64_t now_ns)
+{
+	uint64_t late = now_ns > deadline_ns ? now_ns - deadline_ns : 0;
+	uint64_t period = deadline_ns - stats->prev_deadline_ns;
+	uint64_t abs_error, limit = 1000;
+	int64_t error;
+	int bucket;
+
+	stats->toggles++;
+
+	if (period) {
+		error = (int64_t)(now_ns - stats->prev_ns) - (int64_t)period;
+		abs_error = error < 0 ? -error : error;
+
+		for (bucket = 0; bucket < TIMING_BUCKETS - 1;
+		     bucket++, limit *= 10)
+			if (abs_error < limit)
+				break;
+
+		stats->histogram[bucket]++;
+		stats->periods++;
+		stats->total_error_ns += error;
+		if (error < stats->min_error_ns)
+			stats->min_error_ns = error;
+		if (error > stats->max_error_ns)
+			stats->max_error_ns = error;
+	}
+
+	stats->total_late_ns += late;
+	if (late > stats->max_late_ns)
+		stats->max_late_ns = late;
+	/* Woke up when the next toggle was already due. */
+	if (period && late >= period)
+		stats->overruns++;
+
+	stats->prev_ns = now_ns;
+	stats->prev_deadline_ns = deadline_ns;
+}
+
+static void print_timing_report(struct timing_stats *stats)
+{
+	static const char *const bucket_names[TIMING_BUCKETS] = {
+		"< 1us", "< 10us", "< 100us", "< 1ms", "< 10ms", ">= 10ms"
+	};
+	unsigned long long toggles = stats->toggles;
+	unsigned long long periods = stats->periods;
+	int i;
+
+	printf("toggles: %llu\n", toggles);
+	if (!toggles) {
+		fflush(stdout);
+		return;
+	}
+
+	if (periods)
+		printf("period error (us): min %.3f, mean %.3f, max %.3f\n",
+		       stats->min_error_ns / 1000.0,
+		       (double)stats->total_error_ns / periods / 1000.0,
+		       stats->max_error_ns / 1000.0);
+	printf("lateness (us): mean %.3f, max %.3f\n",
+	       (double)stats->total_late_ns / toggles / 1000.0,
+	       stats->max_late_ns / 1000.0);
+	printf("overruns: %llu\n", stats->overruns);
+	if (output_group)
+		printf("chip skew (us): last %.3f, mean %.3f, max %.3f\n",
+		       gpiod_output_group_get_last_skew_ns(output_group) / 1000.0,
+		       gpiod_output_group_get_mean_skew_ns(output_group) / 1000.0,
+		       gpiod_output_group_get_max_skew_ns(output_group) / 1000.0);
+	if (!periods) {
+		fflush(stdout);
+		return;
+	}
+
+	printf("period error histogram:\n");
+
+	for (i = 0; i < TIMING_BUCKETS; i++)
+		printf("  %-8s %12llu %6.2f%%\n", bucket_names[i],
+		       stats->histogram[i],
+		       100.0 * stats->histogram[i] / periods);
+
+	fflush(stdout);
+}
+
 /*
  * Toggle the resolved lines as specified by the toggle_periods,
  * and apply the values to the requests.
  * offset and values are scratch pads for working.
+ *
+ * Each toggle is scheduled at an absolute deadline derived from the start of
+ * the sequence, so the time spent setting the lines or waking up late does
+ * not accumulate into the period of the generated waveform.
  */
 static void toggle_sequence(int toggles, unsigned long long *toggle_periods,
 			    struct gpiod_line_request **requests,
 			    struct line_resolver *resolver,
 			    unsigned int *offsets,
-			    enum gpiod_line_value *values)
+			    enum gpiod_line_value *values,
+			    struct timing_stats *stats)
 {
+	uint64_t deadline_ns;
 	int i = 0;
 
 	if ((toggles == 1) && (toggle_periods[0] == 0))
 		return;
 
+	deadline_ns = clock_ns(CLOCK_MONOTONIC);
+
+	if (stats)
+		timing_stats_init(stats, deadline_ns);
+
 	for (;;) {
-		sleep_us(toggle_periods[i]);
+		deadline_ns += toggle_periods[i] * 1000;
+		if (!wait_deadline(deadline_ns))
+			return;
+
 		toggle_all_lines(resolver);
 		apply_values(requests, resolver, offsets, values);
 
+		if (stats)
+			timing_stats_add(stats, deadline_ns,
+					 clock_ns(CLOCK_MONOTONIC));
+
 		i++;
 		if ((i == toggles - 1) && (toggle_periods[i] == 0))
 			return;
@@ -401,6 +705,854 @@ static void toggle_sequence(int toggles, unsigned long long *toggle_periods,
 	}
 }
 
+static uint64_t waveform_lines_mask(int num_lines)
+{
+	return num_lines >= WAVEFORM_MAX_LINES ? ~0ULL :
+						 (1ULL << num_lines) - 1;
+}
+
+static void waveform_add_step(struct waveform *wf, const char *path,
+			      uint64_t time_ns, uint64_t mask, uint64_t bits)
+{
+	struct waveform_step *steps, *last = NULL;
+
+	if (wf->num_steps)
+		last = &wf->steps[wf->num_steps - 1];
+
+	if (last && time_ns < last->time_ns)
+		die("%s: waveform steps must be in chronological order", path);
+
+	/* Steps at the same time are applied with a single write. */
+	if (last && time_ns == last->time_ns) {
+		last->bits = (last->bits & ~mask) | (bits & mask);
+		last->mask |= mask;
+		return;
+	}
+
+	if (wf->num_steps == wf->capacity) {
+		wf->capacity = wf->capacity ? wf->capacity * 2 : 64;
+		steps = realloc(wf->steps, wf->capacity * sizeof(*steps));
+		if (!steps)
+			die("out of memory");
+
+		wf->steps = steps;
+	}
+
+	wf->steps[wf->num_steps].time_ns = time_ns;
+	wf->steps[wf->num_steps].mask = mask;
+	wf->steps[wf->num_steps].bits = bits & mask;
+	wf->num_steps++;
+}
+
+/*
+ * Text waveforms consist of lines of the form:
+ *
+ *     <time> <mask> <bits>
+ *
+ * where time uses the period syntax and is measured from the start of the
+ * playback, and bit N of mask and bits refers to the Nth line specified on
+ * the command line. Everything following a '#' is a comment.
+ */
+static void parse_waveform_text(FILE *fp, const char *path,
+				struct waveform *wf, int num_lines)
+{
+	unsigned long long mask, bits;
+	char *line = NULL, *tok[3], *end;
+	size_t linesize = 0;
+	int lineno = 0, i;
+	long long time;
+
+	while (getline(&line, &linesize, fp) >= 0) {
+		lineno++;
+
+		end = strchr(line, '#');
+		if (end)
+			*end = '\0';
+
+		tok[0] = strtok(line, " \t\r\n");
+		if (!tok[0])
+			continue;
+
+		for (i = 1; i < 3; i++) {
+			tok[i] = strtok(NULL, " \t\r\n");
+			if (!tok[i])
+				die("%s:%d: expected <time> <mask> <bits>",
+				    path, lineno);
+		}
+
+		if (strtok(NULL, " \t\r\n"))
+			die("%s:%d: trailing characters", path, lineno);
+
+		time = parse_period(tok[0]);
+		if (time < 0)
+			die("%s:%d: invalid time: %s", path, lineno, tok[0]);
+
+		mask = strtoull(tok[1], &end, 0);
+		if (*end != '\0' || (mask & ~waveform_lines_mask(num_lines)))
+			die("%s:%d: invalid mask: %s", path, lineno, tok[1]);
+
+		bits = strtoull(tok[2], &end, 0);
+		if (*end != '\0')
+			die("%s:%d: invalid bits: %s", path, lineno, tok[2]);
+
+		waveform_add_step(wf, path, time * 1000, mask, bits);
+	}
+
+	free(line);
+}
+
+/*
+ * Binary waveforms start with WAVEFORM_BINARY_MAGIC followed by records of
+ * three little-endian 64-bit words: time in nanoseconds, mask and bits.
+ */
+static void parse_waveform_binary(FILE *fp, const char *path,
+				  struct waveform *wf, int num_lines)
+{
+	uint64_t record[3];
+	size_t rd;
+
+	for (;;) {
+		rd = fread(record, 1, sizeof(record), fp);
+		if (rd == 0)
+			break;
+		if (rd != sizeof(record))
+			die("%s: truncated waveform record", path);
+
+		record[1] = le64toh(record[1]);
+		if (record[1] & ~waveform_lines_mask(num_lines))
+			die("%s: invalid mask in step %zu",
+			    path, wf->num_steps);
+
+		waveform_add_step(wf, path, le64toh(record[0]), record[1],
+				  le64toh(record[2]));
+	}
+}
+
+static void parse_vcd_timescale(FILE *fp, const char *path,
+				uint64_t *mul, uint64_t *div)
+{
+	static const struct {
+		const char *name;
+		uint64_t mul;
+		uint64_t div;
+	} units[] = {
+		{ "s", 1000000000ULL, 1 },
+		{ "ms", 1000000, 1 },
+		{ "us", 1000, 1 },
+		{ "ns", 1, 1 },
+		{ "ps", 1, 1000 },
+		{ "fs", 1, 1000000 },
+	};
+	char text[64] = "", tok[64];
+	unsigned long num;
+	char *unit;
+	size_t i;
+
+	while (fscanf(fp, "%63s", tok) == 1 && strcmp(tok, "$end") != 0) {
+		if (strlen(text) + strlen(tok) >= sizeof(text))
+			die("%s: invalid timescale", path);
+
+		strcat(text, tok);
+	}
+
+	num = strtoul(text, &unit, 10);
+	if (num != 1 && num != 10 && num != 100)
+		die("%s: invalid timescale: %s", path, text);
+
+	for (i = 0; i < sizeof(units) / sizeof(*units); i++) {
+		if (strcmp(unit, units[i].name) == 0) {
+			*mul = units[i].mul * num;
+			*div = units[i].div;
+			return;
+		}
+	}
+
+	die("%s: invalid timescale: %s", path, text);
+}
+
+static void skip_vcd_section(FILE *fp, const char *path)
+{
+	char tok[256];
+
+	while (fscanf(fp, "%255s", tok) == 1)
+		if (strcmp(tok, "$end") == 0)
+			return;
+
+	die("%s: unterminated VCD section", path);
+}
+
+/*
+ * gpiomon writes the names of lines mapped with vcd_name_char() and unnamed
+ * lines as line<offset>, match the reference the same way.
+ */
+static bool vcd_ref_matches(const char *ref, struct resolved_line *line)
+{
+	const char *name = gpiod_line_info_get_name(line->info);
+	char unnamed[32];
+
+	if (!name) {
+		snprintf(unnamed, sizeof(unnamed), "line%u", line->offset);
+		return strcmp(ref, unnamed) == 0;
+	}
+
+	for (; *name && *ref; name++, ref++)
+		if (*ref != vcd_name_char(*name))
+			return false;
+
+	return *name == '\0' && *ref == '\0';
+}
+
+/*
+ * Only scalar signals whose reference matches the id or the name of one of
+ * the requested lines are played back, everything else is ignored.
+ */
+static void parse_vcd_var(FILE *fp, const char *path,
+			  struct line_resolver *resolver,
+			  struct vcd_signal **signals, int *num_signals)
+{
+	char type[64], size[64], id[64], ref[256];
+	struct vcd_signal *sig;
+	int i;
+
+	if (fscanf(fp, "%63s %63s %63s %255s", type, size, id, ref) != 4)
+		die("%s: invalid VCD variable definition", path);
+
+	skip_vcd_section(fp, path);
+
+	if (strcmp(size, "1") != 0)
+		return;
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		if (strcmp(ref, resolver->lines[i].id) == 0 ||
+		    vcd_ref_matches(ref, &resolver->lines[i]))
+			break;
+	}
+
+	if (i == resolver->num_lines)
+		return;
+
+	sig = realloc(*signals, (*num_signals + 1) * sizeof(*sig));
+	if (!sig)
+		die("out of memory");
+
+	sig[*num_signals].id = strdup(id);
+	if (!sig[*num_signals].id)
+		die("out of memory");
+
+	sig[*num_signals].line = i;
+	*signals = sig;
+	(*num_signals)++;
+}
+
+static void parse_waveform_vcd(FILE *fp, const char *path,
+			       struct waveform *wf,
+			       struct line_resolver *resolver)
+{
+	uint64_t mul = 1, div = 1, time_ns = 0, mask = 0, bits = 0, frac;
+	struct vcd_signal *signals = NULL;
+	int num_signals = 0, i;
+	unsigned long long time;
+	char tok[256], *id;
+	bool value;
+
+	while (fscanf(fp, "%255s", tok) == 1) {
+		if (strcmp(tok, "$timescale") == 0) {
+			parse_vcd_timescale(fp, path, &mul, &div);
+			continue;
+		}
+
+		if (strcmp(tok, "$var") == 0) {
+			parse_vcd_var(fp, path, resolver, &signals,
+				      &num_signals);
+			continue;
+		}
+
+		/* Value changes are listed inside of the dump sections. */
+		if (strcmp(tok, "$dumpvars") == 0 ||
+		    strcmp(tok, "$dumpall") == 0 ||
+		    strcmp(tok, "$dumpon") == 0 ||
+		    strcmp(tok, "$dumpoff") == 0 ||
+		    strcmp(tok, "$end") == 0)
+			continue;
+
+		if (tok[0] == '$') {
+			skip_vcd_section(fp, path);
+			continue;
+		}
+
+		switch (tok[0]) {
+		case '#':
+			if (mask)
+				waveform_add_step(wf, path, time_ns, mask,
+						  bits);
+
+			errno = 0;
+			time = strtoull(tok + 1, &id, 10);
+			if (*id != '\0' || errno)
+				die("%s: invalid VCD time: %s", path, tok);
+
+			/*
+			 * Scale in two steps, the remainder is below div so
+			 * multiplying it can't overflow with the units of the
+			 * timescale.
+			 */
+			frac = time % div * mul / div;
+			if (time / div > (UINT64_MAX - frac) / mul)
+				die("%s: VCD time out of range: %s", path, tok);
+
+			time_ns = time / div * mul + frac;
+			mask = bits = 0;
+			continue;
+		case '0':
+		case '1':
+			value = tok[0] == '1';
+			id = tok + 1;
+			break;
+		case 'b':
+		case 'B':
+			value = strcmp(tok + 1, "1") == 0;
+			if (fscanf(fp, "%255s", tok) != 1)
+				die("%s: truncated VCD value change", path);
+
+			id = tok;
+			break;
+		case 'r':
+		case 'R':
+			if (fscanf(fp, "%255s", tok) != 1)
+				die("%s: truncated VCD value change", path);
+			continue;
+		case 'x':
+		case 'X':
+		case 'z':
+		case 'Z':
+			/* Undefined values leave the line unchanged. */
+			continue;
+		default:
+			die("%s: invalid VCD token: %s", path, tok);
+		}
+
+		for (i = 0; i < num_signals; i++) {
+			if (strcmp(id, signals[i].id) != 0)
+				continue;
+
+			mask |= 1ULL << signals[i].line;
+			if (value)
+				bits |= 1ULL << signals[i].line;
+			else
+				bits &= ~(1ULL << signals[i].line);
+		}
+	}
+
+	if (mask)
+		waveform_add_step(wf, path, time_ns, mask, bits);
+
+	if (!num_signals)
+		die("%s: no VCD signals match the requested lines", path);
+
+	for (i = 0; i < num_signals; i++)
+		free(signals[i].id);
+	free(signals);
+}
+
+static void load_waveform_or_die(const char *path, struct waveform *wf,
+				 struct line_resolver *resolver)
+{
+	char magic[sizeof(WAVEFORM_BINARY_MAGIC) - 1];
+	FILE *fp;
+	int c;
+
+	memset(wf, 0, sizeof(*wf));
+
+	fp = fopen(path, "r");
+	if (!fp)
+		die_perror("unable to open waveform file '%s'", path);
+
+	if (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+	    memcmp(magic, WAVEFORM_BINARY_MAGIC, sizeof(magic)) == 0) {
+		parse_waveform_binary(fp, path, wf, resolver->num_lines);
+	} else {
+		rewind(fp);
+
+		do {
+			c = getc(fp);
+		} while (isspace(c));
+		ungetc(c, fp);
+
+		if (c == '$')
+			parse_waveform_vcd(fp, path, wf, resolver);
+		else
+			parse_waveform_text(fp, path, wf,
+					    resolver->num_lines);
+	}
+
+	if (ferror(fp))
+		die_perror("error reading waveform file '%s'", path);
+
+	fclose(fp);
+
+	if (!wf->num_steps)
+		die("%s: waveform contains no steps", path);
+}
+
+/*
+ * Play the waveform back with each step scheduled at an absolute deadline
+ * relative to the start of the playback. Every step results in a single
+ * set_values call on each chip with lines changed by the step.
+ *
+ * Returns the number of steps applied only after the following step was
+ * already due.
+ */
+static size_t play_waveform(struct waveform *wf,
+			  struct gpiod_line_request **requests,
+			  struct line_resolver *resolver,
+			  unsigned int *offsets,
+			  enum gpiod_line_value *values,
+			  struct timing_stats *stats)
+{
+	uint64_t start_ns, now_ns, *chip_masks;
+	struct waveform_step *step;
+	size_t i, late = 0;
+	int j;
+
+	chip_masks = calloc(resolver->num_chips, sizeof(*chip_masks));
+	if (!chip_masks)
+		die("out of memory");
+
+	for (j = 0; j < resolver->num_lines; j++)
+		chip_masks[resolver->lines[j].chip_num] |= 1ULL << j;
+
+	start_ns = clock_ns(CLOCK_MONOTONIC);
+	timing_stats_init(stats, start_ns);
+
+	for (i = 0; i < wf->num_steps; i++) {
+		step = &wf->steps[i];
+
+		if (!wait_deadline(start_ns + step->time_ns))
+			break;
+
+		for (j = 0; j < resolver->num_lines; j++)
+			if (step->mask & (1ULL << j))
+				resolver->lines[j].value =
+					!!(step->bits & (1ULL << j));
+
+		for (j = 0; j < resolver->num_chips; j++)
+			if (step->mask & chip_masks[j])
+				set_chip_values(requests, resolver, j, offsets,
+						values);
+
+		commit_chip_values();
+
+		now_ns = clock_ns(CLOCK_MONOTONIC);
+		timing_stats_add(stats, start_ns + step->time_ns, now_ns);
+
+		if (i + 1 < wf->num_steps &&
+		    now_ns >= start_ns + wf->steps[i + 1].time_ns)
+			late++;
+	}
+
+	free(chip_masks);
+
+	return late;
+}
+
+/*
+ * Script commands are compiled into a list of operations, with the line ids
+ * resolved to bit masks. Consecutive set and toggle commands collapse into a
+ * single update, so they are applied with one write per chip.
+ */
+enum {
+	SCRIPT_OP_UPDATE = 0,
+	SCRIPT_OP_SLEEP,
+	SCRIPT_OP_GET,
+};
+
+struct script_op {
+	int type;
+	/*
+	 * bit N refers to the Nth requested line. Lines in mask are set to
+	 * the corresponding bits, then lines in toggle are inverted.
+	 */
+	uint64_t mask;
+	uint64_t bits;
+	uint64_t toggle;
+	uint64_t period_ns;
+	/* get prints these lines in the order in which they were given */
+	int *lines;
+	int num_lines;
+};
+
+struct script {
+	struct script_op *ops;
+	size_t num_ops;
+	size_t capacity;
+};
+
+static struct script_op *script_add_op(struct script *script, int type)
+{
+	struct script_op *ops, *last = NULL;
+
+	if (script->num_ops)
+		last = &script->ops[script->num_ops - 1];
+
+	if (last && last->type == type && type != SCRIPT_OP_GET)
+		return last;
+
+	if (script->num_ops == script->capacity) {
+		script->capacity = script->capacity ? script->capacity * 2 : 64;
+		ops = realloc(script->ops, script->capacity * sizeof(*ops));
+		if (!ops)
+			die("out of memory");
+
+		script->ops = ops;
+	}
+
+	last = &script->ops[script->num_ops++];
+	memset(last, 0, sizeof(*last));
+	last->type = type;
+
+	return last;
+}
+
+/*
+ * Split a line into words, returning the each of the words and the count.
+ *
+ * max_words specifies the max number of words that may be returned in words.
+ *
+ * Any escaping is ignored, on the assumption that the only escaped
+ * character of consequence is '"', and that names won't include quotes.
+ */
+static int split_words(char *line, int max_words, char **words)
+{
+	bool in_quotes = false, in_word = false;
+	int num_words = 0;
+
+	for (; (*line != '\0'); line++) {
+		if (!in_word) {
+			if (isspace(*line))
+				continue;
+
+			in_word = true;
+			in_quotes = (*line == '"');
+
+			/* count all words, but only store max_words */
+			if (num_words < max_words)
+				words[num_words] = line;
+		} else {
+			if (in_quotes) {
+				if (*line == '"')
+					in_quotes = false;
+				continue;
+			}
+			if (isspace(*line)) {
+				num_words++;
+				in_word = false;
+				*line = '\0';
+			}
+		}
+	}
+
+	if (in_word)
+		num_words++;
+
+	return num_words;
+}
+
+/* Return the index of the requested line, stripping any quotes, or -1. */
+static int script_find_line(struct line_resolver *resolver, char *id)
+{
+	size_t len;
+	int i;
+
+	len = strlen(id);
+	if (len >= 2 && id[0] == '"' && id[len - 1] == '"') {
+		id[len - 1] = '\0';
+		id++;
+	}
+
+	for (i = 0; i < resolver->num_lines; i++)
+		if (strcmp(id, resolver->lines[i].id) == 0)
+			return i;
+
+	return -1;
+}
+
+/* Resolve the lines of a get command, keeping their order and duplicates. */
+static void script_parse_get(struct script_op *op,
+			     struct line_resolver *resolver, char **words,
+			     int num_words, const char *path, int lineno)
+{
+	int line, capacity, i;
+
+	capacity = resolver->num_lines;
+	op->lines = calloc(capacity, sizeof(*op->lines));
+	if (!op->lines)
+		die("out of memory");
+
+	for (i = 0; i < num_words; i++) {
+		line = script_find_line(resolver, words[i]);
+		if (line < 0)
+			die("%s:%d: unknown line: '%s'", path, lineno,
+			    words[i]);
+
+		if (op->num_lines == capacity) {
+			capacity *= 2;
+			op->lines = realloc(op->lines,
+					    capacity * sizeof(*op->lines));
+			if (!op->lines)
+				die("out of memory");
+		}
+
+		op->lines[op->num_lines++] = line;
+	}
+
+	/* Without arguments, get prints all requested lines. */
+	if (!op->num_lines) {
+		for (line = 0; line < resolver->num_lines; line++)
+			op->lines[line] = line;
+		op->num_lines = resolver->num_lines;
+	}
+}
+
+static uint64_t script_parse_lines(struct line_resolver *resolver,
+				   char **words, int num_words,
+				   const char *path, int lineno)
+{
+	uint64_t mask = 0;
+	int line, i;
+
+	for (i = 0; i < num_words; i++) {
+		line = script_find_line(resolver, words[i]);
+		if (line < 0)
+			die("%s:%d: unknown line: '%s'", path, lineno,
+			    words[i]);
+
+		mask |= 1ULL << line;
+	}
+
+	return mask ?: waveform_lines_mask(resolver->num_lines);
+}
+
+/*
+ * Scripts consist of the commands of the interactive mode, one per line:
+ *
+ *     set <line=value>...
+ *     toggle [line]...
+ *     sleep <period>
+ *     get [line]...
+ *     exit
+ *
+ * Everything following a '#' is a comment.
+ */
+static void load_script_or_die(const char *path, struct script *script,
+			       struct line_resolver *resolver)
+{
+	char *line = NULL, **words = NULL, *cmd, *value, *end;
+	int lineno = 0, num_words, max_words = 0, idx, i;
+	enum gpiod_line_value val;
+	struct script_op *op;
+	size_t linesize = 0;
+	long long period;
+	FILE *fp;
+
+	memset(script, 0, sizeof(*script));
+
+	if (strcmp(path, "-") == 0) {
+		fp = stdin;
+		path = "<stdin>";
+	} else {
+		fp = fopen(path, "r");
+		if (!fp)
+			die_perror("unable to open script '%s'", path);
+	}
+
+	while (getline(&line, &linesize, fp) >= 0) {
+		lineno++;
+
+		end = strchr(line, '#');
+		if (end)
+			*end = '\0';
+
+		/* Words are separated by whitespace so this is an upper bound. */
+		if ((int)(strlen(line) / 2 + 1) > max_words) {
+			max_words = strlen(line) / 2 + 1;
+			words = realloc(words, max_words * sizeof(*words));
+			if (!words)
+				die("out of memory");
+		}
+
+		num_words = split_words(line, max_words, words);
+		if (!num_words)
+			continue;
+
+		cmd = words[0];
+		num_words--;
+
+		if (strcmp(cmd, "set") == 0) {
+			op = script_add_op(script, SCRIPT_OP_UPDATE);
+
+			if (!num_words)
+				die("%s:%d: at least one GPIO line value must be specified",
+				    path, lineno);
+
+			for (i = 1; i <= num_words; i++) {
+				value = strrchr(words[i], '=');
+				if (!value)
+					die("%s:%d: invalid line value: '%s'",
+					    path, lineno, words[i]);
+
+				*value++ = '\0';
+				val = parse_value(value);
+				if (val == GPIOD_LINE_VALUE_ERROR)
+					die("%s:%d: invalid line value: '%s'",
+					    path, lineno, value);
+
+				idx = script_find_line(resolver, words[i]);
+				if (idx < 0)
+					die("%s:%d: unknown line: '%s'",
+					    path, lineno, words[i]);
+
+				/* A set overrides the earlier toggles. */
+				op->mask |= 1ULL << idx;
+				op->toggle &= ~(1ULL << idx);
+				if (val == GPIOD_LINE_VALUE_ACTIVE)
+					op->bits |= 1ULL << idx;
+				else
+					op->bits &= ~(1ULL << idx);
+			}
+		} else if (strcmp(cmd, "toggle") == 0) {
+			op = script_add_op(script, SCRIPT_OP_UPDATE);
+			op->toggle ^= script_parse_lines(resolver, &words[1],
+							 num_words, path,
+							 lineno);
+		} else if (strcmp(cmd, "get") == 0) {
+			op = script_add_op(script, SCRIPT_OP_GET);
+			script_parse_get(op, resolver, &words[1], num_words,
+					 path, lineno);
+		} else if (strcmp(cmd, "sleep") == 0) {
+			if (!num_words)
+				die("%s:%d: a period must be specified",
+				    path, lineno);
+
+			period = parse_period(words[1]);
+			if (period < 0)
+				die("%s:%d: invalid period: '%s'",
+				    path, lineno, words[1]);
+
+			if (num_words > 1)
+				die("%s:%d: only one period can be specified",
+				    path, lineno);
+
+			op = script_add_op(script, SCRIPT_OP_SLEEP);
+			op->period_ns += period * 1000;
+		} else if (strcmp(cmd, "exit") == 0) {
+			break;
+		} else {
+			die("%s:%d: unknown command: '%s'", path, lineno, cmd);
+		}
+	}
+
+	if (ferror(fp))
+		die_perror("error reading script '%s'", path);
+
+	free(words);
+	free(line);
+	if (fp != stdin)
+		fclose(fp);
+}
+
+static void print_script_values(struct line_resolver *resolver,
+				struct script_op *op, bool unquoted)
+{
+	const char *fmt = unquoted ? "%s=%s" : "\"%s\"=%s";
+	struct resolved_line *line;
+	int i;
+
+	for (i = 0; i < op->num_lines; i++) {
+		line = &resolver->lines[op->lines[i]];
+
+		if (i)
+			fputc(' ', stdout);
+
+		printf(fmt, line->id, line->value ? "active" : "inactive");
+	}
+
+	fputc('\n', stdout);
+}
+
+/*
+ * Run the script with sleeps measured as absolute deadlines from the start
+ * of the script, so the time spent executing the commands doesn't
+ * accumulate. Every update results in a single set_values call on each chip
+ * with lines changed by the update.
+ */
+static void run_script(struct script *script,
+		       struct gpiod_line_request **requests,
+		       struct line_resolver *resolver, unsigned int *offsets,
+		       enum gpiod_line_value *values, bool unquoted,
+		       struct timing_stats *stats)
+{
+	uint64_t deadline_ns, *chip_masks, changed;
+	struct resolved_line *line;
+	struct script_op *op;
+	size_t i;
+	int j;
+
+	chip_masks = calloc(resolver->num_chips, sizeof(*chip_masks));
+	if (!chip_masks)
+		die("out of memory");
+
+	for (j = 0; j < resolver->num_lines; j++)
+		chip_masks[resolver->lines[j].chip_num] |= 1ULL << j;
+
+	deadline_ns = clock_ns(CLOCK_MONOTONIC);
+	if (stats)
+		timing_stats_init(stats, deadline_ns);
+
+	for (i = 0; i < script->num_ops; i++) {
+		op = &script->ops[i];
+
+		switch (op->type) {
+		case SCRIPT_OP_SLEEP:
+			/* Let the output through while waiting. */
+			fflush(stdout);
+			deadline_ns += op->period_ns;
+			if (!wait_deadline(deadline_ns))
+				goto out;
+			break;
+		case SCRIPT_OP_GET:
+			print_script_values(resolver, op, unquoted);
+			break;
+		case SCRIPT_OP_UPDATE:
+			for (j = 0; j < resolver->num_lines; j++) {
+				line = &resolver->lines[j];
+
+				if (op->mask & (1ULL << j))
+					line->value = !!(op->bits & (1ULL << j));
+				if (op->toggle & (1ULL << j))
+					line->value = !line->value;
+			}
+
+			changed = op->mask | op->toggle;
+
+			for (j = 0; j < resolver->num_chips; j++)
+				if (changed & chip_masks[j])
+					set_chip_values(requests, resolver, j,
+							offsets, values);
+
+			commit_chip_values();
+
+			if (stats)
+				timing_stats_add(stats, deadline_ns,
+						 clock_ns(CLOCK_MONOTONIC));
+			break;
+		}
+	}
+
+out:
+	fflush(stdout);
+	free(chip_masks);
+}
+
 #ifdef GPIOSET_INTERACTIVE
 
 /*
@@ -557,50 +1709,6 @@ static void print_interactive_help(void)
 	printf("        If no lines are specified then all requested lines are toggled\n\n");
 }
 
-/*
- * Split a line into words, returning the each of the words and the count.
- *
- * max_words specifies the max number of words that may be returned in words.
- *
- * Any escaping is ignored, on the assumption that the only escaped
- * character of consequence is '"', and that names won't include quotes.
- */
-static int split_words(char *line, int max_words, char **words)
-{
-	bool in_quotes = false, in_word = false;
-	int num_words = 0;
-
-	for (; (*line != '\0'); line++) {
-		if (!in_word) {
-			if (isspace(*line))
-				continue;
-
-			in_word = true;
-			in_quotes = (*line == '"');
-
-			/* count all words, but only store max_words */
-			if (num_words < max_words)
-				words[num_words] = line;
-		} else {
-			if (in_quotes) {
-				if (*line == '"')
-					in_quotes = false;
-				continue;
-			}
-			if (isspace(*line)) {
-				num_words++;
-				in_word = false;
-				*line = '\0';
-			}
-		}
-	}
-
-	if (in_word)
-		num_words++;
-
-	return num_words;
-}
-
 /* check if a line is specified somewhere in the rl_line_buffer */
 static bool in_line_buffer(const char *id)
 {
@@ -871,7 +1979,11 @@ int main(int argc, char **argv)
 	enum gpiod_line_value *values;
 	struct gpiod_chip *chip;
 	unsigned int *offsets;
+	struct timing_stats timing;
+	struct waveform waveform;
+	struct script script;
 	int i, num_lines, ret;
+	size_t late;
 	struct config cfg;
 	char **lines;
 
@@ -919,6 +2031,22 @@ int main(int argc, char **argv)
 	for (i = 0; i < num_lines; i++)
 		resolver->lines[i].value = values[i];
 
+	if (cfg.waveform) {
+		if (num_lines > WAVEFORM_MAX_LINES)
+			die("waveform supports at most %d lines",
+			    WAVEFORM_MAX_LINES);
+
+		load_waveform_or_die(cfg.waveform, &waveform, resolver);
+	}
+
+	if (cfg.script) {
+		if (num_lines > WAVEFORM_MAX_LINES)
+			die("script supports at most %d lines",
+			    WAVEFORM_MAX_LINES);
+
+		load_script_or_die(cfg.script, &script, resolver);
+	}
+
 	requests = calloc(resolver->num_chips, sizeof(*requests));
 	offsets = calloc(num_lines, sizeof(*offsets));
 	if (!requests || !offsets)
@@ -968,6 +2096,20 @@ int main(int argc, char **argv)
 		if (daemon(0, cfg.interactive) < 0)
 			die_perror("unable to daemonize");
 
+	if (cfg.realtime_priority)
+		setup_realtime(cfg.realtime_priority);
+
+	/* After daemonizing and with the scheduling policy for the threads. */
+	if (cfg.sync_outputs) {
+		output_group = gpiod_output_group_new(requests,
+						      resolver->num_chips);
+		if (!output_group)
+			die_perror("unable to create the output group");
+	}
+
+	if (cfg.timing_report)
+		setup_signals(NULL);
+
 	if (cfg.toggles) {
 		for (i = 0; i < cfg.toggles; i++)
 			if ((cfg.hold_period_us > cfg.toggle_periods[i]) &&
@@ -976,8 +2118,47 @@ int main(int argc, char **argv)
 				cfg.toggle_periods[i] = cfg.hold_period_us;
 
 		toggle_sequence(cfg.toggles, cfg.toggle_periods, requests,
-				resolver, offsets, values);
+				resolver, offsets, values,
+				cfg.timing_report ? &timing : NULL);
 		free(cfg.toggle_periods);
+
+		if (cfg.timing_report)
+			print_timing_report(&timing);
+
+		if (caught_signal)
+			reraise_signal(caught_signal);
+	}
+
+	if (cfg.waveform) {
+		late = play_waveform(&waveform, requests, resolver, offsets,
+				     values, &timing);
+
+		if (cfg.timing_report)
+			print_timing_report(&timing);
+
+		if (late)
+			print_error("%zu of %zu waveform steps were late",
+				    late, waveform.num_steps);
+
+		free(waveform.steps);
+
+		if (caught_signal)
+			reraise_signal(caught_signal);
+	}
+
+	if (cfg.script) {
+		run_script(&script, requests, resolver, offsets, values,
+			   cfg.unquoted, cfg.timing_report ? &timing : NULL);
+
+		if (cfg.timing_report)
+			print_timing_report(&timing);
+
+		for (i = 0; i < (int)script.num_ops; i++)
+			free(script.ops[i].lines);
+		free(script.ops);
+
+		if (caught_signal)
+			reraise_signal(caught_signal);
 	}
 
 	if (cfg.hold_period_us)
@@ -987,13 +2168,15 @@ int main(int argc, char **argv)
 	if (cfg.interactive)
 		interact(requests, resolver, lines, offsets, values,
 			 cfg.unquoted);
-	else if (!cfg.toggles)
+	else if (!cfg.toggles && !cfg.waveform && !cfg.script)
 		wait_fd(gpiod_line_request_get_fd(requests[0]));
 #else
-	if (!cfg.toggles)
+	if (!cfg.toggles && !cfg.waveform && !cfg.script)
 		wait_fd(gpiod_line_request_get_fd(requests[0]));
 #endif
 
+	gpiod_output_group_free(output_group);
+
 	for (i = 0; i < resolver->num_chips; i++)
 		gpiod_line_request_release(requests[i]);
 
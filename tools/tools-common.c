@@ -10,12 +10,15 @@
 #include <gpiod.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "tools-common.h"
 
@@ -209,6 +212,10 @@ void print_chip_help(void)
 	printf("\nChips:\n");
 	printf("    A GPIO chip may be identified by number, name, or path.\n");
 	printf("    e.g. '0', 'gpiochip0', and '/dev/gpiochip0' all refer to the same chip.\n");
+	printf("    Line names can be cached between runs by setting %s to the path of\n",
+	       LINE_CACHE_ENV);
+	printf("    the cache file, or to an empty string for %s.\n",
+	       GPIOD_LINE_RESOLVER_DEFAULT_CACHE);
 }
 
 void print_period_help(void)
@@ -510,6 +517,167 @@ int all_chip_paths(char ***paths_ptr)
 	return ret;
 }
 
+struct parallel_jobs {
+	void (*func)(int job, void *data);
+	void *data;
+	int num_jobs;
+	int next;
+};
+
+static void *parallel_worker(void *data)
+{
+	struct parallel_jobs *jobs = data;
+	int job;
+
+	for (;;) {
+		job = __atomic_fetch_add(&jobs->next, 1, __ATOMIC_RELAXED);
+		if (job >= jobs->num_jobs)
+			break;
+
+		jobs->func(job, jobs->data);
+	}
+
+	return NULL;
+}
+
+/*
+ * Call func for each of the jobs, on up to as many threads as there are CPUs
+ * online. Jobs are picked in order but may complete in any order.
+ */
+void run_parallel(int num_jobs, void (*func)(int job, void *data),
+		  void *data)
+{
+	struct parallel_jobs jobs;
+	int i, num_threads;
+	pthread_t *threads;
+	long num_cpus;
+
+	jobs.func = func;
+	jobs.data = data;
+	jobs.num_jobs = num_jobs;
+	jobs.next = 0;
+
+	num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	num_threads = num_cpus < num_jobs ? (int)num_cpus : num_jobs;
+
+	/* The calling thread is one of the workers. */
+	threads = NULL;
+	if (num_threads > 1)
+		threads = calloc(num_threads - 1, sizeof(*threads));
+
+	for (i = 0; threads && i < num_threads - 1; i++) {
+		/* Whatever threads couldn't be started, the rest do the work. */
+		if (pthread_create(&threads[i], NULL, parallel_worker, &jobs))
+			break;
+	}
+
+	parallel_worker(&jobs);
+
+	while (threads && i--)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+}
+
+volatile sig_atomic_t caught_signal;
+
+static void handle_signal(int signum)
+{
+	caught_signal = signum;
+}
+
+/*
+ * Install the handlers for SIGINT and SIGTERM, which only record the signal
+ * in caught_signal. There's no SA_RESTART, so that blocking calls return
+ * with EINTR and the loops of the tools notice the signal.
+ *
+ * If wait_mask is not NULL, the signals are also blocked and the previous
+ * mask is stored in it, for use with ppoll() or pselect() while waiting.
+ */
+void setup_signals(sigset_t *wait_mask)
+{
+	struct sigaction sa;
+	sigset_t mask;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGINT, &sa, NULL) || sigaction(SIGTERM, &sa, NULL))
+		die_perror("unable to install signal handlers");
+
+	if (!wait_mask)
+		return;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+
+	if (sigprocmask(SIG_BLOCK, &mask, wait_mask))
+		die_perror("unable to block signals");
+}
+
+/* Terminate with the same status the signal would have caused. */
+void reraise_signal(int signum)
+{
+	sigset_t mask;
+
+	signal(signum, SIG_DFL);
+	sigemptyset(&mask);
+	sigaddset(&mask, signum);
+	sigprocmask(SIG_UNBLOCK, &mask, NULL);
+	raise(signum);
+}
+
+uint64_t clock_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Sleep until the absolute CLOCK_MONOTONIC deadline.
+ * Returns false if interrupted by a signal that should end the tool.
+ *
+ * SIGINT and SIGTERM are blocked while checking caught_signal and then
+ * waited for together with the deadline, so that a signal arriving right
+ * before the wait doesn't go unnoticed until the deadline passes.
+ */
+bool wait_deadline(uint64_t deadline_ns)
+{
+	sigset_t mask, orig_mask;
+	struct timespec timeout;
+	uint64_t now;
+	int signum;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+
+	if (sigprocmask(SIG_BLOCK, &mask, &orig_mask))
+		die_perror("unable to block signals");
+
+	while (!caught_signal) {
+		now = clock_ns(CLOCK_MONOTONIC);
+		if (now >= deadline_ns)
+			break;
+
+		timeout.tv_sec = (deadline_ns - now) / 1000000000ULL;
+		timeout.tv_nsec = (deadline_ns - now) % 1000000000ULL;
+
+		signum = sigtimedwait(&mask, NULL, &timeout);
+		if (signum > 0)
+			caught_signal = signum;
+	}
+
+	sigprocmask(SIG_SETMASK, &orig_mask, NULL);
+
+	return !caught_signal;
+}
+
 static bool resolve_line(struct line_resolver *resolver,
 			 struct gpiod_line_info *info, int chip_num)
 {
@@ -613,6 +781,113 @@ struct line_resolver *resolver_init(int num_lines, char **lines, int num_chips,
 	return resolver;
 }
 
+/*
+ * The line name cache is opt-in so that plain invocations don't create
+ * files under /run.
+ */
+static const char *line_cache_path(void)
+{
+	const char *path = getenv(LINE_CACHE_ENV);
+
+	if (path && !*path)
+		return GPIOD_LINE_RESOLVER_DEFAULT_CACHE;
+
+	return path;
+}
+
+/*
+ * Lines identified only by name are looked up in the library's line name
+ * index, which avoids querying every line of every chip on each invocation.
+ * Only the chips containing requested lines are opened.
+ */
+static struct line_resolver *resolve_lines_by_name(int num_lines, char **lines,
+						   bool strict)
+{
+	struct gpiod_line_resolver *index;
+	struct line_resolver *resolver;
+	struct resolved_line *line;
+	struct gpiod_chip *chip;
+	size_t num_chips, chip_idx;
+	unsigned int offset;
+	const char *path;
+	bool chip_used;
+	int i, count;
+
+	index = gpiod_line_resolver_new(line_cache_path());
+	if (!index)
+		die_perror("unable to index GPIO lines");
+
+	num_chips = gpiod_line_resolver_get_num_chips(index);
+	resolver = resolver_init(num_lines, lines, num_chips, strict, true);
+
+	for (i = 0; i < num_lines; i++) {
+		line = &resolver->lines[i];
+
+		count = gpiod_line_resolver_find(index, line->id, &chip_idx,
+						 &offset);
+		if (count < 0)
+			die_perror("unable to look up line '%s'", line->id);
+		if (count == 0)
+			continue;
+		if (strict && count > 1)
+			die("line '%s' is not unique", line->id);
+
+		/* index of the chip in the line index until the chip is opened */
+		line->chip_num = chip_idx;
+		line->offset = offset;
+		line->resolved = true;
+		resolver->num_found++;
+	}
+
+	for (chip_idx = 0; chip_idx < num_chips; chip_idx++) {
+		chip_used = false;
+		chip = NULL;
+		path = gpiod_line_resolver_get_chip_path(index, chip_idx);
+
+		for (i = 0; i < num_lines; i++) {
+			line = &resolver->lines[i];
+			if (!line->resolved || line->info ||
+			    line->chip_num != (int)chip_idx)
+				continue;
+
+			if (!chip) {
+				chip = gpiod_chip_open(path);
+				if (!chip)
+					die_perror("unable to open chip '%s'",
+						   path);
+			}
+
+			line->info = gpiod_chip_get_line_info(chip,
+							      line->offset);
+			if (!line->info)
+				die_perror("unable to read the info for line %u from %s",
+					   line->offset, path);
+
+			line->chip_num = resolver->num_chips;
+			chip_used = true;
+		}
+
+		if (!chip_used)
+			continue;
+
+		resolver->chips[resolver->num_chips].info =
+						gpiod_chip_get_info(chip);
+		if (!resolver->chips[resolver->num_chips].info)
+			die_perror("unable to get info for '%s'", path);
+
+		resolver->chips[resolver->num_chips].path = strdup(path);
+		if (!resolver->chips[resolver->num_chips].path)
+			die("out of memory");
+
+		resolver->num_chips++;
+		gpiod_chip_close(chip);
+	}
+
+	gpiod_line_resolver_free(index);
+
+	return resolver;
+}
+
 struct line_resolver *resolve_lines(int num_lines, char **lines,
 				    const char *chip_id, bool strict,
 				    bool by_name)
@@ -626,10 +901,10 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 	char **paths;
 
 	if (chip_id == NULL)
-		by_name = true;
+		return resolve_lines_by_name(num_lines, lines, strict);
 
 	num_chips = chip_paths(chip_id, &paths);
-	if (chip_id && (num_chips == 0))
+	if (num_chips == 0)
 		die("cannot find GPIO chip character device '%s'", chip_id);
 
 	resolver = resolver_init(num_lines, lines, num_chips, strict, by_name);
@@ -637,14 +912,8 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 	for (i = 0; (i < num_chips) && !resolve_done(resolver); i++) {
 		chip_used = false;
 		chip = gpiod_chip_open(paths[i]);
-		if (!chip) {
-			if ((errno == EACCES) && (chip_id == NULL)) {
-				free(paths[i]);
-				continue;
-			}
-
+		if (!chip)
 			die_perror("unable to open chip '%s'", paths[i]);
-		}
 
 		chip_info = gpiod_chip_get_info(chip);
 		if (!chip_info)
@@ -652,7 +921,7 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 
 		num_lines = gpiod_chip_info_get_num_lines(chip_info);
 
-		if (i == 0 && chip_id && !by_name)
+		if (i == 0 && !by_name)
 			chip_used = resolve_lines_by_offset(resolver, num_lines);
 
 		for (offset = 0;
@@ -794,3 +1063,216 @@ void set_line_values(struct line_resolver *resolver, int chip_num,
 		}
 	}
 }
+
+/*
+ * Compile a --format string into a sequence of literal segments and field
+ * conversions so that it doesn't need to be parsed again for every event.
+ * Only the conversion characters listed in convs are treated as fields,
+ * unknown specifiers are output verbatim.
+ */
+struct output_format *parse_output_format(const char *fmt, const char *convs)
+{
+	struct output_format *format;
+	const char *curr, *text;
+	struct format_op *op;
+	size_t len;
+
+	/* There can't be more ops than characters in the string. */
+	format = calloc(1, sizeof(*format) +
+			   (strlen(fmt) + 1) * sizeof(struct format_op));
+	if (!format)
+		die("out of memory");
+
+	for (curr = fmt; *curr;) {
+		if (*curr == '%' && curr[1] != '\0' && strchr(convs, curr[1])) {
+			op = &format->ops[format->num_ops++];
+			op->conv = curr[1];
+			curr += 2;
+			continue;
+		}
+
+		text = curr;
+		len = 1;
+
+		if (*curr == '%' && curr[1] == '%') {
+			/* "%%" is a literal '%' */
+			curr += 2;
+		} else if (*curr == '%' && curr[1] != '\0') {
+			/* unknown specifiers are output verbatim */
+			len = 2;
+			curr += 2;
+		} else {
+			curr++;
+		}
+
+		op = format->num_ops ? &format->ops[format->num_ops - 1] : NULL;
+		if (op && !op->conv && op->text + op->len == text) {
+			op->len += len;
+		} else {
+			op = &format->ops[format->num_ops++];
+			op->text = text;
+			op->len = len;
+		}
+	}
+
+	return format;
+}
+
+void free_output_format(struct output_format *format)
+{
+	free(format);
+}
+
+#define OUTPUT_BUFFER_SIZE	4096
+#define OUTPUT_BUFFER_FLUSH	65536
+
+void output_buffer_init(struct output_buffer *buf)
+{
+	memset(buf, 0, sizeof(*buf));
+
+	buf->data = malloc(OUTPUT_BUFFER_SIZE);
+	if (!buf->data)
+		die("out of memory");
+
+	buf->size = OUTPUT_BUFFER_SIZE;
+	buf->time_fmt = -1;
+}
+
+void output_buffer_release(struct output_buffer *buf)
+{
+	free(buf->data);
+	buf->data = NULL;
+}
+
+void output_buffer_flush(struct output_buffer *buf)
+{
+	/*
+	 * Going through stdio keeps the ordering with anything printed
+	 * directly. Large writes bypass the stdio buffer anyway.
+	 */
+	if (buf->len && fwrite(buf->data, buf->len, 1, stdout) != 1)
+		die_perror("unable to write output");
+
+	buf->len = 0;
+}
+
+bool output_buffer_is_full(struct output_buffer *buf)
+{
+	return buf->len >= OUTPUT_BUFFER_FLUSH;
+}
+
+static char *output_buffer_reserve(struct output_buffer *buf, size_t len)
+{
+	size_t size;
+	char *data;
+
+	if (buf->len + len > buf->size) {
+		for (size = buf->size * 2; size < buf->len + len; size *= 2)
+			;
+
+		data = realloc(buf->data, size);
+		if (!data)
+			die("out of memory");
+
+		buf->data = data;
+		buf->size = size;
+	}
+
+	return buf->data + buf->len;
+}
+
+void output_buffer_append(struct output_buffer *buf, const char *str,
+			  size_t len)
+{
+	memcpy(output_buffer_reserve(buf, len), str, len);
+	buf->len += len;
+}
+
+void output_buffer_append_str(struct output_buffer *buf, const char *str)
+{
+	output_buffer_append(buf, str, strlen(str));
+}
+
+void output_buffer_append_char(struct output_buffer *buf, char c)
+{
+	*output_buffer_reserve(buf, 1) = c;
+	buf->len++;
+}
+
+/* Append val zero-padded to at least width digits. */
+static void output_buffer_append_padded(struct output_buffer *buf,
+					uint64_t val, unsigned int width)
+{
+	char digits[20], *pos = digits + sizeof(digits);
+
+	do {
+		*--pos = '0' + val % 10;
+		val /= 10;
+	} while (val);
+
+	while ((size_t)(digits + sizeof(digits) - pos) < width)
+		*--pos = '0';
+
+	output_buffer_append(buf, pos, digits + sizeof(digits) - pos);
+}
+
+void output_buffer_append_uint(struct output_buffer *buf, uint64_t val)
+{
+	output_buffer_append_padded(buf, val, 1);
+}
+
+void output_buffer_append_int(struct output_buffer *buf, int val)
+{
+	if (val < 0) {
+		output_buffer_append_char(buf, '-');
+		output_buffer_append_uint(buf, -(int64_t)val);
+	} else {
+		output_buffer_append_uint(buf, val);
+	}
+}
+
+/* Same output as print_event_time(). */
+void output_buffer_append_event_time(struct output_buffer *buf,
+				     uint64_t evtime, int format)
+{
+	time_t evtsec = evtime / 1000000000;
+	struct tm t;
+
+	if (!format) {
+		output_buffer_append_uint(buf, evtsec);
+		output_buffer_append_char(buf, '.');
+		output_buffer_append_padded(buf, evtime % 1000000000, 9);
+		return;
+	}
+
+	/* Calendar conversion is costly, only redo it once a second. */
+	if (evtsec != buf->time_sec || format != buf->time_fmt) {
+		if (format == 2)
+			localtime_r(&evtsec, &t);
+		else
+			gmtime_r(&evtsec, &t);
+
+		buf->time_len = strftime(buf->time_str, sizeof(buf->time_str),
+					 "%FT%T.", &t);
+		buf->time_sec = evtsec;
+		buf->time_fmt = format;
+	}
+
+	output_buffer_append(buf, buf->time_str, buf->time_len);
+	output_buffer_append_padded(buf, evtime % 1000000000, 9);
+
+	if (format != 2)
+		output_buffer_append_char(buf, 'Z');
+}
+
+/*
+ * VCD references are whitespace separated, so line names written to VCDs
+ * only keep the safe chars. Readers must map the names the same way.
+ */
+char vcd_name_char(char c)
+{
+	if (isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.')
+		return c;
+
+	return '_';
+}
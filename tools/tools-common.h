@@ -6,6 +6,8 @@
 #define __GPIOD_TOOLS_COMMON_H__
 
 #include <gpiod.h>
+#include <signal.h>
+#include <time.h>
 
 /*
  * Various helpers for the GPIO tools.
@@ -19,6 +21,12 @@
 
 #define GETOPT_NULL_LONGOPT	NULL, 0, NULL, 0
 
+/* environment variable enabling the line name cache */
+#define LINE_CACHE_ENV		"GPIOD_LINE_CACHE"
+
+/* the last SIGINT or SIGTERM received after setup_signals() */
+extern volatile sig_atomic_t caught_signal;
+
 struct resolved_line {
 	/* from the command line */
 	const char *id;
@@ -78,6 +86,35 @@ struct line_resolver {
 	struct resolved_line lines[];
 };
 
+/* a single step of a compiled custom output format */
+struct format_op {
+	/* conversion character, or 0 for literal text */
+	char conv;
+
+	/* literal text, pointing into the original format string */
+	const char *text;
+	size_t len;
+};
+
+/* a --format string compiled into a sequence of steps */
+struct output_format {
+	int num_ops;
+	struct format_op ops[];
+};
+
+/* output accumulated in memory and written to stdout in one go */
+struct output_buffer {
+	char *data;
+	size_t len;
+	size_t size;
+
+	/* the last formatted timestamp, reused while the second is the same */
+	time_t time_sec;
+	int time_fmt;
+	size_t time_len;
+	char time_str[32];
+};
+
 void set_prog_name(const char *name);
 const char *get_prog_name(void);
 const char *get_prog_short_name(void);
@@ -102,6 +139,12 @@ void print_line_id(struct line_resolver *resolver, int chip_num,
 bool chip_path_lookup(const char *id, char **path_ptr);
 int chip_paths(const char *id, char ***paths_ptr);
 int all_chip_paths(char ***paths_ptr);
+void run_parallel(int num_jobs, void (*func)(int job, void *data),
+		  void *data);
+void setup_signals(sigset_t *wait_mask);
+void reraise_signal(int signum);
+uint64_t clock_ns(clockid_t clock);
+bool wait_deadline(uint64_t deadline_ns);
 struct line_resolver *resolve_lines(int num_lines, char **lines,
 				    const char *chip_id, bool strict,
 				    bool by_name);
@@ -120,5 +163,20 @@ const char *get_line_name(struct line_resolver *resolver, int chip_num,
 			  unsigned int offset);
 void set_line_values(struct line_resolver *resolver, int chip_num,
 		     enum gpiod_line_value *values);
+struct output_format *parse_output_format(const char *fmt, const char *convs);
+void free_output_format(struct output_format *format);
+void output_buffer_init(struct output_buffer *buf);
+void output_buffer_release(struct output_buffer *buf);
+void output_buffer_flush(struct output_buffer *buf);
+bool output_buffer_is_full(struct output_buffer *buf);
+void output_buffer_append(struct output_buffer *buf, const char *str,
+			  size_t len);
+void output_buffer_append_str(struct output_buffer *buf, const char *str);
+void output_buffer_append_char(struct output_buffer *buf, char c);
+void output_buffer_append_uint(struct output_buffer *buf, uint64_t val);
+void output_buffer_append_int(struct output_buffer *buf, int val);
+void output_buffer_append_event_time(struct output_buffer *buf,
+				     uint64_t evtime, int format);
+char vcd_name_char(char c);
 
 #endif /* __GPIOD_TOOLS_COMMON_H__ */